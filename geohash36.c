@@ -1,350 +1,951 @@
-/***********************************************************************************************************************
-Includes
-***********************************************************************************************************************/
-#include "geohash36.h"
-
-/***********************************************************************************************************************
-Defines/macros
-***********************************************************************************************************************/
-
-/*!
-************************************************************************************************************************
-* @brief Defines the side size of base36 matrix.
-************************************************************************************************************************
-**/
-#define GEOHASH_MATRIX_SIDE                  6
-
-/*!
-************************************************************************************************************************
-* @brief Defines the Earth radius in meters.
-************************************************************************************************************************
-**/
-#ifndef EARTH_RADIUS_IN_METERS
-#define EARTH_RADIUS_IN_METERS               6370000
-#endif
-
-/*!
-************************************************************************************************************************
-* @brief Defines PI constant.
-************************************************************************************************************************
-**/
-#ifndef PI
-#define PI                                   3.14159265358979323846f
-#endif
-
-/*!
-************************************************************************************************************************
-* @brief Macro to calculate the absolute value of a number.
-************************************************************************************************************************
-**/
-#ifndef ABS
-#define ABS(value)                           (((value) < 0) ? (-value) : (value))
-#endif
-
-/***********************************************************************************************************************
-Typedefs/structs/unions
-***********************************************************************************************************************/
-typedef union
-{
-   uint8_t value;
-
-   struct
-   {
-      uint8_t curr : 7;
-      uint8_t next : 1;
-   }info;
-
-}hash_node_t;
-
-/***********************************************************************************************************************
-Constants
-***********************************************************************************************************************/
-const char base36[GEOHASH_MATRIX_SIDE][GEOHASH_MATRIX_SIDE] =
-{
-   '2', '3', '4', '5', '6', '7',
-   '8', '9', 'b', 'B', 'C', 'd',
-   'D', 'F', 'g', 'G', 'h', 'H',
-   'j', 'J', 'K', 'l', 'L', 'M',
-   'n', 'N', 'P', 'q', 'Q', 'r',
-   'R', 't', 'T', 'V', 'W', 'X'
-};
-//----------------------------------------------------------------------------------------------------------------------
-
-const uint8_t base36_inverse_hash[] =
-{
-   0x91, 0x15, 0xFF, 0xFF, 0x93, 0x18, 0x14, 0x00, 0x16, 0x00, 0x97, 0x1B, 0x99, 0x1D, 0xFF, 0xFF, 0x9A, 0x1F, 0x1C, 
-   0x00, 0x1E, 0x00, 0xFF, 0xFF, 0x20, 0x00, 0xFF, 0xFF, 0x80, 0x21, 0x81, 0x22, 0x82, 0x23, 0x03, 0x00, 0x04, 0x00, 
-   0x05, 0x00, 0x06, 0x00, 0x07, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x08, 0x00, 0xFF, 0xFF, 0x0B, 
-   0x00, 0xFF, 0xFF, 0x09, 0x00, 0x8A, 0x0E, 0x8C, 0x10, 0xFF, 0xFF, 0x8D, 0x12, 0x0F, 0x00
-};
-
-/***********************************************************************************************************************
-Internal functions
-***********************************************************************************************************************/
-
-/*!
-************************************************************************************************************************
-* @brief Calculates the potency of a number using multiplication
-************************************************************************************************************************
-* @param [in] base_: desired base value;
-* @param [in] exp_: desired expoent.
-************************************************************************************************************************
-* @return Result of potency.
-************************************************************************************************************************
-**/
-static int geohash36_fastPow(int base_, uint32_t exp_)
-{
-   int output = 1;
-
-   if (exp_ == 0)
-      return output;
-
-   while(exp_ > 0)
-   {
-      output *= base_;
-      exp_--;
-   }
-
-   return output;
-}
-
-/*!
-************************************************************************************************************************
-* @brief Gets the line and column of Base36 table given a character
-************************************************************************************************************************
-* @param [in] c_: pointer of instance of lgps_filter_t used to control all;
-* @param [out] line_: pointer to a integer which will store the line calculated;
-* @param [out] col_: pointer to a integer which will store the column calculated.
-************************************************************************************************************************
-* @return None.
-************************************************************************************************************************
-**/
-static void geohash36_charToIndexes(char c_, int8_t * line_, int8_t * col_)
-{
-   (*line_) = -1;
-   (*col_) = -1;
-
-   //for (int i = 0; i < GEOHASH_MATRIX_SIDE; i++)
-   //{
-   //   for (int j = 0; j < GEOHASH_MATRIX_SIDE; j++)
-   //   {
-   //      if (c_ == base36[i][j])
-   //      {
-   //         (*line_) = i;
-   //         (*col_) = j;
-   //         break;
-   //      }
-   //   }
-   //}
-
-   int possible_index = c_ % 36;
-
-   hash_node_t * node_ptr = (hash_node_t *)(base36_inverse_hash + (possible_index << 1));
-
-   if (node_ptr->value != 0xFF)
-   {
-      char temp = *(((char*)base36) + node_ptr->info.curr);
-
-      if (temp == c_)
-      {
-         (*line_) = node_ptr->info.curr / GEOHASH_MATRIX_SIDE;
-         (*col_) = node_ptr->info.curr % GEOHASH_MATRIX_SIDE;
-      }
-      else if(node_ptr->info.next)
-      {
-         node_ptr++;
-         temp = *(((char*)base36) + node_ptr->info.curr);
-
-         if (temp == c_)
-         {
-            (*line_) = node_ptr->info.curr / GEOHASH_MATRIX_SIDE;
-            (*col_) = node_ptr->info.curr % GEOHASH_MATRIX_SIDE;
-         }
-      }
-   }
-}
-
-/***********************************************************************************************************************
-External functions
-***********************************************************************************************************************/
-
-/*!
-************************************************************************************************************************
-* @brief Encodes desired latitude/longitude in Geohash-36 representation with a desired length.
-************************************************************************************************************************
-* @param [in] latitude_: latitude of position which will be encoded;
-* @param [in] longitude_: longitude of position which will be encoded;
-* @param [out] outBuffer_: pointer of string buffer which will receive the Geohash-36;
-* @param [in] numCharacters_: desired Geohash-36 length.
-************************************************************************************************************************
-* @return Geohash-36 length.
-************************************************************************************************************************
-**/
-int geohash36_encode(double latitude_, double longitude_, char * outBuffer_, int numCharacters_)
-{
-   //(51.504444, -0.086666)  -->   bdrdC26BqH
-
-   double lat[] = { -90.0,  90.0  };
-   double lon[] = { -180.0, 180.0 };
-   int latIdx = 0, longIdx = 0;
-   double slice;
-   int outbuffer_count = 0;
-    
-   if(outBuffer_ == NULL)
-       return 0;
-
-   while (numCharacters_ > 0)
-   {
-      slice = lon[0] - lon[1];
-      slice = ABS(slice) / (double)GEOHASH_MATRIX_SIDE;
-
-      for (int i = 0; i < GEOHASH_MATRIX_SIDE; i++)
-      {
-         double leftBoudary = (lon[0] + (i * slice));
-         double rightBoudary = (lon[0] + ((i + 1) * slice));
-
-         if ((longitude_ > leftBoudary) && (longitude_ <= rightBoudary))
-         {
-            longIdx = i;
-            lon[0] = leftBoudary;
-            lon[1] = rightBoudary;
-            break;
-         }
-      }
-
-      slice = lat[0] - lat[1];
-      slice = ABS(slice) / (double)GEOHASH_MATRIX_SIDE;
-
-      for (int i = 0; i < GEOHASH_MATRIX_SIDE; i++)
-      {
-         double leftBoudary = (lat[0] + (i * slice));
-         double rightBoudary = (lat[0] + ((i + 1) * slice));
-
-         if ((latitude_ > leftBoudary) && (latitude_ <= rightBoudary))
-         {
-            latIdx = GEOHASH_MATRIX_SIDE - 1 - i;
-            lat[0] = leftBoudary;
-            lat[1] = rightBoudary;
-            break;
-         }
-      }
-
-      outBuffer_[outbuffer_count++] = base36[latIdx][longIdx];
-      latIdx = 0;
-      longIdx = 0;
-      numCharacters_--;
-   }
-
-   return outbuffer_count;
-}
-
-/*!
-************************************************************************************************************************
-* @brief Decodes a Geohash-36 string.
-************************************************************************************************************************
-* @param [in] buffer_: input buffer which contains a Geohash-36 string;
-* @param [in] bufferSize_: "buffer_" length;
-* @param [out] outLatitude_: pointer to latitude which will store the result of decoding;
-* @param [out] outLongitude_: pointer to longitude which will store the result of decoding.
-************************************************************************************************************************
-* @return Initialize result code.
-* @retval  0  - Everything worked;
-* @retval -1  - Fail to decode due invalid input.
-************************************************************************************************************************
-**/
-int geohash36_decode(char * buffer_, int bufferSize_, double * outLatitude_, double * outLongitude_)
-{
-   //bdrdC26BqH   ~~>   (51.504444, -0.086666)
-
-   double lat[] = { -90.0,  90.0  };
-   double lon[] = { -180.0, 180.0 };
-   int8_t latLine, longCol;
-   double slice;
-    
-   if((buffer_ == NULL) || (outLatitude_ == NULL) || (outLongitude_ == NULL))
-      return -1;
-
-   for (int i = 0; i < bufferSize_; i++)
-   {
-      geohash36_charToIndexes(buffer_[i], &latLine, &longCol);
-
-      if (latLine == -1)
-         return -1;
-
-      latLine = GEOHASH_MATRIX_SIDE - 1 - latLine;
-
-      slice = lon[0] - lon[1];
-      slice = (ABS(slice) / (double)GEOHASH_MATRIX_SIDE);
-      lon[1] = lon[0] + (slice * (longCol + 1));
-      lon[0] = lon[0] + (slice * longCol);
-      
-      slice = lat[0] - lat[1];
-      slice = (ABS(slice) / (double)GEOHASH_MATRIX_SIDE);
-      lat[1] = lat[0] + (slice * (latLine + 1));
-      lat[0] = lat[0] + (slice * latLine);
-   }
-
-   (*outLatitude_) = (lat[1] + lat[0]) / 2;
-   (*outLongitude_) = (lon[1] + lon[0]) / 2;
-
-   return 0;
-}
-
-/*!
-************************************************************************************************************************
-* @brief Gets the precision (in meters) for latitude and longitude, given the number of characters in Geohash-36
-************************************************************************************************************************
-* @param [in] numCharacters_: desired Geohash-36 length;
-* @param [out] lat_prec: pointer to a integer which will store latitude precision in meters;
-* @param [out] long_prec: pointer to a integer which will store longitude precision in meters.
-************************************************************************************************************************
-* @return None.
-************************************************************************************************************************
-**/
-void geohash36_getPrecisionInMeters(int numCharacters_, double * lat_prec, double * long_prec)
-{
-   double one_grade_in_meters = (2 * PI * EARTH_RADIUS_IN_METERS) / 360;
-
-   (*lat_prec) = (90 / (double)geohash36_fastPow(GEOHASH_MATRIX_SIDE, numCharacters_)) * one_grade_in_meters;
-   (*long_prec) = (*lat_prec) * 2;
-}
-
-/*!
- ************************************************************************************************************************
- * @brief Gets a neighbor Geohash-36 given a input hash and a direction (north, northeast, etc).
- ************************************************************************************************************************
- * @param [in] buffer_: input buffer which contains a Geohash-36 string;
- * @param [in] bufferSize_: "buffer_" length;
- * @param [out] outBuffer_: pointer of string buffer which will receive the Geohash-36 neighbor;
- * @param [in] direction_: code to indicate the direction of neighbor. See header file to view expected codes.
- ************************************************************************************************************************
- * @return Initialize result code.
- * @retval  outBuffer_  - Everything worked;
- * @retval NULL         - Fail to decode due invalid input.
- ************************************************************************************************************************
- **/
-char * geohash36_getNeighbor(char * buffer_, int bufferSize_, char * outBuffer_, uint16_t direction_)
-{
-   int8_t lat_diff, long_diff;
-   int8_t latLine, longCol;
-   
-   if((buffer_ == NULL) || (bufferSize_ == 0) || (outBuffer_ == NULL))
-      return NULL;
-    
-   geohash36_charToIndexes(buffer_[bufferSize_ - 1], &latLine, &longCol);
-   
-   if(latLine == -1)
-      return NULL;
-   
-   lat_diff  = (int8_t)(direction_ >> 8);
-   long_diff = (int8_t)(direction_);
-   
-   latLine = (latLine + lat_diff) % GEOHASH_MATRIX_SIDE;
-   longCol = (longCol + long_diff) % GEOHASH_MATRIX_SIDE;
-      
-   memcpy(outBuffer_, buffer_, bufferSize_);
-   
-   outBuffer_[bufferSize_ - 1] = base36[latLine][longCol];
-   
-   return outBuffer_;
-}
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "geohash36.h"
+#include "geohash36_internal.h"
+
+/***********************************************************************************************************************
+Defines/macros
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Macro to calculate the absolute value of a number.
+************************************************************************************************************************
+**/
+#ifndef ABS
+#define ABS(value)                           (((value) < 0) ? (-value) : (value))
+#endif
+
+/***********************************************************************************************************************
+Typedefs/structs/unions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Characters which absorb the carry when a hash moves one cell (-1 when the carry leaves the whole grid).
+*
+* Moving a line/column forward increments the last character whose line/column is below 5 and resets the following
+* ones to 0; moving backward decrements the last one above 0 and sets the following ones to 5.
+************************************************************************************************************************
+**/
+typedef struct
+{
+   int lineForward;
+   int lineBackward;
+   int colForward;
+   int colBackward;
+
+}geohash36_carry_t;
+
+/***********************************************************************************************************************
+Constants
+***********************************************************************************************************************/
+const char base36[GEOHASH_MATRIX_SIDE][GEOHASH_MATRIX_SIDE] =
+{
+   '2', '3', '4', '5', '6', '7',
+   '8', '9', 'b', 'B', 'C', 'd',
+   'D', 'F', 'g', 'G', 'h', 'H',
+   'j', 'J', 'K', 'l', 'L', 'M',
+   'n', 'N', 'P', 'q', 'Q', 'r',
+   'R', 't', 'T', 'V', 'W', 'X'
+};
+//----------------------------------------------------------------------------------------------------------------------
+
+/* Line (high nibble) and column (low nibble) of each character in base36[][], 0xFF for invalid characters */
+const uint8_t base36_index[256] =
+{
+   0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+   0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+   0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+   0xFF, 0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x10, 0x11, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+   0xFF, 0xFF, 0x13, 0x14, 0x20, 0xFF, 0x21, 0x23, 0x25, 0xFF, 0x31, 0x32, 0x34, 0x35, 0x41, 0xFF,
+   0x42, 0x44, 0x50, 0xFF, 0x52, 0xFF, 0x53, 0x54, 0x55, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+   0xFF, 0xFF, 0x12, 0xFF, 0x15, 0xFF, 0xFF, 0x22, 0x24, 0xFF, 0x30, 0xFF, 0x33, 0xFF, 0x40, 0xFF,
+   0xFF, 0x43, 0x45, 0xFF, 0x51, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+   0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+   0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+   0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+   0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+   0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+   0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+   0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+   0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+//----------------------------------------------------------------------------------------------------------------------
+
+const uint64_t geohash36_pow6[GEOHASH36_MAX_CELL_CHARACTERS + 1] =
+{
+   1ULL, 6ULL, 36ULL, 216ULL, 1296ULL, 7776ULL, 46656ULL, 279936ULL, 1679616ULL, 10077696ULL, 60466176ULL,
+   362797056ULL, 2176782336ULL, 13060694016ULL, 78364164096ULL, 470184984576ULL, 2821109907456ULL,
+   16926659444736ULL, 101559956668416ULL, 609359740010496ULL, 3656158440062976ULL
+};
+//----------------------------------------------------------------------------------------------------------------------
+
+/* Rank in ASCII order of each base36[][] character, and the base36[][] position of each rank */
+const uint8_t base36_rank[GEOHASH_MATRIX_SIDE * GEOHASH_MATRIX_SIDE] =
+{
+   0,  1,  2,  3,  4,  5,  6,  7,  26, 8,  9,  27, 10, 11, 28, 12, 29, 13,
+   30, 14, 15, 31, 16, 17, 32, 18, 19, 33, 20, 34, 21, 35, 22, 23, 24, 25
+};
+
+const uint8_t base36_rank_position[GEOHASH_MATRIX_SIDE * GEOHASH_MATRIX_SIDE] =
+{
+   0,  1,  2,  3,  4,  5,  6,  7,  9,  10, 12, 13, 15, 17, 19, 20, 22, 23,
+   25, 26, 28, 30, 32, 33, 34, 35, 8,  11, 14, 16, 18, 21, 24, 27, 29, 31
+};
+//----------------------------------------------------------------------------------------------------------------------
+
+/***********************************************************************************************************************
+Internal functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Gets the line and column of Base36 table given a character
+************************************************************************************************************************
+* @param [in] c_: Geohash-36 character;
+* @param [out] line_: pointer to a integer which will store the line calculated;
+* @param [out] col_: pointer to a integer which will store the column calculated.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_charToIndexes(char c_, int8_t * line_, int8_t * col_)
+{
+   uint8_t index = base36_index[(uint8_t)c_];
+
+   (*line_) = (index == 0xFF) ? -1 : (int8_t)(index >> 4);
+   (*col_) = (index == 0xFF) ? -1 : (int8_t)(index & 0x0F);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Converts a position inside the grid (in cells) to the index of the cell which contains it.
+*
+* Cells are left-open/right-closed, like the original boundary scan: a position exactly on a boundary belongs to the
+* cell before it. Positions outside the grid (and NaN) are clamped to the first/last cell. The position is a rounded
+* double, so a coordinate within a few ulps of a boundary can land in the next cell; the boundary scan rounded its
+* boundaries too, and the two occasionally disagree on such coordinates.
+************************************************************************************************************************
+* @param [in] position_: position in cells, from 0 to "numCells_";
+* @param [in] numCells_: number of cells in this axis;
+* @param [out] remainder_: optional pointer which will store the position inside the cell, from 0 to 1.
+************************************************************************************************************************
+* @return Cell index.
+************************************************************************************************************************
+**/
+uint64_t geohash36_quantize(double position_, uint64_t numCells_, double * remainder_)
+{
+   double limit = (double)numCells_;
+   uint64_t index;
+
+   position_ = (position_ > 0) ? position_ : 0;
+   position_ = (position_ < limit) ? position_ : limit;
+
+   index = (uint64_t)position_;
+
+   if ((double)index < position_)
+      index++;
+
+   index = (index > 0) ? (index - 1) : 0;
+
+   if (remainder_ != NULL)
+      (*remainder_) = position_ - (double)index;
+
+   return index;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Finds the characters which absorb the carry of a one cell move in each axis.
+************************************************************************************************************************
+* @param [in] buffer_: input buffer which contains a Geohash-36 string;
+* @param [in] bufferSize_: "buffer_" length;
+* @param [out] carry_: pointer to the structure which will store the positions.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input.
+************************************************************************************************************************
+**/
+static int geohash36_findCarry(const char * buffer_, int bufferSize_, geohash36_carry_t * carry_)
+{
+   int8_t latLine, longCol;
+
+   carry_->lineForward = carry_->lineBackward = carry_->colForward = carry_->colBackward = -1;
+
+   for (int i = 0; i < bufferSize_; i++)
+   {
+      geohash36_charToIndexes(buffer_[i], &latLine, &longCol);
+
+      if (latLine == -1)
+         return -1;
+
+      carry_->lineForward = (latLine < (GEOHASH_MATRIX_SIDE - 1)) ? i : carry_->lineForward;
+      carry_->lineBackward = (latLine > 0) ? i : carry_->lineBackward;
+      carry_->colForward = (longCol < (GEOHASH_MATRIX_SIDE - 1)) ? i : carry_->colForward;
+      carry_->colBackward = (longCol > 0) ? i : carry_->colBackward;
+   }
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Moves one line/column of a character (see geohash36_carry_t).
+************************************************************************************************************************
+* @param [in] value_: line or column of the character;
+* @param [in] position_: position of the character in the hash;
+* @param [in] delta_: -1, 0 or +1;
+* @param [in] forward_: position which absorbs the carry of +1;
+* @param [in] backward_: position which absorbs the carry of -1.
+************************************************************************************************************************
+* @return New line or column.
+************************************************************************************************************************
+**/
+static int8_t geohash36_stepIndex(int8_t value_, int position_, int delta_, int forward_, int backward_)
+{
+   if (delta_ > 0)
+      return (position_ == forward_) ? (value_ + 1) : ((position_ > forward_) ? 0 : value_);
+
+   if (delta_ < 0)
+      return (position_ == backward_) ? (value_ - 1) : ((position_ > backward_) ? (GEOHASH_MATRIX_SIDE - 1) : value_);
+
+   return value_;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Writes the neighbor of a hash (longitude wraps at the antimeridian, latitude stops at the poles).
+************************************************************************************************************************
+* @param [in] buffer_: input buffer which contains a valid Geohash-36 string;
+* @param [in] bufferSize_: "buffer_" length;
+* @param [in] carry_: carry positions of "buffer_" (see geohash36_findCarry);
+* @param [in] latDelta_: -1 (north), 0 or +1 (south);
+* @param [in] lonDelta_: -1 (west), 0 or +1 (east);
+* @param [out] outBuffer_: pointer of string buffer which will receive the Geohash-36 neighbor.
+************************************************************************************************************************
+* @return 0 if written, -1 if the neighbor is beyond a pole.
+************************************************************************************************************************
+**/
+static int geohash36_writeNeighbor(const char * buffer_, int bufferSize_, const geohash36_carry_t * carry_,
+                                   int latDelta_, int lonDelta_, char * outBuffer_)
+{
+   int8_t latLine, longCol;
+
+   if (((latDelta_ < 0) && (carry_->lineBackward == -1)) || ((latDelta_ > 0) && (carry_->lineForward == -1)))
+      return -1;
+
+   for (int i = 0; i < bufferSize_; i++)
+   {
+      geohash36_charToIndexes(buffer_[i], &latLine, &longCol);
+
+      latLine = geohash36_stepIndex(latLine, i, latDelta_, carry_->lineForward, carry_->lineBackward);
+      longCol = geohash36_stepIndex(longCol, i, lonDelta_, carry_->colForward, carry_->colBackward);
+
+      outBuffer_[i] = base36[latLine][longCol];
+   }
+
+   return 0;
+}
+
+/***********************************************************************************************************************
+External functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Encodes desired latitude/longitude in Geohash-36 representation with a desired length.
+************************************************************************************************************************
+* @param [in] latitude_: latitude of position which will be encoded;
+* @param [in] longitude_: longitude of position which will be encoded;
+* @param [out] outBuffer_: pointer of string buffer which will receive the Geohash-36;
+* @param [in] numCharacters_: desired Geohash-36 length.
+************************************************************************************************************************
+* @return Geohash-36 length.
+************************************************************************************************************************
+**/
+int geohash36_encode(double latitude_, double longitude_, char * outBuffer_, int numCharacters_)
+{
+   //(51.504444, -0.086666)  -->   bdrdC26BqH
+
+   geohash36_cell_t cell;
+   double latPosition, lonPosition;
+   int outbuffer_count = 0;
+    
+   if(outBuffer_ == NULL)
+       return 0;
+
+   cell.numCharacters = MIN(numCharacters_, GEOHASH36_MAX_CELL_CHARACTERS);
+
+   if (cell.numCharacters <= 0)
+      return 0;
+
+   latPosition = ((latitude_ + 90.0) * (double)geohash36_pow6[cell.numCharacters]) / 180.0;
+   lonPosition = ((longitude_ + 180.0) * (double)geohash36_pow6[cell.numCharacters]) / 360.0;
+
+   while (1)
+   {
+      cell.latIndex = geohash36_quantize(latPosition, geohash36_pow6[cell.numCharacters], &latPosition);
+      cell.lonIndex = geohash36_quantize(lonPosition, geohash36_pow6[cell.numCharacters], &lonPosition);
+
+      outbuffer_count += geohash36_cellToString(&cell, outBuffer_ + outbuffer_count);
+
+      // Longer hashes keep subdividing the remainder inside the last cell
+      cell.numCharacters = MIN(numCharacters_ - outbuffer_count, GEOHASH36_MAX_CELL_CHARACTERS);
+
+      if (cell.numCharacters <= 0)
+         break;
+
+      latPosition *= (double)geohash36_pow6[cell.numCharacters];
+      lonPosition *= (double)geohash36_pow6[cell.numCharacters];
+   }
+
+   return outbuffer_count;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Decodes a Geohash-36 string.
+************************************************************************************************************************
+* @param [in] buffer_: input buffer which contains a Geohash-36 string;
+* @param [in] bufferSize_: "buffer_" length;
+* @param [out] outLatitude_: pointer to latitude which will store the result of decoding;
+* @param [out] outLongitude_: pointer to longitude which will store the result of decoding.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Fail to decode due invalid input.
+************************************************************************************************************************
+**/
+int geohash36_decode(char * buffer_, int bufferSize_, double * outLatitude_, double * outLongitude_)
+{
+   //bdrdC26BqH   ~~>   (51.504444, -0.086666)
+
+   geohash36_cell_t cell;
+   double lat = -90.0, lon = -180.0;
+   double latWidth = 180.0, lonWidth = 360.0;
+   int digits;
+    
+   if((buffer_ == NULL) || (outLatitude_ == NULL) || (outLongitude_ == NULL))
+      return -1;
+
+   for (int i = 0; i < bufferSize_; i += digits)
+   {
+      digits = MIN(bufferSize_ - i, GEOHASH36_MAX_CELL_CHARACTERS);
+
+      if (geohash36_stringToCell(buffer_ + i, digits, &cell) != 0)
+         return -1;
+
+      latWidth /= (double)geohash36_pow6[digits];
+      lonWidth /= (double)geohash36_pow6[digits];
+      lat += (double)cell.latIndex * latWidth;
+      lon += (double)cell.lonIndex * lonWidth;
+   }
+
+   (*outLatitude_) = lat + (latWidth / 2);
+   (*outLongitude_) = lon + (lonWidth / 2);
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Gets the precision (in meters) for latitude and longitude, given the number of characters in Geohash-36
+************************************************************************************************************************
+* @param [in] numCharacters_: desired Geohash-36 length;
+* @param [out] lat_prec: pointer to a integer which will store latitude precision in meters;
+* @param [out] long_prec: pointer to a integer which will store longitude precision in meters.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+void geohash36_getPrecisionInMeters(int numCharacters_, double * lat_prec, double * long_prec)
+{
+   double one_grade_in_meters = (2 * PI * EARTH_RADIUS_IN_METERS) / 360;
+   int length = MAX(0, MIN(numCharacters_, GEOHASH36_MAX_CELL_CHARACTERS));
+
+   (*lat_prec) = (90 / (double)geohash36_pow6[length]) * one_grade_in_meters;
+   (*long_prec) = (*lat_prec) * 2;
+}
+
+/*!
+ ************************************************************************************************************************
+ * @brief Gets a neighbor Geohash-36 given a input hash and a direction (north, northeast, etc).
+ *
+ * Moves across parent cells when needed (the carry goes up through the prefix), wrapping the longitude at the
+ * antimeridian. There is no neighbor beyond the poles.
+ ************************************************************************************************************************
+ * @param [in] buffer_: input buffer which contains a Geohash-36 string;
+ * @param [in] bufferSize_: "buffer_" length;
+ * @param [out] outBuffer_: pointer of string buffer which will receive the Geohash-36 neighbor;
+ * @param [in] direction_: code to indicate the direction of neighbor. See header file to view expected codes.
+ ************************************************************************************************************************
+ * @return Initialize result code.
+ * @retval  outBuffer_  - Everything worked;
+ * @retval NULL         - Fail to decode due invalid input (or neighbor beyond a pole).
+ ************************************************************************************************************************
+ **/
+char * geohash36_getNeighbor(char * buffer_, int bufferSize_, char * outBuffer_, uint16_t direction_)
+{
+   geohash36_carry_t carry;
+   int8_t lat_diff, long_diff;
+   
+   if((buffer_ == NULL) || (bufferSize_ <= 0) || (outBuffer_ == NULL))
+      return NULL;
+    
+   if (geohash36_findCarry(buffer_, bufferSize_, &carry) != 0)
+      return NULL;
+   
+   // Codes keep the original "+5 means -1" convention of the base36 matrix
+   lat_diff  = (int8_t)(direction_ >> 8);
+   long_diff = (int8_t)(direction_);
+
+   lat_diff = (lat_diff == (GEOHASH_MATRIX_SIDE - 1)) ? -1 : lat_diff;
+   long_diff = (long_diff == (GEOHASH_MATRIX_SIDE - 1)) ? -1 : long_diff;
+
+   if ((lat_diff < -1) || (lat_diff > 1) || (long_diff < -1) || (long_diff > 1))
+      return NULL;
+      
+   if (geohash36_writeNeighbor(buffer_, bufferSize_, &carry, lat_diff, long_diff, outBuffer_) != 0)
+      return NULL;
+   
+   return outBuffer_;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Quantizes latitude/longitude into the integer grid of a Geohash-36 with a desired length.
+************************************************************************************************************************
+* @param [in] latitude_: latitude of position which will be encoded;
+* @param [in] longitude_: longitude of position which will be encoded;
+* @param [in] numCharacters_: desired Geohash-36 length (0 to GEOHASH36_MAX_CELL_CHARACTERS);
+* @param [out] outCell_: pointer to the cell which will store the result.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input.
+************************************************************************************************************************
+**/
+int geohash36_encodeCell(double latitude_, double longitude_, int numCharacters_, geohash36_cell_t * outCell_)
+{
+   if ((outCell_ == NULL) || (numCharacters_ < 0) || (numCharacters_ > GEOHASH36_MAX_CELL_CHARACTERS))
+      return -1;
+
+   outCell_->latIndex = geohash36_quantize(((latitude_ + 90.0) * (double)geohash36_pow6[numCharacters_]) / 180.0,
+                                           geohash36_pow6[numCharacters_], NULL);
+   outCell_->lonIndex = geohash36_quantize(((longitude_ + 180.0) * (double)geohash36_pow6[numCharacters_]) / 360.0,
+                                           geohash36_pow6[numCharacters_], NULL);
+   outCell_->numCharacters = numCharacters_;
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Converts a Geohash-36 string in its integer grid cell.
+************************************************************************************************************************
+* @param [in] buffer_: input buffer which contains a Geohash-36 string;
+* @param [in] bufferSize_: "buffer_" length (0 to GEOHASH36_MAX_CELL_CHARACTERS);
+* @param [out] outCell_: pointer to the cell which will store the result.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input.
+************************************************************************************************************************
+**/
+int geohash36_stringToCell(const char * buffer_, int bufferSize_, geohash36_cell_t * outCell_)
+{
+   uint64_t latIndex = 0, lonIndex = 0;
+   int8_t latLine, longCol;
+
+   if ((buffer_ == NULL) || (outCell_ == NULL) || (bufferSize_ < 0) || (bufferSize_ > GEOHASH36_MAX_CELL_CHARACTERS))
+      return -1;
+
+   for (int i = 0; i < bufferSize_; i++)
+   {
+      geohash36_charToIndexes(buffer_[i], &latLine, &longCol);
+
+      if (latLine == -1)
+         return -1;
+
+      latIndex = (latIndex * GEOHASH_MATRIX_SIDE) + (GEOHASH_MATRIX_SIDE - 1 - latLine);
+      lonIndex = (lonIndex * GEOHASH_MATRIX_SIDE) + longCol;
+   }
+
+   outCell_->latIndex = latIndex;
+   outCell_->lonIndex = lonIndex;
+   outCell_->numCharacters = bufferSize_;
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Writes the Geohash-36 characters of an integer grid cell (without null terminator).
+************************************************************************************************************************
+* @param [in] cell_: pointer to the cell which will be converted;
+* @param [out] outBuffer_: pointer of string buffer which will receive the Geohash-36.
+************************************************************************************************************************
+* @return Geohash-36 length (0 for invalid input).
+************************************************************************************************************************
+**/
+int geohash36_cellToString(const geohash36_cell_t * cell_, char * outBuffer_)
+{
+   uint64_t latIndex, lonIndex;
+   uint32_t latIndex32, lonIndex32;
+   int i;
+
+   if ((cell_ == NULL) || (outBuffer_ == NULL) || (cell_->numCharacters < 0) ||
+       (cell_->numCharacters > GEOHASH36_MAX_CELL_CHARACTERS))
+      return 0;
+
+   latIndex = cell_->latIndex;
+   lonIndex = cell_->lonIndex;
+   i = cell_->numCharacters - 1;
+
+   // Division by a constant is turned into a multiply-shift by the compiler (cheaper in 32 bits, up to 12 characters)
+   for (; (i >= 0) && ((latIndex | lonIndex) > UINT32_MAX); i--)
+   {
+      outBuffer_[i] = base36[GEOHASH_MATRIX_SIDE - 1 - (latIndex % GEOHASH_MATRIX_SIDE)][lonIndex % GEOHASH_MATRIX_SIDE];
+      latIndex /= GEOHASH_MATRIX_SIDE;
+      lonIndex /= GEOHASH_MATRIX_SIDE;
+   }
+
+   latIndex32 = (uint32_t)latIndex;
+   lonIndex32 = (uint32_t)lonIndex;
+
+   for (; i >= 0; i--)
+   {
+      outBuffer_[i] = base36[GEOHASH_MATRIX_SIDE - 1 - (latIndex32 % GEOHASH_MATRIX_SIDE)][lonIndex32 % GEOHASH_MATRIX_SIDE];
+      latIndex32 /= GEOHASH_MATRIX_SIDE;
+      lonIndex32 /= GEOHASH_MATRIX_SIDE;
+   }
+
+   return cell_->numCharacters;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Gets the latitude/longitude boundaries of an integer grid cell.
+************************************************************************************************************************
+* @param [in] cell_: pointer to the cell;
+* @param [out] outBounds_: pointer to the boundaries which will store the result.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input.
+************************************************************************************************************************
+**/
+int geohash36_getCellBounds(const geohash36_cell_t * cell_, geohash36_bounds_t * outBounds_)
+{
+   double latWidth, lonWidth;
+
+   if ((cell_ == NULL) || (outBounds_ == NULL) || (cell_->numCharacters < 0) ||
+       (cell_->numCharacters > GEOHASH36_MAX_CELL_CHARACTERS))
+      return -1;
+
+   latWidth = 180.0 / (double)geohash36_pow6[cell_->numCharacters];
+   lonWidth = 360.0 / (double)geohash36_pow6[cell_->numCharacters];
+
+   outBounds_->minLatitude = -90.0 + ((double)cell_->latIndex * latWidth);
+   outBounds_->maxLatitude = -90.0 + ((double)(cell_->latIndex + 1) * latWidth);
+   outBounds_->minLongitude = -180.0 + ((double)cell_->lonIndex * lonWidth);
+   outBounds_->maxLongitude = -180.0 + ((double)(cell_->lonIndex + 1) * lonWidth);
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Encodes desired latitude/longitude directly in a packed key.
+************************************************************************************************************************
+* @param [in] latitude_: latitude of position which will be encoded;
+* @param [in] longitude_: longitude of position which will be encoded;
+* @param [in] numCharacters_: desired Geohash-36 length (0 to GEOHASH36_KEY_MAX_CHARACTERS).
+************************************************************************************************************************
+* @return Packed key or GEOHASH36_KEY_INVALID.
+************************************************************************************************************************
+**/
+geohash36_key_t geohash36_encodeKey(double latitude_, double longitude_, int numCharacters_)
+{
+   geohash36_cell_t cell;
+
+   if ((numCharacters_ > GEOHASH36_KEY_MAX_CHARACTERS) ||
+       (geohash36_encodeCell(latitude_, longitude_, numCharacters_, &cell) != 0))
+      return GEOHASH36_KEY_INVALID;
+
+   return geohash36_cellToKey(&cell);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Decodes a packed key to the center of its cell.
+************************************************************************************************************************
+* @param [in] key_: packed key;
+* @param [out] outLatitude_: pointer to latitude which will store the result of decoding;
+* @param [out] outLongitude_: pointer to longitude which will store the result of decoding.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Fail to decode due invalid input.
+************************************************************************************************************************
+**/
+int geohash36_decodeKey(geohash36_key_t key_, double * outLatitude_, double * outLongitude_)
+{
+   geohash36_cell_t cell;
+   geohash36_bounds_t bounds;
+
+   if ((outLatitude_ == NULL) || (outLongitude_ == NULL) || (geohash36_keyToCell(key_, &cell) != 0) ||
+       (geohash36_getCellBounds(&cell, &bounds) != 0))
+      return -1;
+
+   (*outLatitude_) = (bounds.minLatitude + bounds.maxLatitude) / 2;
+   (*outLongitude_) = (bounds.minLongitude + bounds.maxLongitude) / 2;
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Converts a Geohash-36 string in a packed key.
+************************************************************************************************************************
+* @param [in] buffer_: input buffer which contains a Geohash-36 string;
+* @param [in] bufferSize_: "buffer_" length (0 to GEOHASH36_KEY_MAX_CHARACTERS).
+************************************************************************************************************************
+* @return Packed key or GEOHASH36_KEY_INVALID.
+************************************************************************************************************************
+**/
+geohash36_key_t geohash36_stringToKey(const char * buffer_, int bufferSize_)
+{
+   geohash36_key_t key = 0;
+   int8_t latLine, longCol;
+
+   if ((buffer_ == NULL) || (bufferSize_ < 0) || (bufferSize_ > GEOHASH36_KEY_MAX_CHARACTERS))
+      return GEOHASH36_KEY_INVALID;
+
+   for (int i = 0; i < bufferSize_; i++)
+   {
+      geohash36_charToIndexes(buffer_[i], &latLine, &longCol);
+
+      if (latLine == -1)
+         return GEOHASH36_KEY_INVALID;
+
+      key |= (geohash36_key_t)base36_rank[(latLine * GEOHASH_MATRIX_SIDE) + longCol] <<
+             (GEOHASH36_KEY_FIRST_CHAR_SHIFT - (i * GEOHASH36_KEY_CHAR_BITS));
+   }
+
+   return key | (geohash36_key_t)bufferSize_;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Writes the Geohash-36 characters of a packed key (without null terminator).
+************************************************************************************************************************
+* @param [in] key_: packed key;
+* @param [out] outBuffer_: pointer of string buffer which will receive the Geohash-36.
+************************************************************************************************************************
+* @return Geohash-36 length (0 for invalid input).
+************************************************************************************************************************
+**/
+int geohash36_keyToString(geohash36_key_t key_, char * outBuffer_)
+{
+   int numCharacters = GEOHASH36_KEY_LENGTH(key_);
+
+   if ((outBuffer_ == NULL) || (!geohash36_keyIsValid(key_)))
+      return 0;
+
+   for (int i = 0; i < numCharacters; i++)
+   {
+      uint8_t rank = (key_ >> (GEOHASH36_KEY_FIRST_CHAR_SHIFT - (i * GEOHASH36_KEY_CHAR_BITS))) & GEOHASH36_KEY_CHAR_MASK;
+
+      outBuffer_[i] = *(((char*)base36) + base36_rank_position[rank]);
+   }
+
+   return numCharacters;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Converts an integer grid cell in a packed key.
+************************************************************************************************************************
+* @param [in] cell_: pointer to the cell (up to GEOHASH36_KEY_MAX_CHARACTERS).
+************************************************************************************************************************
+* @return Packed key or GEOHASH36_KEY_INVALID.
+************************************************************************************************************************
+**/
+geohash36_key_t geohash36_cellToKey(const geohash36_cell_t * cell_)
+{
+   geohash36_key_t key;
+   uint64_t latIndex, lonIndex;
+   int shift;
+
+   if ((cell_ == NULL) || (cell_->numCharacters < 0) || (cell_->numCharacters > GEOHASH36_KEY_MAX_CHARACTERS) ||
+       (cell_->latIndex >= geohash36_pow6[cell_->numCharacters]) ||
+       (cell_->lonIndex >= geohash36_pow6[cell_->numCharacters]))
+      return GEOHASH36_KEY_INVALID;
+
+   key = (geohash36_key_t)cell_->numCharacters;
+   latIndex = cell_->latIndex;
+   lonIndex = cell_->lonIndex;
+   shift = GEOHASH36_KEY_FIRST_CHAR_SHIFT - ((cell_->numCharacters - 1) * GEOHASH36_KEY_CHAR_BITS);
+
+   for (int i = cell_->numCharacters - 1; i >= 0; i--)
+   {
+      int position = ((GEOHASH_MATRIX_SIDE - 1 - (latIndex % GEOHASH_MATRIX_SIDE)) * GEOHASH_MATRIX_SIDE) +
+                     (lonIndex % GEOHASH_MATRIX_SIDE);
+
+      key |= (geohash36_key_t)base36_rank[position] << shift;
+      latIndex /= GEOHASH_MATRIX_SIDE;
+      lonIndex /= GEOHASH_MATRIX_SIDE;
+      shift += GEOHASH36_KEY_CHAR_BITS;
+   }
+
+   return key;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Converts a packed key in its integer grid cell.
+************************************************************************************************************************
+* @param [in] key_: packed key;
+* @param [out] outCell_: pointer to the cell which will store the result.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input.
+************************************************************************************************************************
+**/
+int geohash36_keyToCell(geohash36_key_t key_, geohash36_cell_t * outCell_)
+{
+   uint64_t latIndex = 0, lonIndex = 0;
+   int numCharacters = GEOHASH36_KEY_LENGTH(key_);
+
+   if ((outCell_ == NULL) || (!geohash36_keyIsValid(key_)))
+      return -1;
+
+   for (int i = 0; i < numCharacters; i++)
+   {
+      uint8_t rank = (key_ >> (GEOHASH36_KEY_FIRST_CHAR_SHIFT - (i * GEOHASH36_KEY_CHAR_BITS))) & GEOHASH36_KEY_CHAR_MASK;
+      uint8_t position = base36_rank_position[rank];
+
+      latIndex = (latIndex * GEOHASH_MATRIX_SIDE) + (GEOHASH_MATRIX_SIDE - 1 - (position / GEOHASH_MATRIX_SIDE));
+      lonIndex = (lonIndex * GEOHASH_MATRIX_SIDE) + (position % GEOHASH_MATRIX_SIDE);
+   }
+
+   outCell_->latIndex = latIndex;
+   outCell_->lonIndex = lonIndex;
+   outCell_->numCharacters = numCharacters;
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Checks if a packed key is well formed (valid length, valid characters and zeroed unused characters).
+************************************************************************************************************************
+* @param [in] key_: packed key.
+************************************************************************************************************************
+* @return 1 if valid, 0 otherwise.
+************************************************************************************************************************
+**/
+int geohash36_keyIsValid(geohash36_key_t key_)
+{
+   int numCharacters = GEOHASH36_KEY_LENGTH(key_);
+
+   if (numCharacters > GEOHASH36_KEY_MAX_CHARACTERS)
+      return 0;
+
+   if ((key_ & ~geohash36_keyPrefixMask(numCharacters) & ~GEOHASH36_KEY_LENGTH_MASK) != 0)
+      return 0;
+
+   for (int i = 0; i < numCharacters; i++)
+   {
+      if (((key_ >> (GEOHASH36_KEY_FIRST_CHAR_SHIFT - (i * GEOHASH36_KEY_CHAR_BITS))) & GEOHASH36_KEY_CHAR_MASK) >=
+          (GEOHASH_MATRIX_SIDE * GEOHASH_MATRIX_SIDE))
+         return 0;
+   }
+
+   return 1;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Gets the mask which selects the first characters of a packed key.
+************************************************************************************************************************
+* @param [in] numCharacters_: prefix length (0 to GEOHASH36_KEY_MAX_CHARACTERS).
+************************************************************************************************************************
+* @return Mask of the character bits of the prefix.
+************************************************************************************************************************
+**/
+geohash36_key_t geohash36_keyPrefixMask(int numCharacters_)
+{
+   if (numCharacters_ <= 0)
+      return 0;
+
+   numCharacters_ = MIN(numCharacters_, GEOHASH36_KEY_MAX_CHARACTERS);
+
+   return ~0ULL << (64 - (numCharacters_ * GEOHASH36_KEY_CHAR_BITS));
+}
+
+/*!
+************************************************************************************************************************
+* @brief Checks if a packed key is contained in (starts with) a prefix key.
+************************************************************************************************************************
+* @param [in] prefix_: packed key of the prefix;
+* @param [in] key_: packed key to be checked.
+************************************************************************************************************************
+* @return 1 if "key_" starts with "prefix_", 0 otherwise.
+************************************************************************************************************************
+**/
+int geohash36_keyHasPrefix(geohash36_key_t prefix_, geohash36_key_t key_)
+{
+   geohash36_key_t mask = geohash36_keyPrefixMask(GEOHASH36_KEY_LENGTH(prefix_));
+
+   return (GEOHASH36_KEY_LENGTH(prefix_) <= GEOHASH36_KEY_LENGTH(key_)) && (((prefix_ ^ key_) & mask) == 0);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Truncates a packed key to a shorter length (gets its ancestor cell).
+************************************************************************************************************************
+* @param [in] key_: packed key;
+* @param [in] numCharacters_: desired length (0 to the key length).
+************************************************************************************************************************
+* @return Packed key of the ancestor or GEOHASH36_KEY_INVALID.
+************************************************************************************************************************
+**/
+geohash36_key_t geohash36_keyTruncate(geohash36_key_t key_, int numCharacters_)
+{
+   if ((numCharacters_ < 0) || (numCharacters_ > GEOHASH36_KEY_LENGTH(key_)) ||
+       (GEOHASH36_KEY_LENGTH(key_) > GEOHASH36_KEY_MAX_CHARACTERS))
+      return GEOHASH36_KEY_INVALID;
+
+   return (key_ & geohash36_keyPrefixMask(numCharacters_)) | (geohash36_key_t)numCharacters_;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Gets the upper limit of the keys which start with a prefix.
+*
+* Every key with prefix "prefix_" is in the closed range [prefix_, geohash36_keyRangeEnd(prefix_)].
+************************************************************************************************************************
+* @param [in] prefix_: packed key of the prefix.
+************************************************************************************************************************
+* @return Upper limit of the range (not a valid key itself).
+************************************************************************************************************************
+**/
+geohash36_key_t geohash36_keyRangeEnd(geohash36_key_t prefix_)
+{
+   return prefix_ | ~geohash36_keyPrefixMask(GEOHASH36_KEY_LENGTH(prefix_));
+}
+
+/*!
+************************************************************************************************************************
+* @brief Gets the 8 neighbors of a Geohash-36 and the hash itself, parsing the input only once.
+************************************************************************************************************************
+* @param [in] buffer_: input buffer which contains a Geohash-36 string;
+* @param [in] bufferSize_: "buffer_" length;
+* @param [out] outBuffers_: buffer of GEO36_NEIGHBORS_COUNT * "bufferSize_" characters which will receive the hashes
+*                           in the order given by GEO36_NEIGHBORS_INDEX_* (neighbors beyond the poles are zeroed).
+************************************************************************************************************************
+* @return Bit mask of the written neighbors (bit GEO36_NEIGHBORS_INDEX_*), or -1 for invalid input.
+************************************************************************************************************************
+**/
+int geohash36_getNeighbors(const char * buffer_, int bufferSize_, char * outBuffers_)
+{
+   geohash36_carry_t carry;
+   int mask = 0;
+
+   if ((buffer_ == NULL) || (bufferSize_ <= 0) || (outBuffers_ == NULL))
+      return -1;
+
+   if (geohash36_findCarry(buffer_, bufferSize_, &carry) != 0)
+      return -1;
+
+   for (int i = 0; i < GEO36_NEIGHBORS_COUNT; i++)
+   {
+      char * out = outBuffers_ + (i * bufferSize_);
+
+      if (geohash36_writeNeighbor(buffer_, bufferSize_, &carry, (i / 3) - 1, (i % 3) - 1, out) == 0)
+         mask |= (1 << i);
+      else
+         memset(out, 0, bufferSize_);
+   }
+
+   return mask;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Moves an integer grid cell (longitude wraps at the antimeridian, latitude stops at the poles).
+************************************************************************************************************************
+* @param [in] cell_: pointer to the cell;
+* @param [in] latDelta_: number of rows to move (negative to north, positive to south);
+* @param [in] lonDelta_: number of columns to move (negative to west, positive to east);
+* @param [out] outCell_: pointer to the cell which will store the result.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input or destination beyond a pole.
+************************************************************************************************************************
+**/
+int geohash36_getCellNeighbor(const geohash36_cell_t * cell_, int64_t latDelta_, int64_t lonDelta_,
+                              geohash36_cell_t * outCell_)
+{
+   int64_t numCells, lat, lon;
+
+   if ((cell_ == NULL) || (outCell_ == NULL) || (cell_->numCharacters < 0) ||
+       (cell_->numCharacters > GEOHASH36_MAX_CELL_CHARACTERS))
+      return -1;
+
+   // Rows grow to the north in the grid, lines of base36[][] grow to the south
+   numCells = (int64_t)geohash36_pow6[cell_->numCharacters];
+   lat = (int64_t)cell_->latIndex - latDelta_;
+   lon = ((int64_t)cell_->lonIndex + (lonDelta_ % numCells) + numCells) % numCells;
+
+   if ((lat < 0) || (lat >= numCells))
+      return -1;
+
+   outCell_->latIndex = (uint64_t)lat;
+   outCell_->lonIndex = (uint64_t)lon;
+   outCell_->numCharacters = cell_->numCharacters;
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Gets the 8 neighbors of a packed key and the key itself.
+************************************************************************************************************************
+* @param [in] key_: packed key;
+* @param [out] outKeys_: array of GEO36_NEIGHBORS_COUNT keys which will receive the result in the order given by
+*                        GEO36_NEIGHBORS_INDEX_* (GEOHASH36_KEY_INVALID for neighbors beyond the poles).
+************************************************************************************************************************
+* @return Bit mask of the valid neighbors (bit GEO36_NEIGHBORS_INDEX_*), or -1 for invalid input.
+************************************************************************************************************************
+**/
+int geohash36_getKeyNeighbors(geohash36_key_t key_, geohash36_key_t * outKeys_)
+{
+   geohash36_cell_t cell, neighbor;
+   int mask = 0;
+
+   if ((outKeys_ == NULL) || (geohash36_keyToCell(key_, &cell) != 0))
+      return -1;
+
+   for (int i = 0; i < GEO36_NEIGHBORS_COUNT; i++)
+   {
+      if (geohash36_getCellNeighbor(&cell, (i / 3) - 1, (i % 3) - 1, &neighbor) == 0)
+      {
+         outKeys_[i] = geohash36_cellToKey(&neighbor);
+         mask |= (1 << i);
+      }
+      else
+      {
+         outKeys_[i] = GEOHASH36_KEY_INVALID;
+      }
+   }
+
+   return mask;
+}
@@ -1,129 +1,470 @@
-#ifndef _GEOHASH36_H_
-#define _GEOHASH36_H_
-
-/***********************************************************************************************************************
-Includes
-***********************************************************************************************************************/
-#include "string.h"
-#include "stdint.h"
-
-/***********************************************************************************************************************
-Defines/macros
-***********************************************************************************************************************/
-
-/*!
-************************************************************************************************************************
-* @brief Suggested number of characters in Geohash-46 (default).
-************************************************************************************************************************
-**/
-#define GEOHASH36_DEFAULT_NUM_CHARACTERS     10
-
-/*!
-************************************************************************************************************************
-* @brief Macro to get minimum between 2 values.
-************************************************************************************************************************
-**/
-#ifndef MIN
-#define MIN(a, b)                            (((a) < (b)) ? (a) : (b))
-#endif
-
-/*!
-************************************************************************************************************************
-* @brief Default codes to set which direction will used when we process neighbors.
- 
-'2', '3', '4', '5', '6', '7',
-'8', '9', 'b', 'B', 'C', 'd',
-'D', 'F', 'g', 'G', 'h', 'H',
-'j', 'J', 'K', 'l', 'L', 'M',
-'n', 'N', 'P', 'q', 'Q', 'r',
-'R', 't', 'T', 'V', 'W', 'X'
- 
-(+5,+5)  (+5, 0)  (+5,+1)
-( 0,+5)  ( 0, 0)  ( 0,+1)
-(+1,+5)  (+1, 0)  (+1,+1)
-
-(+5,+5) 0x0505 -> Northwest
-(+5, 0) 0x0500 -> North
-(+5,+1) 0x0501 -> Northeast
-( 0,+5) 0x0005 -> West
-( 0, 0) 0x0000 -> Center
-( 0,+1) 0x0001 -> East
-(+1,+5) 0x0105 -> Southwest
-(+1, 0) 0x0100 -> South
-(+1,+1) 0x0101 -> Southeast
-************************************************************************************************************************
-**/
-#define GEO36_NEIGHBORS_DIR_NORTHWEST     0x0505
-#define GEO36_NEIGHBORS_DIR_NORTH         0x0500
-#define GEO36_NEIGHBORS_DIR_NORTHEAST     0x0501
-#define GEO36_NEIGHBORS_DIR_WEST          0x0005
-#define GEO36_NEIGHBORS_DIR_CENTER        0x0000
-#define GEO36_NEIGHBORS_DIR_EAST          0x0001
-#define GEO36_NEIGHBORS_DIR_SOUTHWEST     0x0105
-#define GEO36_NEIGHBORS_DIR_SOUTH         0x0100
-#define GEO36_NEIGHBORS_DIR_SOUTHEAST     0x0101
-
-/***********************************************************************************************************************
-Exported functions
-***********************************************************************************************************************/
-
-/*!
-************************************************************************************************************************
-* @brief Encodes desired latitude/longitude in Geohash-36 representation with a desired length.
-************************************************************************************************************************
-* @param [in] latitude_: latitude of position which will be encoded;
-* @param [in] longitude_: longitude of position which will be encoded;
-* @param [out] outBuffer_: pointer of string buffer which will receive the Geohash-36;
-* @param [in] numCharacters_: desired Geohash-36 length.
-************************************************************************************************************************
-* @return Geohash-36 length.
-************************************************************************************************************************
-**/
-int geohash36_encode(double latitude_, double longitude_, char * outBuffer_, int numCharacters_);
-
-/*!
-************************************************************************************************************************
-* @brief Decodes a Geohash-36 string.
-************************************************************************************************************************
-* @param [in] buffer_: input buffer which contains a Geohash-36 string;
-* @param [in] bufferSize_: "buffer_" length;
-* @param [out] outLatitude_: pointer to latitude which will store the result of decoding;
-* @param [out] outLongitude_: pointer to longitude which will store the result of decoding.
-************************************************************************************************************************
-* @return Initialize result code.
-* @retval  0  - Everything worked;
-* @retval -1  - Fail to decode due invalid input.
-************************************************************************************************************************
-**/
-int geohash36_decode(char * buffer_, int bufferSize_, double * outLatitude_, double * outLongitude_);
-
-/*!
-************************************************************************************************************************
-* @brief Gets the precision (in meters) for latitude and longitude, given the number of characters in Geohash-36
-************************************************************************************************************************
-* @param [in] numCharacters_: desired Geohash-36 length;
-* @param [out] lat_prec: pointer to a integer which will store latitude precision in meters;
-* @param [out] long_prec: pointer to a integer which will store longitude precision in meters.
-************************************************************************************************************************
-* @return None.
-************************************************************************************************************************
-**/
-void geohash36_getPrecisionInMeters(int numCharacters_, double * lat_prec, double * long_prec);
-
-/*!
- ************************************************************************************************************************
- * @brief Gets a neighbor Geohash-36 given a input hash and a direction (north, northeast, etc).
- ************************************************************************************************************************
- * @param [in] buffer_: input buffer which contains a Geohash-36 string;
- * @param [in] bufferSize_: "buffer_" length;
- * @param [out] outBuffer_: pointer of string buffer which will receive the Geohash-36 neighbor;
- * @param [in] direction_: code to indicate the direction of neighbor. See header file to view expected codes.
- ************************************************************************************************************************
- * @return Initialize result code.
- * @retval outBuffer_  - Everything worked;
- * @retval NULL        - Fail to decode due invalid input.
- ************************************************************************************************************************
- **/
-char * geohash36_getNeighbor(char * buffer_, int bufferSize_, char * outBuffer_, uint16_t direction_);
-
-#endif // _GEOHASH36_H_
+#ifndef _GEOHASH36_H_
+#define _GEOHASH36_H_
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "string.h"
+#include "stdint.h"
+
+/***********************************************************************************************************************
+Defines/macros
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Suggested number of characters in Geohash-46 (default).
+************************************************************************************************************************
+**/
+#define GEOHASH36_DEFAULT_NUM_CHARACTERS     10
+
+/*!
+************************************************************************************************************************
+* @brief Maximum number of characters handled by the integer grid (6^20 < 2^53, so indexes stay exact in a double).
+************************************************************************************************************************
+**/
+#define GEOHASH36_MAX_CELL_CHARACTERS        20
+
+/*!
+************************************************************************************************************************
+* @brief Maximum number of characters which fits in a packed key (6 bits per character + 4 bits of length).
+************************************************************************************************************************
+**/
+#define GEOHASH36_KEY_MAX_CHARACTERS         10
+
+/*!
+************************************************************************************************************************
+* @brief Value returned by the key functions when the input is invalid (its length field is out of range).
+************************************************************************************************************************
+**/
+#define GEOHASH36_KEY_INVALID                ((geohash36_key_t)UINT64_MAX)
+
+/*!
+************************************************************************************************************************
+* @brief Macro to get the number of characters of a packed key.
+************************************************************************************************************************
+**/
+#define GEOHASH36_KEY_LENGTH(key)            ((int)((key) & 0x0F))
+
+/*!
+************************************************************************************************************************
+* @brief Macro to get minimum between 2 values.
+************************************************************************************************************************
+**/
+#ifndef MIN
+#define MIN(a, b)                            (((a) < (b)) ? (a) : (b))
+#endif
+
+/*!
+************************************************************************************************************************
+* @brief Macro to get maximum between 2 values.
+************************************************************************************************************************
+**/
+#ifndef MAX
+#define MAX(a, b)                            (((a) > (b)) ? (a) : (b))
+#endif
+
+/*!
+************************************************************************************************************************
+* @brief Default codes to set which direction will used when we process neighbors.
+ 
+'2', '3', '4', '5', '6', '7',
+'8', '9', 'b', 'B', 'C', 'd',
+'D', 'F', 'g', 'G', 'h', 'H',
+'j', 'J', 'K', 'l', 'L', 'M',
+'n', 'N', 'P', 'q', 'Q', 'r',
+'R', 't', 'T', 'V', 'W', 'X'
+ 
+(+5,+5)  (+5, 0)  (+5,+1)
+( 0,+5)  ( 0, 0)  ( 0,+1)
+(+1,+5)  (+1, 0)  (+1,+1)
+
+(+5,+5) 0x0505 -> Northwest
+(+5, 0) 0x0500 -> North
+(+5,+1) 0x0501 -> Northeast
+( 0,+5) 0x0005 -> West
+( 0, 0) 0x0000 -> Center
+( 0,+1) 0x0001 -> East
+(+1,+5) 0x0105 -> Southwest
+(+1, 0) 0x0100 -> South
+(+1,+1) 0x0101 -> Southeast
+************************************************************************************************************************
+**/
+#define GEO36_NEIGHBORS_DIR_NORTHWEST     0x0505
+#define GEO36_NEIGHBORS_DIR_NORTH         0x0500
+#define GEO36_NEIGHBORS_DIR_NORTHEAST     0x0501
+#define GEO36_NEIGHBORS_DIR_WEST          0x0005
+#define GEO36_NEIGHBORS_DIR_CENTER        0x0000
+#define GEO36_NEIGHBORS_DIR_EAST          0x0001
+#define GEO36_NEIGHBORS_DIR_SOUTHWEST     0x0105
+#define GEO36_NEIGHBORS_DIR_SOUTH         0x0100
+#define GEO36_NEIGHBORS_DIR_SOUTHEAST     0x0101
+
+/*!
+************************************************************************************************************************
+* @brief Positions of each direction in the output of geohash36_getNeighbors/geohash36_getKeyNeighbors (same layout of
+*        the table above, row by row).
+************************************************************************************************************************
+**/
+#define GEO36_NEIGHBORS_INDEX_NORTHWEST   0
+#define GEO36_NEIGHBORS_INDEX_NORTH       1
+#define GEO36_NEIGHBORS_INDEX_NORTHEAST   2
+#define GEO36_NEIGHBORS_INDEX_WEST        3
+#define GEO36_NEIGHBORS_INDEX_CENTER      4
+#define GEO36_NEIGHBORS_INDEX_EAST        5
+#define GEO36_NEIGHBORS_INDEX_SOUTHWEST   6
+#define GEO36_NEIGHBORS_INDEX_SOUTH       7
+#define GEO36_NEIGHBORS_INDEX_SOUTHEAST   8
+#define GEO36_NEIGHBORS_COUNT             9
+
+/***********************************************************************************************************************
+Typedefs/structs/unions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Integer grid representation of a Geohash-36 cell.
+*
+* At "numCharacters" characters the world is split in 6^numCharacters rows and columns. "latIndex" counts rows from
+* the south pole and "lonIndex" counts columns from the antimeridian (-180), so each character is one base-6 digit of
+* both indexes (most significant first).
+************************************************************************************************************************
+**/
+typedef struct
+{
+   uint64_t latIndex;
+   uint64_t lonIndex;
+   int numCharacters;
+
+}geohash36_cell_t;
+
+/*!
+************************************************************************************************************************
+* @brief Latitude/longitude boundaries of a Geohash-36 cell.
+************************************************************************************************************************
+**/
+typedef struct
+{
+   double minLatitude;
+   double maxLatitude;
+   double minLongitude;
+   double maxLongitude;
+
+}geohash36_bounds_t;
+
+/*!
+************************************************************************************************************************
+* @brief Geohash-36 packed in a 64 bits integer.
+*
+* Character "i" is stored in bits [63 - 6i, 58 - 6i] as its rank in ASCII order (0 = '2', 35 = 't'), unused
+* characters are zero and bits [3, 0] keep the length. So comparing two keys as integers gives the same order as
+* comparing the strings with memcmp/strcmp (a prefix comes before its descendants), and a key starts with a prefix when
+* (key & mask) == (prefix & mask), mask being geohash36_keyPrefixMask(prefix length).
+************************************************************************************************************************
+**/
+typedef uint64_t geohash36_key_t;
+
+/***********************************************************************************************************************
+Exported functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Encodes desired latitude/longitude in Geohash-36 representation with a desired length.
+************************************************************************************************************************
+* @param [in] latitude_: latitude of position which will be encoded;
+* @param [in] longitude_: longitude of position which will be encoded;
+* @param [out] outBuffer_: pointer of string buffer which will receive the Geohash-36;
+* @param [in] numCharacters_: desired Geohash-36 length.
+************************************************************************************************************************
+* @return Geohash-36 length.
+************************************************************************************************************************
+**/
+int geohash36_encode(double latitude_, double longitude_, char * outBuffer_, int numCharacters_);
+
+/*!
+************************************************************************************************************************
+* @brief Decodes a Geohash-36 string.
+************************************************************************************************************************
+* @param [in] buffer_: input buffer which contains a Geohash-36 string;
+* @param [in] bufferSize_: "buffer_" length;
+* @param [out] outLatitude_: pointer to latitude which will store the result of decoding;
+* @param [out] outLongitude_: pointer to longitude which will store the result of decoding.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Fail to decode due invalid input.
+************************************************************************************************************************
+**/
+int geohash36_decode(char * buffer_, int bufferSize_, double * outLatitude_, double * outLongitude_);
+
+/*!
+************************************************************************************************************************
+* @brief Gets the precision (in meters) for latitude and longitude, given the number of characters in Geohash-36
+************************************************************************************************************************
+* @param [in] numCharacters_: desired Geohash-36 length;
+* @param [out] lat_prec: pointer to a integer which will store latitude precision in meters;
+* @param [out] long_prec: pointer to a integer which will store longitude precision in meters.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+void geohash36_getPrecisionInMeters(int numCharacters_, double * lat_prec, double * long_prec);
+
+/*!
+ ************************************************************************************************************************
+ * @brief Gets a neighbor Geohash-36 given a input hash and a direction (north, northeast, etc).
+ *
+ * Moves across parent cells when needed (the carry goes up through the prefix), wrapping the longitude at the
+ * antimeridian. There is no neighbor beyond the poles.
+ ************************************************************************************************************************
+ * @param [in] buffer_: input buffer which contains a Geohash-36 string;
+ * @param [in] bufferSize_: "buffer_" length;
+ * @param [out] outBuffer_: pointer of string buffer which will receive the Geohash-36 neighbor;
+ * @param [in] direction_: code to indicate the direction of neighbor. See header file to view expected codes.
+ ************************************************************************************************************************
+ * @return Initialize result code.
+ * @retval outBuffer_  - Everything worked;
+ * @retval NULL        - Fail to decode due invalid input (or neighbor beyond a pole).
+ ************************************************************************************************************************
+ **/
+char * geohash36_getNeighbor(char * buffer_, int bufferSize_, char * outBuffer_, uint16_t direction_);
+
+/*!
+************************************************************************************************************************
+* @brief Quantizes latitude/longitude into the integer grid of a Geohash-36 with a desired length.
+************************************************************************************************************************
+* @param [in] latitude_: latitude of position which will be encoded;
+* @param [in] longitude_: longitude of position which will be encoded;
+* @param [in] numCharacters_: desired Geohash-36 length (0 to GEOHASH36_MAX_CELL_CHARACTERS);
+* @param [out] outCell_: pointer to the cell which will store the result.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input.
+************************************************************************************************************************
+**/
+int geohash36_encodeCell(double latitude_, double longitude_, int numCharacters_, geohash36_cell_t * outCell_);
+
+/*!
+************************************************************************************************************************
+* @brief Converts a Geohash-36 string in its integer grid cell.
+************************************************************************************************************************
+* @param [in] buffer_: input buffer which contains a Geohash-36 string;
+* @param [in] bufferSize_: "buffer_" length (0 to GEOHASH36_MAX_CELL_CHARACTERS);
+* @param [out] outCell_: pointer to the cell which will store the result.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input.
+************************************************************************************************************************
+**/
+int geohash36_stringToCell(const char * buffer_, int bufferSize_, geohash36_cell_t * outCell_);
+
+/*!
+************************************************************************************************************************
+* @brief Writes the Geohash-36 characters of an integer grid cell (without null terminator).
+************************************************************************************************************************
+* @param [in] cell_: pointer to the cell which will be converted;
+* @param [out] outBuffer_: pointer of string buffer which will receive the Geohash-36.
+************************************************************************************************************************
+* @return Geohash-36 length (0 for invalid input).
+************************************************************************************************************************
+**/
+int geohash36_cellToString(const geohash36_cell_t * cell_, char * outBuffer_);
+
+/*!
+************************************************************************************************************************
+* @brief Gets the latitude/longitude boundaries of an integer grid cell.
+************************************************************************************************************************
+* @param [in] cell_: pointer to the cell;
+* @param [out] outBounds_: pointer to the boundaries which will store the result.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input.
+************************************************************************************************************************
+**/
+int geohash36_getCellBounds(const geohash36_cell_t * cell_, geohash36_bounds_t * outBounds_);
+
+/*!
+************************************************************************************************************************
+* @brief Encodes desired latitude/longitude directly in a packed key.
+************************************************************************************************************************
+* @param [in] latitude_: latitude of position which will be encoded;
+* @param [in] longitude_: longitude of position which will be encoded;
+* @param [in] numCharacters_: desired Geohash-36 length (0 to GEOHASH36_KEY_MAX_CHARACTERS).
+************************************************************************************************************************
+* @return Packed key or GEOHASH36_KEY_INVALID.
+************************************************************************************************************************
+**/
+geohash36_key_t geohash36_encodeKey(double latitude_, double longitude_, int numCharacters_);
+
+/*!
+************************************************************************************************************************
+* @brief Decodes a packed key to the center of its cell.
+************************************************************************************************************************
+* @param [in] key_: packed key;
+* @param [out] outLatitude_: pointer to latitude which will store the result of decoding;
+* @param [out] outLongitude_: pointer to longitude which will store the result of decoding.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Fail to decode due invalid input.
+************************************************************************************************************************
+**/
+int geohash36_decodeKey(geohash36_key_t key_, double * outLatitude_, double * outLongitude_);
+
+/*!
+************************************************************************************************************************
+* @brief Converts a Geohash-36 string in a packed key.
+************************************************************************************************************************
+* @param [in] buffer_: input buffer which contains a Geohash-36 string;
+* @param [in] bufferSize_: "buffer_" length (0 to GEOHASH36_KEY_MAX_CHARACTERS).
+************************************************************************************************************************
+* @return Packed key or GEOHASH36_KEY_INVALID.
+************************************************************************************************************************
+**/
+geohash36_key_t geohash36_stringToKey(const char * buffer_, int bufferSize_);
+
+/*!
+************************************************************************************************************************
+* @brief Writes the Geohash-36 characters of a packed key (without null terminator).
+************************************************************************************************************************
+* @param [in] key_: packed key;
+* @param [out] outBuffer_: pointer of string buffer which will receive the Geohash-36.
+************************************************************************************************************************
+* @return Geohash-36 length (0 for invalid input).
+************************************************************************************************************************
+**/
+int geohash36_keyToString(geohash36_key_t key_, char * outBuffer_);
+
+/*!
+************************************************************************************************************************
+* @brief Converts an integer grid cell in a packed key.
+************************************************************************************************************************
+* @param [in] cell_: pointer to the cell (up to GEOHASH36_KEY_MAX_CHARACTERS).
+************************************************************************************************************************
+* @return Packed key or GEOHASH36_KEY_INVALID.
+************************************************************************************************************************
+**/
+geohash36_key_t geohash36_cellToKey(const geohash36_cell_t * cell_);
+
+/*!
+************************************************************************************************************************
+* @brief Converts a packed key in its integer grid cell.
+************************************************************************************************************************
+* @param [in] key_: packed key;
+* @param [out] outCell_: pointer to the cell which will store the result.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input.
+************************************************************************************************************************
+**/
+int geohash36_keyToCell(geohash36_key_t key_, geohash36_cell_t * outCell_);
+
+/*!
+************************************************************************************************************************
+* @brief Checks if a packed key is well formed (valid length, valid characters and zeroed unused characters).
+************************************************************************************************************************
+* @param [in] key_: packed key.
+************************************************************************************************************************
+* @return 1 if valid, 0 otherwise.
+************************************************************************************************************************
+**/
+int geohash36_keyIsValid(geohash36_key_t key_);
+
+/*!
+************************************************************************************************************************
+* @brief Gets the mask which selects the first characters of a packed key.
+************************************************************************************************************************
+* @param [in] numCharacters_: prefix length (0 to GEOHASH36_KEY_MAX_CHARACTERS).
+************************************************************************************************************************
+* @return Mask of the character bits of the prefix.
+************************************************************************************************************************
+**/
+geohash36_key_t geohash36_keyPrefixMask(int numCharacters_);
+
+/*!
+************************************************************************************************************************
+* @brief Checks if a packed key is contained in (starts with) a prefix key.
+************************************************************************************************************************
+* @param [in] prefix_: packed key of the prefix;
+* @param [in] key_: packed key to be checked.
+************************************************************************************************************************
+* @return 1 if "key_" starts with "prefix_", 0 otherwise.
+************************************************************************************************************************
+**/
+int geohash36_keyHasPrefix(geohash36_key_t prefix_, geohash36_key_t key_);
+
+/*!
+************************************************************************************************************************
+* @brief Truncates a packed key to a shorter length (gets its ancestor cell).
+************************************************************************************************************************
+* @param [in] key_: packed key;
+* @param [in] numCharacters_: desired length (0 to the key length).
+************************************************************************************************************************
+* @return Packed key of the ancestor or GEOHASH36_KEY_INVALID.
+************************************************************************************************************************
+**/
+geohash36_key_t geohash36_keyTruncate(geohash36_key_t key_, int numCharacters_);
+
+/*!
+************************************************************************************************************************
+* @brief Gets the upper limit of the keys which start with a prefix.
+*
+* Every key with prefix "prefix_" is in the closed range [prefix_, geohash36_keyRangeEnd(prefix_)].
+************************************************************************************************************************
+* @param [in] prefix_: packed key of the prefix.
+************************************************************************************************************************
+* @return Upper limit of the range (not a valid key itself).
+************************************************************************************************************************
+**/
+geohash36_key_t geohash36_keyRangeEnd(geohash36_key_t prefix_);
+
+/*!
+************************************************************************************************************************
+* @brief Gets the 8 neighbors of a Geohash-36 and the hash itself, parsing the input only once.
+************************************************************************************************************************
+* @param [in] buffer_: input buffer which contains a Geohash-36 string;
+* @param [in] bufferSize_: "buffer_" length;
+* @param [out] outBuffers_: buffer of GEO36_NEIGHBORS_COUNT * "bufferSize_" characters which will receive the hashes
+*                           in the order given by GEO36_NEIGHBORS_INDEX_* (neighbors beyond the poles are zeroed).
+************************************************************************************************************************
+* @return Bit mask of the written neighbors (bit GEO36_NEIGHBORS_INDEX_*), or -1 for invalid input.
+************************************************************************************************************************
+**/
+int geohash36_getNeighbors(const char * buffer_, int bufferSize_, char * outBuffers_);
+
+/*!
+************************************************************************************************************************
+* @brief Moves an integer grid cell (longitude wraps at the antimeridian, latitude stops at the poles).
+************************************************************************************************************************
+* @param [in] cell_: pointer to the cell;
+* @param [in] latDelta_: number of rows to move (negative to north, positive to south);
+* @param [in] lonDelta_: number of columns to move (negative to west, positive to east);
+* @param [out] outCell_: pointer to the cell which will store the result.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input or destination beyond a pole.
+************************************************************************************************************************
+**/
+int geohash36_getCellNeighbor(const geohash36_cell_t * cell_, int64_t latDelta_, int64_t lonDelta_,
+                              geohash36_cell_t * outCell_);
+
+/*!
+************************************************************************************************************************
+* @brief Gets the 8 neighbors of a packed key and the key itself.
+************************************************************************************************************************
+* @param [in] key_: packed key;
+* @param [out] outKeys_: array of GEO36_NEIGHBORS_COUNT keys which will receive the result in the order given by
+*                        GEO36_NEIGHBORS_INDEX_* (GEOHASH36_KEY_INVALID for neighbors beyond the poles).
+************************************************************************************************************************
+* @return Bit mask of the valid neighbors (bit GEO36_NEIGHBORS_INDEX_*), or -1 for invalid input.
+************************************************************************************************************************
+**/
+int geohash36_getKeyNeighbors(geohash36_key_t key_, geohash36_key_t * outKeys_);
+
+#endif // _GEOHASH36_H_
@@ -0,0 +1,555 @@
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include "geohash36_aggregate.h"
+#include "geohash36_batch.h"
+#include "geohash36_internal.h"
+
+/***********************************************************************************************************************
+Defines/macros
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Initial number of slots of the table (power of 2, kept at most half full).
+************************************************************************************************************************
+**/
+#define GEOHASH36_AGGREGATE_MIN_SLOTS        1024
+
+/*!
+************************************************************************************************************************
+* @brief Number of points encoded at a time by geohash36_aggregate_addPoints.
+************************************************************************************************************************
+**/
+#define GEOHASH36_AGGREGATE_BLOCK            256
+
+/***********************************************************************************************************************
+Typedefs/structs/unions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Run of points being accumulated: cell of the last point at each length, not yet added to the table.
+************************************************************************************************************************
+**/
+typedef struct
+{
+   geohash36_aggregate_cell_t pending[GEOHASH36_KEY_MAX_CHARACTERS + 1];
+   geohash36_key_t previous;
+   int previousCharacters;
+
+}geohash36_aggregate_run_t;
+
+/***********************************************************************************************************************
+Internal functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Gets the slot of the table for a key (hash of the key, then linear probing).
+************************************************************************************************************************
+* @param [in] cells_: table;
+* @param [in] numSlots_: number of slots (power of 2);
+* @param [in] key_: desired key.
+************************************************************************************************************************
+* @return Slot holding the key, or the empty slot where it would be.
+************************************************************************************************************************
+**/
+static geohash36_aggregate_cell_t * geohash36_aggregate_findSlot(geohash36_aggregate_cell_t * cells_, size_t numSlots_,
+                                                                 geohash36_key_t key_)
+{
+   size_t position = (size_t)((key_ * 0x9E3779B97F4A7C15ull) >> 32) & (numSlots_ - 1);
+
+   while ((cells_[position].key != key_) && (cells_[position].key != GEOHASH36_KEY_INVALID))
+      position = (position + 1) & (numSlots_ - 1);
+
+   return &cells_[position];
+}
+
+/*!
+************************************************************************************************************************
+* @brief Grows the table so that "numNewCells_" more cells keep it at most half full.
+************************************************************************************************************************
+* @param [in] aggregate_: pointer to the aggregate;
+* @param [in] numNewCells_: upper bound of the number of cells about to be added.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Allocation failure (the table is unchanged).
+************************************************************************************************************************
+**/
+static int geohash36_aggregate_reserve(geohash36_aggregate_t * aggregate_, size_t numNewCells_)
+{
+   geohash36_aggregate_cell_t * cells;
+   size_t numSlots = aggregate_->numSlots;
+   size_t i;
+
+   if (numNewCells_ > (SIZE_MAX / (4 * sizeof(geohash36_aggregate_cell_t))) - aggregate_->numCells)
+      return -1;
+
+   while (2 * (aggregate_->numCells + numNewCells_) > numSlots)
+      numSlots *= 2;
+
+   if (numSlots == aggregate_->numSlots)
+      return 0;
+
+   cells = malloc(numSlots * sizeof(geohash36_aggregate_cell_t));
+   if (cells == NULL)
+      return -1;
+
+   for (i = 0; i < numSlots; i++)
+      cells[i].key = GEOHASH36_KEY_INVALID;
+
+   for (i = 0; i < aggregate_->numSlots; i++)
+   {
+      if (aggregate_->cells[i].key != GEOHASH36_KEY_INVALID)
+         (*geohash36_aggregate_findSlot(cells, numSlots, aggregate_->cells[i].key)) = aggregate_->cells[i];
+   }
+
+   free(aggregate_->cells);
+   aggregate_->cells = cells;
+   aggregate_->numSlots = numSlots;
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Adds a count and a sum to a cell of the table (room for a new cell must have been reserved).
+************************************************************************************************************************
+* @param [in] aggregate_: pointer to the aggregate;
+* @param [in] cell_: key, count and sum to add.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_aggregate_addCell(geohash36_aggregate_t * aggregate_, const geohash36_aggregate_cell_t * cell_)
+{
+   geohash36_aggregate_cell_t * slot;
+
+   slot = geohash36_aggregate_findSlot(aggregate_->cells, aggregate_->numSlots, cell_->key);
+
+   if (slot->key == cell_->key)
+   {
+      slot->count += cell_->count;
+      slot->sum += cell_->sum;
+      return;
+   }
+
+   (*slot) = (*cell_);
+   aggregate_->numCells++;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Gets the number of leading characters a key shares with the previous key of a run.
+************************************************************************************************************************
+* @param [in] run_: run being accumulated;
+* @param [in] key_: key;
+* @param [in] numCharacters_: number of characters of the key to aggregate.
+************************************************************************************************************************
+* @return Number of common characters (0 at the start of the run).
+************************************************************************************************************************
+**/
+static int geohash36_aggregate_common(const geohash36_aggregate_run_t * run_, geohash36_key_t key_, int numCharacters_)
+{
+   geohash36_key_t difference;
+   int common;
+
+   if (run_->previous == GEOHASH36_KEY_INVALID)
+      return 0;
+
+   difference = (key_ ^ run_->previous) & ~GEOHASH36_KEY_LENGTH_MASK;
+   common = (difference != 0) ? (__builtin_clzll(difference) / GEOHASH36_KEY_CHAR_BITS) : GEOHASH36_KEY_MAX_CHARACTERS;
+
+   return MIN(common, MIN(numCharacters_, run_->previousCharacters));
+}
+
+/*!
+************************************************************************************************************************
+* @brief Counts the cells a run starts for a block of keys, which bounds the number of cells it adds to the table.
+************************************************************************************************************************
+* @param [in] aggregate_: pointer to the aggregate;
+* @param [in] run_: run being counted (only "previous" and "previousCharacters" are used);
+* @param [in] keys_: array of keys;
+* @param [in] n_: number of keys.
+************************************************************************************************************************
+* @return Number of cells started.
+************************************************************************************************************************
+**/
+static size_t geohash36_aggregate_countCells(const geohash36_aggregate_t * aggregate_, geohash36_aggregate_run_t * run_,
+                                             const geohash36_key_t * keys_, size_t n_)
+{
+   size_t i, count = 0;
+   int numCharacters;
+
+   for (i = 0; i < n_; i++)
+   {
+      if ((keys_[i] == GEOHASH36_KEY_INVALID) || (GEOHASH36_KEY_LENGTH(keys_[i]) > GEOHASH36_KEY_MAX_CHARACTERS))
+         continue;
+
+      numCharacters = MIN(GEOHASH36_KEY_LENGTH(keys_[i]), aggregate_->maxCharacters);
+      count += (size_t)(numCharacters - geohash36_aggregate_common(run_, keys_[i], numCharacters));
+
+      run_->previous = keys_[i];
+      run_->previousCharacters = numCharacters;
+   }
+
+   return count;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Starts an empty run.
+************************************************************************************************************************
+* @param [out] run_: run.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_aggregate_startRun(geohash36_aggregate_run_t * run_)
+{
+   int length;
+
+   for (length = 0; length <= GEOHASH36_KEY_MAX_CHARACTERS; length++)
+      run_->pending[length].key = GEOHASH36_KEY_INVALID;
+
+   run_->previous = GEOHASH36_KEY_INVALID;
+   run_->previousCharacters = 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Accumulates keys in a run: lengths within the common prefix with the previous key only update the pending
+*        cells, and the pending cells of the other lengths are added to the table and restarted.
+************************************************************************************************************************
+* @param [in] aggregate_: pointer to the aggregate (with room reserved for the cells started by the keys);
+* @param [in] run_: run being accumulated;
+* @param [in] keys_: array of keys;
+* @param [in] values_: optional array of values (can be NULL);
+* @param [in] n_: number of keys.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_aggregate_accumulate(geohash36_aggregate_t * aggregate_, geohash36_aggregate_run_t * run_,
+                                           const geohash36_key_t * keys_, const double * values_, size_t n_)
+{
+   geohash36_aggregate_cell_t * pending;
+   geohash36_key_t key;
+   double value;
+   int numCharacters, common, length;
+   size_t i;
+
+   for (i = 0; i < n_; i++)
+   {
+      key = keys_[i];
+
+      if ((key == GEOHASH36_KEY_INVALID) || (GEOHASH36_KEY_LENGTH(key) > GEOHASH36_KEY_MAX_CHARACTERS))
+         continue;
+
+      numCharacters = MIN(GEOHASH36_KEY_LENGTH(key), aggregate_->maxCharacters);
+      value = (values_ != NULL) ? values_[i] : 0.0;
+      common = geohash36_aggregate_common(run_, key, numCharacters);
+
+      for (length = 1; length <= common; length++)
+      {
+         run_->pending[length].count++;
+         run_->pending[length].sum += value;
+      }
+
+      for (length = common + 1; length <= aggregate_->maxCharacters; length++)
+      {
+         pending = &run_->pending[length];
+
+         if (pending->key != GEOHASH36_KEY_INVALID)
+            geohash36_aggregate_addCell(aggregate_, pending);
+
+         pending->key = (length <= numCharacters) ? geohash36_keyTruncate(key, length) : GEOHASH36_KEY_INVALID;
+         pending->count = 1;
+         pending->sum = value;
+      }
+
+      run_->previous = key;
+      run_->previousCharacters = numCharacters;
+   }
+}
+
+/*!
+************************************************************************************************************************
+* @brief Adds the pending cells of a run to the table.
+************************************************************************************************************************
+* @param [in] aggregate_: pointer to the aggregate;
+* @param [in] run_: run.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_aggregate_finishRun(geohash36_aggregate_t * aggregate_, const geohash36_aggregate_run_t * run_)
+{
+   int length;
+
+   for (length = 1; length <= aggregate_->maxCharacters; length++)
+   {
+      if (run_->pending[length].key != GEOHASH36_KEY_INVALID)
+         geohash36_aggregate_addCell(aggregate_, &run_->pending[length]);
+   }
+}
+
+/*!
+************************************************************************************************************************
+* @brief Compares two cells by key (qsort callback).
+************************************************************************************************************************
+**/
+static int geohash36_aggregate_compare(const void * a_, const void * b_)
+{
+   geohash36_key_t a = ((const geohash36_aggregate_cell_t *)a_)->key;
+   geohash36_key_t b = ((const geohash36_aggregate_cell_t *)b_)->key;
+
+   return (a < b) ? -1 : ((a > b) ? 1 : 0);
+}
+
+/***********************************************************************************************************************
+External functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Initializes an empty aggregate.
+************************************************************************************************************************
+* @param [out] aggregate_: pointer to the aggregate;
+* @param [in] maxCharacters_: longest cell length (1 to GEOHASH36_KEY_MAX_CHARACTERS); every length from 1 to
+*                             "maxCharacters_" is aggregated.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input or allocation failure.
+************************************************************************************************************************
+**/
+int geohash36_aggregate_init(geohash36_aggregate_t * aggregate_, int maxCharacters_)
+{
+   size_t i;
+
+   if ((aggregate_ == NULL) || (maxCharacters_ < 1) || (maxCharacters_ > GEOHASH36_KEY_MAX_CHARACTERS))
+      return -1;
+
+   memset(aggregate_, 0, sizeof(geohash36_aggregate_t));
+
+   aggregate_->cells = malloc(GEOHASH36_AGGREGATE_MIN_SLOTS * sizeof(geohash36_aggregate_cell_t));
+   if (aggregate_->cells == NULL)
+      return -1;
+
+   for (i = 0; i < GEOHASH36_AGGREGATE_MIN_SLOTS; i++)
+      aggregate_->cells[i].key = GEOHASH36_KEY_INVALID;
+
+   aggregate_->numSlots = GEOHASH36_AGGREGATE_MIN_SLOTS;
+   aggregate_->maxCharacters = maxCharacters_;
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Releases the memory of an aggregate.
+************************************************************************************************************************
+* @param [in] aggregate_: pointer to the aggregate.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+void geohash36_aggregate_free(geohash36_aggregate_t * aggregate_)
+{
+   if (aggregate_ == NULL)
+      return;
+
+   free(aggregate_->cells);
+   memset(aggregate_, 0, sizeof(geohash36_aggregate_t));
+}
+
+/*!
+************************************************************************************************************************
+* @brief Adds points given by packed keys. A key shorter than "maxCharacters" only counts for the lengths up to its
+*        own, and GEOHASH36_KEY_INVALID keys are skipped.
+************************************************************************************************************************
+* @param [in] aggregate_: pointer to the aggregate;
+* @param [in] keys_: array of keys;
+* @param [in] values_: optional array of values added to the sums (can be NULL, in which case sums stay 0);
+* @param [in] n_: number of keys.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input or allocation failure (the aggregate is left unchanged).
+************************************************************************************************************************
+**/
+int geohash36_aggregate_addKeys(geohash36_aggregate_t * aggregate_, const geohash36_key_t * keys_,
+                                const double * values_, size_t n_)
+{
+   geohash36_aggregate_run_t run;
+
+   if ((aggregate_ == NULL) || (aggregate_->cells == NULL) || ((keys_ == NULL) && (n_ > 0)))
+      return -1;
+
+   // Room for every cell the keys start is reserved first, so a failure leaves the aggregate unchanged
+   geohash36_aggregate_startRun(&run);
+
+   if (geohash36_aggregate_reserve(aggregate_, geohash36_aggregate_countCells(aggregate_, &run, keys_, n_)) != 0)
+      return -1;
+
+   geohash36_aggregate_startRun(&run);
+   geohash36_aggregate_accumulate(aggregate_, &run, keys_, values_, n_);
+   geohash36_aggregate_finishRun(aggregate_, &run);
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Adds points given by latitude/longitude (each one encoded once, at "maxCharacters").
+************************************************************************************************************************
+* @param [in] aggregate_: pointer to the aggregate;
+* @param [in] lat_: array of latitudes;
+* @param [in] lon_: array of longitudes;
+* @param [in] values_: optional array of values added to the sums (can be NULL);
+* @param [in] n_: number of points.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input or allocation failure (the aggregate is left unchanged).
+************************************************************************************************************************
+**/
+int geohash36_aggregate_addPoints(geohash36_aggregate_t * aggregate_, const double * lat_, const double * lon_,
+                                  const double * values_, size_t n_)
+{
+   geohash36_key_t keys[GEOHASH36_AGGREGATE_BLOCK];
+   geohash36_aggregate_run_t run;
+   size_t first, count, numNewCells = 0;
+
+   if ((aggregate_ == NULL) || (aggregate_->cells == NULL) || (((lat_ == NULL) || (lon_ == NULL)) && (n_ > 0)))
+      return -1;
+
+   // The points are encoded twice: once to reserve room for the cells they start, once to add them
+   geohash36_aggregate_startRun(&run);
+
+   for (first = 0; first < n_; first += count)
+   {
+      count = MIN(n_ - first, GEOHASH36_AGGREGATE_BLOCK);
+
+      if (geohash36_encodeKey_batch(lat_ + first, lon_ + first, count, keys, aggregate_->maxCharacters) != 0)
+         return -1;
+
+      numNewCells += geohash36_aggregate_countCells(aggregate_, &run, keys, count);
+   }
+
+   if (geohash36_aggregate_reserve(aggregate_, numNewCells) != 0)
+      return -1;
+
+   geohash36_aggregate_startRun(&run);
+
+   for (first = 0; first < n_; first += count)
+   {
+      count = MIN(n_ - first, GEOHASH36_AGGREGATE_BLOCK);
+
+      geohash36_encodeKey_batch(lat_ + first, lon_ + first, count, keys, aggregate_->maxCharacters);
+      geohash36_aggregate_accumulate(aggregate_, &run, keys, (values_ != NULL) ? values_ + first : NULL, count);
+   }
+
+   geohash36_aggregate_finishRun(aggregate_, &run);
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Adds the cells of another aggregate (partial result of another thread or shard) to an aggregate.
+************************************************************************************************************************
+* @param [in] aggregate_: pointer to the aggregate receiving the cells;
+* @param [in] other_: pointer to the aggregate to add (same "maxCharacters").
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input or allocation failure (the aggregate is left unchanged).
+************************************************************************************************************************
+**/
+int geohash36_aggregate_merge(geohash36_aggregate_t * aggregate_, const geohash36_aggregate_t * other_)
+{
+   size_t i;
+
+   if ((aggregate_ == NULL) || (other_ == NULL) || (aggregate_ == other_) || (aggregate_->cells == NULL) ||
+       (other_->cells == NULL) || (aggregate_->maxCharacters != other_->maxCharacters))
+      return -1;
+
+   if (geohash36_aggregate_reserve(aggregate_, other_->numCells) != 0)
+      return -1;
+
+   for (i = 0; i < other_->numSlots; i++)
+   {
+      if (other_->cells[i].key != GEOHASH36_KEY_INVALID)
+         geohash36_aggregate_addCell(aggregate_, &other_->cells[i]);
+   }
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Gets the aggregate of one cell.
+************************************************************************************************************************
+* @param [in] aggregate_: pointer to the aggregate;
+* @param [in] key_: key of the cell;
+* @param [out] outCell_: pointer which will receive the aggregate of the cell (count 0 when it has no points).
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input.
+************************************************************************************************************************
+**/
+int geohash36_aggregate_get(const geohash36_aggregate_t * aggregate_, geohash36_key_t key_,
+                            geohash36_aggregate_cell_t * outCell_)
+{
+   const geohash36_aggregate_cell_t * slot;
+
+   if ((aggregate_ == NULL) || (aggregate_->cells == NULL) || (outCell_ == NULL) || (key_ == GEOHASH36_KEY_INVALID))
+      return -1;
+
+   slot = geohash36_aggregate_findSlot(aggregate_->cells, aggregate_->numSlots, key_);
+
+   outCell_->key = key_;
+   outCell_->count = (slot->key == key_) ? slot->count : 0;
+   outCell_->sum = (slot->key == key_) ? slot->sum : 0.0;
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Copies every non-empty cell, sorted by key (each cell comes right before its children).
+************************************************************************************************************************
+* @param [in] aggregate_: pointer to the aggregate;
+* @param [out] outCells_: array which will receive the cells;
+* @param [in] maxCells_: size of "outCells_" (at least "numCells").
+************************************************************************************************************************
+* @return Number of cells, or -1 for invalid input.
+************************************************************************************************************************
+**/
+long geohash36_aggregate_export(const geohash36_aggregate_t * aggregate_, geohash36_aggregate_cell_t * outCells_,
+                                size_t maxCells_)
+{
+   size_t i, count = 0;
+
+   if ((aggregate_ == NULL) || (aggregate_->cells == NULL) || (maxCells_ < aggregate_->numCells) ||
+       ((outCells_ == NULL) && (aggregate_->numCells > 0)))
+      return -1;
+
+   for (i = 0; i < aggregate_->numSlots; i++)
+   {
+      if (aggregate_->cells[i].key != GEOHASH36_KEY_INVALID)
+         outCells_[count++] = aggregate_->cells[i];
+   }
+
+   if (count > 1)
+      qsort(outCells_, count, sizeof(geohash36_aggregate_cell_t), geohash36_aggregate_compare);
+
+   return (long)count;
+}
@@ -0,0 +1,155 @@
+#ifndef _GEOHASH36_AGGREGATE_H_
+#define _GEOHASH36_AGGREGATE_H_
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "stddef.h"
+#include "geohash36.h"
+
+/***********************************************************************************************************************
+Typedefs/structs/unions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Aggregate of a cell: number of points and sum of their values (GEOHASH36_KEY_INVALID for empty slots).
+************************************************************************************************************************
+**/
+typedef struct
+{
+   geohash36_key_t key;
+   uint64_t count;
+   double sum;
+
+}geohash36_aggregate_cell_t;
+
+/*!
+************************************************************************************************************************
+* @brief Counts and sums of points per cell, for every length from 1 to "maxCharacters".
+*
+* The cells are kept in an open addressing table keyed by packed key. Points are added in runs: the cells shared with
+* the previous point (its common prefix) are accumulated locally, and only the lengths where the prefix changes touch
+* the table, so spatially sorted or clustered input costs about one probe per point.
+************************************************************************************************************************
+**/
+typedef struct
+{
+   geohash36_aggregate_cell_t * cells;
+   size_t numSlots;
+   size_t numCells;
+   int maxCharacters;
+
+}geohash36_aggregate_t;
+
+/***********************************************************************************************************************
+Exported functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Initializes an empty aggregate.
+************************************************************************************************************************
+* @param [out] aggregate_: pointer to the aggregate;
+* @param [in] maxCharacters_: longest cell length (1 to GEOHASH36_KEY_MAX_CHARACTERS); every length from 1 to
+*                             "maxCharacters_" is aggregated.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input or allocation failure.
+************************************************************************************************************************
+**/
+int geohash36_aggregate_init(geohash36_aggregate_t * aggregate_, int maxCharacters_);
+
+/*!
+************************************************************************************************************************
+* @brief Releases the memory of an aggregate.
+************************************************************************************************************************
+* @param [in] aggregate_: pointer to the aggregate.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+void geohash36_aggregate_free(geohash36_aggregate_t * aggregate_);
+
+/*!
+************************************************************************************************************************
+* @brief Adds points given by packed keys. A key shorter than "maxCharacters" only counts for the lengths up to its
+*        own, and GEOHASH36_KEY_INVALID keys are skipped.
+************************************************************************************************************************
+* @param [in] aggregate_: pointer to the aggregate;
+* @param [in] keys_: array of keys;
+* @param [in] values_: optional array of values added to the sums (can be NULL, in which case sums stay 0);
+* @param [in] n_: number of keys.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input or allocation failure (the aggregate is left unchanged).
+************************************************************************************************************************
+**/
+int geohash36_aggregate_addKeys(geohash36_aggregate_t * aggregate_, const geohash36_key_t * keys_,
+                                const double * values_, size_t n_);
+
+/*!
+************************************************************************************************************************
+* @brief Adds points given by latitude/longitude (each one encoded once, at "maxCharacters").
+************************************************************************************************************************
+* @param [in] aggregate_: pointer to the aggregate;
+* @param [in] lat_: array of latitudes;
+* @param [in] lon_: array of longitudes;
+* @param [in] values_: optional array of values added to the sums (can be NULL);
+* @param [in] n_: number of points.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input or allocation failure (the aggregate is left unchanged).
+************************************************************************************************************************
+**/
+int geohash36_aggregate_addPoints(geohash36_aggregate_t * aggregate_, const double * lat_, const double * lon_,
+                                  const double * values_, size_t n_);
+
+/*!
+************************************************************************************************************************
+* @brief Adds the cells of another aggregate (partial result of another thread or shard) to an aggregate.
+************************************************************************************************************************
+* @param [in] aggregate_: pointer to the aggregate receiving the cells;
+* @param [in] other_: pointer to the aggregate to add (same "maxCharacters").
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input or allocation failure (the aggregate is left unchanged).
+************************************************************************************************************************
+**/
+int geohash36_aggregate_merge(geohash36_aggregate_t * aggregate_, const geohash36_aggregate_t * other_);
+
+/*!
+************************************************************************************************************************
+* @brief Gets the aggregate of one cell.
+************************************************************************************************************************
+* @param [in] aggregate_: pointer to the aggregate;
+* @param [in] key_: key of the cell;
+* @param [out] outCell_: pointer which will receive the aggregate of the cell (count 0 when it has no points).
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input.
+************************************************************************************************************************
+**/
+int geohash36_aggregate_get(const geohash36_aggregate_t * aggregate_, geohash36_key_t key_,
+                            geohash36_aggregate_cell_t * outCell_);
+
+/*!
+************************************************************************************************************************
+* @brief Copies every non-empty cell, sorted by key (each cell comes right before its children).
+************************************************************************************************************************
+* @param [in] aggregate_: pointer to the aggregate;
+* @param [out] outCells_: array which will receive the cells;
+* @param [in] maxCells_: size of "outCells_" (at least "numCells").
+************************************************************************************************************************
+* @return Number of cells, or -1 for invalid input.
+************************************************************************************************************************
+**/
+long geohash36_aggregate_export(const geohash36_aggregate_t * aggregate_, geohash36_aggregate_cell_t * outCells_,
+                                size_t maxCells_);
+
+#endif // _GEOHASH36_AGGREGATE_H_
@@ -0,0 +1,1128 @@
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "geohash36_batch.h"
+#include "geohash36_internal.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define GEOHASH36_BATCH_X86
+#include <immintrin.h>
+#endif
+
+/***********************************************************************************************************************
+Defines/macros
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Number of positions quantized at once before the characters are written (indexes stay in L1 cache).
+************************************************************************************************************************
+**/
+#define GEOHASH36_BATCH_BLOCK_SIZE           256
+
+/*!
+************************************************************************************************************************
+* @brief Number of characters translated at once by the batch decoder.
+************************************************************************************************************************
+**/
+#define GEOHASH36_BATCH_DECODE_BLOCK_SIZE    4096
+
+/*!
+************************************************************************************************************************
+* @brief 2^52: adding it to a double in [0, 2^52) rounds it to an integer placed in the low bits of the mantissa.
+************************************************************************************************************************
+**/
+#define GEOHASH36_BATCH_MAGIC                4503599627370496.0
+
+/***********************************************************************************************************************
+Typedefs/structs/unions
+***********************************************************************************************************************/
+typedef void (*geohash36_quantize_fn_t)(const double * lat_, const double * lon_, size_t n_, int numCharacters_,
+                                        uint64_t * latIndex_, uint64_t * lonIndex_);
+
+typedef void (*geohash36_translate_fn_t)(const char * in_, size_t size_, uint8_t * out_);
+
+typedef size_t (*geohash36_scan_fn_t)(const uint8_t * indexes_, size_t size_);
+
+/***********************************************************************************************************************
+Variables
+***********************************************************************************************************************/
+static geohash36_kernel_t geohash36_batch_kernel = GEOHASH36_KERNEL_AUTO;
+
+/***********************************************************************************************************************
+Internal functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Quantizes latitudes/longitudes in grid indexes, one position at a time.
+************************************************************************************************************************
+* @param [in] lat_: array of latitudes;
+* @param [in] lon_: array of longitudes;
+* @param [in] n_: number of positions;
+* @param [in] numCharacters_: desired Geohash-36 length (0 to GEOHASH36_MAX_CELL_CHARACTERS);
+* @param [out] latIndex_: array which will receive the latitude indexes;
+* @param [out] lonIndex_: array which will receive the longitude indexes.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_quantize_scalar(const double * lat_, const double * lon_, size_t n_, int numCharacters_,
+                                      uint64_t * latIndex_, uint64_t * lonIndex_)
+{
+   uint64_t numCells = geohash36_pow6[numCharacters_];
+
+   for (size_t i = 0; i < n_; i++)
+   {
+      latIndex_[i] = geohash36_quantize(((lat_[i] + 90.0) * (double)numCells) / 180.0, numCells, NULL);
+      lonIndex_[i] = geohash36_quantize(((lon_[i] + 180.0) * (double)numCells) / 360.0, numCells, NULL);
+   }
+}
+
+/*!
+************************************************************************************************************************
+* @brief Translates characters in their base36_index[] entries (line/column or 0xFF), one at a time.
+************************************************************************************************************************
+* @param [in] in_: Geohash-36 characters;
+* @param [in] size_: number of characters;
+* @param [out] out_: array which will receive the entries.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_translate_scalar(const char * in_, size_t size_, uint8_t * out_)
+{
+   for (size_t i = 0; i < size_; i++)
+      out_[i] = base36_index[(uint8_t)in_[i]];
+}
+
+/*!
+************************************************************************************************************************
+* @brief Finds the first invalid entry (0xFF, the only one with the high bit set) of translated characters, one at a
+*        time.
+************************************************************************************************************************
+* @param [in] indexes_: base36_index[] entries;
+* @param [in] size_: number of entries.
+************************************************************************************************************************
+* @return Position of the first invalid entry, or "size_" if every entry is valid.
+************************************************************************************************************************
+**/
+static size_t geohash36_scan_scalar(const uint8_t * indexes_, size_t size_)
+{
+   size_t i;
+
+   for (i = 0; i < size_; i++)
+   {
+      if (indexes_[i] & 0x80)
+         break;
+   }
+
+   return i;
+}
+
+#ifdef GEOHASH36_BATCH_X86
+
+/*!
+************************************************************************************************************************
+* @brief Same steps of geohash36_quantize for 2 positions (SSE2 has no ceil, so it rounds and corrects).
+************************************************************************************************************************
+* @param [in] position_: positions in cells;
+* @param [in] numCells_: number of cells in this axis.
+************************************************************************************************************************
+* @return Cell indexes.
+************************************************************************************************************************
+**/
+__attribute__((target("sse2")))
+static inline __m128i geohash36_quantize_pd(__m128d position_, __m128d numCells_)
+{
+   __m128d magic = _mm_set1_pd(GEOHASH36_BATCH_MAGIC);
+   __m128d one = _mm_set1_pd(1.0);
+   __m128d zero = _mm_setzero_pd();
+   __m128d index;
+
+   // max() returns the second operand for NaN, as the scalar "(position > 0) ? position : 0"
+   position_ = _mm_max_pd(position_, zero);
+   position_ = _mm_min_pd(position_, numCells_);
+
+   index = _mm_sub_pd(_mm_add_pd(position_, magic), magic);
+   index = _mm_add_pd(index, _mm_and_pd(_mm_cmplt_pd(index, position_), one));
+   index = _mm_max_pd(_mm_sub_pd(index, one), zero);
+
+   return _mm_sub_epi64(_mm_castpd_si128(_mm_add_pd(index, magic)), _mm_castpd_si128(magic));
+}
+
+/*!
+************************************************************************************************************************
+* @brief Quantizes latitudes/longitudes in grid indexes, 2 positions at a time (SSE2).
+************************************************************************************************************************
+* @param See geohash36_quantize_scalar.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+__attribute__((target("sse2")))
+static void geohash36_quantize_sse2(const double * lat_, const double * lon_, size_t n_, int numCharacters_,
+                                    uint64_t * latIndex_, uint64_t * lonIndex_)
+{
+   __m128d latSpan = _mm_set1_pd(180.0);
+   __m128d lonSpan = _mm_set1_pd(360.0);
+   __m128d latOffset = _mm_set1_pd(90.0);
+   __m128d lonOffset = _mm_set1_pd(180.0);
+   __m128d numCells = _mm_set1_pd((double)geohash36_pow6[numCharacters_]);
+   size_t i;
+
+   for (i = 0; (i + 2) <= n_; i += 2)
+   {
+      __m128d latPosition = _mm_mul_pd(_mm_add_pd(_mm_loadu_pd(lat_ + i), latOffset), numCells);
+      __m128d lonPosition = _mm_mul_pd(_mm_add_pd(_mm_loadu_pd(lon_ + i), lonOffset), numCells);
+
+      latPosition = _mm_div_pd(latPosition, latSpan);
+      lonPosition = _mm_div_pd(lonPosition, lonSpan);
+
+      _mm_storeu_si128((__m128i *)(latIndex_ + i), geohash36_quantize_pd(latPosition, numCells));
+      _mm_storeu_si128((__m128i *)(lonIndex_ + i), geohash36_quantize_pd(lonPosition, numCells));
+   }
+
+   geohash36_quantize_scalar(lat_ + i, lon_ + i, n_ - i, numCharacters_, latIndex_ + i, lonIndex_ + i);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Same steps of geohash36_quantize for 4 positions (AVX2).
+************************************************************************************************************************
+* @param [in] position_: positions in cells;
+* @param [in] numCells_: number of cells in this axis.
+************************************************************************************************************************
+* @return Cell indexes.
+************************************************************************************************************************
+**/
+__attribute__((target("avx2")))
+static inline __m256i geohash36_quantize_pd256(__m256d position_, __m256d numCells_)
+{
+   __m256d magic = _mm256_set1_pd(GEOHASH36_BATCH_MAGIC);
+   __m256d zero = _mm256_setzero_pd();
+   __m256d index;
+
+   position_ = _mm256_max_pd(position_, zero);
+   position_ = _mm256_min_pd(position_, numCells_);
+
+   index = _mm256_round_pd(position_, _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC);
+   index = _mm256_max_pd(_mm256_sub_pd(index, _mm256_set1_pd(1.0)), zero);
+
+   return _mm256_sub_epi64(_mm256_castpd_si256(_mm256_add_pd(index, magic)), _mm256_castpd_si256(magic));
+}
+
+/*!
+************************************************************************************************************************
+* @brief Quantizes latitudes/longitudes in grid indexes, 4 positions at a time (AVX2).
+************************************************************************************************************************
+* @param See geohash36_quantize_scalar.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+__attribute__((target("avx2")))
+static void geohash36_quantize_avx2(const double * lat_, const double * lon_, size_t n_, int numCharacters_,
+                                    uint64_t * latIndex_, uint64_t * lonIndex_)
+{
+   __m256d latSpan = _mm256_set1_pd(180.0);
+   __m256d lonSpan = _mm256_set1_pd(360.0);
+   __m256d latOffset = _mm256_set1_pd(90.0);
+   __m256d lonOffset = _mm256_set1_pd(180.0);
+   __m256d numCells = _mm256_set1_pd((double)geohash36_pow6[numCharacters_]);
+   size_t i;
+
+   for (i = 0; (i + 4) <= n_; i += 4)
+   {
+      __m256d latPosition = _mm256_mul_pd(_mm256_add_pd(_mm256_loadu_pd(lat_ + i), latOffset), numCells);
+      __m256d lonPosition = _mm256_mul_pd(_mm256_add_pd(_mm256_loadu_pd(lon_ + i), lonOffset), numCells);
+
+      latPosition = _mm256_div_pd(latPosition, latSpan);
+      lonPosition = _mm256_div_pd(lonPosition, lonSpan);
+
+      _mm256_storeu_si256((__m256i *)(latIndex_ + i), geohash36_quantize_pd256(latPosition, numCells));
+      _mm256_storeu_si256((__m256i *)(lonIndex_ + i), geohash36_quantize_pd256(lonPosition, numCells));
+   }
+
+   geohash36_quantize_scalar(lat_ + i, lon_ + i, n_ - i, numCharacters_, latIndex_ + i, lonIndex_ + i);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Same steps of geohash36_quantize for 8 positions (AVX-512).
+************************************************************************************************************************
+* @param [in] position_: positions in cells;
+* @param [in] numCells_: number of cells in this axis.
+************************************************************************************************************************
+* @return Cell indexes.
+************************************************************************************************************************
+**/
+__attribute__((target("avx512f")))
+static inline __m512i geohash36_quantize_pd512(__m512d position_, __m512d numCells_)
+{
+   __m512d magic = _mm512_set1_pd(GEOHASH36_BATCH_MAGIC);
+   __m512d zero = _mm512_setzero_pd();
+   __m512d index;
+
+   position_ = _mm512_max_pd(position_, zero);
+   position_ = _mm512_min_pd(position_, numCells_);
+
+   index = _mm512_roundscale_pd(position_, _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC);
+   index = _mm512_max_pd(_mm512_sub_pd(index, _mm512_set1_pd(1.0)), zero);
+
+   return _mm512_sub_epi64(_mm512_castpd_si512(_mm512_add_pd(index, magic)), _mm512_castpd_si512(magic));
+}
+
+/*!
+************************************************************************************************************************
+* @brief Quantizes latitudes/longitudes in grid indexes, 8 positions at a time (AVX-512).
+************************************************************************************************************************
+* @param See geohash36_quantize_scalar.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+__attribute__((target("avx512f")))
+static void geohash36_quantize_avx512(const double * lat_, const double * lon_, size_t n_, int numCharacters_,
+                                      uint64_t * latIndex_, uint64_t * lonIndex_)
+{
+   __m512d latSpan = _mm512_set1_pd(180.0);
+   __m512d lonSpan = _mm512_set1_pd(360.0);
+   __m512d latOffset = _mm512_set1_pd(90.0);
+   __m512d lonOffset = _mm512_set1_pd(180.0);
+   __m512d numCells = _mm512_set1_pd((double)geohash36_pow6[numCharacters_]);
+   size_t i;
+
+   for (i = 0; (i + 8) <= n_; i += 8)
+   {
+      __m512d latPosition = _mm512_mul_pd(_mm512_add_pd(_mm512_loadu_pd(lat_ + i), latOffset), numCells);
+      __m512d lonPosition = _mm512_mul_pd(_mm512_add_pd(_mm512_loadu_pd(lon_ + i), lonOffset), numCells);
+
+      latPosition = _mm512_div_pd(latPosition, latSpan);
+      lonPosition = _mm512_div_pd(lonPosition, lonSpan);
+
+      _mm512_storeu_si512((void *)(latIndex_ + i), geohash36_quantize_pd512(latPosition, numCells));
+      _mm512_storeu_si512((void *)(lonIndex_ + i), geohash36_quantize_pd512(lonPosition, numCells));
+   }
+
+   geohash36_quantize_scalar(lat_ + i, lon_ + i, n_ - i, numCharacters_, latIndex_ + i, lonIndex_ + i);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Translates characters in their base36_index[] entries, 32 at a time (AVX2).
+*
+* Every valid character is in 0x32-0x74, so the high nibble selects one of five 16 entries rows of base36_index[] and
+* a byte shuffle looks the low nibble up in that row. Characters of any other row stay 0xFF.
+************************************************************************************************************************
+* @param See geohash36_translate_scalar.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+__attribute__((target("avx2")))
+static void geohash36_translate_avx2(const char * in_, size_t size_, uint8_t * out_)
+{
+   __m256i rows[5];
+   __m256i nibbleMask = _mm256_set1_epi8(0x0F);
+   size_t i;
+
+   for (int r = 0; r < 5; r++)
+      rows[r] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(base36_index + ((r + 3) * 16))));
+
+   for (i = 0; (i + 32) <= size_; i += 32)
+   {
+      __m256i c = _mm256_loadu_si256((const __m256i *)(in_ + i));
+      __m256i low = _mm256_and_si256(c, nibbleMask);
+      __m256i high = _mm256_and_si256(_mm256_srli_epi16(c, 4), nibbleMask);
+      __m256i result = _mm256_set1_epi8((char)0xFF);
+
+      for (int r = 0; r < 5; r++)
+      {
+         __m256i selected = _mm256_cmpeq_epi8(high, _mm256_set1_epi8((char)(r + 3)));
+
+         result = _mm256_blendv_epi8(result, _mm256_shuffle_epi8(rows[r], low), selected);
+      }
+
+      _mm256_storeu_si256((__m256i *)(out_ + i), result);
+   }
+
+   geohash36_translate_scalar(in_ + i, size_ - i, out_ + i);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Translates characters in their base36_index[] entries, 64 at a time (AVX-512). See geohash36_translate_avx2.
+************************************************************************************************************************
+* @param See geohash36_translate_scalar.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+__attribute__((target("avx512f,avx512bw")))
+static void geohash36_translate_avx512(const char * in_, size_t size_, uint8_t * out_)
+{
+   __m512i rows[5];
+   __m512i nibbleMask = _mm512_set1_epi8(0x0F);
+   size_t i;
+
+   for (int r = 0; r < 5; r++)
+      rows[r] = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i *)(base36_index + ((r + 3) * 16))));
+
+   for (i = 0; (i + 64) <= size_; i += 64)
+   {
+      __m512i c = _mm512_loadu_si512((const void *)(in_ + i));
+      __m512i low = _mm512_and_si512(c, nibbleMask);
+      __m512i high = _mm512_and_si512(_mm512_srli_epi16(c, 4), nibbleMask);
+      __m512i result = _mm512_set1_epi8((char)0xFF);
+
+      for (int r = 0; r < 5; r++)
+      {
+         __mmask64 selected = _mm512_cmpeq_epi8_mask(high, _mm512_set1_epi8((char)(r + 3)));
+
+         result = _mm512_mask_shuffle_epi8(result, selected, rows[r], low);
+      }
+
+      _mm512_storeu_si512((void *)(out_ + i), result);
+   }
+
+   geohash36_translate_scalar(in_ + i, size_ - i, out_ + i);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Finds the first invalid entry of translated characters, 16 at a time (SSE2).
+************************************************************************************************************************
+* @param See geohash36_scan_scalar.
+************************************************************************************************************************
+* @return Position of the first invalid entry, or "size_" if every entry is valid.
+************************************************************************************************************************
+**/
+__attribute__((target("sse2")))
+static size_t geohash36_scan_sse2(const uint8_t * indexes_, size_t size_)
+{
+   size_t i;
+
+   for (i = 0; (i + 16) <= size_; i += 16)
+   {
+      int mask = _mm_movemask_epi8(_mm_loadu_si128((const __m128i *)(indexes_ + i)));
+
+      if (mask != 0)
+         return i + (size_t)__builtin_ctz((unsigned int)mask);
+   }
+
+   return i + geohash36_scan_scalar(indexes_ + i, size_ - i);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Finds the first invalid entry of translated characters, 32 at a time (AVX2).
+************************************************************************************************************************
+* @param See geohash36_scan_scalar.
+************************************************************************************************************************
+* @return Position of the first invalid entry, or "size_" if every entry is valid.
+************************************************************************************************************************
+**/
+__attribute__((target("avx2")))
+static size_t geohash36_scan_avx2(const uint8_t * indexes_, size_t size_)
+{
+   size_t i;
+
+   for (i = 0; (i + 32) <= size_; i += 32)
+   {
+      int mask = _mm256_movemask_epi8(_mm256_loadu_si256((const __m256i *)(indexes_ + i)));
+
+      if (mask != 0)
+         return i + (size_t)__builtin_ctz((unsigned int)mask);
+   }
+
+   return i + geohash36_scan_scalar(indexes_ + i, size_ - i);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Finds the first invalid entry of translated characters, 64 at a time (AVX-512).
+************************************************************************************************************************
+* @param See geohash36_scan_scalar.
+************************************************************************************************************************
+* @return Position of the first invalid entry, or "size_" if every entry is valid.
+************************************************************************************************************************
+**/
+__attribute__((target("avx512f,avx512bw")))
+static size_t geohash36_scan_avx512(const uint8_t * indexes_, size_t size_)
+{
+   size_t i;
+
+   for (i = 0; (i + 64) <= size_; i += 64)
+   {
+      __mmask64 mask = _mm512_movepi8_mask(_mm512_loadu_si512((const void *)(indexes_ + i)));
+
+      if (mask != 0)
+         return i + (size_t)__builtin_ctzll((unsigned long long)mask);
+   }
+
+   return i + geohash36_scan_scalar(indexes_ + i, size_ - i);
+}
+
+#endif // GEOHASH36_BATCH_X86
+
+/*!
+************************************************************************************************************************
+* @brief Checks if a kernel can run in this CPU.
+************************************************************************************************************************
+* @param [in] kernel_: desired kernel.
+************************************************************************************************************************
+* @return 1 if supported, 0 otherwise.
+************************************************************************************************************************
+**/
+static int geohash36_batch_isSupported(geohash36_kernel_t kernel_)
+{
+   switch (kernel_)
+   {
+      case GEOHASH36_KERNEL_SCALAR:
+         return 1;
+
+#ifdef GEOHASH36_BATCH_X86
+      case GEOHASH36_KERNEL_SSE2:
+         __builtin_cpu_init();
+         return __builtin_cpu_supports("sse2") ? 1 : 0;
+
+      case GEOHASH36_KERNEL_AVX2:
+         __builtin_cpu_init();
+         return __builtin_cpu_supports("avx2") ? 1 : 0;
+
+      case GEOHASH36_KERNEL_AVX512:
+         __builtin_cpu_init();
+         return (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) ? 1 : 0;
+#endif
+
+      default:
+         return 0;
+   }
+}
+
+/*!
+************************************************************************************************************************
+* @brief Gets the quantization function of the selected kernel (picking the best one on first use).
+************************************************************************************************************************
+* @return Quantization function.
+************************************************************************************************************************
+**/
+static geohash36_quantize_fn_t geohash36_batch_getQuantizeFn(void)
+{
+   switch (geohash36_batch_getKernel())
+   {
+#ifdef GEOHASH36_BATCH_X86
+      case GEOHASH36_KERNEL_SSE2:
+         return geohash36_quantize_sse2;
+
+      case GEOHASH36_KERNEL_AVX2:
+         return geohash36_quantize_avx2;
+
+      case GEOHASH36_KERNEL_AVX512:
+         return geohash36_quantize_avx512;
+#endif
+
+      default:
+         return geohash36_quantize_scalar;
+   }
+}
+
+/*!
+************************************************************************************************************************
+* @brief Gets the character translation function of the selected kernel (SSE2 has no byte shuffle, so it uses the
+*        flat table directly).
+************************************************************************************************************************
+* @return Translation function.
+************************************************************************************************************************
+**/
+static geohash36_translate_fn_t geohash36_batch_getTranslateFn(void)
+{
+   switch (geohash36_batch_getKernel())
+   {
+#ifdef GEOHASH36_BATCH_X86
+      case GEOHASH36_KERNEL_AVX2:
+         return geohash36_translate_avx2;
+
+      case GEOHASH36_KERNEL_AVX512:
+         return geohash36_translate_avx512;
+#endif
+
+      default:
+         return geohash36_translate_scalar;
+   }
+}
+
+/*!
+************************************************************************************************************************
+* @brief Gets the function which finds invalid characters for the selected kernel.
+************************************************************************************************************************
+* @return Scan function.
+************************************************************************************************************************
+**/
+static geohash36_scan_fn_t geohash36_batch_getScanFn(void)
+{
+   switch (geohash36_batch_getKernel())
+   {
+#ifdef GEOHASH36_BATCH_X86
+      case GEOHASH36_KERNEL_SSE2:
+         return geohash36_scan_sse2;
+
+      case GEOHASH36_KERNEL_AVX2:
+         return geohash36_scan_avx2;
+
+      case GEOHASH36_KERNEL_AVX512:
+         return geohash36_scan_avx512;
+#endif
+
+      default:
+         return geohash36_scan_scalar;
+   }
+}
+
+/*!
+************************************************************************************************************************
+* @brief Writes the decoding result of one hash of the batch.
+************************************************************************************************************************
+* @param [in] bounds_: boundaries of the cell (NaN for invalid hashes);
+* @param [in] latWidth_: cell height in degrees;
+* @param [in] lonWidth_: cell width in degrees;
+* @param [in] i_: position of the hash in the batch;
+* @param [out] outLat_, outLon_, outBounds_: see geohash36_decode_batch.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_batch_writeDecoded(const geohash36_bounds_t * bounds_, double latWidth_, double lonWidth_,
+                                         size_t i_, double * outLat_, double * outLon_,
+                                         geohash36_bounds_t * outBounds_)
+{
+   // Same center computed by geohash36_decode
+   outLat_[i_] = bounds_->minLatitude + (latWidth_ / 2);
+   outLon_[i_] = bounds_->minLongitude + (lonWidth_ / 2);
+
+   if (outBounds_ != NULL)
+      outBounds_[i_] = (*bounds_);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Writes the validation result of one entry of the batch.
+************************************************************************************************************************
+* @param [in] hash_: characters of the entry;
+* @param [in] index_: base36_index[] entries of the characters;
+* @param [in] offset_: first offending character of the entry, or -1 if it is valid;
+* @param [in] i_: position of the entry in the batch;
+* @param [in] outCharacters_: length of the canonical hash/key of the entry;
+* @param [out] outValid_, outOffsets_, outHashes_, outKeys_: see geohash36_validate_batch.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_batch_writeValidated(const char * hash_, const uint8_t * index_, int offset_, size_t i_,
+                                           int outCharacters_, uint64_t * outValid_, int * outOffsets_,
+                                           char * outHashes_, geohash36_key_t * outKeys_)
+{
+   if (outOffsets_ != NULL)
+      outOffsets_[i_] = offset_;
+
+   if (offset_ >= 0)
+   {
+      if (outHashes_ != NULL)
+         memset(outHashes_ + (i_ * outCharacters_), 0, outCharacters_);
+
+      if (outKeys_ != NULL)
+         outKeys_[i_] = GEOHASH36_KEY_INVALID;
+
+      return;
+   }
+
+   if (outValid_ != NULL)
+      outValid_[i_ / 64] |= 1ULL << (i_ % 64);
+
+   if (outHashes_ != NULL)
+      memcpy(outHashes_ + (i_ * outCharacters_), hash_, outCharacters_);
+
+   if (outKeys_ != NULL)
+   {
+      geohash36_key_t key = (geohash36_key_t)outCharacters_;
+
+      // Same key built by geohash36_stringToKey
+      for (int k = 0; k < outCharacters_; k++)
+      {
+         key |= (geohash36_key_t)base36_rank[((index_[k] >> 4) * GEOHASH_MATRIX_SIDE) + (index_[k] & 0x0F)] <<
+                (GEOHASH36_KEY_FIRST_CHAR_SHIFT - (k * GEOHASH36_KEY_CHAR_BITS));
+      }
+
+      outKeys_[i_] = key;
+   }
+}
+
+/***********************************************************************************************************************
+External functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Selects the kernel used by the batch functions.
+************************************************************************************************************************
+* @param [in] kernel_: desired kernel. GEOHASH36_KERNEL_AUTO picks the best one supported by the CPU (default).
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Kernel not supported by this CPU/build (selection is not changed).
+************************************************************************************************************************
+**/
+int geohash36_batch_setKernel(geohash36_kernel_t kernel_)
+{
+   if ((kernel_ != GEOHASH36_KERNEL_AUTO) && (!geohash36_batch_isSupported(kernel_)))
+      return -1;
+
+   __atomic_store_n(&geohash36_batch_kernel, kernel_, __ATOMIC_RELAXED);
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Gets the kernel used by the batch functions.
+************************************************************************************************************************
+* @return Selected kernel (never GEOHASH36_KERNEL_AUTO).
+************************************************************************************************************************
+**/
+geohash36_kernel_t geohash36_batch_getKernel(void)
+{
+   geohash36_kernel_t kernel = __atomic_load_n(&geohash36_batch_kernel, __ATOMIC_RELAXED);
+   geohash36_kernel_t expected = GEOHASH36_KERNEL_AUTO;
+
+   // Threads resolving the first use at once all find the same kernel, and only the first one stores it (a kernel set
+   // in the meantime wins)
+   if (kernel == GEOHASH36_KERNEL_AUTO)
+   {
+      kernel = GEOHASH36_KERNEL_AVX512;
+
+      while ((kernel != GEOHASH36_KERNEL_SCALAR) && (!geohash36_batch_isSupported(kernel)))
+         kernel = (geohash36_kernel_t)(kernel - 1);
+
+      if (!__atomic_compare_exchange_n(&geohash36_batch_kernel, &expected, kernel, 0, __ATOMIC_RELAXED,
+                                       __ATOMIC_RELAXED))
+         kernel = expected;
+   }
+
+   return kernel;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Gets the name of a kernel.
+************************************************************************************************************************
+* @param [in] kernel_: desired kernel.
+************************************************************************************************************************
+* @return Kernel name ("scalar", "sse2", etc).
+************************************************************************************************************************
+**/
+const char * geohash36_batch_kernelName(geohash36_kernel_t kernel_)
+{
+   switch (kernel_)
+   {
+      case GEOHASH36_KERNEL_AUTO:   return "auto";
+      case GEOHASH36_KERNEL_SCALAR: return "scalar";
+      case GEOHASH36_KERNEL_SSE2:   return "sse2";
+      case GEOHASH36_KERNEL_AVX2:   return "avx2";
+      case GEOHASH36_KERNEL_AVX512: return "avx512";
+      default:                      return "unknown";
+   }
+}
+
+/*!
+************************************************************************************************************************
+* @brief Encodes arrays of latitudes/longitudes in Geohash-36.
+************************************************************************************************************************
+* @param [in] lat_: array of latitudes;
+* @param [in] lon_: array of longitudes;
+* @param [in] n_: number of positions;
+* @param [out] out_: buffer of "n_ * numCharacters_" characters which will receive the hashes, one after the other
+*                    (without null terminators);
+* @param [in] numCharacters_: desired Geohash-36 length.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input.
+************************************************************************************************************************
+**/
+int geohash36_encode_batch(const double * lat_, const double * lon_, size_t n_, char * out_, int numCharacters_)
+{
+   uint64_t latIndex[GEOHASH36_BATCH_BLOCK_SIZE], lonIndex[GEOHASH36_BATCH_BLOCK_SIZE];
+   geohash36_quantize_fn_t quantize;
+   geohash36_cell_t cell;
+   size_t count;
+
+   if ((lat_ == NULL) || (lon_ == NULL) || (out_ == NULL) || (numCharacters_ < 0))
+      return -1;
+
+   // Hashes longer than the integer grid keep subdividing doubles, so they go through the scalar encoder
+   if (numCharacters_ > GEOHASH36_MAX_CELL_CHARACTERS)
+   {
+      for (size_t i = 0; i < n_; i++)
+         geohash36_encode(lat_[i], lon_[i], out_ + (i * numCharacters_), numCharacters_);
+
+      return 0;
+   }
+
+   quantize = geohash36_batch_getQuantizeFn();
+   cell.numCharacters = numCharacters_;
+
+   for (size_t i = 0; i < n_; i += count)
+   {
+      count = MIN(n_ - i, GEOHASH36_BATCH_BLOCK_SIZE);
+
+      quantize(lat_ + i, lon_ + i, count, numCharacters_, latIndex, lonIndex);
+
+      for (size_t j = 0; j < count; j++)
+      {
+         cell.latIndex = latIndex[j];
+         cell.lonIndex = lonIndex[j];
+         geohash36_cellToString(&cell, out_ + ((i + j) * numCharacters_));
+      }
+   }
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Encodes arrays of latitudes/longitudes in packed keys.
+************************************************************************************************************************
+* @param [in] lat_: array of latitudes;
+* @param [in] lon_: array of longitudes;
+* @param [in] n_: number of positions;
+* @param [out] out_: array of "n_" keys which will receive the result;
+* @param [in] numCharacters_: desired Geohash-36 length (0 to GEOHASH36_KEY_MAX_CHARACTERS).
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input.
+************************************************************************************************************************
+**/
+int geohash36_encodeKey_batch(const double * lat_, const double * lon_, size_t n_, geohash36_key_t * out_,
+                              int numCharacters_)
+{
+   uint64_t latIndex[GEOHASH36_BATCH_BLOCK_SIZE], lonIndex[GEOHASH36_BATCH_BLOCK_SIZE];
+   geohash36_quantize_fn_t quantize;
+   geohash36_cell_t cell;
+   size_t count;
+
+   if ((lat_ == NULL) || (lon_ == NULL) || (out_ == NULL) || (numCharacters_ < 0) ||
+       (numCharacters_ > GEOHASH36_KEY_MAX_CHARACTERS))
+      return -1;
+
+   quantize = geohash36_batch_getQuantizeFn();
+   cell.numCharacters = numCharacters_;
+
+   for (size_t i = 0; i < n_; i += count)
+   {
+      count = MIN(n_ - i, GEOHASH36_BATCH_BLOCK_SIZE);
+
+      quantize(lat_ + i, lon_ + i, count, numCharacters_, latIndex, lonIndex);
+
+      for (size_t j = 0; j < count; j++)
+      {
+         cell.latIndex = latIndex[j];
+         cell.lonIndex = lonIndex[j];
+         out_[i + j] = geohash36_cellToKey(&cell);
+      }
+   }
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Decodes an array of fixed length Geohash-36 strings.
+*
+* Invalid hashes don't stop the decoding: they are flagged in "outValid_" and get NaN coordinates/boundaries.
+************************************************************************************************************************
+* @param [in] hashes_: buffer of "n_ * numCharacters_" characters with the hashes one after the other;
+* @param [in] n_: number of hashes;
+* @param [in] numCharacters_: length of each hash;
+* @param [out] outLat_: array which will receive the latitudes (center of the cells);
+* @param [out] outLon_: array which will receive the longitudes (center of the cells);
+* @param [out] outBounds_: optional array which will receive the boundaries of the cells (can be NULL);
+* @param [out] outValid_: optional array which will receive 1 for valid hashes and 0 for invalid ones (can be NULL).
+************************************************************************************************************************
+* @return Number of invalid hashes (0 when every hash was decoded), or -1 for invalid arguments.
+************************************************************************************************************************
+**/
+long geohash36_decode_batch(const char * hashes_, size_t n_, int numCharacters_, double * outLat_, double * outLon_,
+                            geohash36_bounds_t * outBounds_, uint8_t * outValid_)
+{
+   uint8_t indexes[GEOHASH36_BATCH_DECODE_BLOCK_SIZE];
+   geohash36_translate_fn_t translate;
+   double latWidth = 180.0, lonWidth = 360.0;
+   size_t hashesPerBlock, count;
+   long invalid = 0;
+
+   if ((hashes_ == NULL) || (outLat_ == NULL) || (outLon_ == NULL) || (numCharacters_ < 0))
+      return -1;
+
+   // Hashes longer than the integer grid go through the scalar decoder
+   if (numCharacters_ > GEOHASH36_MAX_CELL_CHARACTERS)
+   {
+      for (int i = 0; i < numCharacters_; i++)
+      {
+         latWidth /= GEOHASH_MATRIX_SIDE;
+         lonWidth /= GEOHASH_MATRIX_SIDE;
+      }
+
+      for (size_t i = 0; i < n_; i++)
+      {
+         geohash36_bounds_t bounds;
+         double lat, lon;
+         int valid = (geohash36_decode((char *)hashes_ + (i * numCharacters_), numCharacters_, &lat, &lon) == 0);
+
+         bounds.minLatitude = valid ? (lat - (latWidth / 2)) : (0.0 / 0.0);
+         bounds.maxLatitude = bounds.minLatitude + latWidth;
+         bounds.minLongitude = valid ? (lon - (lonWidth / 2)) : (0.0 / 0.0);
+         bounds.maxLongitude = bounds.minLongitude + lonWidth;
+         geohash36_batch_writeDecoded(&bounds, latWidth, lonWidth, i, outLat_, outLon_, outBounds_);
+         invalid += !valid;
+
+         if (outValid_ != NULL)
+            outValid_[i] = (uint8_t)valid;
+      }
+
+      return invalid;
+   }
+
+   latWidth /= (double)geohash36_pow6[numCharacters_];
+   lonWidth /= (double)geohash36_pow6[numCharacters_];
+   translate = geohash36_batch_getTranslateFn();
+   hashesPerBlock = (numCharacters_ > 0) ? (size_t)(GEOHASH36_BATCH_DECODE_BLOCK_SIZE / numCharacters_) : n_;
+
+   for (size_t i = 0; i < n_; i += count)
+   {
+      count = MIN(n_ - i, hashesPerBlock);
+
+      translate(hashes_ + (i * numCharacters_), count * numCharacters_, indexes);
+
+      for (size_t j = 0; j < count; j++)
+      {
+         const uint8_t * index = indexes + (j * numCharacters_);
+         uint64_t latIndex = 0, lonIndex = 0;
+         uint8_t merged = 0;
+         geohash36_bounds_t bounds;
+
+         // Invalid characters are 0xFF, the only entries with the high bit set
+         for (int k = 0; k < numCharacters_; k++)
+         {
+            merged |= index[k];
+            latIndex = (latIndex * GEOHASH_MATRIX_SIDE) + (GEOHASH_MATRIX_SIDE - 1 - (index[k] >> 4));
+            lonIndex = (lonIndex * GEOHASH_MATRIX_SIDE) + (index[k] & 0x0F);
+         }
+
+         if (merged & 0x80)
+         {
+            bounds.minLatitude = bounds.maxLatitude = 0.0 / 0.0;
+            bounds.minLongitude = bounds.maxLongitude = 0.0 / 0.0;
+            invalid++;
+         }
+         else
+         {
+            // Same boundaries computed by geohash36_getCellBounds
+            bounds.minLatitude = -90.0 + ((double)latIndex * latWidth);
+            bounds.maxLatitude = -90.0 + ((double)(latIndex + 1) * latWidth);
+            bounds.minLongitude = -180.0 + ((double)lonIndex * lonWidth);
+            bounds.maxLongitude = -180.0 + ((double)(lonIndex + 1) * lonWidth);
+         }
+
+         geohash36_batch_writeDecoded(&bounds, latWidth, lonWidth, i + j, outLat_, outLon_, outBounds_);
+
+         if (outValid_ != NULL)
+            outValid_[i + j] = (uint8_t)((merged & 0x80) == 0);
+      }
+   }
+
+   return invalid;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Validates an array of fixed length Geohash-36 strings, optionally truncating them and converting them to
+*        packed keys in the same pass.
+*
+* Invalid hashes don't stop the validation: their bit of "outValid_" is 0, their offset is the position of their first
+* invalid character, and their canonical hash and key are zeros and GEOHASH36_KEY_INVALID.
+************************************************************************************************************************
+* @param [in] hashes_: buffer of "n_ * numCharacters_" characters with the hashes one after the other;
+* @param [in] n_: number of hashes;
+* @param [in] numCharacters_: length of each hash (1 to GEOHASH36_VALIDATE_MAX_CHARACTERS);
+* @param [out] outValid_: optional bitmap of "(n_ + 63) / 64" words which will receive 1 for valid hashes (bit "i % 64"
+*                         of word "i / 64") and 0 for invalid ones (can be NULL);
+* @param [out] outOffsets_: optional array which will receive the offset of the first invalid character of each hash,
+*                           or -1 for valid hashes (can be NULL);
+* @param [in] outCharacters_: length of the canonical hashes and keys (0 to keep "numCharacters_", otherwise 1 to
+*                             "numCharacters_");
+* @param [out] outHashes_: optional buffer of "n_ * outCharacters_" characters which will receive the canonical hashes
+*                          (can be NULL);
+* @param [out] outKeys_: optional array which will receive the packed keys, up to GEOHASH36_KEY_MAX_CHARACTERS
+*                        (can be NULL).
+************************************************************************************************************************
+* @return Number of invalid hashes (0 when every hash is valid), or -1 for invalid arguments.
+************************************************************************************************************************
+**/
+long geohash36_validate_batch(const char * hashes_, size_t n_, int numCharacters_, uint64_t * outValid_,
+                              int * outOffsets_, int outCharacters_, char * outHashes_, geohash36_key_t * outKeys_)
+{
+   uint8_t indexes[GEOHASH36_BATCH_DECODE_BLOCK_SIZE];
+   geohash36_translate_fn_t translate;
+   geohash36_scan_fn_t scan;
+   size_t hashesPerBlock, count;
+   long invalid = 0;
+
+   if ((hashes_ == NULL) || (numCharacters_ < 1) || (numCharacters_ > GEOHASH36_VALIDATE_MAX_CHARACTERS) ||
+       (outCharacters_ < 0) || (outCharacters_ > numCharacters_))
+      return -1;
+
+   outCharacters_ = (outCharacters_ == 0) ? numCharacters_ : outCharacters_;
+
+   if ((outKeys_ != NULL) && (outCharacters_ > GEOHASH36_KEY_MAX_CHARACTERS))
+      return -1;
+
+   if (outValid_ != NULL)
+      memset(outValid_, 0, ((n_ + 63) / 64) * sizeof(uint64_t));
+
+   translate = geohash36_batch_getTranslateFn();
+   scan = geohash36_batch_getScanFn();
+   hashesPerBlock = (size_t)(GEOHASH36_BATCH_DECODE_BLOCK_SIZE / numCharacters_);
+
+   for (size_t i = 0; i < n_; i += count)
+   {
+      const char * block = hashes_ + (i * numCharacters_);
+      size_t size, position = 0;
+
+      count = MIN(n_ - i, hashesPerBlock);
+      size = count * numCharacters_;
+
+      translate(block, size, indexes);
+
+      // Skips the valid hashes up to the next invalid character, then the hash which contains it
+      while (position < size)
+      {
+         size_t bad = position + scan(indexes + position, size - position);
+         size_t last = bad / numCharacters_;
+
+         for (size_t j = position / numCharacters_; j < last; j++)
+         {
+            if (outValid_ != NULL)
+               outValid_[(i + j) / 64] |= 1ULL << ((i + j) % 64);
+
+            if (outOffsets_ != NULL)
+               outOffsets_[i + j] = -1;
+
+            if ((outHashes_ != NULL) || (outKeys_ != NULL))
+               geohash36_batch_writeValidated(block + (j * numCharacters_), indexes + (j * numCharacters_), -1, i + j,
+                                              outCharacters_, NULL, NULL, outHashes_, outKeys_);
+         }
+
+         if (bad == size)
+            break;
+
+         geohash36_batch_writeValidated(NULL, NULL, (int)(bad % numCharacters_), i + last, outCharacters_, outValid_,
+                                        outOffsets_, outHashes_, outKeys_);
+         invalid++;
+         position = (last + 1) * numCharacters_;
+      }
+   }
+
+   return invalid;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Validates a buffer of length-prefixed Geohash-36 strings, optionally bringing them to the same length and
+*        converting them to packed keys in the same pass.
+*
+* Each entry is one byte with its length (0 to 255) followed by its characters. An entry is invalid when it has an
+* invalid character, when the buffer ends before its last character (entries missing from the buffer have offset 0),
+* when it is shorter than "outCharacters_", or when its key would be longer than GEOHASH36_KEY_MAX_CHARACTERS. Its
+* offset is then the position of the first invalid or missing character (GEOHASH36_KEY_MAX_CHARACTERS for keys too
+* long). Invalid entries don't stop the validation, and a valid entry never needs the characters of the next one.
+************************************************************************************************************************
+* @param [in] buffer_: buffer with the entries one after the other;
+* @param [in] size_: "buffer_" length in bytes;
+* @param [in] n_: number of entries;
+* @param [out] outValid_, outOffsets_: see geohash36_validate_batch;
+* @param [in] outCharacters_: length of the canonical hashes and keys (0 to keep the length of each entry, otherwise 1
+*                             to GEOHASH36_VALIDATE_MAX_CHARACTERS; longer entries are truncated, which gives the cell
+*                             that contains them);
+* @param [out] outHashes_: optional buffer of "n_ * outCharacters_" characters which will receive the canonical hashes
+*                          (can be NULL, requires "outCharacters_");
+* @param [out] outKeys_: see geohash36_validate_batch.
+************************************************************************************************************************
+* @return Number of invalid entries (0 when every entry is valid), or -1 for invalid arguments.
+************************************************************************************************************************
+**/
+long geohash36_validatePrefixed_batch(const char * buffer_, size_t size_, size_t n_, uint64_t * outValid_,
+                                      int * outOffsets_, int outCharacters_, char * outHashes_,
+                                      geohash36_key_t * outKeys_)
+{
+   uint8_t indexes[GEOHASH36_BATCH_DECODE_BLOCK_SIZE];
+   geohash36_translate_fn_t translate;
+   geohash36_scan_fn_t scan;
+   size_t position = 0, windowStart = 0, windowEnd = 0;
+   long invalid = 0;
+
+   if ((buffer_ == NULL) || (outCharacters_ < 0) || (outCharacters_ > GEOHASH36_VALIDATE_MAX_CHARACTERS) ||
+       ((outHashes_ != NULL) && (outCharacters_ == 0)) ||
+       ((outKeys_ != NULL) && (outCharacters_ > GEOHASH36_KEY_MAX_CHARACTERS)))
+      return -1;
+
+   if (outValid_ != NULL)
+      memset(outValid_, 0, ((n_ + 63) / 64) * sizeof(uint64_t));
+
+   translate = geohash36_batch_getTranslateFn();
+   scan = geohash36_batch_getScanFn();
+
+   for (size_t i = 0; i < n_; i++)
+   {
+      size_t start, length, available, bad;
+      int offset = -1;
+
+      if (position >= size_)
+      {
+         geohash36_batch_writeValidated(NULL, NULL, 0, i, outCharacters_, outValid_, outOffsets_, outHashes_,
+                                        outKeys_);
+         invalid++;
+         continue;
+      }
+
+      length = (uint8_t)buffer_[position];
+      start = position + 1;
+      available = MIN(length, size_ - start);
+      position = start + length;
+
+      // Translates the next block of the buffer once the entry goes beyond the current one (an entry always fits)
+      if ((start + available) > windowEnd)
+      {
+         windowStart = start;
+         windowEnd = start + MIN(size_ - start, GEOHASH36_BATCH_DECODE_BLOCK_SIZE);
+         translate(buffer_ + windowStart, windowEnd - windowStart, indexes);
+      }
+
+      bad = scan(indexes + (start - windowStart), available);
+
+      if (bad < length)
+         offset = (int)bad;
+      else if ((int)length < outCharacters_)
+         offset = (int)length;
+      else if ((outKeys_ != NULL) && (outCharacters_ == 0) && (length > GEOHASH36_KEY_MAX_CHARACTERS))
+         offset = GEOHASH36_KEY_MAX_CHARACTERS;
+
+      geohash36_batch_writeValidated(buffer_ + start, indexes + (start - windowStart), offset, i,
+                                     (outCharacters_ > 0) ? outCharacters_ : (int)length, outValid_, outOffsets_,
+                                     outHashes_, outKeys_);
+      invalid += (offset >= 0);
+   }
+
+   return invalid;
+}
@@ -0,0 +1,190 @@
+#ifndef _GEOHASH36_BATCH_H_
+#define _GEOHASH36_BATCH_H_
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "stddef.h"
+#include "geohash36.h"
+
+/***********************************************************************************************************************
+Defines/macros
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Maximum length of the hashes checked by the validation functions (the largest one byte length prefix).
+************************************************************************************************************************
+**/
+#define GEOHASH36_VALIDATE_MAX_CHARACTERS    255
+
+/***********************************************************************************************************************
+Typedefs/structs/unions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Kernels used by the batch functions. Every kernel produces exactly the same output as geohash36_encode.
+************************************************************************************************************************
+**/
+typedef enum
+{
+   GEOHASH36_KERNEL_AUTO = 0,
+   GEOHASH36_KERNEL_SCALAR,
+   GEOHASH36_KERNEL_SSE2,
+   GEOHASH36_KERNEL_AVX2,
+   GEOHASH36_KERNEL_AVX512
+
+}geohash36_kernel_t;
+
+/***********************************************************************************************************************
+Exported functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Selects the kernel used by the batch functions.
+************************************************************************************************************************
+* @param [in] kernel_: desired kernel. GEOHASH36_KERNEL_AUTO picks the best one supported by the CPU (default).
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Kernel not supported by this CPU/build (selection is not changed).
+************************************************************************************************************************
+**/
+int geohash36_batch_setKernel(geohash36_kernel_t kernel_);
+
+/*!
+************************************************************************************************************************
+* @brief Gets the kernel used by the batch functions.
+************************************************************************************************************************
+* @return Selected kernel (never GEOHASH36_KERNEL_AUTO).
+************************************************************************************************************************
+**/
+geohash36_kernel_t geohash36_batch_getKernel(void);
+
+/*!
+************************************************************************************************************************
+* @brief Gets the name of a kernel.
+************************************************************************************************************************
+* @param [in] kernel_: desired kernel.
+************************************************************************************************************************
+* @return Kernel name ("scalar", "sse2", etc).
+************************************************************************************************************************
+**/
+const char * geohash36_batch_kernelName(geohash36_kernel_t kernel_);
+
+/*!
+************************************************************************************************************************
+* @brief Encodes arrays of latitudes/longitudes in Geohash-36.
+************************************************************************************************************************
+* @param [in] lat_: array of latitudes;
+* @param [in] lon_: array of longitudes;
+* @param [in] n_: number of positions;
+* @param [out] out_: buffer of "n_ * numCharacters_" characters which will receive the hashes, one after the other
+*                    (without null terminators);
+* @param [in] numCharacters_: desired Geohash-36 length.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input.
+************************************************************************************************************************
+**/
+int geohash36_encode_batch(const double * lat_, const double * lon_, size_t n_, char * out_, int numCharacters_);
+
+/*!
+************************************************************************************************************************
+* @brief Encodes arrays of latitudes/longitudes in packed keys.
+************************************************************************************************************************
+* @param [in] lat_: array of latitudes;
+* @param [in] lon_: array of longitudes;
+* @param [in] n_: number of positions;
+* @param [out] out_: array of "n_" keys which will receive the result;
+* @param [in] numCharacters_: desired Geohash-36 length (0 to GEOHASH36_KEY_MAX_CHARACTERS).
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input.
+************************************************************************************************************************
+**/
+int geohash36_encodeKey_batch(const double * lat_, const double * lon_, size_t n_, geohash36_key_t * out_,
+                              int numCharacters_);
+
+/*!
+************************************************************************************************************************
+* @brief Decodes an array of fixed length Geohash-36 strings.
+*
+* Invalid hashes don't stop the decoding: they are flagged in "outValid_" and get NaN coordinates/boundaries.
+************************************************************************************************************************
+* @param [in] hashes_: buffer of "n_ * numCharacters_" characters with the hashes one after the other;
+* @param [in] n_: number of hashes;
+* @param [in] numCharacters_: length of each hash;
+* @param [out] outLat_: array which will receive the latitudes (center of the cells);
+* @param [out] outLon_: array which will receive the longitudes (center of the cells);
+* @param [out] outBounds_: optional array which will receive the boundaries of the cells (can be NULL);
+* @param [out] outValid_: optional array which will receive 1 for valid hashes and 0 for invalid ones (can be NULL).
+************************************************************************************************************************
+* @return Number of invalid hashes (0 when every hash was decoded), or -1 for invalid arguments.
+************************************************************************************************************************
+**/
+long geohash36_decode_batch(const char * hashes_, size_t n_, int numCharacters_, double * outLat_, double * outLon_,
+                            geohash36_bounds_t * outBounds_, uint8_t * outValid_);
+
+/*!
+************************************************************************************************************************
+* @brief Validates an array of fixed length Geohash-36 strings, optionally truncating them and converting them to
+*        packed keys in the same pass.
+*
+* Invalid hashes don't stop the validation: their bit of "outValid_" is 0, their offset is the position of their first
+* invalid character, and their canonical hash and key are zeros and GEOHASH36_KEY_INVALID.
+************************************************************************************************************************
+* @param [in] hashes_: buffer of "n_ * numCharacters_" characters with the hashes one after the other;
+* @param [in] n_: number of hashes;
+* @param [in] numCharacters_: length of each hash (1 to GEOHASH36_VALIDATE_MAX_CHARACTERS);
+* @param [out] outValid_: optional bitmap of "(n_ + 63) / 64" words which will receive 1 for valid hashes (bit "i % 64"
+*                         of word "i / 64") and 0 for invalid ones (can be NULL);
+* @param [out] outOffsets_: optional array which will receive the offset of the first invalid character of each hash,
+*                           or -1 for valid hashes (can be NULL);
+* @param [in] outCharacters_: length of the canonical hashes and keys (0 to keep "numCharacters_", otherwise 1 to
+*                             "numCharacters_");
+* @param [out] outHashes_: optional buffer of "n_ * outCharacters_" characters which will receive the canonical hashes
+*                          (can be NULL);
+* @param [out] outKeys_: optional array which will receive the packed keys, up to GEOHASH36_KEY_MAX_CHARACTERS
+*                        (can be NULL).
+************************************************************************************************************************
+* @return Number of invalid hashes (0 when every hash is valid), or -1 for invalid arguments.
+************************************************************************************************************************
+**/
+long geohash36_validate_batch(const char * hashes_, size_t n_, int numCharacters_, uint64_t * outValid_,
+                              int * outOffsets_, int outCharacters_, char * outHashes_, geohash36_key_t * outKeys_);
+
+/*!
+************************************************************************************************************************
+* @brief Validates a buffer of length-prefixed Geohash-36 strings, optionally bringing them to the same length and
+*        converting them to packed keys in the same pass.
+*
+* Each entry is one byte with its length (0 to 255) followed by its characters. An entry is invalid when it has an
+* invalid character, when the buffer ends before its last character (entries missing from the buffer have offset 0),
+* when it is shorter than "outCharacters_", or when its key would be longer than GEOHASH36_KEY_MAX_CHARACTERS. Its
+* offset is then the position of the first invalid or missing character (GEOHASH36_KEY_MAX_CHARACTERS for keys too
+* long). Invalid entries don't stop the validation, and a valid entry never needs the characters of the next one.
+************************************************************************************************************************
+* @param [in] buffer_: buffer with the entries one after the other;
+* @param [in] size_: "buffer_" length in bytes;
+* @param [in] n_: number of entries;
+* @param [out] outValid_, outOffsets_: see geohash36_validate_batch;
+* @param [in] outCharacters_: length of the canonical hashes and keys (0 to keep the length of each entry, otherwise 1
+*                             to GEOHASH36_VALIDATE_MAX_CHARACTERS; longer entries are truncated, which gives the cell
+*                             that contains them);
+* @param [out] outHashes_: optional buffer of "n_ * outCharacters_" characters which will receive the canonical hashes
+*                          (can be NULL, requires "outCharacters_");
+* @param [out] outKeys_: see geohash36_validate_batch.
+************************************************************************************************************************
+* @return Number of invalid entries (0 when every entry is valid), or -1 for invalid arguments.
+************************************************************************************************************************
+**/
+long geohash36_validatePrefixed_batch(const char * buffer_, size_t size_, size_t n_, uint64_t * outValid_,
+                                      int * outOffsets_, int outCharacters_, char * outHashes_,
+                                      geohash36_key_t * outKeys_);
+
+#endif // _GEOHASH36_BATCH_H_
@@ -0,0 +1,486 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "geohash36.h"
+#include "geohash36_batch.h"
+#include "geohash36_counter.h"
+#include "geohash36_fixed.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAS_CYCLES                1
+#else
+#define BENCH_HAS_CYCLES                0
+#endif
+
+#define BENCH_NUM_POINTS                (1 << 16)
+#define BENCH_GROUP_SIZE                64
+#define BENCH_NUM_GROUPS                (BENCH_NUM_POINTS / BENCH_GROUP_SIZE)
+#define BENCH_MAX_CHARACTERS            16
+#define BENCH_NUM_PASSES                3
+#define BENCH_MAX_THREADS               64
+#define BENCH_COUNTER_CHARACTERS        8
+#define BENCH_COUNTER_ROUNDS            16
+
+typedef enum
+{
+   DATASET_UNIFORM = 0,
+   DATASET_CLUSTERED,
+   DATASET_EDGE,
+   NUM_DATASETS
+
+}dataset_t;
+
+typedef struct
+{
+   const char * operation;
+   const char * path;
+   const char * dataset;
+   int numCharacters;
+   int numThreads;
+   double nsPerOp;
+   double pointsPerSecond;
+   double p50;
+   double p99;
+   double cyclesPerOp;
+
+}result_t;
+
+typedef struct
+{
+   geohash36_counter_t * counter;
+   size_t stripe;
+
+}counter_thread_t;
+
+typedef void (*bench_fn_t)(size_t first_, size_t count_, int numCharacters_);
+
+static const char * dataset_names[NUM_DATASETS] = { "uniform", "clustered", "edge" };
+
+static double lat[BENCH_NUM_POINTS], lon[BENCH_NUM_POINTS];
+static double outLat[BENCH_NUM_POINTS], outLon[BENCH_NUM_POINTS];
+static char hashes[BENCH_NUM_POINTS * BENCH_MAX_CHARACTERS];
+static char output[BENCH_NUM_POINTS * BENCH_MAX_CHARACTERS];
+static geohash36_key_t keys[BENCH_NUM_POINTS];
+static uint64_t valid[BENCH_NUM_POINTS / 64];
+static int offsets[BENCH_NUM_POINTS];
+static double group_ns[BENCH_NUM_GROUPS];
+static volatile double sink;
+
+static result_t * results = NULL;
+static size_t num_results = 0;
+
+static double now_ns(void)
+{
+   struct timespec time;
+
+   clock_gettime(CLOCK_MONOTONIC, &time);
+   return ((double)time.tv_sec * 1e9) + (double)time.tv_nsec;
+}
+
+static uint64_t now_cycles(void)
+{
+#if BENCH_HAS_CYCLES
+   return __rdtsc();
+#else
+   return 0;
+#endif
+}
+
+static double random_between(double min_, double max_)
+{
+   return min_ + (((double)rand() / (double)RAND_MAX) * (max_ - min_));
+}
+
+static int compare_doubles(const void * a_, const void * b_)
+{
+   double a = *(const double *)a_, b = *(const double *)b_;
+
+   return (a < b) ? -1 : ((a > b) ? 1 : 0);
+}
+
+// Uniform over the globe, clustered around a few cities, or exactly on the cell borders of the measured length
+static void make_dataset(dataset_t dataset_, int numCharacters_)
+{
+   static const double cities[4][2] = { { 51.5074, -0.1278 }, { 40.7128, -74.0060 }, { -23.5505, -46.6333 },
+                                         { 35.6762, 139.6503 } };
+   double cellLat = 180.0, cellLon = 360.0;
+
+   srand(12345);
+
+   for (int i = 0; i < numCharacters_; i++)
+   {
+      cellLat /= 6.0;
+      cellLon /= 6.0;
+   }
+
+   for (size_t i = 0; i < BENCH_NUM_POINTS; i++)
+   {
+      switch (dataset_)
+      {
+         case DATASET_CLUSTERED:
+         {
+            const double * city = cities[rand() % 4];
+
+            lat[i] = city[0] + (random_between(-0.05, 0.05) * random_between(0.0, 1.0));
+            lon[i] = city[1] + (random_between(-0.05, 0.05) * random_between(0.0, 1.0));
+            break;
+         }
+
+         case DATASET_EDGE:
+            lat[i] = -90.0 + (cellLat * (double)(int64_t)random_between(0.0, 180.0 / cellLat));
+            lon[i] = -180.0 + (cellLon * (double)(int64_t)random_between(0.0, 360.0 / cellLon));
+            break;
+
+         default:
+            lat[i] = random_between(-90.0, 90.0);
+            lon[i] = random_between(-180.0, 180.0);
+            break;
+      }
+
+      geohash36_encode(lat[i], lon[i], hashes + (i * numCharacters_), numCharacters_);
+   }
+}
+
+static void bench_encode(size_t first_, size_t count_, int numCharacters_)
+{
+   for (size_t i = first_; i < first_ + count_; i++)
+      geohash36_encode(lat[i], lon[i], output + (i * numCharacters_), numCharacters_);
+}
+
+static void bench_encode_batch(size_t first_, size_t count_, int numCharacters_)
+{
+   geohash36_encode_batch(lat + first_, lon + first_, count_, output + (first_ * numCharacters_), numCharacters_);
+}
+
+static void bench_encode_fixed(size_t first_, size_t count_, int numCharacters_)
+{
+   (void)numCharacters_;
+
+   for (size_t i = first_; i < first_ + count_; i++)
+      geohash36_encode10(lat[i], lon[i], output + (i * GEOHASH36_DEFAULT_NUM_CHARACTERS));
+}
+
+static void bench_decode(size_t first_, size_t count_, int numCharacters_)
+{
+   for (size_t i = first_; i < first_ + count_; i++)
+      geohash36_decode(hashes + (i * numCharacters_), numCharacters_, outLat + i, outLon + i);
+}
+
+static void bench_decode_batch(size_t first_, size_t count_, int numCharacters_)
+{
+   geohash36_decode_batch(hashes + (first_ * numCharacters_), count_, numCharacters_, outLat + first_,
+                          outLon + first_, NULL, NULL);
+}
+
+static void bench_decode_fixed(size_t first_, size_t count_, int numCharacters_)
+{
+   (void)numCharacters_;
+
+   for (size_t i = first_; i < first_ + count_; i++)
+      geohash36_decode10(hashes + (i * GEOHASH36_DEFAULT_NUM_CHARACTERS), outLat + i, outLon + i);
+}
+
+// Groups start on a multiple of 64 points, so each one has its own words of the bitmap
+static void bench_validate_batch(size_t first_, size_t count_, int numCharacters_)
+{
+   geohash36_validate_batch(hashes + (first_ * numCharacters_), count_, numCharacters_, valid + (first_ / 64),
+                            offsets + first_, 0, NULL, NULL);
+}
+
+static void bench_neighbor(size_t first_, size_t count_, int numCharacters_)
+{
+   static const int directions[8] = { GEO36_NEIGHBORS_DIR_NORTHWEST, GEO36_NEIGHBORS_DIR_NORTH,
+                                      GEO36_NEIGHBORS_DIR_NORTHEAST, GEO36_NEIGHBORS_DIR_WEST,
+                                      GEO36_NEIGHBORS_DIR_EAST, GEO36_NEIGHBORS_DIR_SOUTHWEST,
+                                      GEO36_NEIGHBORS_DIR_SOUTH, GEO36_NEIGHBORS_DIR_SOUTHEAST };
+
+   for (size_t i = first_; i < first_ + count_; i++)
+      geohash36_getNeighbor(hashes + (i * numCharacters_), numCharacters_, output + (i * numCharacters_),
+                            directions[i % 8]);
+}
+
+static void bench_precision(size_t first_, size_t count_, int numCharacters_)
+{
+   double latPrec, lonPrec, sum = 0.0;
+
+   for (size_t i = first_; i < first_ + count_; i++)
+   {
+      geohash36_getPrecisionInMeters(numCharacters_, &latPrec, &lonPrec);
+      sum += latPrec;
+   }
+
+   sink = sum;
+}
+
+static result_t * add_result(const char * operation_, const char * path_, const char * dataset_, int numCharacters_,
+                             int numThreads_)
+{
+   result_t * result;
+
+   results = realloc(results, (num_results + 1) * sizeof(result_t));
+   if (results == NULL)
+   {
+      fprintf(stderr, "Out of memory\n");
+      exit(1);
+   }
+
+   result = &results[num_results++];
+   result->operation = operation_;
+   result->path = path_;
+   result->dataset = dataset_;
+   result->numCharacters = numCharacters_;
+   result->numThreads = numThreads_;
+
+   return result;
+}
+
+// Runs the benchmark over every point, timing groups of BENCH_GROUP_SIZE operations for the latency percentiles
+static void run(const char * operation_, const char * path_, const char * dataset_, int numCharacters_,
+                bench_fn_t fn_)
+{
+   double totalNs = 0.0, start;
+   uint64_t cycles = 0, startCycles;
+   result_t * result;
+
+   for (int pass = 0; pass < BENCH_NUM_PASSES; pass++)
+   {
+      // First pass warms up caches and branch predictors
+      totalNs = 0.0;
+      cycles = 0;
+
+      for (size_t g = 0; g < BENCH_NUM_GROUPS; g++)
+      {
+         startCycles = now_cycles();
+         start = now_ns();
+         fn_(g * BENCH_GROUP_SIZE, BENCH_GROUP_SIZE, numCharacters_);
+         group_ns[g] = now_ns() - start;
+         cycles += now_cycles() - startCycles;
+         totalNs += group_ns[g];
+      }
+   }
+
+   qsort(group_ns, BENCH_NUM_GROUPS, sizeof(double), compare_doubles);
+
+   result = add_result(operation_, path_, dataset_, numCharacters_, 1);
+   result->nsPerOp = totalNs / BENCH_NUM_POINTS;
+   result->pointsPerSecond = 1e9 / result->nsPerOp;
+   result->p50 = group_ns[BENCH_NUM_GROUPS / 2] / BENCH_GROUP_SIZE;
+   result->p99 = group_ns[(BENCH_NUM_GROUPS * 99) / 100] / BENCH_GROUP_SIZE;
+   result->cyclesPerOp = BENCH_HAS_CYCLES ? ((double)cycles / BENCH_NUM_POINTS) : -1.0;
+
+   printf("%-14s %-8s %-10s %2d %10.2f ns/op %14.0f points/s  p50 %8.2f  p99 %8.2f", operation_, path_, dataset_,
+          numCharacters_, result->nsPerOp, result->pointsPerSecond, result->p50, result->p99);
+
+   if (result->cyclesPerOp >= 0.0)
+      printf("  %8.1f cycles/op", result->cyclesPerOp);
+
+   printf("\n");
+}
+
+static void * counter_thread(void * context_)
+{
+   counter_thread_t * thread = context_;
+
+   for (int round = 0; round < BENCH_COUNTER_ROUNDS; round++)
+   {
+      for (size_t i = 0; i < BENCH_NUM_POINTS; i++)
+         geohash36_counter_add(thread->counter, keys[i], 1, thread->stripe);
+   }
+
+   return NULL;
+}
+
+// Every thread adds the whole clustered dataset to one shared map, so that they contend on the same hot cells
+static void run_counter(const char * path_, int numThreads_, int striped_)
+{
+   counter_thread_t threads[BENCH_MAX_THREADS];
+   pthread_t handles[BENCH_MAX_THREADS];
+   geohash36_counter_t counter;
+   double totalNs = 0.0, start;
+   result_t * result;
+   int started;
+
+   for (int pass = 0; pass < BENCH_NUM_PASSES; pass++)
+   {
+      if (geohash36_counter_init(&counter, BENCH_NUM_POINTS, striped_ ? (size_t)numThreads_ : 1) != 0)
+      {
+         fprintf(stderr, "Out of memory\n");
+         exit(1);
+      }
+
+      start = now_ns();
+
+      for (started = 0; started < numThreads_; started++)
+      {
+         threads[started] = (counter_thread_t) { &counter, (size_t)started };
+
+         if (pthread_create(&handles[started], NULL, counter_thread, &threads[started]) != 0)
+            break;
+      }
+
+      for (int t = 0; t < started; t++)
+         pthread_join(handles[t], NULL);
+
+      totalNs = now_ns() - start;
+      geohash36_counter_free(&counter);
+
+      if (started < numThreads_)
+      {
+         fprintf(stderr, "Could not start %d threads\n", numThreads_);
+         exit(1);
+      }
+   }
+
+   result = add_result("counter_add", path_, dataset_names[DATASET_CLUSTERED], BENCH_COUNTER_CHARACTERS,
+                       numThreads_);
+   result->nsPerOp = totalNs / ((double)BENCH_NUM_POINTS * BENCH_COUNTER_ROUNDS * numThreads_);
+   result->pointsPerSecond = 1e9 / result->nsPerOp;
+   result->p50 = -1.0;
+   result->p99 = -1.0;
+   result->cyclesPerOp = -1.0;
+
+   printf("%-14s %-8s %-10s %2d %10.2f ns/op %14.0f points/s  %2d threads\n", result->operation, path_,
+          result->dataset, BENCH_COUNTER_CHARACTERS, result->nsPerOp, result->pointsPerSecond, numThreads_);
+}
+
+static int write_json(const char * path_)
+{
+   FILE * file = fopen(path_, "w");
+
+   if (file == NULL)
+      return -1;
+
+   fprintf(file, "{\n  \"group_size\": %d,\n  \"points\": %d,\n  \"kernel\": \"%s\",\n  \"results\": [\n",
+           BENCH_GROUP_SIZE, BENCH_NUM_POINTS, geohash36_batch_kernelName(geohash36_batch_getKernel()));
+
+   for (size_t i = 0; i < num_results; i++)
+   {
+      const result_t * result = &results[i];
+
+      fprintf(file, "    { \"operation\": \"%s\", \"path\": \"%s\", \"dataset\": \"%s\", \"length\": %d, "
+                    "\"threads\": %d, \"ns_per_op\": %.3f, \"points_per_sec\": %.0f, ",
+              result->operation, result->path, result->dataset, result->numCharacters, result->numThreads,
+              result->nsPerOp, result->pointsPerSecond);
+
+      if (result->p50 >= 0.0)
+         fprintf(file, "\"p50_ns\": %.3f, \"p99_ns\": %.3f, ", result->p50, result->p99);
+      else
+         fprintf(file, "\"p50_ns\": null, \"p99_ns\": null, ");
+
+      if (result->cyclesPerOp >= 0.0)
+         fprintf(file, "\"cycles_per_op\": %.2f }", result->cyclesPerOp);
+      else
+         fprintf(file, "\"cycles_per_op\": null }");
+
+      fprintf(file, "%s\n", (i + 1 < num_results) ? "," : "");
+   }
+
+   fprintf(file, "  ]\n}\n");
+
+   return (fclose(file) == 0) ? 0 : -1;
+}
+
+int main(int argc, char ** argv)
+{
+   static const geohash36_kernel_t kernels[] = { GEOHASH36_KERNEL_SCALAR, GEOHASH36_KERNEL_SSE2,
+                                                 GEOHASH36_KERNEL_AVX2, GEOHASH36_KERNEL_AVX512 };
+   const char * jsonPath = NULL;
+   int minCharacters = 1, maxCharacters = BENCH_MAX_CHARACTERS;
+   int numCpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+   int maxThreads = MAX(MIN(numCpus, BENCH_MAX_THREADS), 1);
+   geohash36_kernel_t best;
+
+   for (int i = 1; i < argc; i++)
+   {
+      if ((strcmp(argv[i], "--json") == 0) && (i + 1 < argc))
+         jsonPath = argv[++i];
+      else if ((strcmp(argv[i], "--length") == 0) && (i + 1 < argc))
+         minCharacters = maxCharacters = atoi(argv[++i]);
+      else if ((strcmp(argv[i], "--threads") == 0) && (i + 1 < argc))
+         maxThreads = atoi(argv[++i]);
+      else
+      {
+         printf("Usage: %s [--json file] [--length 1-%d] [--threads 1-%d]\n", argv[0], BENCH_MAX_CHARACTERS,
+                BENCH_MAX_THREADS);
+         return 1;
+      }
+   }
+
+   if ((minCharacters < 1) || (maxCharacters > BENCH_MAX_CHARACTERS))
+   {
+      printf("Invalid length\n");
+      return 1;
+   }
+
+   if ((maxThreads < 1) || (maxThreads > BENCH_MAX_THREADS))
+   {
+      printf("Invalid number of threads\n");
+      return 1;
+   }
+
+   geohash36_batch_setKernel(GEOHASH36_KERNEL_AUTO);
+   best = geohash36_batch_getKernel();
+
+   for (int numCharacters = minCharacters; numCharacters <= maxCharacters; numCharacters++)
+   {
+      run("precision", "scalar", "none", numCharacters, bench_precision);
+
+      for (int d = 0; d < NUM_DATASETS; d++)
+      {
+         make_dataset((dataset_t)d, numCharacters);
+
+         run("encode", "scalar", dataset_names[d], numCharacters, bench_encode);
+         run("decode", "scalar", dataset_names[d], numCharacters, bench_decode);
+         run("getNeighbor", "scalar", dataset_names[d], numCharacters, bench_neighbor);
+
+         // Fixed length versions, for the default length only
+         if (numCharacters == GEOHASH36_DEFAULT_NUM_CHARACTERS)
+         {
+            run("encode", "fixed", dataset_names[d], numCharacters, bench_encode_fixed);
+            run("decode", "fixed", dataset_names[d], numCharacters, bench_decode_fixed);
+         }
+
+         // Batch paths with every kernel supported by this CPU
+         for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++)
+         {
+            if (geohash36_batch_setKernel(kernels[k]) != 0)
+               continue;
+
+            run("encode_batch", geohash36_batch_kernelName(kernels[k]), dataset_names[d], numCharacters,
+                bench_encode_batch);
+            run("decode_batch", geohash36_batch_kernelName(kernels[k]), dataset_names[d], numCharacters,
+                bench_decode_batch);
+            run("validate_batch", geohash36_batch_kernelName(kernels[k]), dataset_names[d], numCharacters,
+                bench_validate_batch);
+         }
+
+         geohash36_batch_setKernel(best);
+      }
+   }
+
+   // Scaling of the shared counter map, with a single stripe and with one stripe per thread
+   make_dataset(DATASET_CLUSTERED, BENCH_COUNTER_CHARACTERS);
+   geohash36_encodeKey_batch(lat, lon, BENCH_NUM_POINTS, keys, BENCH_COUNTER_CHARACTERS);
+
+   for (int numThreads = 1; numThreads <= maxThreads; numThreads++)
+   {
+      run_counter("shared", numThreads, 0);
+      run_counter("striped", numThreads, 1);
+   }
+
+   if ((jsonPath != NULL) && (write_json(jsonPath) != 0))
+   {
+      printf("Could not write %s\n", jsonPath);
+      return 1;
+   }
+
+   free(results);
+   return 0;
+}
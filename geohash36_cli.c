@@ -0,0 +1,665 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "geohash36.h"
+#include "geohash36_batch.h"
+#include "geohash36_pool.h"
+#include "geohash36_transcode.h"
+
+#define CLI_BATCH_RECORDS               65536
+#define CLI_BUFFER_SIZE                 (8 * 1024 * 1024)
+#define CLI_MAX_LINE                    64
+#define CLI_SLOT_SIZE                   32
+#define CLI_CHUNK_RECORDS               4096
+#define CLI_EXIT_INVALID                2
+
+typedef enum
+{
+   FORMAT_CSV = 0,
+   FORMAT_BINARY
+
+}format_t;
+
+// Input stream: a read-only mapping of a regular file, or large reads of a pipe into a buffer
+typedef struct
+{
+   int fd;
+   const char * map;
+   size_t mapSize;
+   char * buffer;
+   size_t begin;
+   size_t end;
+   int eof;
+
+}reader_t;
+
+// One batch of records: framing is serial, everything else runs per chunk (possibly in the pool)
+typedef struct
+{
+   int decode;
+   format_t inputFormat;
+   format_t outputFormat;
+   int numCharacters;
+   size_t recordSize;
+
+   const char ** records;
+   uint16_t * recordLengths;
+   double * lat;
+   double * lon;
+   char * hashes;
+   char * slots;
+   uint8_t * slotLengths;
+   long numInvalid;
+   int failed;
+
+}batch_t;
+
+static void usage(void)
+{
+   fprintf(stderr,
+           "Usage: geohash36 encode|decode [options] [input [output]]\n"
+           "  -l, --length N          hash length (default 10; decode: length of binary records)\n"
+           "  -i, --input-format F    csv (default) or binary\n"
+           "  -o, --output-format F   csv (default) or binary\n"
+           "  -t, --threads N         worker threads (default 1, 0 = one per CPU)\n"
+           "      --header            skip the first input line\n"
+           "Input \"-\" or missing reads stdin, output missing writes stdout.\n"
+           "CSV: encode reads \"lat,lon\" lines and writes hashes, decode reads hashes and writes \"lat,lon\".\n"
+           "Binary: positions are two native doubles (lat, lon), hashes are N characters without separator.\n"
+           "Positions must be finite, with |lat| <= 90 and |lon| <= 180.\n"
+           "Invalid records give empty lines, NaN positions or hashes of '?', and exit status 2.\n");
+}
+
+static int reader_open(reader_t * reader_, const char * path_)
+{
+   struct stat status;
+
+   memset(reader_, 0, sizeof(reader_t));
+   reader_->fd = ((path_ == NULL) || (strcmp(path_, "-") == 0)) ? STDIN_FILENO : open(path_, O_RDONLY);
+
+   if (reader_->fd < 0)
+      return -1;
+
+   // Regular files are mapped: records are parsed straight from the page cache
+   if ((fstat(reader_->fd, &status) == 0) && S_ISREG(status.st_mode) && (status.st_size > 0))
+   {
+      void * map = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, reader_->fd, 0);
+
+      if (map != MAP_FAILED)
+      {
+         posix_madvise(map, (size_t)status.st_size, POSIX_MADV_SEQUENTIAL);
+         reader_->map = (const char *)map;
+         reader_->mapSize = (size_t)status.st_size;
+         reader_->end = reader_->mapSize;
+         reader_->eof = 1;
+         return 0;
+      }
+   }
+
+   reader_->buffer = malloc(CLI_BUFFER_SIZE);
+   return (reader_->buffer != NULL) ? 0 : -1;
+}
+
+static void reader_close(reader_t * reader_)
+{
+   if (reader_->map != NULL)
+      munmap((void *)reader_->map, reader_->mapSize);
+
+   if (reader_->fd != STDIN_FILENO)
+      close(reader_->fd);
+
+   free(reader_->buffer);
+}
+
+// Makes as many bytes as possible available (keeping the unconsumed ones), and returns them
+static int reader_fill(reader_t * reader_, const char ** data_, size_t * size_)
+{
+   ssize_t count;
+
+   if (reader_->map != NULL)
+   {
+      (*data_) = reader_->map + reader_->begin;
+      (*size_) = MIN(reader_->end - reader_->begin, (size_t)CLI_BUFFER_SIZE);
+      return 0;
+   }
+
+   if (reader_->begin > 0)
+   {
+      memmove(reader_->buffer, reader_->buffer + reader_->begin, reader_->end - reader_->begin);
+      reader_->end -= reader_->begin;
+      reader_->begin = 0;
+   }
+
+   while (!reader_->eof && (reader_->end < CLI_BUFFER_SIZE))
+   {
+      count = read(reader_->fd, reader_->buffer + reader_->end, CLI_BUFFER_SIZE - reader_->end);
+
+      if (count < 0)
+      {
+         if (errno == EINTR)
+            continue;
+
+         return -1;
+      }
+
+      if (count == 0)
+         reader_->eof = 1;
+
+      reader_->end += (size_t)count;
+   }
+
+   (*data_) = reader_->buffer;
+   (*size_) = reader_->end;
+   return 0;
+}
+
+static int write_all(int fd_, const char * data_, size_t size_)
+{
+   ssize_t count;
+
+   while (size_ > 0)
+   {
+      count = write(fd_, data_, size_);
+
+      if (count < 0)
+      {
+         if (errno == EINTR)
+            continue;
+
+         return -1;
+      }
+
+      data_ += count;
+      size_ -= (size_t)count;
+   }
+
+   return 0;
+}
+
+// Fixed point formatting with 9 decimals (much faster than printf)
+static size_t format_coordinate(double value_, char * out_)
+{
+   char digits[24];
+   uint64_t scaled, integer, fraction;
+   size_t size = 0;
+   int numDigits = 0;
+
+   if (value_ < 0.0)
+   {
+      out_[size++] = '-';
+      value_ = -value_;
+   }
+
+   scaled = (uint64_t)((value_ * 1e9) + 0.5);
+   integer = scaled / 1000000000u;
+   fraction = scaled % 1000000000u;
+
+   do
+   {
+      digits[numDigits++] = (char)('0' + (integer % 10));
+      integer /= 10;
+
+   }while (integer > 0);
+
+   while (numDigits > 0)
+      out_[size++] = digits[--numDigits];
+
+   out_[size++] = '.';
+
+   for (int i = 8; i >= 0; i--)
+   {
+      out_[size + i] = (char)('0' + (fraction % 10));
+      fraction /= 10;
+   }
+
+   return size + 9;
+}
+
+// Plain decimals with up to 15 digits are exact integers divided by an exact power of 10: the division is correctly
+// rounded, so the result is the one of strtod (which handles everything else)
+static const char * parse_double(const char * text_, double * value_)
+{
+   static const double powers[16] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13,
+                                      1e14, 1e15 };
+   const char * text = text_;
+   uint64_t mantissa = 0;
+   int numDigits = 0, numDecimals = -1, negative = 0;
+   char * end;
+
+   if ((*text) == '-')
+   {
+      negative = 1;
+      text++;
+   }
+
+   for (;; text++)
+   {
+      if (((*text) >= '0') && ((*text) <= '9'))
+      {
+         mantissa = (mantissa * 10) + (uint64_t)((*text) - '0');
+         numDigits++;
+         numDecimals += (numDecimals >= 0) ? 1 : 0;
+      }
+      else if (((*text) == '.') && (numDecimals < 0))
+         numDecimals = 0;
+      else
+         break;
+   }
+
+   if ((numDigits > 0) && (numDigits <= 15) && ((*text) != 'e') && ((*text) != 'E'))
+   {
+      (*value_) = (double)mantissa / powers[(numDecimals > 0) ? numDecimals : 0];
+      (*value_) = negative ? -(*value_) : (*value_);
+      return text;
+   }
+
+   (*value_) = strtod(text_, &end);
+   return (end != text_) ? end : NULL;
+}
+
+// NaN fails both compares: only finite positions inside the ranges are accepted
+static int check_position(double lat_, double lon_)
+{
+   return ((lat_ >= -90.0) && (lat_ <= 90.0) && (lon_ >= -180.0) && (lon_ <= 180.0)) ? 0 : -1;
+}
+
+static int parse_position(const char * record_, size_t size_, double * lat_, double * lon_)
+{
+   char line[CLI_MAX_LINE];
+   const char * end;
+
+   // Copy to a terminated buffer: the last record of a mapping is not followed by anything readable
+   if (size_ >= CLI_MAX_LINE)
+      return -1;
+
+   memcpy(line, record_, size_);
+   line[size_] = 0;
+
+   end = parse_double(line, lat_);
+   if ((end == NULL) || ((*end) != ','))
+      return -1;
+
+   end = parse_double(end + 1, lon_);
+   if ((end == NULL) || (((*end) != 0) && ((*end) != ',') && ((*end) != '\r')))
+      return -1;
+
+   return check_position(*lat_, *lon_);
+}
+
+static void batch_task(size_t first_, size_t count_, void * context_)
+{
+   batch_t * batch = (batch_t *)context_;
+   size_t numCharacters = (size_t)batch->numCharacters;
+   long numInvalid = 0;
+   size_t i, size;
+   char * slot;
+   int result;
+
+   if (!batch->decode)
+   {
+      // slotLengths[i] is 0 for the invalid records until the output is written
+      for (i = first_; i < first_ + count_; i++)
+      {
+         if (batch->inputFormat == FORMAT_BINARY)
+         {
+            memcpy(&batch->lat[i], batch->records[i], sizeof(double));
+            memcpy(&batch->lon[i], batch->records[i] + sizeof(double), sizeof(double));
+            batch->slotLengths[i] = (check_position(batch->lat[i], batch->lon[i]) == 0);
+         }
+         else
+            batch->slotLengths[i] = (parse_position(batch->records[i], batch->recordLengths[i], &batch->lat[i],
+                                                    &batch->lon[i]) == 0);
+
+         if (!batch->slotLengths[i])
+         {
+            batch->lat[i] = 0.0;
+            batch->lon[i] = 0.0;
+            numInvalid++;
+         }
+      }
+
+      if (batch->outputFormat == FORMAT_BINARY)
+      {
+         result = geohash36_encode_batch(batch->lat + first_, batch->lon + first_, count_,
+                                         batch->slots + (first_ * numCharacters), batch->numCharacters);
+
+         // Binary hashes have no separator to leave empty: invalid records get a slot full of the invalid character
+         for (i = first_; i < first_ + count_; i++)
+         {
+            if (!batch->slotLengths[i])
+               memset(batch->slots + (i * numCharacters), GEOHASH36_TRANSCODE_INVALID_CHAR, numCharacters);
+         }
+      }
+      else
+      {
+         result = geohash36_encode_batch(batch->lat + first_, batch->lon + first_, count_,
+                                         batch->hashes + (first_ * numCharacters), batch->numCharacters);
+
+         for (i = first_; i < first_ + count_; i++)
+         {
+            slot = batch->slots + (i * CLI_SLOT_SIZE);
+            size = batch->slotLengths[i] ? numCharacters : 0;
+
+            memcpy(slot, batch->hashes + (i * numCharacters), size);
+            slot[size] = '\n';
+            batch->slotLengths[i] = (uint8_t)(size + 1);
+         }
+      }
+
+      if (result != 0)
+         __atomic_store_n(&batch->failed, 1, __ATOMIC_RELAXED);
+   }
+   else
+   {
+      if (batch->inputFormat == FORMAT_BINARY)
+      {
+         for (i = first_; i < first_ + count_; i++)
+            memcpy(batch->hashes + (i * numCharacters), batch->records[i], numCharacters);
+
+         numInvalid = geohash36_decode_batch(batch->hashes + (first_ * numCharacters), count_, batch->numCharacters,
+                                             batch->lat + first_, batch->lon + first_, NULL, NULL);
+      }
+      else
+      {
+         for (i = first_; i < first_ + count_; i++)
+         {
+            size = batch->recordLengths[i];
+            while ((size > 0) && ((batch->records[i][size - 1] == '\r') || (batch->records[i][size - 1] == ' ')))
+               size--;
+
+            if ((size == 0) || (geohash36_decode((char *)batch->records[i], (int)size, &batch->lat[i], &batch->lon[i]) != 0))
+            {
+               batch->lat[i] = NAN;
+               batch->lon[i] = NAN;
+               numInvalid++;
+            }
+         }
+      }
+
+      for (i = first_; i < first_ + count_; i++)
+      {
+         if (batch->outputFormat == FORMAT_BINARY)
+         {
+            slot = batch->slots + (i * 2 * sizeof(double));
+            memcpy(slot, &batch->lat[i], sizeof(double));
+            memcpy(slot + sizeof(double), &batch->lon[i], sizeof(double));
+            continue;
+         }
+
+         slot = batch->slots + (i * CLI_SLOT_SIZE);
+         size = 0;
+
+         if (!isnan(batch->lat[i]))
+         {
+            size = format_coordinate(batch->lat[i], slot);
+            slot[size++] = ',';
+            size += format_coordinate(batch->lon[i], slot + size);
+         }
+
+         slot[size++] = '\n';
+         batch->slotLengths[i] = (uint8_t)size;
+      }
+   }
+
+   if (numInvalid > 0)
+      __atomic_fetch_add(&batch->numInvalid, numInvalid, __ATOMIC_RELAXED);
+}
+
+// Splits the available bytes in records; returns the number of bytes they use
+static size_t frame_records(batch_t * batch_, const char * data_, size_t size_, int eof_, size_t * numRecords_)
+{
+   size_t offset = 0, n = 0, length;
+   const char * newline;
+
+   if (batch_->inputFormat == FORMAT_BINARY)
+   {
+      while ((n < CLI_BATCH_RECORDS) && (size_ - offset >= batch_->recordSize))
+      {
+         batch_->records[n++] = data_ + offset;
+         offset += batch_->recordSize;
+      }
+
+      (*numRecords_) = n;
+      return offset;
+   }
+
+   while ((n < CLI_BATCH_RECORDS) && (offset < size_))
+   {
+      newline = memchr(data_ + offset, '\n', size_ - offset);
+
+      if ((newline == NULL) && !eof_)
+         break;
+
+      length = (newline != NULL) ? (size_t)(newline - (data_ + offset)) : (size_ - offset);
+
+      batch_->records[n] = data_ + offset;
+      batch_->recordLengths[n] = (uint16_t)MIN(length, (size_t)UINT16_MAX);
+      offset += (newline != NULL) ? (length + 1) : length;
+      n++;
+   }
+
+   (*numRecords_) = n;
+   return offset;
+}
+
+// Writes the slots of a batch, compacting the variable length ones in place
+static int write_batch(int fd_, batch_t * batch_, size_t n_)
+{
+   size_t size = 0;
+
+   if (batch_->outputFormat == FORMAT_BINARY)
+   {
+      size = n_ * (batch_->decode ? (2 * sizeof(double)) : (size_t)batch_->numCharacters);
+      return write_all(fd_, batch_->slots, size);
+   }
+
+   for (size_t i = 0; i < n_; i++)
+   {
+      if (size != i * CLI_SLOT_SIZE)
+         memmove(batch_->slots + size, batch_->slots + (i * CLI_SLOT_SIZE), batch_->slotLengths[i]);
+
+      size += batch_->slotLengths[i];
+   }
+
+   return write_all(fd_, batch_->slots, size);
+}
+
+int main(int argc, char ** argv)
+{
+   const char * inputPath = NULL;
+   const char * outputPath = NULL;
+   const char * data;
+   geohash36_pool_t pool;
+   reader_t reader;
+   batch_t batch;
+   size_t size, used, n, total = 0;
+   int numThreads = 1, skipHeader = 0, outputFd = STDOUT_FILENO, result = 0;
+
+   memset(&batch, 0, sizeof(batch));
+   batch.numCharacters = GEOHASH36_DEFAULT_NUM_CHARACTERS;
+
+   if ((argc < 2) || ((strcmp(argv[1], "encode") != 0) && (strcmp(argv[1], "decode") != 0)))
+   {
+      usage();
+      return 1;
+   }
+
+   batch.decode = (strcmp(argv[1], "decode") == 0);
+
+   for (int i = 2; i < argc; i++)
+   {
+      const char * option = argv[i];
+
+      if (((strcmp(option, "-l") == 0) || (strcmp(option, "--length") == 0)) && (i + 1 < argc))
+         batch.numCharacters = atoi(argv[++i]);
+      else if (((strcmp(option, "-i") == 0) || (strcmp(option, "--input-format") == 0)) && (i + 1 < argc))
+         batch.inputFormat = (strcmp(argv[++i], "binary") == 0) ? FORMAT_BINARY : FORMAT_CSV;
+      else if (((strcmp(option, "-o") == 0) || (strcmp(option, "--output-format") == 0)) && (i + 1 < argc))
+         batch.outputFormat = (strcmp(argv[++i], "binary") == 0) ? FORMAT_BINARY : FORMAT_CSV;
+      else if (((strcmp(option, "-t") == 0) || (strcmp(option, "--threads") == 0)) && (i + 1 < argc))
+         numThreads = atoi(argv[++i]);
+      else if (strcmp(option, "--header") == 0)
+         skipHeader = 1;
+      else if ((option[0] != '-') || (strcmp(option, "-") == 0))
+      {
+         if (inputPath == NULL)
+            inputPath = option;
+         else if (outputPath == NULL)
+            outputPath = option;
+         else
+         {
+            usage();
+            return 1;
+         }
+      }
+      else
+      {
+         usage();
+         return 1;
+      }
+   }
+
+   if ((batch.numCharacters < 1) || (batch.numCharacters > CLI_SLOT_SIZE - 1) || (numThreads < 0))
+   {
+      fprintf(stderr, "geohash36: invalid length or number of threads\n");
+      return 1;
+   }
+
+   batch.recordSize = batch.decode ? (size_t)batch.numCharacters : (2 * sizeof(double));
+
+   batch.records = malloc(CLI_BATCH_RECORDS * sizeof(const char *));
+   batch.recordLengths = malloc(CLI_BATCH_RECORDS * sizeof(uint16_t));
+   batch.lat = malloc(CLI_BATCH_RECORDS * sizeof(double));
+   batch.lon = malloc(CLI_BATCH_RECORDS * sizeof(double));
+   batch.hashes = malloc(CLI_BATCH_RECORDS * (size_t)batch.numCharacters);
+   batch.slots = malloc(CLI_BATCH_RECORDS * CLI_SLOT_SIZE);
+   batch.slotLengths = malloc(CLI_BATCH_RECORDS * sizeof(uint8_t));
+
+   if ((batch.records == NULL) || (batch.recordLengths == NULL) || (batch.lat == NULL) || (batch.lon == NULL) ||
+       (batch.hashes == NULL) || (batch.slots == NULL) || (batch.slotLengths == NULL))
+   {
+      fprintf(stderr, "geohash36: out of memory\n");
+      return 1;
+   }
+
+   if ((numThreads != 1) && (geohash36_pool_init(&pool, numThreads, NULL) != 0))
+   {
+      fprintf(stderr, "geohash36: could not start %d threads\n", numThreads);
+      return 1;
+   }
+
+   if (reader_open(&reader, inputPath) != 0)
+   {
+      fprintf(stderr, "geohash36: could not open %s: %s\n", inputPath, strerror(errno));
+      return 1;
+   }
+
+   if (outputPath != NULL)
+   {
+      outputFd = open(outputPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+      if (outputFd < 0)
+      {
+         fprintf(stderr, "geohash36: could not open %s: %s\n", outputPath, strerror(errno));
+         return 1;
+      }
+   }
+
+   for (;;)
+   {
+      if (reader_fill(&reader, &data, &size) != 0)
+      {
+         fprintf(stderr, "geohash36: read error: %s\n", strerror(errno));
+         result = 1;
+         break;
+      }
+
+      if (skipHeader && (batch.inputFormat == FORMAT_CSV))
+      {
+         const char * newline = memchr(data, '\n', size);
+
+         // A full buffer without newline: the header can't be skipped
+         if ((newline == NULL) && !reader.eof)
+         {
+            fprintf(stderr, "geohash36: line too long\n");
+            result = 1;
+            break;
+         }
+
+         used = (newline != NULL) ? (size_t)(newline - data) + 1 : size;
+         reader.begin += used;
+         data += used;
+         size -= used;
+         skipHeader = 0;
+      }
+
+      used = frame_records(&batch, data, size, reader.eof && (reader.begin + size == reader.end), &n);
+
+      if (n == 0)
+      {
+         if (size > 0)
+         {
+            fprintf(stderr, "geohash36: %s\n", (batch.inputFormat == FORMAT_BINARY) ? "truncated binary record" :
+                                                                                      "line too long");
+            result = 1;
+         }
+
+         break;
+      }
+
+      if (numThreads != 1)
+         geohash36_pool_run(&pool, n, CLI_CHUNK_RECORDS, batch_task, &batch);
+      else
+         batch_task(0, n, &batch);
+
+      if (batch.failed)
+      {
+         fprintf(stderr, "geohash36: encode failed\n");
+         result = 1;
+         break;
+      }
+
+      if (write_batch(outputFd, &batch, n) != 0)
+      {
+         fprintf(stderr, "geohash36: write error: %s\n", strerror(errno));
+         result = 1;
+         break;
+      }
+
+      reader.begin += used;
+      total += n;
+   }
+
+   if (batch.numInvalid > 0)
+   {
+      fprintf(stderr, "geohash36: %ld invalid records out of %zu\n", batch.numInvalid, total);
+      result = (result == 0) ? CLI_EXIT_INVALID : result;
+   }
+
+   reader_close(&reader);
+
+   if ((outputFd != STDOUT_FILENO) && (close(outputFd) != 0))
+      result = 1;
+
+   if (numThreads != 1)
+      geohash36_pool_free(&pool);
+
+   free(batch.records);
+   free(batch.recordLengths);
+   free(batch.lat);
+   free(batch.lon);
+   free(batch.hashes);
+   free(batch.slots);
+   free(batch.slotLengths);
+
+   return result;
+}
@@ -0,0 +1,582 @@
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include "geohash36_compact.h"
+#include "geohash36_internal.h"
+
+/***********************************************************************************************************************
+Defines/macros
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Bytes read past the last packed difference (each difference is read with a 64-bit load).
+************************************************************************************************************************
+**/
+#define GEOHASH36_COMPACT_PADDING            8
+
+/***********************************************************************************************************************
+Constants
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Powers of 36 (number of keys of each length below a prefix).
+************************************************************************************************************************
+**/
+static const uint64_t geohash36_compact_pow36[GEOHASH36_KEY_MAX_CHARACTERS + 1] =
+{
+   1ULL, 36ULL, 1296ULL, 46656ULL, 1679616ULL, 60466176ULL, 2176782336ULL, 78364164096ULL, 2821109907456ULL,
+   101559956668416ULL, 3656158440062976ULL
+};
+
+/***********************************************************************************************************************
+Internal functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Converts the first characters of a key to a base-36 number (ranks of the characters as digits).
+************************************************************************************************************************
+* @param [in] key_: packed key;
+* @param [in] numCharacters_: number of characters converted.
+************************************************************************************************************************
+* @return Number.
+************************************************************************************************************************
+**/
+static uint64_t geohash36_compact_toNumber(geohash36_key_t key_, int numCharacters_)
+{
+   uint64_t number = 0;
+   int i;
+
+   for (i = 0; i < numCharacters_; i++)
+      number = (number * 36) + ((key_ >> (GEOHASH36_KEY_FIRST_CHAR_SHIFT - (i * GEOHASH36_KEY_CHAR_BITS))) &
+                                GEOHASH36_KEY_CHAR_MASK);
+
+   return number;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Converts a base-36 number back to a key.
+************************************************************************************************************************
+* @param [in] number_: number;
+* @param [in] numCharacters_: key length.
+************************************************************************************************************************
+* @return Packed key.
+************************************************************************************************************************
+**/
+static geohash36_key_t geohash36_compact_toKey(uint64_t number_, int numCharacters_)
+{
+   geohash36_key_t key = (geohash36_key_t)numCharacters_;
+   int i;
+
+   for (i = numCharacters_ - 1; i >= 0; i--)
+   {
+      key |= (number_ % 36) << (GEOHASH36_KEY_FIRST_CHAR_SHIFT - (i * GEOHASH36_KEY_CHAR_BITS));
+      number_ /= 36;
+   }
+
+   return key;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Reads a packed difference of a block.
+************************************************************************************************************************
+* @param [in] compact_: pointer to the collection;
+* @param [in] block_: block;
+* @param [in] index_: index of the difference (0 for the entry following the restart point).
+************************************************************************************************************************
+* @return Difference with the restart point.
+************************************************************************************************************************
+**/
+static inline uint64_t geohash36_compact_readDelta(const geohash36_compact_t * compact_, size_t block_, size_t index_)
+{
+   uint64_t width = compact_->blocks[block_] & 0xFF;
+   size_t bit = index_ * width;
+   const uint8_t * data = compact_->data + (compact_->blocks[block_] >> 8) + (bit / 8);
+   uint64_t word = 0;
+   int i;
+
+   // Little-endian whatever the host (compilers turn this into a single load)
+   for (i = 0; i < 8; i++)
+      word |= (uint64_t)data[i] << (8 * i);
+
+   return (word >> (bit % 8)) & ((1ULL << width) - 1);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Gets the position of the first number not lower than a number.
+************************************************************************************************************************
+* @param [in] compact_: pointer to the collection;
+* @param [in] number_: number.
+************************************************************************************************************************
+* @return Position ("numEntries" if every number is lower).
+************************************************************************************************************************
+**/
+static size_t geohash36_compact_lowerBound(const geohash36_compact_t * compact_, uint64_t number_)
+{
+   size_t first = 0, count = compact_->numRestarts, half;
+   size_t block;
+   uint64_t delta;
+
+   if (count == 0)
+      return 0;
+
+   // Last block starting below the number (without branches, the comparisons are unpredictable)
+   while (count > 1)
+   {
+      half = count / 2;
+      first = (compact_->restarts[first + half - 1] < number_) ? (first + half) : first;
+      count -= half;
+   }
+
+   first += (compact_->restarts[first] < number_);
+
+   if (first == 0)
+      return 0;
+
+   // First difference of the block not lower than the one of the number
+   block = first - 1;
+   delta = number_ - compact_->restarts[block];
+   count = MIN((size_t)compact_->restartInterval, compact_->numEntries - (block * compact_->restartInterval)) - 1;
+   first = 0;
+
+   if (count == 0)
+      return (block * compact_->restartInterval) + 1;
+
+   while (count > 1)
+   {
+      half = count / 2;
+      first = (geohash36_compact_readDelta(compact_, block, first + half - 1) < delta) ? (first + half) : first;
+      count -= half;
+   }
+
+   first += (geohash36_compact_readDelta(compact_, block, first) < delta);
+
+   return (block * compact_->restartInterval) + 1 + first;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Empties a collection, keeping its memory.
+************************************************************************************************************************
+* @param [in] compact_: pointer to the collection.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_compact_clear(geohash36_compact_t * compact_)
+{
+   compact_->numBytes = 0;
+   compact_->numRestarts = 0;
+   compact_->numEntries = 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Appends a block.
+************************************************************************************************************************
+* @param [in] compact_: pointer to the collection (with room for the restart point);
+* @param [in] numbers_: sorted numbers of the block;
+* @param [in] n_: number of entries of the block (1 to "restartInterval").
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Allocation failure.
+************************************************************************************************************************
+**/
+static int geohash36_compact_addBlock(geohash36_compact_t * compact_, const uint64_t * numbers_, size_t n_)
+{
+   uint64_t range = numbers_[n_ - 1] - numbers_[0], delta;
+   size_t numBytes, maxBytes, bit, i;
+   uint8_t width = 0;
+   int written;
+   void * memory;
+
+   while ((width < 64) && ((range >> width) != 0))
+      width++;
+
+   numBytes = ((((n_ - 1) * width) + 7) / 8);
+
+   if (compact_->numBytes + numBytes + GEOHASH36_COMPACT_PADDING > compact_->maxBytes)
+   {
+      maxBytes = MAX(2 * compact_->maxBytes, compact_->numBytes + numBytes + GEOHASH36_COMPACT_PADDING);
+      maxBytes = MAX(maxBytes, 1024);
+
+      if ((memory = realloc(compact_->data, maxBytes)) == NULL)
+         return -1;
+
+      memset((uint8_t *)memory + compact_->maxBytes, 0, maxBytes - compact_->maxBytes);
+      compact_->data = memory;
+      compact_->maxBytes = maxBytes;
+   }
+
+   compact_->restarts[compact_->numRestarts] = numbers_[0];
+   compact_->blocks[compact_->numRestarts] = ((uint64_t)compact_->numBytes << 8) | width;
+
+   for (i = 1; i < n_; i++)
+   {
+      delta = numbers_[i] - numbers_[0];
+      bit = (compact_->numBytes * 8) + ((i - 1) * width);
+
+      for (written = 0; written < width; written += 8 - (int)(bit % 8), bit += 8 - (bit % 8))
+         compact_->data[bit / 8] |= (uint8_t)((delta >> written) << (bit % 8));
+   }
+
+   compact_->numBytes += numBytes;
+   compact_->numRestarts++;
+   compact_->numEntries += n_;
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Replaces the content of a collection with sorted keys, given as packed keys or as strings.
+************************************************************************************************************************
+* @param [in] compact_: pointer to the collection;
+* @param [in] keys_: keys (NULL to read "hashes_");
+* @param [in] hashes_: hashes of the collection length, without separator;
+* @param [in] n_: number of keys.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input, unsorted keys or allocation failure (the collection is then empty).
+************************************************************************************************************************
+**/
+static int geohash36_compact_buildFrom(geohash36_compact_t * compact_, const geohash36_key_t * keys_,
+                                       const char * hashes_, size_t n_)
+{
+   size_t interval = (size_t)compact_->restartInterval;
+   size_t numRestarts = (n_ + interval - 1) / interval;
+   size_t i, count = 0;
+   uint64_t * numbers;
+   uint64_t number, last = 0;
+   geohash36_key_t key;
+   void * memory;
+   int result = 0;
+
+   geohash36_compact_clear(compact_);
+
+   if (n_ == 0)
+      return 0;
+
+   // The restart points are sized once, the packed differences grow with the blocks
+   if ((memory = realloc(compact_->restarts, numRestarts * sizeof(uint64_t))) == NULL)
+      return -1;
+
+   compact_->restarts = memory;
+
+   if ((memory = realloc(compact_->blocks, numRestarts * sizeof(uint64_t))) == NULL)
+      return -1;
+
+   compact_->blocks = memory;
+
+   if ((numbers = malloc(interval * sizeof(uint64_t))) == NULL)
+      return -1;
+
+   if (compact_->data != NULL)
+      memset(compact_->data, 0, compact_->maxBytes);
+
+   for (i = 0; (i < n_) && (result == 0); i++)
+   {
+      // Characters are ranked in ASCII order, so sorted hashes give sorted keys
+      key = (keys_ != NULL) ? keys_[i] : geohash36_stringToKey(hashes_ + (i * compact_->numCharacters),
+                                                               compact_->numCharacters);
+
+      if ((GEOHASH36_KEY_LENGTH(key) != compact_->numCharacters) || !geohash36_keyIsValid(key))
+      {
+         result = -1;
+         break;
+      }
+
+      number = geohash36_compact_toNumber(key, compact_->numCharacters);
+
+      if ((i > 0) && (number < last))
+      {
+         result = -1;
+         break;
+      }
+
+      numbers[count++] = number;
+      last = number;
+
+      if ((count == interval) || (i == n_ - 1))
+      {
+         result = geohash36_compact_addBlock(compact_, numbers, count);
+         count = 0;
+      }
+   }
+
+   free(numbers);
+
+   if (result != 0)
+   {
+      geohash36_compact_clear(compact_);
+      return -1;
+   }
+
+   // Releases the growth margin of the packed differences
+   if ((memory = realloc(compact_->data, compact_->numBytes + GEOHASH36_COMPACT_PADDING)) != NULL)
+   {
+      compact_->data = memory;
+      compact_->maxBytes = compact_->numBytes + GEOHASH36_COMPACT_PADDING;
+   }
+
+   return 0;
+}
+
+/***********************************************************************************************************************
+External functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Initializes an empty collection.
+************************************************************************************************************************
+* @param [out] compact_: pointer to the collection;
+* @param [in] numCharacters_: length of the keys (1 to GEOHASH36_KEY_MAX_CHARACTERS);
+* @param [in] restartInterval_: number of entries between restart points (GEOHASH36_COMPACT_DEFAULT_RESTART trades
+*                               about half a byte per entry for short lookups).
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input.
+************************************************************************************************************************
+**/
+int geohash36_compact_init(geohash36_compact_t * compact_, int numCharacters_, int restartInterval_)
+{
+   if ((compact_ == NULL) || (numCharacters_ < 1) || (numCharacters_ > GEOHASH36_KEY_MAX_CHARACTERS) ||
+       (restartInterval_ < 1))
+      return -1;
+
+   memset(compact_, 0, sizeof(geohash36_compact_t));
+   compact_->numCharacters = numCharacters_;
+   compact_->restartInterval = restartInterval_;
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Releases the memory of a collection.
+************************************************************************************************************************
+* @param [in] compact_: pointer to the collection.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+void geohash36_compact_free(geohash36_compact_t * compact_)
+{
+   if (compact_ == NULL)
+      return;
+
+   free(compact_->data);
+   free(compact_->restarts);
+   free(compact_->blocks);
+   compact_->data = NULL;
+   compact_->restarts = NULL;
+   compact_->blocks = NULL;
+   compact_->maxBytes = 0;
+   geohash36_compact_clear(compact_);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Replaces the content of a collection with sorted keys.
+************************************************************************************************************************
+* @param [in] compact_: pointer to the collection;
+* @param [in] keys_: keys sorted in ascending order (same length as the collection);
+* @param [in] n_: number of keys.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input, unsorted keys or allocation failure (the collection is then empty).
+************************************************************************************************************************
+**/
+int geohash36_compact_build(geohash36_compact_t * compact_, const geohash36_key_t * keys_, size_t n_)
+{
+   if ((compact_ == NULL) || ((keys_ == NULL) && (n_ > 0)))
+      return -1;
+
+   return geohash36_compact_buildFrom(compact_, keys_, NULL, n_);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Replaces the content of a collection with sorted Geohash-36 strings, as written by geohash36_encode_batch
+*        (hashes of the collection length, without separator).
+************************************************************************************************************************
+* @param [in] compact_: pointer to the collection;
+* @param [in] hashes_: hashes sorted in ascending (ASCII) order;
+* @param [in] n_: number of hashes.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input, unsorted hashes or allocation failure (the collection is then empty).
+************************************************************************************************************************
+**/
+int geohash36_compact_buildStrings(geohash36_compact_t * compact_, const char * hashes_, size_t n_)
+{
+   if ((compact_ == NULL) || ((hashes_ == NULL) && (n_ > 0)))
+      return -1;
+
+   return geohash36_compact_buildFrom(compact_, NULL, hashes_, n_);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Gets the memory used by a collection.
+************************************************************************************************************************
+* @param [in] compact_: pointer to the collection.
+************************************************************************************************************************
+* @return Number of bytes used by the entries and the restart points.
+************************************************************************************************************************
+**/
+size_t geohash36_compact_getBytes(const geohash36_compact_t * compact_)
+{
+   if (compact_ == NULL)
+      return 0;
+
+   return compact_->numBytes + (compact_->numRestarts * (2 * sizeof(uint64_t)));
+}
+
+/*!
+************************************************************************************************************************
+* @brief Gets the key at a position.
+************************************************************************************************************************
+* @param [in] compact_: pointer to the collection;
+* @param [in] position_: position of the entry.
+************************************************************************************************************************
+* @return Key, or GEOHASH36_KEY_INVALID for invalid input.
+************************************************************************************************************************
+**/
+geohash36_key_t geohash36_compact_get(const geohash36_compact_t * compact_, size_t position_)
+{
+   size_t block, index;
+   uint64_t number;
+
+   if ((compact_ == NULL) || (position_ >= compact_->numEntries))
+      return GEOHASH36_KEY_INVALID;
+
+   block = position_ / (size_t)compact_->restartInterval;
+   index = position_ % (size_t)compact_->restartInterval;
+   number = compact_->restarts[block];
+
+   if (index > 0)
+      number += geohash36_compact_readDelta(compact_, block, index - 1);
+
+   return geohash36_compact_toKey(number, compact_->numCharacters);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Gets the position of the first key not lower than a key (binary search over the restart points, then inside
+*        one block).
+************************************************************************************************************************
+* @param [in] compact_: pointer to the collection;
+* @param [in] key_: key (of any length: shorter keys stand for the first key of their cell).
+************************************************************************************************************************
+* @return Position ("numEntries" if every key is lower or the key is invalid).
+************************************************************************************************************************
+**/
+size_t geohash36_compact_find(const geohash36_compact_t * compact_, geohash36_key_t key_)
+{
+   int numCharacters;
+   uint64_t number;
+
+   if (compact_ == NULL)
+      return 0;
+
+   if (!geohash36_keyIsValid(key_))
+      return compact_->numEntries;
+
+   numCharacters = GEOHASH36_KEY_LENGTH(key_);
+   number = geohash36_compact_toNumber(key_, MIN(numCharacters, compact_->numCharacters));
+
+   // A longer key comes after the key of its ancestor cell
+   if (numCharacters > compact_->numCharacters)
+      number++;
+   else
+      number *= geohash36_compact_pow36[compact_->numCharacters - numCharacters];
+
+   return geohash36_compact_lowerBound(compact_, number);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Gets the range of keys starting with a prefix.
+************************************************************************************************************************
+* @param [in] compact_: pointer to the collection;
+* @param [in] prefix_: key of the prefix (not longer than the keys of the collection);
+* @param [out] outFirst_: optional pointer which will receive the position of the first key of the range.
+************************************************************************************************************************
+* @return Number of keys starting with the prefix, or -1 for invalid input.
+************************************************************************************************************************
+**/
+long geohash36_compact_findPrefix(const geohash36_compact_t * compact_, geohash36_key_t prefix_, size_t * outFirst_)
+{
+   uint64_t number, size;
+   size_t first;
+
+   if ((compact_ == NULL) || !geohash36_keyIsValid(prefix_) ||
+       (GEOHASH36_KEY_LENGTH(prefix_) > compact_->numCharacters))
+      return -1;
+
+   size = geohash36_compact_pow36[compact_->numCharacters - GEOHASH36_KEY_LENGTH(prefix_)];
+   number = geohash36_compact_toNumber(prefix_, GEOHASH36_KEY_LENGTH(prefix_)) * size;
+   first = geohash36_compact_lowerBound(compact_, number);
+
+   if (outFirst_ != NULL)
+      *outFirst_ = first;
+
+   return (long)(geohash36_compact_lowerBound(compact_, number + size) - first);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Decodes consecutive keys.
+************************************************************************************************************************
+* @param [in] compact_: pointer to the collection;
+* @param [in] first_: position of the first key;
+* @param [in] n_: number of keys desired;
+* @param [out] outKeys_: array which will receive the keys.
+************************************************************************************************************************
+* @return Number of keys decoded (less than "n_" at the end of the collection), or -1 for invalid input.
+************************************************************************************************************************
+**/
+long geohash36_compact_decode(const geohash36_compact_t * compact_, size_t first_, size_t n_,
+                              geohash36_key_t * outKeys_)
+{
+   size_t block, index, count, i;
+
+   if ((compact_ == NULL) || ((outKeys_ == NULL) && (n_ > 0)))
+      return -1;
+
+   if (first_ >= compact_->numEntries)
+      return 0;
+
+   count = MIN(n_, compact_->numEntries - first_);
+   block = first_ / (size_t)compact_->restartInterval;
+   index = first_ % (size_t)compact_->restartInterval;
+
+   for (i = 0; i < count; i++)
+   {
+      outKeys_[i] = geohash36_compact_toKey(compact_->restarts[block] +
+                                            ((index > 0) ? geohash36_compact_readDelta(compact_, block, index - 1) : 0),
+                                            compact_->numCharacters);
+
+      if (++index == (size_t)compact_->restartInterval)
+      {
+         block++;
+         index = 0;
+      }
+   }
+
+   return (long)count;
+}
@@ -0,0 +1,178 @@
+#ifndef _GEOHASH36_COMPACT_H_
+#define _GEOHASH36_COMPACT_H_
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "stddef.h"
+#include "geohash36.h"
+
+/***********************************************************************************************************************
+Defines/macros
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Default number of entries between restart points.
+************************************************************************************************************************
+**/
+#define GEOHASH36_COMPACT_DEFAULT_RESTART    32
+
+/***********************************************************************************************************************
+Typedefs/structs/unions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Sorted collection of keys of the same length, delta coded in blocks.
+*
+* Each key is seen as a base-36 number (its characters in rank order), so that keys sharing a long prefix become close
+* numbers. The first key of each block (restart point) is kept as is in "restarts"; the others are stored in "data" as
+* their difference with it, packed on the number of bits of the largest difference of the block. "blocks" gives the
+* position of these differences in "data" (upper 56 bits) and their width (lower 8 bits). Any key of a block can thus
+* be read directly, and a lookup is a binary search over the restart points followed by one inside the block.
+************************************************************************************************************************
+**/
+typedef struct
+{
+   uint8_t * data;
+   size_t numBytes;
+   size_t maxBytes;
+
+   uint64_t * restarts;
+   uint64_t * blocks;
+   size_t numRestarts;
+
+   size_t numEntries;
+   int numCharacters;
+   int restartInterval;
+
+}geohash36_compact_t;
+
+/***********************************************************************************************************************
+Exported functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Initializes an empty collection.
+************************************************************************************************************************
+* @param [out] compact_: pointer to the collection;
+* @param [in] numCharacters_: length of the keys (1 to GEOHASH36_KEY_MAX_CHARACTERS);
+* @param [in] restartInterval_: number of entries between restart points (GEOHASH36_COMPACT_DEFAULT_RESTART trades
+*                               about half a byte per entry for short lookups).
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input.
+************************************************************************************************************************
+**/
+int geohash36_compact_init(geohash36_compact_t * compact_, int numCharacters_, int restartInterval_);
+
+/*!
+************************************************************************************************************************
+* @brief Releases the memory of a collection.
+************************************************************************************************************************
+* @param [in] compact_: pointer to the collection.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+void geohash36_compact_free(geohash36_compact_t * compact_);
+
+/*!
+************************************************************************************************************************
+* @brief Replaces the content of a collection with sorted keys.
+************************************************************************************************************************
+* @param [in] compact_: pointer to the collection;
+* @param [in] keys_: keys sorted in ascending order (same length as the collection);
+* @param [in] n_: number of keys.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input, unsorted keys or allocation failure (the collection is then empty).
+************************************************************************************************************************
+**/
+int geohash36_compact_build(geohash36_compact_t * compact_, const geohash36_key_t * keys_, size_t n_);
+
+/*!
+************************************************************************************************************************
+* @brief Replaces the content of a collection with sorted Geohash-36 strings, as written by geohash36_encode_batch
+*        (hashes of the collection length, without separator).
+************************************************************************************************************************
+* @param [in] compact_: pointer to the collection;
+* @param [in] hashes_: hashes sorted in ascending (ASCII) order;
+* @param [in] n_: number of hashes.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input, unsorted hashes or allocation failure (the collection is then empty).
+************************************************************************************************************************
+**/
+int geohash36_compact_buildStrings(geohash36_compact_t * compact_, const char * hashes_, size_t n_);
+
+/*!
+************************************************************************************************************************
+* @brief Gets the memory used by a collection.
+************************************************************************************************************************
+* @param [in] compact_: pointer to the collection.
+************************************************************************************************************************
+* @return Number of bytes used by the entries and the restart points.
+************************************************************************************************************************
+**/
+size_t geohash36_compact_getBytes(const geohash36_compact_t * compact_);
+
+/*!
+************************************************************************************************************************
+* @brief Gets the key at a position.
+************************************************************************************************************************
+* @param [in] compact_: pointer to the collection;
+* @param [in] position_: position of the entry.
+************************************************************************************************************************
+* @return Key, or GEOHASH36_KEY_INVALID for invalid input.
+************************************************************************************************************************
+**/
+geohash36_key_t geohash36_compact_get(const geohash36_compact_t * compact_, size_t position_);
+
+/*!
+************************************************************************************************************************
+* @brief Gets the position of the first key not lower than a key (binary search over the restart points, then inside
+*        one block).
+************************************************************************************************************************
+* @param [in] compact_: pointer to the collection;
+* @param [in] key_: key (of any length: shorter keys stand for the first key of their cell).
+************************************************************************************************************************
+* @return Position ("numEntries" if every key is lower or the key is invalid).
+************************************************************************************************************************
+**/
+size_t geohash36_compact_find(const geohash36_compact_t * compact_, geohash36_key_t key_);
+
+/*!
+************************************************************************************************************************
+* @brief Gets the range of keys starting with a prefix.
+************************************************************************************************************************
+* @param [in] compact_: pointer to the collection;
+* @param [in] prefix_: key of the prefix (not longer than the keys of the collection);
+* @param [out] outFirst_: optional pointer which will receive the position of the first key of the range.
+************************************************************************************************************************
+* @return Number of keys starting with the prefix, or -1 for invalid input.
+************************************************************************************************************************
+**/
+long geohash36_compact_findPrefix(const geohash36_compact_t * compact_, geohash36_key_t prefix_, size_t * outFirst_);
+
+/*!
+************************************************************************************************************************
+* @brief Decodes consecutive keys.
+************************************************************************************************************************
+* @param [in] compact_: pointer to the collection;
+* @param [in] first_: position of the first key;
+* @param [in] n_: number of keys desired;
+* @param [out] outKeys_: array which will receive the keys.
+************************************************************************************************************************
+* @return Number of keys decoded (less than "n_" at the end of the collection), or -1 for invalid input.
+************************************************************************************************************************
+**/
+long geohash36_compact_decode(const geohash36_compact_t * compact_, size_t first_, size_t n_,
+                              geohash36_key_t * outKeys_);
+
+#endif // _GEOHASH36_COMPACT_H_
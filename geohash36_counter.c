@@ -0,0 +1,353 @@
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include "geohash36_counter.h"
+#include "geohash36_batch.h"
+
+/***********************************************************************************************************************
+Defines/macros
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Minimum number of slots of the table.
+************************************************************************************************************************
+**/
+#define GEOHASH36_COUNTER_MIN_SLOTS          1024
+
+/*!
+************************************************************************************************************************
+* @brief Number of points encoded at a time by geohash36_counter_addPoints.
+************************************************************************************************************************
+**/
+#define GEOHASH36_COUNTER_BLOCK              256
+
+/***********************************************************************************************************************
+Internal functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Finds the slot of a key.
+************************************************************************************************************************
+* @param [in] counter_: pointer to the map;
+* @param [in] key_: key.
+************************************************************************************************************************
+* @return Slot of the key, or "numSlots" if it is not in the table.
+************************************************************************************************************************
+**/
+static size_t geohash36_counter_find(const geohash36_counter_t * counter_, geohash36_key_t key_)
+{
+   size_t position = (size_t)((key_ * 0x9E3779B97F4A7C15ull) >> 32) & (counter_->numSlots - 1);
+   geohash36_key_t key;
+
+   while ((key = __atomic_load_n(&counter_->keys[position], __ATOMIC_ACQUIRE)) != GEOHASH36_KEY_INVALID)
+   {
+      if (key == key_)
+         return position;
+
+      position = (position + 1) & (counter_->numSlots - 1);
+   }
+
+   return counter_->numSlots;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Finds the slot of a key, claiming an empty one for a new key.
+*
+* A thread claiming a slot first reserves one of the "maxCells" cells, so that the table always keeps empty slots and
+* probing ends. Two threads adding the same new key race on the same empty slot: the loser of the compare-and-swap
+* sees the key of the winner and uses its slot.
+************************************************************************************************************************
+* @param [in] counter_: pointer to the map;
+* @param [in] key_: key.
+************************************************************************************************************************
+* @return Slot of the key, or "numSlots" if the map is full.
+************************************************************************************************************************
+**/
+static size_t geohash36_counter_claim(geohash36_counter_t * counter_, geohash36_key_t key_)
+{
+   size_t position = (size_t)((key_ * 0x9E3779B97F4A7C15ull) >> 32) & (counter_->numSlots - 1);
+   geohash36_key_t key;
+   int reserved = 0;
+
+   for (;;)
+   {
+      key = __atomic_load_n(&counter_->keys[position], __ATOMIC_ACQUIRE);
+
+      if (key == key_)
+         break;
+
+      if (key == GEOHASH36_KEY_INVALID)
+      {
+         if (!reserved)
+         {
+            if (__atomic_fetch_add(&counter_->numCells, 1, __ATOMIC_RELAXED) >= counter_->maxCells)
+            {
+               __atomic_fetch_sub(&counter_->numCells, 1, __ATOMIC_RELAXED);
+               return counter_->numSlots;
+            }
+
+            reserved = 1;
+         }
+
+         if (__atomic_compare_exchange_n(&counter_->keys[position], &key, key_, 0, __ATOMIC_ACQ_REL,
+                                         __ATOMIC_ACQUIRE))
+            return position;
+
+         // Lost the slot to another key (keep probing) or to the same key (use it)
+         if (key == key_)
+            break;
+      }
+
+      position = (position + 1) & (counter_->numSlots - 1);
+   }
+
+   if (reserved)
+      __atomic_fetch_sub(&counter_->numCells, 1, __ATOMIC_RELAXED);
+
+   return position;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Compares two cells by key (qsort callback).
+************************************************************************************************************************
+**/
+static int geohash36_counter_compare(const void * a_, const void * b_)
+{
+   geohash36_key_t a = ((const geohash36_counter_cell_t *)a_)->key;
+   geohash36_key_t b = ((const geohash36_counter_cell_t *)b_)->key;
+
+   return (a < b) ? -1 : ((a > b) ? 1 : 0);
+}
+
+/***********************************************************************************************************************
+External functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Initializes an empty counter map.
+************************************************************************************************************************
+* @param [out] counter_: pointer to the map;
+* @param [in] maxCells_: maximum number of cells (the table has at least twice as many slots);
+* @param [in] numStripes_: number of counters per cell (1, or about the number of writing threads for hot cells).
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input or allocation failure.
+************************************************************************************************************************
+**/
+int geohash36_counter_init(geohash36_counter_t * counter_, size_t maxCells_, size_t numStripes_)
+{
+   size_t i;
+
+   if ((counter_ == NULL) || (maxCells_ == 0) || (numStripes_ == 0) || (maxCells_ > (SIZE_MAX / 4)))
+      return -1;
+
+   memset(counter_, 0, sizeof(geohash36_counter_t));
+
+   counter_->numSlots = GEOHASH36_COUNTER_MIN_SLOTS;
+
+   while (counter_->numSlots < 2 * maxCells_)
+      counter_->numSlots *= 2;
+
+   counter_->keys = malloc(counter_->numSlots * sizeof(geohash36_key_t));
+   counter_->counts = calloc(counter_->numSlots * numStripes_, sizeof(int64_t));
+
+   if ((counter_->keys == NULL) || (counter_->counts == NULL))
+   {
+      geohash36_counter_free(counter_);
+      return -1;
+   }
+
+   for (i = 0; i < counter_->numSlots; i++)
+      counter_->keys[i] = GEOHASH36_KEY_INVALID;
+
+   counter_->numStripes = numStripes_;
+   counter_->maxCells = maxCells_;
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Releases the memory of a counter map (no thread may use it anymore).
+************************************************************************************************************************
+* @param [in] counter_: pointer to the map.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+void geohash36_counter_free(geohash36_counter_t * counter_)
+{
+   if (counter_ == NULL)
+      return;
+
+   free(counter_->keys);
+   free(counter_->counts);
+   memset(counter_, 0, sizeof(geohash36_counter_t));
+}
+
+/*!
+************************************************************************************************************************
+* @brief Adds an amount to the counter of a cell (thread-safe, lock-free).
+************************************************************************************************************************
+* @param [in] counter_: pointer to the map;
+* @param [in] key_: key of the cell;
+* @param [in] delta_: amount added (can be negative);
+* @param [in] stripe_: stripe of the calling thread (any value, taken modulo "numStripes").
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input or full map.
+************************************************************************************************************************
+**/
+int geohash36_counter_add(geohash36_counter_t * counter_, geohash36_key_t key_, int64_t delta_, size_t stripe_)
+{
+   size_t position;
+
+   if ((counter_ == NULL) || (counter_->keys == NULL) || (GEOHASH36_KEY_LENGTH(key_) > GEOHASH36_KEY_MAX_CHARACTERS))
+      return -1;
+
+   position = geohash36_counter_claim(counter_, key_);
+
+   if (position == counter_->numSlots)
+      return -1;
+
+   __atomic_fetch_add(&counter_->counts[((stripe_ % counter_->numStripes) * counter_->numSlots) + position], delta_,
+                      __ATOMIC_RELAXED);
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Encodes points and increments the counters of their cells (thread-safe, lock-free).
+************************************************************************************************************************
+* @param [in] counter_: pointer to the map;
+* @param [in] lat_, lon_: positions;
+* @param [in] n_: number of points;
+* @param [in] numCharacters_: length of the cells (1 to GEOHASH36_KEY_MAX_CHARACTERS);
+* @param [in] stripe_: stripe of the calling thread (any value, taken modulo "numStripes").
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input or full map (the points before the failing one are counted).
+************************************************************************************************************************
+**/
+int geohash36_counter_addPoints(geohash36_counter_t * counter_, const double * lat_, const double * lon_, size_t n_,
+                                int numCharacters_, size_t stripe_)
+{
+   geohash36_key_t keys[GEOHASH36_COUNTER_BLOCK];
+   size_t first, count, i;
+
+   if ((counter_ == NULL) || (((lat_ == NULL) || (lon_ == NULL)) && (n_ > 0)) || (numCharacters_ < 1) ||
+       (numCharacters_ > GEOHASH36_KEY_MAX_CHARACTERS))
+      return -1;
+
+   for (first = 0; first < n_; first += count)
+   {
+      count = MIN(n_ - first, GEOHASH36_COUNTER_BLOCK);
+
+      if (geohash36_encodeKey_batch(lat_ + first, lon_ + first, count, keys, numCharacters_) != 0)
+         return -1;
+
+      for (i = 0; i < count; i++)
+      {
+         if (geohash36_counter_add(counter_, keys[i], 1, stripe_) != 0)
+            return -1;
+      }
+   }
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Gets the count of a cell (thread-safe).
+************************************************************************************************************************
+* @param [in] counter_: pointer to the map;
+* @param [in] key_: key of the cell.
+************************************************************************************************************************
+* @return Count of the cell (0 for unknown cells).
+************************************************************************************************************************
+**/
+int64_t geohash36_counter_get(const geohash36_counter_t * counter_, geohash36_key_t key_)
+{
+   size_t position, stripe;
+   int64_t count = 0;
+
+   if ((counter_ == NULL) || (counter_->keys == NULL) || (GEOHASH36_KEY_LENGTH(key_) > GEOHASH36_KEY_MAX_CHARACTERS))
+      return 0;
+
+   position = geohash36_counter_find(counter_, key_);
+
+   if (position == counter_->numSlots)
+      return 0;
+
+   for (stripe = 0; stripe < counter_->numStripes; stripe++)
+      count += __atomic_load_n(&counter_->counts[(stripe * counter_->numSlots) + position], __ATOMIC_RELAXED);
+
+   return count;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Copies the non-zero counts, sorted by key (thread-safe).
+*
+* Each counter is read (or read and zeroed) with one atomic operation while the writers go on. With "reset_", every
+* amount added is thus reported by exactly one snapshot, which makes consecutive snapshots a consistent series of
+* intervals. Cells which do not fit in "outCells_" are not read, and keep their counts for the next snapshot.
+************************************************************************************************************************
+* @param [in] counter_: pointer to the map;
+* @param [out] outCells_: array which will receive the cells;
+* @param [in] maxCells_: "outCells_" length;
+* @param [in] reset_: 1 to zero the counters read, 0 to leave them.
+************************************************************************************************************************
+* @return Number of cells copied, or -1 for invalid input.
+************************************************************************************************************************
+**/
+long geohash36_counter_snapshot(geohash36_counter_t * counter_, geohash36_counter_cell_t * outCells_, size_t maxCells_,
+                                int reset_)
+{
+   size_t position, stripe, count = 0;
+   geohash36_key_t key;
+   int64_t * counter;
+   int64_t total;
+
+   if ((counter_ == NULL) || (counter_->keys == NULL) || ((outCells_ == NULL) && (maxCells_ > 0)))
+      return -1;
+
+   for (position = 0; (position < counter_->numSlots) && (count < maxCells_); position++)
+   {
+      key = __atomic_load_n(&counter_->keys[position], __ATOMIC_ACQUIRE);
+
+      if (key == GEOHASH36_KEY_INVALID)
+         continue;
+
+      total = 0;
+
+      for (stripe = 0; stripe < counter_->numStripes; stripe++)
+      {
+         counter = &counter_->counts[(stripe * counter_->numSlots) + position];
+         total += reset_ ? __atomic_exchange_n(counter, 0, __ATOMIC_RELAXED)
+                         : __atomic_load_n(counter, __ATOMIC_RELAXED);
+      }
+
+      if (total != 0)
+      {
+         outCells_[count].key = key;
+         outCells_[count].count = total;
+         count++;
+      }
+   }
+
+   qsort(outCells_, count, sizeof(geohash36_counter_cell_t), geohash36_counter_compare);
+
+   return (long)count;
+}
@@ -0,0 +1,142 @@
+#ifndef _GEOHASH36_COUNTER_H_
+#define _GEOHASH36_COUNTER_H_
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "stddef.h"
+#include "geohash36.h"
+
+/***********************************************************************************************************************
+Typedefs/structs/unions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Count of a cell.
+************************************************************************************************************************
+**/
+typedef struct
+{
+   geohash36_key_t key;
+   int64_t count;
+
+}geohash36_counter_cell_t;
+
+/*!
+************************************************************************************************************************
+* @brief Per-cell counters shared by several threads without locks.
+*
+* The cells are kept in a fixed open addressing table keyed by packed key, claimed with a compare-and-swap on the key
+* and never removed. Each cell has one counter per stripe ("numStripes" arrays of "numSlots" counters), updated with
+* atomic adds: threads using different stripes do not contend on hot cells, and reading a cell sums its stripes.
+************************************************************************************************************************
+**/
+typedef struct
+{
+   geohash36_key_t * keys;
+   int64_t * counts;
+   size_t numSlots;
+   size_t numStripes;
+
+   size_t maxCells;
+   size_t numCells;
+
+}geohash36_counter_t;
+
+/***********************************************************************************************************************
+Exported functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Initializes an empty counter map.
+************************************************************************************************************************
+* @param [out] counter_: pointer to the map;
+* @param [in] maxCells_: maximum number of cells (the table has at least twice as many slots);
+* @param [in] numStripes_: number of counters per cell (1, or about the number of writing threads for hot cells).
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input or allocation failure.
+************************************************************************************************************************
+**/
+int geohash36_counter_init(geohash36_counter_t * counter_, size_t maxCells_, size_t numStripes_);
+
+/*!
+************************************************************************************************************************
+* @brief Releases the memory of a counter map (no thread may use it anymore).
+************************************************************************************************************************
+* @param [in] counter_: pointer to the map.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+void geohash36_counter_free(geohash36_counter_t * counter_);
+
+/*!
+************************************************************************************************************************
+* @brief Adds an amount to the counter of a cell (thread-safe, lock-free).
+************************************************************************************************************************
+* @param [in] counter_: pointer to the map;
+* @param [in] key_: key of the cell;
+* @param [in] delta_: amount added (can be negative);
+* @param [in] stripe_: stripe of the calling thread (any value, taken modulo "numStripes").
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input or full map.
+************************************************************************************************************************
+**/
+int geohash36_counter_add(geohash36_counter_t * counter_, geohash36_key_t key_, int64_t delta_, size_t stripe_);
+
+/*!
+************************************************************************************************************************
+* @brief Encodes points and increments the counters of their cells (thread-safe, lock-free).
+************************************************************************************************************************
+* @param [in] counter_: pointer to the map;
+* @param [in] lat_, lon_: positions;
+* @param [in] n_: number of points;
+* @param [in] numCharacters_: length of the cells (1 to GEOHASH36_KEY_MAX_CHARACTERS);
+* @param [in] stripe_: stripe of the calling thread (any value, taken modulo "numStripes").
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input or full map (the points before the failing one are counted).
+************************************************************************************************************************
+**/
+int geohash36_counter_addPoints(geohash36_counter_t * counter_, const double * lat_, const double * lon_, size_t n_,
+                                int numCharacters_, size_t stripe_);
+
+/*!
+************************************************************************************************************************
+* @brief Gets the count of a cell (thread-safe).
+************************************************************************************************************************
+* @param [in] counter_: pointer to the map;
+* @param [in] key_: key of the cell.
+************************************************************************************************************************
+* @return Count of the cell (0 for unknown cells).
+************************************************************************************************************************
+**/
+int64_t geohash36_counter_get(const geohash36_counter_t * counter_, geohash36_key_t key_);
+
+/*!
+************************************************************************************************************************
+* @brief Copies the non-zero counts, sorted by key (thread-safe).
+*
+* Each counter is read (or read and zeroed) with one atomic operation while the writers go on. With "reset_", every
+* amount added is thus reported by exactly one snapshot, which makes consecutive snapshots a consistent series of
+* intervals. Cells which do not fit in "outCells_" are not read, and keep their counts for the next snapshot.
+************************************************************************************************************************
+* @param [in] counter_: pointer to the map;
+* @param [out] outCells_: array which will receive the cells;
+* @param [in] maxCells_: "outCells_" length;
+* @param [in] reset_: 1 to zero the counters read, 0 to leave them.
+************************************************************************************************************************
+* @return Number of cells copied, or -1 for invalid input.
+************************************************************************************************************************
+**/
+long geohash36_counter_snapshot(geohash36_counter_t * counter_, geohash36_counter_cell_t * outCells_, size_t maxCells_,
+                                int reset_);
+
+#endif // _GEOHASH36_COUNTER_H_
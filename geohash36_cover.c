@@ -0,0 +1,502 @@
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include <math.h>
+#include <stdlib.h>
+#include "geohash36_cover.h"
+#include "geohash36_internal.h"
+
+/***********************************************************************************************************************
+Typedefs/structs/unions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Region to be covered: a box, or a circle (center + radius) with its bounding box.
+************************************************************************************************************************
+**/
+typedef struct
+{
+   geohash36_bounds_t box;
+   int isCircle;
+   double latitude;
+   double longitude;
+   double radiusInMeters;
+
+}geohash36_region_t;
+
+/*!
+************************************************************************************************************************
+* @brief Cover cell which can be split, and how many cells its split adds.
+************************************************************************************************************************
+**/
+typedef struct
+{
+   int position;
+   int numChildren;
+
+}geohash36_candidate_t;
+
+/***********************************************************************************************************************
+Internal functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Checks if the longitude range of a cell intersects/is inside the longitude range of a box.
+************************************************************************************************************************
+* @param [in] box_: box ("minLongitude" > "maxLongitude" crosses the antimeridian);
+* @param [in] cell_: boundaries of the cell;
+* @param [in] inside_: 0 to check intersection, 1 to check if the cell is inside the box.
+************************************************************************************************************************
+* @return 1 or 0.
+************************************************************************************************************************
+**/
+static int geohash36_cover_checkLongitude(const geohash36_bounds_t * box_, const geohash36_bounds_t * cell_,
+                                          int inside_)
+{
+   if (box_->minLongitude <= box_->maxLongitude)
+   {
+      if (inside_)
+         return (cell_->minLongitude >= box_->minLongitude) && (cell_->maxLongitude <= box_->maxLongitude);
+
+      return (cell_->minLongitude <= box_->maxLongitude) && (cell_->maxLongitude >= box_->minLongitude);
+   }
+
+   if (inside_)
+      return (cell_->minLongitude >= box_->minLongitude) || (cell_->maxLongitude <= box_->maxLongitude);
+
+   return (cell_->maxLongitude >= box_->minLongitude) || (cell_->minLongitude <= box_->maxLongitude);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Checks if a cell intersects the region.
+************************************************************************************************************************
+* @param [in] region_: region to be covered;
+* @param [in] cell_: boundaries of the cell.
+************************************************************************************************************************
+* @return 1 or 0.
+************************************************************************************************************************
+**/
+static int geohash36_cover_intersects(const geohash36_region_t * region_, const geohash36_bounds_t * cell_)
+{
+   if ((cell_->minLatitude > region_->box.maxLatitude) || (cell_->maxLatitude < region_->box.minLatitude) ||
+       (!geohash36_cover_checkLongitude(&region_->box, cell_, 0)))
+      return 0;
+
+   if (region_->isCircle)
+      return geohash36_getMinDistanceInMeters(region_->latitude, region_->longitude, cell_) <= region_->radiusInMeters;
+
+   return 1;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Checks if a cell is inside the region (no need to split it).
+************************************************************************************************************************
+* @param [in] region_: region to be covered;
+* @param [in] cell_: boundaries of the cell.
+************************************************************************************************************************
+* @return 1 or 0.
+************************************************************************************************************************
+**/
+static int geohash36_cover_isInside(const geohash36_region_t * region_, const geohash36_bounds_t * cell_)
+{
+   if (region_->isCircle)
+   {
+      // The farthest point of a small cell is one of its corners
+      return (geohash36_getDistanceInMeters(region_->latitude, region_->longitude, cell_->minLatitude,
+                                            cell_->minLongitude) <= region_->radiusInMeters) &&
+             (geohash36_getDistanceInMeters(region_->latitude, region_->longitude, cell_->minLatitude,
+                                            cell_->maxLongitude) <= region_->radiusInMeters) &&
+             (geohash36_getDistanceInMeters(region_->latitude, region_->longitude, cell_->maxLatitude,
+                                            cell_->minLongitude) <= region_->radiusInMeters) &&
+             (geohash36_getDistanceInMeters(region_->latitude, region_->longitude, cell_->maxLatitude,
+                                            cell_->maxLongitude) <= region_->radiusInMeters);
+   }
+
+   return (cell_->minLatitude >= region_->box.minLatitude) && (cell_->maxLatitude <= region_->box.maxLatitude) &&
+          geohash36_cover_checkLongitude(&region_->box, cell_, 1);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Counts the children of a cell which intersect the region (0 when the cell doesn't need to be split).
+************************************************************************************************************************
+* @param [in] region_: region to be covered;
+* @param [in] key_: key of the cell;
+* @param [in] maxCharacters_: maximum cell length.
+************************************************************************************************************************
+* @return Number of children.
+************************************************************************************************************************
+**/
+static int geohash36_cover_countChildren(const geohash36_region_t * region_, geohash36_key_t key_, int maxCharacters_)
+{
+   geohash36_cell_t cell, child;
+   geohash36_bounds_t bounds;
+   int count = 0;
+
+   geohash36_keyToCell(key_, &cell);
+   geohash36_getCellBounds(&cell, &bounds);
+
+   if ((cell.numCharacters >= maxCharacters_) || geohash36_cover_isInside(region_, &bounds))
+      return 0;
+
+   child.numCharacters = cell.numCharacters + 1;
+
+   for (int i = 0; i < (GEOHASH_MATRIX_SIDE * GEOHASH_MATRIX_SIDE); i++)
+   {
+      child.latIndex = (cell.latIndex * GEOHASH_MATRIX_SIDE) + (i / GEOHASH_MATRIX_SIDE);
+      child.lonIndex = (cell.lonIndex * GEOHASH_MATRIX_SIDE) + (i % GEOHASH_MATRIX_SIDE);
+      geohash36_getCellBounds(&child, &bounds);
+
+      count += geohash36_cover_intersects(region_, &bounds);
+   }
+
+   return count;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Replaces a cover cell by its children which intersect the region.
+************************************************************************************************************************
+* @param [in] region_: region to be covered;
+* @param [in/out] keys_: cover;
+* @param [in/out] numKeys_: number of cells in the cover;
+* @param [in] position_: position of the cell to be split.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_cover_split(const geohash36_region_t * region_, geohash36_key_t * keys_, int * numKeys_,
+                                  int position_)
+{
+   geohash36_cell_t cell, child;
+   geohash36_bounds_t bounds;
+   int first = 1;
+
+   geohash36_keyToCell(keys_[position_], &cell);
+   child.numCharacters = cell.numCharacters + 1;
+
+   for (int i = 0; i < (GEOHASH_MATRIX_SIDE * GEOHASH_MATRIX_SIDE); i++)
+   {
+      child.latIndex = (cell.latIndex * GEOHASH_MATRIX_SIDE) + (i / GEOHASH_MATRIX_SIDE);
+      child.lonIndex = (cell.lonIndex * GEOHASH_MATRIX_SIDE) + (i % GEOHASH_MATRIX_SIDE);
+      geohash36_getCellBounds(&child, &bounds);
+
+      if (!geohash36_cover_intersects(region_, &bounds))
+         continue;
+
+      // The first child takes the place of its parent, the others go to the end
+      if (first)
+         keys_[position_] = geohash36_cellToKey(&child);
+      else
+         keys_[(*numKeys_)++] = geohash36_cellToKey(&child);
+
+      first = 0;
+   }
+}
+
+/*!
+************************************************************************************************************************
+* @brief Writes the initial cover: cells of the longest length whose cells are bigger than the region box.
+************************************************************************************************************************
+* @param [in] region_: region to be covered;
+* @param [in] maxCharacters_: maximum cell length;
+* @param [out] keys_: array which will receive the cover;
+* @param [in] maxCells_: maximum number of cells.
+************************************************************************************************************************
+* @return Number of cells.
+************************************************************************************************************************
+**/
+static int geohash36_cover_start(const geohash36_region_t * region_, int maxCharacters_, geohash36_key_t * keys_,
+                                 int maxCells_)
+{
+   double height = region_->box.maxLatitude - region_->box.minLatitude;
+   double width = region_->box.maxLongitude - region_->box.minLongitude;
+   int numCharacters = 0;
+
+   width = (width < 0) ? (width + 360.0) : width;
+
+   while ((numCharacters < maxCharacters_) && ((180.0 / (double)geohash36_pow6[numCharacters + 1]) >= height) &&
+          ((360.0 / (double)geohash36_pow6[numCharacters + 1]) >= width))
+      numCharacters++;
+
+   // Cells are as big as the box, so it spans at most 2 x 2 of them
+   for (; numCharacters >= 0; numCharacters--)
+   {
+      geohash36_cell_t minCell, maxCell, cell;
+      geohash36_bounds_t bounds;
+      uint64_t numColumns;
+      int count = 0;
+
+      geohash36_encodeCell(region_->box.minLatitude, region_->box.minLongitude, numCharacters, &minCell);
+      geohash36_encodeCell(region_->box.maxLatitude, region_->box.maxLongitude, numCharacters, &maxCell);
+
+      numColumns = ((maxCell.lonIndex + geohash36_pow6[numCharacters] - minCell.lonIndex) %
+                    geohash36_pow6[numCharacters]) + 1;
+      cell.numCharacters = numCharacters;
+
+      for (cell.latIndex = minCell.latIndex; cell.latIndex <= maxCell.latIndex; cell.latIndex++)
+      {
+         for (uint64_t c = 0; c < numColumns; c++)
+         {
+            cell.lonIndex = (minCell.lonIndex + c) % geohash36_pow6[numCharacters];
+            geohash36_getCellBounds(&cell, &bounds);
+
+            if ((count < maxCells_) && geohash36_cover_intersects(region_, &bounds))
+               keys_[count] = geohash36_cellToKey(&cell);
+
+            count += geohash36_cover_intersects(region_, &bounds);
+         }
+      }
+
+      if ((count <= maxCells_) || (numCharacters == 0))
+         return MIN(count, maxCells_);
+   }
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Compares split candidates (fewer children first, then position for a stable order).
+************************************************************************************************************************
+**/
+static int geohash36_cover_compareCandidates(const void * a_, const void * b_)
+{
+   const geohash36_candidate_t * a = (const geohash36_candidate_t *)a_;
+   const geohash36_candidate_t * b = (const geohash36_candidate_t *)b_;
+
+   if (a->numChildren != b->numChildren)
+      return a->numChildren - b->numChildren;
+
+   return a->position - b->position;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Compares keys in ascending order.
+************************************************************************************************************************
+**/
+static int geohash36_cover_compareKeys(const void * a_, const void * b_)
+{
+   geohash36_key_t a = *(const geohash36_key_t *)a_, b = *(const geohash36_key_t *)b_;
+
+   return (a > b) - (a < b);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Covers a region (see geohash36_coverBounds).
+************************************************************************************************************************
+* @param [in] region_: region to be covered;
+* @param [in] maxCharacters_: maximum cell length;
+* @param [out] outKeys_: array which will receive the cover;
+* @param [in] maxCells_: maximum number of cells.
+************************************************************************************************************************
+* @return Number of cells, or -1 for allocation failure.
+************************************************************************************************************************
+**/
+static int geohash36_cover(const geohash36_region_t * region_, int maxCharacters_, geohash36_key_t * outKeys_,
+                           int maxCells_)
+{
+   geohash36_candidate_t * candidates;
+   int numKeys;
+
+   candidates = (geohash36_candidate_t *)malloc(sizeof(geohash36_candidate_t) * maxCells_);
+
+   if (candidates == NULL)
+      return -1;
+
+   numKeys = geohash36_cover_start(region_, maxCharacters_, outKeys_, maxCells_);
+
+   // Split level by level, so that the cells stay as even as possible
+   for (int level = 0; level < maxCharacters_; level++)
+   {
+      int numCandidates = 0;
+
+      for (int i = 0; i < numKeys; i++)
+      {
+         if (GEOHASH36_KEY_LENGTH(outKeys_[i]) != level)
+            continue;
+
+         candidates[numCandidates].position = i;
+         candidates[numCandidates].numChildren = geohash36_cover_countChildren(region_, outKeys_[i], maxCharacters_);
+
+         if (candidates[numCandidates].numChildren > 0)
+            numCandidates++;
+      }
+
+      qsort(candidates, numCandidates, sizeof(candidates[0]), geohash36_cover_compareCandidates);
+
+      for (int i = 0; i < numCandidates; i++)
+      {
+         if ((numKeys + candidates[i].numChildren - 1) <= maxCells_)
+            geohash36_cover_split(region_, outKeys_, &numKeys, candidates[i].position);
+      }
+   }
+
+   free(candidates);
+
+   qsort(outKeys_, numKeys, sizeof(outKeys_[0]), geohash36_cover_compareKeys);
+
+   return numKeys;
+}
+
+/***********************************************************************************************************************
+External functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Gets the great circle (haversine) distance between two positions.
+************************************************************************************************************************
+* @param [in] lat1_, lon1_: first position;
+* @param [in] lat2_, lon2_: second position.
+************************************************************************************************************************
+* @return Distance in meters.
+************************************************************************************************************************
+**/
+double geohash36_getDistanceInMeters(double lat1_, double lon1_, double lat2_, double lon2_)
+{
+   double sinLat = sin(GEOHASH36_RADIANS(lat2_ - lat1_) / 2);
+   double sinLon = sin(GEOHASH36_RADIANS(lon2_ - lon1_) / 2);
+   double a = (sinLat * sinLat) + (cos(GEOHASH36_RADIANS(lat1_)) * cos(GEOHASH36_RADIANS(lat2_)) * sinLon * sinLon);
+
+   a = (a < 1.0) ? a : 1.0;
+
+   return 2 * EARTH_RADIUS_IN_METERS * asin(sqrt(a));
+}
+
+/*!
+************************************************************************************************************************
+* @brief Gets the distance between a position and the closest point of a cell (0 when the position is inside it).
+************************************************************************************************************************
+* @param [in] latitude_, longitude_: position;
+* @param [in] bounds_: boundaries of the cell.
+************************************************************************************************************************
+* @return Distance in meters.
+************************************************************************************************************************
+**/
+double geohash36_getMinDistanceInMeters(double latitude_, double longitude_, const geohash36_bounds_t * bounds_)
+{
+   double closestLat = MIN(MAX(latitude_, bounds_->minLatitude), bounds_->maxLatitude);
+   double distance;
+
+   if ((longitude_ >= bounds_->minLongitude) && (longitude_ <= bounds_->maxLongitude))
+      return geohash36_getDistanceInMeters(latitude_, longitude_, closestLat, longitude_);
+
+   distance = -1;
+
+   // Otherwise the closest point is on one of the side meridians. Along a meridian the cosine of the distance is
+   // A sin(lat) + B cos(lat), which peaks at atan2(A, B): clamping that latitude to the side gives the closest point.
+   for (int side = 0; side < 2; side++)
+   {
+      double lon = side ? bounds_->maxLongitude : bounds_->minLongitude;
+      double peak = atan2(sin(GEOHASH36_RADIANS(latitude_)),
+                          cos(GEOHASH36_RADIANS(latitude_)) * cos(GEOHASH36_RADIANS(lon - longitude_)));
+      double lat = peak * (180.0 / 3.14159265358979323846);
+      double sideDistance;
+
+      lat = MIN(MAX(lat, bounds_->minLatitude), bounds_->maxLatitude);
+      sideDistance = geohash36_getDistanceInMeters(latitude_, longitude_, lat, lon);
+      distance = ((distance < 0) || (sideDistance < distance)) ? sideDistance : distance;
+   }
+
+   return distance;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Covers a latitude/longitude box with mixed length Geohash-36 cells.
+*
+* Starts from the longest length whose cells are bigger than the box and splits the cells which cut the box (those with
+* fewer intersecting children first) while the cover fits in "maxCells_". Every key "k" of the result is the prefix
+* range [k, geohash36_keyRangeEnd(k)], and the keys come sorted.
+************************************************************************************************************************
+* @param [in] bounds_: box to be covered ("minLongitude" > "maxLongitude" crosses the antimeridian);
+* @param [in] maxCharacters_: maximum cell length (1 to GEOHASH36_KEY_MAX_CHARACTERS);
+* @param [out] outKeys_: array of "maxCells_" keys which will receive the cover;
+* @param [in] maxCells_: maximum number of cells.
+************************************************************************************************************************
+* @return Number of cells, or -1 for invalid input/allocation failure.
+************************************************************************************************************************
+**/
+int geohash36_coverBounds(const geohash36_bounds_t * bounds_, int maxCharacters_, geohash36_key_t * outKeys_,
+                          int maxCells_)
+{
+   geohash36_region_t region;
+
+   if ((bounds_ == NULL) || (outKeys_ == NULL) || (maxCells_ < 1) || (maxCharacters_ < 1) ||
+       (maxCharacters_ > GEOHASH36_KEY_MAX_CHARACTERS) || !(bounds_->minLatitude <= bounds_->maxLatitude) ||
+       !(bounds_->minLongitude >= -180.0) || !(bounds_->maxLongitude <= 180.0))
+      return -1;
+
+   region.box = (*bounds_);
+   region.box.minLatitude = MAX(region.box.minLatitude, -90.0);
+   region.box.maxLatitude = MIN(region.box.maxLatitude, 90.0);
+   region.isCircle = 0;
+
+   return geohash36_cover(&region, maxCharacters_, outKeys_, maxCells_);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Covers every position within a distance of a center with mixed length Geohash-36 cells.
+*
+* See geohash36_coverBounds.
+************************************************************************************************************************
+* @param [in] latitude_, longitude_: center of the region;
+* @param [in] radiusInMeters_: radius of the region;
+* @param [in] maxCharacters_: maximum cell length (1 to GEOHASH36_KEY_MAX_CHARACTERS);
+* @param [out] outKeys_: array of "maxCells_" keys which will receive the cover;
+* @param [in] maxCells_: maximum number of cells.
+************************************************************************************************************************
+* @return Number of cells, or -1 for invalid input/allocation failure.
+************************************************************************************************************************
+**/
+int geohash36_coverRadius(double latitude_, double longitude_, double radiusInMeters_, int maxCharacters_,
+                          geohash36_key_t * outKeys_, int maxCells_)
+{
+   geohash36_region_t region;
+   double latPrec, lonPrec, latDegrees, lonDegrees;
+
+   if ((outKeys_ == NULL) || (maxCells_ < 1) || (maxCharacters_ < 1) ||
+       (maxCharacters_ > GEOHASH36_KEY_MAX_CHARACTERS) || !(latitude_ >= -90.0) || !(latitude_ <= 90.0) ||
+       !(longitude_ >= -180.0) || !(longitude_ <= 180.0) || !(radiusInMeters_ >= 0))
+      return -1;
+
+   // A zero length cell is 90 degrees away from its center in latitude. The box is only a filter before the exact
+   // distance test, so it is widened a bit: getPrecisionInMeters rounds PI to single precision.
+   geohash36_getPrecisionInMeters(0, &latPrec, &lonPrec);
+   latDegrees = (radiusInMeters_ / (latPrec / 90.0)) * 1.000001;
+
+   region.isCircle = 1;
+   region.latitude = latitude_;
+   region.longitude = longitude_;
+   region.radiusInMeters = radiusInMeters_;
+   region.box.minLatitude = MAX(latitude_ - latDegrees, -90.0);
+   region.box.maxLatitude = MIN(latitude_ + latDegrees, 90.0);
+   region.box.minLongitude = -180.0;
+   region.box.maxLongitude = 180.0;
+
+   // Longitude extent of a spherical cap (the whole circle of latitudes when it reaches a pole)
+   if ((region.box.minLatitude > -90.0) && (region.box.maxLatitude < 90.0))
+   {
+      double ratio = sin(radiusInMeters_ / EARTH_RADIUS_IN_METERS) / cos(GEOHASH36_RADIANS(latitude_));
+
+      lonDegrees = (ratio < 1.0) ? (asin(ratio) * (180.0 / 3.14159265358979323846)) : 180.0;
+
+      if (lonDegrees < 180.0)
+      {
+         region.box.minLongitude = longitude_ - lonDegrees;
+         region.box.maxLongitude = longitude_ + lonDegrees;
+         region.box.minLongitude += (region.box.minLongitude < -180.0) ? 360.0 : 0.0;
+         region.box.maxLongitude -= (region.box.maxLongitude > 180.0) ? 360.0 : 0.0;
+      }
+   }
+
+   return geohash36_cover(&region, maxCharacters_, outKeys_, maxCells_);
+}
@@ -0,0 +1,74 @@
+#ifndef _GEOHASH36_COVER_H_
+#define _GEOHASH36_COVER_H_
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "geohash36.h"
+
+/***********************************************************************************************************************
+Exported functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Gets the great circle (haversine) distance between two positions.
+************************************************************************************************************************
+* @param [in] lat1_, lon1_: first position;
+* @param [in] lat2_, lon2_: second position.
+************************************************************************************************************************
+* @return Distance in meters.
+************************************************************************************************************************
+**/
+double geohash36_getDistanceInMeters(double lat1_, double lon1_, double lat2_, double lon2_);
+
+/*!
+************************************************************************************************************************
+* @brief Gets the distance between a position and the closest point of a cell (0 when the position is inside it).
+************************************************************************************************************************
+* @param [in] latitude_, longitude_: position;
+* @param [in] bounds_: boundaries of the cell.
+************************************************************************************************************************
+* @return Distance in meters.
+************************************************************************************************************************
+**/
+double geohash36_getMinDistanceInMeters(double latitude_, double longitude_, const geohash36_bounds_t * bounds_);
+
+/*!
+************************************************************************************************************************
+* @brief Covers a latitude/longitude box with mixed length Geohash-36 cells.
+*
+* Starts from the longest length whose cells are bigger than the box and splits the cells which cut the box (those with
+* fewer intersecting children first) while the cover fits in "maxCells_". Every key "k" of the result is the prefix
+* range [k, geohash36_keyRangeEnd(k)], and the keys come sorted.
+************************************************************************************************************************
+* @param [in] bounds_: box to be covered ("minLongitude" > "maxLongitude" crosses the antimeridian);
+* @param [in] maxCharacters_: maximum cell length (1 to GEOHASH36_KEY_MAX_CHARACTERS);
+* @param [out] outKeys_: array of "maxCells_" keys which will receive the cover;
+* @param [in] maxCells_: maximum number of cells.
+************************************************************************************************************************
+* @return Number of cells, or -1 for invalid input/allocation failure.
+************************************************************************************************************************
+**/
+int geohash36_coverBounds(const geohash36_bounds_t * bounds_, int maxCharacters_, geohash36_key_t * outKeys_,
+                          int maxCells_);
+
+/*!
+************************************************************************************************************************
+* @brief Covers every position within a distance of a center with mixed length Geohash-36 cells.
+*
+* See geohash36_coverBounds.
+************************************************************************************************************************
+* @param [in] latitude_, longitude_: center of the region;
+* @param [in] radiusInMeters_: radius of the region;
+* @param [in] maxCharacters_: maximum cell length (1 to GEOHASH36_KEY_MAX_CHARACTERS);
+* @param [out] outKeys_: array of "maxCells_" keys which will receive the cover;
+* @param [in] maxCells_: maximum number of cells.
+************************************************************************************************************************
+* @return Number of cells, or -1 for invalid input/allocation failure.
+************************************************************************************************************************
+**/
+int geohash36_coverRadius(double latitude_, double longitude_, double radiusInMeters_, int maxCharacters_,
+                          geohash36_key_t * outKeys_, int maxCells_);
+
+#endif // _GEOHASH36_COVER_H_
@@ -0,0 +1,500 @@
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "geohash36_file.h"
+
+/***********************************************************************************************************************
+Defines/macros
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Size of the header fields (the rest of the header page is zero).
+************************************************************************************************************************
+**/
+#define GEOHASH36_FILE_HEADER_SIZE           64
+
+/*!
+************************************************************************************************************************
+* @brief Number of entries per fence (one fence per page of entries).
+************************************************************************************************************************
+**/
+#define GEOHASH36_FILE_FENCE_INTERVAL        (GEOHASH36_FILE_PAGE_SIZE / 16)
+
+/*!
+************************************************************************************************************************
+* @brief Number of entries converted per write.
+************************************************************************************************************************
+**/
+#define GEOHASH36_FILE_WRITE_BLOCK           4096
+
+/*!
+************************************************************************************************************************
+* @brief Rounds a size up to the page size.
+************************************************************************************************************************
+**/
+#define GEOHASH36_FILE_ALIGN(size)           ((((size) + GEOHASH36_FILE_PAGE_SIZE - 1) / GEOHASH36_FILE_PAGE_SIZE) * \
+                                              GEOHASH36_FILE_PAGE_SIZE)
+
+/***********************************************************************************************************************
+Typedefs/structs/unions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Header fields (little-endian in the file).
+************************************************************************************************************************
+**/
+typedef struct
+{
+   char magic[8];
+   uint32_t version;
+   uint32_t pageSize;
+   uint64_t numEntries;
+   uint64_t entriesOffset;
+   uint64_t numFences;
+   uint64_t fencesOffset;
+   uint32_t fenceInterval;
+   uint32_t entrySize;
+   uint64_t fileSize;
+
+}geohash36_file_header_t;
+
+/***********************************************************************************************************************
+Internal functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Checks if the host is little-endian (the layout of the file is then the layout of the structures).
+************************************************************************************************************************
+* @return 1 or 0.
+************************************************************************************************************************
+**/
+static int geohash36_file_isLittleEndian(void)
+{
+   const uint16_t value = 1;
+
+   return (*(const uint8_t *)&value) == 1;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Stores a 32 bits little-endian integer.
+************************************************************************************************************************
+* @param [out] out_: destination;
+* @param [in] value_: value.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_file_store32(uint8_t * out_, uint32_t value_)
+{
+   int i;
+
+   for (i = 0; i < 4; i++)
+      out_[i] = (uint8_t)(value_ >> (8 * i));
+}
+
+/*!
+************************************************************************************************************************
+* @brief Stores a 64 bits little-endian integer.
+************************************************************************************************************************
+* @param [out] out_: destination;
+* @param [in] value_: value.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_file_store64(uint8_t * out_, uint64_t value_)
+{
+   int i;
+
+   for (i = 0; i < 8; i++)
+      out_[i] = (uint8_t)(value_ >> (8 * i));
+}
+
+/*!
+************************************************************************************************************************
+* @brief Writes zeros up to an offset.
+************************************************************************************************************************
+* @param [in] file_: destination;
+* @param [in] from_: current offset;
+* @param [in] to_: desired offset.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - I/O error.
+************************************************************************************************************************
+**/
+static int geohash36_file_pad(FILE * file_, uint64_t from_, uint64_t to_)
+{
+   static const uint8_t zeros[GEOHASH36_FILE_PAGE_SIZE];
+   size_t size;
+
+   while (from_ < to_)
+   {
+      size = (size_t)MIN(to_ - from_, (uint64_t)GEOHASH36_FILE_PAGE_SIZE);
+
+      if (fwrite(zeros, 1, size, file_) != size)
+         return -1;
+
+      from_ += size;
+   }
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Writes the sections of an index file.
+************************************************************************************************************************
+* @param [in] file_: destination;
+* @param [in] entries_: entries sorted by key;
+* @param [in] n_: number of entries.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Allocation failure or I/O error.
+************************************************************************************************************************
+**/
+static int geohash36_file_writeSections(FILE * file_, const geohash36_entry_t * entries_, size_t n_)
+{
+   uint8_t header[GEOHASH36_FILE_HEADER_SIZE];
+   uint8_t * buffer;
+   uint64_t numFences = (n_ + GEOHASH36_FILE_FENCE_INTERVAL - 1) / GEOHASH36_FILE_FENCE_INTERVAL;
+   uint64_t fencesOffset = GEOHASH36_FILE_PAGE_SIZE;
+   uint64_t entriesOffset = GEOHASH36_FILE_ALIGN(fencesOffset + (numFences * 8));
+   uint64_t fileSize = GEOHASH36_FILE_ALIGN(entriesOffset + ((uint64_t)n_ * 16));
+   size_t i, j, count;
+   int result = 0;
+
+   memset(header, 0, sizeof(header));
+   memcpy(header, GEOHASH36_FILE_MAGIC, sizeof(GEOHASH36_FILE_MAGIC));
+   geohash36_file_store32(header + 8, GEOHASH36_FILE_VERSION);
+   geohash36_file_store32(header + 12, GEOHASH36_FILE_PAGE_SIZE);
+   geohash36_file_store64(header + 16, n_);
+   geohash36_file_store64(header + 24, entriesOffset);
+   geohash36_file_store64(header + 32, numFences);
+   geohash36_file_store64(header + 40, fencesOffset);
+   geohash36_file_store32(header + 48, GEOHASH36_FILE_FENCE_INTERVAL);
+   geohash36_file_store32(header + 52, 16);
+   geohash36_file_store64(header + 56, fileSize);
+
+   if ((fwrite(header, 1, sizeof(header), file_) != sizeof(header)) ||
+       (geohash36_file_pad(file_, sizeof(header), fencesOffset) != 0))
+      return -1;
+
+   buffer = malloc(GEOHASH36_FILE_WRITE_BLOCK * 16);
+   if (buffer == NULL)
+      return -1;
+
+   for (i = 0; (i < numFences) && (result == 0); i += count)
+   {
+      count = (size_t)MIN(numFences - i, (uint64_t)GEOHASH36_FILE_WRITE_BLOCK);
+
+      for (j = 0; j < count; j++)
+         geohash36_file_store64(buffer + (j * 8), entries_[(i + j) * GEOHASH36_FILE_FENCE_INTERVAL].key);
+
+      if (fwrite(buffer, 8, count, file_) != count)
+         result = -1;
+   }
+
+   if ((result == 0) && (geohash36_file_pad(file_, fencesOffset + (numFences * 8), entriesOffset) != 0))
+      result = -1;
+
+   for (i = 0; (i < n_) && (result == 0); i += count)
+   {
+      count = MIN(n_ - i, (size_t)GEOHASH36_FILE_WRITE_BLOCK);
+
+      for (j = 0; j < count; j++)
+      {
+         geohash36_file_store64(buffer + (j * 16), entries_[i + j].key);
+         geohash36_file_store64(buffer + (j * 16) + 8, entries_[i + j].id);
+      }
+
+      if (fwrite(buffer, 16, count, file_) != count)
+         result = -1;
+   }
+
+   free(buffer);
+
+   if ((result == 0) && (geohash36_file_pad(file_, entriesOffset + ((uint64_t)n_ * 16), fileSize) != 0))
+      result = -1;
+
+   return result;
+}
+
+/***********************************************************************************************************************
+External functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Writes an index file from entries sorted by key. The file is written next to "path_" and renamed, so processes
+*        which have the old file opened keep a valid mapping.
+************************************************************************************************************************
+* @param [in] path_: path of the file;
+* @param [in] entries_: entries sorted by key;
+* @param [in] n_: number of entries.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input (e.g. unsorted entries) or I/O error.
+************************************************************************************************************************
+**/
+int geohash36_file_write(const char * path_, const geohash36_entry_t * entries_, size_t n_)
+{
+   FILE * file;
+   char * temporaryPath;
+   size_t i;
+   int result;
+
+   if ((path_ == NULL) || ((n_ > 0) && (entries_ == NULL)))
+      return -1;
+
+   for (i = 1; i < n_; i++)
+   {
+      if (entries_[i].key < entries_[i - 1].key)
+         return -1;
+   }
+
+   temporaryPath = malloc(strlen(path_) + sizeof(".tmp"));
+   if (temporaryPath == NULL)
+      return -1;
+
+   strcpy(temporaryPath, path_);
+   strcat(temporaryPath, ".tmp");
+
+   file = fopen(temporaryPath, "wb");
+   if (file == NULL)
+   {
+      free(temporaryPath);
+      return -1;
+   }
+
+   result = geohash36_file_writeSections(file, entries_, n_);
+
+   if ((fflush(file) != 0) || (fsync(fileno(file)) != 0))
+      result = -1;
+
+   if (fclose(file) != 0)
+      result = -1;
+
+   if ((result == 0) && (rename(temporaryPath, path_) != 0))
+      result = -1;
+
+   if (result != 0)
+      remove(temporaryPath);
+
+   free(temporaryPath);
+   return result;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Writes an index file with every entry of an index (flushing it first).
+************************************************************************************************************************
+* @param [in] path_: path of the file;
+* @param [in] index_: pointer to the index.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input, allocation failure or I/O error.
+************************************************************************************************************************
+**/
+int geohash36_file_writeIndex(const char * path_, geohash36_index_t * index_)
+{
+   if (geohash36_index_flush(index_) != 0)
+      return -1;
+
+   return geohash36_file_write(path_, index_->entries, index_->numEntries);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Opens an index file with mmap (read only). Only the header is checked, so the time does not depend on the
+*        number of entries.
+************************************************************************************************************************
+* @param [out] file_: pointer to the opened file;
+* @param [in] path_: path of the file.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input, I/O error, invalid file or big-endian host.
+************************************************************************************************************************
+**/
+int geohash36_file_open(geohash36_file_t * file_, const char * path_)
+{
+   geohash36_file_header_t header;
+   struct stat status;
+   void * mapping;
+   int descriptor;
+
+   if ((file_ == NULL) || (path_ == NULL) || !geohash36_file_isLittleEndian())
+      return -1;
+
+   memset(file_, 0, sizeof(geohash36_file_t));
+
+   descriptor = open(path_, O_RDONLY);
+   if (descriptor < 0)
+      return -1;
+
+   if ((fstat(descriptor, &status) != 0) || (status.st_size < GEOHASH36_FILE_PAGE_SIZE))
+   {
+      close(descriptor);
+      return -1;
+   }
+
+   mapping = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_SHARED, descriptor, 0);
+   close(descriptor);
+
+   if (mapping == MAP_FAILED)
+      return -1;
+
+   memcpy(&header, mapping, sizeof(header));
+
+   if ((memcmp(header.magic, GEOHASH36_FILE_MAGIC, sizeof(GEOHASH36_FILE_MAGIC)) != 0) ||
+       (header.version != GEOHASH36_FILE_VERSION) || (header.pageSize != GEOHASH36_FILE_PAGE_SIZE) ||
+       (header.entrySize != sizeof(geohash36_entry_t)) || (header.fenceInterval == 0) ||
+       (header.fileSize != (uint64_t)status.st_size) ||
+       (header.numFences != (header.numEntries + header.fenceInterval - 1) / header.fenceInterval) ||
+       (header.fencesOffset % GEOHASH36_FILE_PAGE_SIZE) || (header.entriesOffset % GEOHASH36_FILE_PAGE_SIZE) ||
+       (header.fencesOffset > header.fileSize) || (header.entriesOffset > header.fileSize) ||
+       (header.numFences > (header.fileSize - header.fencesOffset) / 8) ||
+       (header.numEntries > (header.fileSize - header.entriesOffset) / sizeof(geohash36_entry_t)))
+   {
+      munmap(mapping, (size_t)status.st_size);
+      return -1;
+   }
+
+   file_->mapping = mapping;
+   file_->mappingSize = (size_t)status.st_size;
+   file_->entries = (const geohash36_entry_t *)((const uint8_t *)mapping + header.entriesOffset);
+   file_->numEntries = (size_t)header.numEntries;
+   file_->fences = (const geohash36_key_t *)((const uint8_t *)mapping + header.fencesOffset);
+   file_->numFences = (size_t)header.numFences;
+   file_->fenceInterval = header.fenceInterval;
+
+   // Fences are read by every lookup, entries only a page at a time
+   posix_madvise((void *)file_->fences, file_->numFences * sizeof(geohash36_key_t), POSIX_MADV_WILLNEED);
+   posix_madvise((void *)file_->entries, file_->numEntries * sizeof(geohash36_entry_t), POSIX_MADV_RANDOM);
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Unmaps an index file.
+************************************************************************************************************************
+* @param [in] file_: pointer to the opened file.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+void geohash36_file_close(geohash36_file_t * file_)
+{
+   if ((file_ == NULL) || (file_->mapping == NULL))
+      return;
+
+   munmap(file_->mapping, file_->mappingSize);
+   memset(file_, 0, sizeof(geohash36_file_t));
+}
+
+/*!
+************************************************************************************************************************
+* @brief Finds the first entry with key not lower than a value: binary search of the fences, then of a single page of
+*        entries.
+************************************************************************************************************************
+* @param [in] file_: pointer to the opened file;
+* @param [in] key_: desired key.
+************************************************************************************************************************
+* @return Position of the entry ("numEntries" if every key is lower).
+************************************************************************************************************************
+**/
+size_t geohash36_file_lowerBound(const geohash36_file_t * file_, geohash36_key_t key_)
+{
+   size_t first = 0;
+   size_t count, half, last;
+
+   if (file_ == NULL)
+      return 0;
+
+   // First fence not lower than the key: the answer is after the previous fence and up to this one
+   for (count = file_->numFences; count > 0;)
+   {
+      half = count / 2;
+
+      if (file_->fences[first + half] < key_)
+      {
+         first += half + 1;
+         count -= half + 1;
+      }
+      else
+         count = half;
+   }
+
+   if (first == 0)
+      return 0;
+
+   last = MIN(first * file_->fenceInterval, file_->numEntries);
+   first = ((first - 1) * file_->fenceInterval) + 1;
+
+   for (count = last - first; count > 0;)
+   {
+      half = count / 2;
+
+      if (file_->entries[first + half].key < key_)
+      {
+         first += half + 1;
+         count -= half + 1;
+      }
+      else
+         count = half;
+   }
+
+   return first;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Visits every entry whose key starts with a prefix, in key order.
+************************************************************************************************************************
+* @param [in] file_: pointer to the opened file;
+* @param [in] prefix_: key of the prefix;
+* @param [in] callback_: function called for each entry found;
+* @param [in] context_: pointer given to the callback.
+************************************************************************************************************************
+* @return Number of entries visited.
+************************************************************************************************************************
+**/
+size_t geohash36_file_queryPrefix(const geohash36_file_t * file_, geohash36_key_t prefix_,
+                                  geohash36_index_callback_t callback_, void * context_)
+{
+   geohash36_key_t last;
+   size_t i, visited = 0;
+
+   if ((file_ == NULL) || !geohash36_keyIsValid(prefix_))
+      return 0;
+
+   last = geohash36_keyRangeEnd(prefix_);
+
+   for (i = geohash36_file_lowerBound(file_, prefix_); (i < file_->numEntries) && (file_->entries[i].key <= last); i++)
+   {
+      visited++;
+
+      if ((callback_ != NULL) && callback_(&file_->entries[i], context_))
+         break;
+   }
+
+   return visited;
+}
@@ -0,0 +1,156 @@
+#ifndef _GEOHASH36_FILE_H_
+#define _GEOHASH36_FILE_H_
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "stddef.h"
+#include "geohash36.h"
+#include "geohash36_index.h"
+
+/***********************************************************************************************************************
+Defines/macros
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Magic number at the start of index files.
+************************************************************************************************************************
+**/
+#define GEOHASH36_FILE_MAGIC                 "GH36IDX"
+
+/*!
+************************************************************************************************************************
+* @brief Version of the index file format.
+************************************************************************************************************************
+**/
+#define GEOHASH36_FILE_VERSION               1
+
+/*!
+************************************************************************************************************************
+* @brief Alignment of the sections of index files.
+************************************************************************************************************************
+**/
+#define GEOHASH36_FILE_PAGE_SIZE             4096
+
+/***********************************************************************************************************************
+Typedefs/structs/unions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Index file opened with mmap.
+*
+* File layout (every integer little-endian, every section aligned to GEOHASH36_FILE_PAGE_SIZE):
+* - Header page: magic (8 bytes), version (u32), page size (u32), number of entries (u64), offset of the entries (u64),
+*   number of fences (u64), offset of the fences (u64), entries per fence (u32), entry size (u32), file size (u64);
+* - Fences: key of every "fenceInterval"-th entry (one per page of entries), searched before touching the entries;
+* - Entries: geohash36_entry_t array sorted by key.
+*
+* Opening only checks the header: entries and fences are used straight from the mapping, which the page cache shares
+* between every process that opens the same file.
+************************************************************************************************************************
+**/
+typedef struct
+{
+   const geohash36_entry_t * entries;
+   size_t numEntries;
+
+   const geohash36_key_t * fences;
+   size_t numFences;
+   size_t fenceInterval;
+
+   void * mapping;
+   size_t mappingSize;
+
+}geohash36_file_t;
+
+/***********************************************************************************************************************
+Exported functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Writes an index file from entries sorted by key. The file is written next to "path_" and renamed, so processes
+*        which have the old file opened keep a valid mapping.
+************************************************************************************************************************
+* @param [in] path_: path of the file;
+* @param [in] entries_: entries sorted by key;
+* @param [in] n_: number of entries.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input (e.g. unsorted entries) or I/O error.
+************************************************************************************************************************
+**/
+int geohash36_file_write(const char * path_, const geohash36_entry_t * entries_, size_t n_);
+
+/*!
+************************************************************************************************************************
+* @brief Writes an index file with every entry of an index (flushing it first).
+************************************************************************************************************************
+* @param [in] path_: path of the file;
+* @param [in] index_: pointer to the index.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input, allocation failure or I/O error.
+************************************************************************************************************************
+**/
+int geohash36_file_writeIndex(const char * path_, geohash36_index_t * index_);
+
+/*!
+************************************************************************************************************************
+* @brief Opens an index file with mmap (read only). Only the header is checked, so the time does not depend on the
+*        number of entries.
+************************************************************************************************************************
+* @param [out] file_: pointer to the opened file;
+* @param [in] path_: path of the file.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input, I/O error, invalid file or big-endian host.
+************************************************************************************************************************
+**/
+int geohash36_file_open(geohash36_file_t * file_, const char * path_);
+
+/*!
+************************************************************************************************************************
+* @brief Unmaps an index file.
+************************************************************************************************************************
+* @param [in] file_: pointer to the opened file.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+void geohash36_file_close(geohash36_file_t * file_);
+
+/*!
+************************************************************************************************************************
+* @brief Finds the first entry with key not lower than a value: binary search of the fences, then of a single page of
+*        entries.
+************************************************************************************************************************
+* @param [in] file_: pointer to the opened file;
+* @param [in] key_: desired key.
+************************************************************************************************************************
+* @return Position of the entry ("numEntries" if every key is lower).
+************************************************************************************************************************
+**/
+size_t geohash36_file_lowerBound(const geohash36_file_t * file_, geohash36_key_t key_);
+
+/*!
+************************************************************************************************************************
+* @brief Visits every entry whose key starts with a prefix, in key order.
+************************************************************************************************************************
+* @param [in] file_: pointer to the opened file;
+* @param [in] prefix_: key of the prefix;
+* @param [in] callback_: function called for each entry found;
+* @param [in] context_: pointer given to the callback.
+************************************************************************************************************************
+* @return Number of entries visited.
+************************************************************************************************************************
+**/
+size_t geohash36_file_queryPrefix(const geohash36_file_t * file_, geohash36_key_t prefix_,
+                                  geohash36_index_callback_t callback_, void * context_);
+
+#endif // _GEOHASH36_FILE_H_
@@ -0,0 +1,328 @@
+#ifndef _GEOHASH36_FIXED_H_
+#define _GEOHASH36_FIXED_H_
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "geohash36.h"
+
+/***********************************************************************************************************************
+Defines/macros
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Side of the character matrix and layout of a packed key (same values as geohash36_internal.h, which is not
+*        part of the public headers).
+************************************************************************************************************************
+**/
+#define GEOHASH36_FIXED_SIDE                 6
+#define GEOHASH36_FIXED_KEY_CHAR_BITS        6
+#define GEOHASH36_FIXED_KEY_FIRST_CHAR_SHIFT 58
+#define GEOHASH36_FIXED_KEY_CHAR_MASK        0x3FULL
+
+/*!
+************************************************************************************************************************
+* @brief 6^n as a constant expression, for n from 0 to GEOHASH36_MAX_CELL_CHARACTERS (0 otherwise).
+************************************************************************************************************************
+**/
+#define GEOHASH36_POW6(n)                                                                                              \
+   ((n) == 0 ? 1ULL : (n) == 1 ? 6ULL : (n) == 2 ? 36ULL : (n) == 3 ? 216ULL : (n) == 4 ? 1296ULL :                    \
+    (n) == 5 ? 7776ULL : (n) == 6 ? 46656ULL : (n) == 7 ? 279936ULL : (n) == 8 ? 1679616ULL :                          \
+    (n) == 9 ? 10077696ULL : (n) == 10 ? 60466176ULL : (n) == 11 ? 362797056ULL : (n) == 12 ? 2176782336ULL :          \
+    (n) == 13 ? 13060694016ULL : (n) == 14 ? 78364164096ULL : (n) == 15 ? 470184984576ULL :                            \
+    (n) == 16 ? 2821109907456ULL : (n) == 17 ? 16926659444736ULL : (n) == 18 ? 101559956668416ULL :                    \
+    (n) == 19 ? 609359740010496ULL : (n) == 20 ? 3656158440062976ULL : 0ULL)
+
+/*!
+************************************************************************************************************************
+* @brief Repeats "m(n, i)" for i from 0 to n - 1 (n being a literal from 1 to GEOHASH36_MAX_CELL_CHARACTERS).
+************************************************************************************************************************
+**/
+#define GEOHASH36_FIXED_REPEAT(n, m)         GEOHASH36_FIXED_REPEAT_##n(n, m)
+#define GEOHASH36_FIXED_REPEAT_1(n, m)       m(n, 0)
+#define GEOHASH36_FIXED_REPEAT_2(n, m)       GEOHASH36_FIXED_REPEAT_1(n, m) m(n, 1)
+#define GEOHASH36_FIXED_REPEAT_3(n, m)       GEOHASH36_FIXED_REPEAT_2(n, m) m(n, 2)
+#define GEOHASH36_FIXED_REPEAT_4(n, m)       GEOHASH36_FIXED_REPEAT_3(n, m) m(n, 3)
+#define GEOHASH36_FIXED_REPEAT_5(n, m)       GEOHASH36_FIXED_REPEAT_4(n, m) m(n, 4)
+#define GEOHASH36_FIXED_REPEAT_6(n, m)       GEOHASH36_FIXED_REPEAT_5(n, m) m(n, 5)
+#define GEOHASH36_FIXED_REPEAT_7(n, m)       GEOHASH36_FIXED_REPEAT_6(n, m) m(n, 6)
+#define GEOHASH36_FIXED_REPEAT_8(n, m)       GEOHASH36_FIXED_REPEAT_7(n, m) m(n, 7)
+#define GEOHASH36_FIXED_REPEAT_9(n, m)       GEOHASH36_FIXED_REPEAT_8(n, m) m(n, 8)
+#define GEOHASH36_FIXED_REPEAT_10(n, m)      GEOHASH36_FIXED_REPEAT_9(n, m) m(n, 9)
+#define GEOHASH36_FIXED_REPEAT_11(n, m)      GEOHASH36_FIXED_REPEAT_10(n, m) m(n, 10)
+#define GEOHASH36_FIXED_REPEAT_12(n, m)      GEOHASH36_FIXED_REPEAT_11(n, m) m(n, 11)
+#define GEOHASH36_FIXED_REPEAT_13(n, m)      GEOHASH36_FIXED_REPEAT_12(n, m) m(n, 12)
+#define GEOHASH36_FIXED_REPEAT_14(n, m)      GEOHASH36_FIXED_REPEAT_13(n, m) m(n, 13)
+#define GEOHASH36_FIXED_REPEAT_15(n, m)      GEOHASH36_FIXED_REPEAT_14(n, m) m(n, 14)
+#define GEOHASH36_FIXED_REPEAT_16(n, m)      GEOHASH36_FIXED_REPEAT_15(n, m) m(n, 15)
+#define GEOHASH36_FIXED_REPEAT_17(n, m)      GEOHASH36_FIXED_REPEAT_16(n, m) m(n, 16)
+#define GEOHASH36_FIXED_REPEAT_18(n, m)      GEOHASH36_FIXED_REPEAT_17(n, m) m(n, 17)
+#define GEOHASH36_FIXED_REPEAT_19(n, m)      GEOHASH36_FIXED_REPEAT_18(n, m) m(n, 18)
+#define GEOHASH36_FIXED_REPEAT_20(n, m)      GEOHASH36_FIXED_REPEAT_19(n, m) m(n, 19)
+
+/*!
+************************************************************************************************************************
+* @brief Fixed point digit extraction, for up to GEOHASH36_FIXED_FRACTION_MAX_CHARACTERS characters.
+*
+* index * ceil(2^57 / 6^n) is the position of the index in its axis as a 57 bits fraction. Multiplying it by 6 moves
+* the next digit above bit 57. The rounding error stays below one unit of the last digit while 6^(2n) < 2^57, so the
+* digits are exact, without any division. Longer hashes divide by the digit weights.
+************************************************************************************************************************
+**/
+#define GEOHASH36_FIXED_FRACTION_BITS        57
+#define GEOHASH36_FIXED_FRACTION_MAX_CHARACTERS 11
+#define GEOHASH36_FIXED_FRACTION_MASK        ((1ULL << GEOHASH36_FIXED_FRACTION_BITS) - 1)
+#define GEOHASH36_FIXED_FRACTION_SCALE(n)                                                                              \
+   (((1ULL << GEOHASH36_FIXED_FRACTION_BITS) + GEOHASH36_POW6(n) - 1) / GEOHASH36_POW6(n))
+
+/*!
+************************************************************************************************************************
+* @brief Base-6 digit "i" (0 = most significant) of an index of a length "n" grid, by division.
+************************************************************************************************************************
+**/
+#define GEOHASH36_FIXED_DIGIT(index, n, i)   (((index) / GEOHASH36_POW6((n) - 1 - (i))) % GEOHASH36_FIXED_SIDE)
+
+/*!
+************************************************************************************************************************
+* @brief Steps of the fixed length functions, for character "i" of a length "n" hash/key.
+************************************************************************************************************************
+**/
+#define GEOHASH36_FIXED_ENCODE_STEP(n, i)                                                                              \
+   latFraction *= GEOHASH36_FIXED_SIDE;                                                                                \
+   lonFraction *= GEOHASH36_FIXED_SIDE;                                                                                \
+   outBuffer_[i] = geohash36_fixed_chars[GEOHASH36_FIXED_SIDE - 1 - (latFraction >> GEOHASH36_FIXED_FRACTION_BITS)]    \
+                                        [lonFraction >> GEOHASH36_FIXED_FRACTION_BITS];                                \
+   latFraction &= GEOHASH36_FIXED_FRACTION_MASK;                                                                       \
+   lonFraction &= GEOHASH36_FIXED_FRACTION_MASK;
+
+#define GEOHASH36_FIXED_ENCODE_DIVIDE_STEP(n, i)                                                                       \
+   outBuffer_[i] = geohash36_fixed_chars[GEOHASH36_FIXED_SIDE - 1 - GEOHASH36_FIXED_DIGIT(latIndex, n, i)]             \
+                                        [GEOHASH36_FIXED_DIGIT(lonIndex, n, i)];
+
+#define GEOHASH36_FIXED_DECODE_STEP(n, i)                                                                              \
+   index = geohash36_fixed_index[(uint8_t)buffer_[i]];                                                                 \
+   invalid |= index;                                                                                                   \
+   latIndex += (uint64_t)(GEOHASH36_FIXED_SIDE - 1 - (index >> 4)) * GEOHASH36_POW6((n) - 1 - (i));                    \
+   lonIndex += (uint64_t)(index & 0x0F) * GEOHASH36_POW6((n) - 1 - (i));
+
+#define GEOHASH36_FIXED_ENCODE_KEY_STEP(n, i)                                                                          \
+   latFraction *= GEOHASH36_FIXED_SIDE;                                                                                \
+   lonFraction *= GEOHASH36_FIXED_SIDE;                                                                                \
+   key |= (geohash36_key_t)geohash36_fixed_rank[((GEOHASH36_FIXED_SIDE - 1 -                                           \
+                                                  (latFraction >> GEOHASH36_FIXED_FRACTION_BITS)) *                    \
+                                                 GEOHASH36_FIXED_SIDE) +                                               \
+                                                (lonFraction >> GEOHASH36_FIXED_FRACTION_BITS)]                        \
+          << (GEOHASH36_FIXED_KEY_FIRST_CHAR_SHIFT - ((i) * GEOHASH36_FIXED_KEY_CHAR_BITS));                           \
+   latFraction &= GEOHASH36_FIXED_FRACTION_MASK;                                                                       \
+   lonFraction &= GEOHASH36_FIXED_FRACTION_MASK;
+
+#define GEOHASH36_FIXED_DECODE_KEY_STEP(n, i)                                                                          \
+   rank = (uint8_t)((key_ >> (GEOHASH36_FIXED_KEY_FIRST_CHAR_SHIFT - ((i) * GEOHASH36_FIXED_KEY_CHAR_BITS))) &         \
+                    GEOHASH36_FIXED_KEY_CHAR_MASK);                                                                    \
+   invalid |= (rank >= (GEOHASH36_FIXED_SIDE * GEOHASH36_FIXED_SIDE));                                                 \
+   position = geohash36_fixed_rank_position[(rank < (GEOHASH36_FIXED_SIDE * GEOHASH36_FIXED_SIDE)) ? rank : 0];        \
+   latIndex += (uint64_t)(GEOHASH36_FIXED_SIDE - 1 - (position / GEOHASH36_FIXED_SIDE)) *                              \
+               GEOHASH36_POW6((n) - 1 - (i));                                                                          \
+   lonIndex += (uint64_t)(position % GEOHASH36_FIXED_SIDE) * GEOHASH36_POW6((n) - 1 - (i));
+
+/*!
+************************************************************************************************************************
+* @brief Defines geohash36_encode<n> and geohash36_decode<n>, fixed length versions of geohash36_encode and
+*        geohash36_decode (n from 1 to GEOHASH36_MAX_CELL_CHARACTERS, as a literal or a macro expanding to one).
+*
+* The grid size and digit weights are constant expressions and every character is handled by its own unrolled step, so
+* a call compiles to a few multiplications by constants. The position is multiplied by 6^n before the division by
+* 180/360, like the generic functions, so the results are the same (also on cell edges).
+************************************************************************************************************************
+**/
+#define GEOHASH36_FIXED_DEFINE(n)            GEOHASH36_FIXED_DEFINE_(n)
+
+#define GEOHASH36_FIXED_DEFINE_(n)                                                                                     \
+static inline int geohash36_encode##n(double latitude_, double longitude_, char * outBuffer_)                          \
+{                                                                                                                      \
+   if (outBuffer_ == NULL)                                                                                             \
+      return 0;                                                                                                        \
+                                                                                                                       \
+   uint64_t latIndex = geohash36_fixed_quantize(((latitude_ + 90.0) * (double)GEOHASH36_POW6(n)) / 180.0,              \
+                                                (double)GEOHASH36_POW6(n));                                            \
+   uint64_t lonIndex = geohash36_fixed_quantize(((longitude_ + 180.0) * (double)GEOHASH36_POW6(n)) / 360.0,            \
+                                                (double)GEOHASH36_POW6(n));                                            \
+                                                                                                                       \
+   if ((n) <= GEOHASH36_FIXED_FRACTION_MAX_CHARACTERS)                                                                 \
+   {                                                                                                                   \
+      uint64_t latFraction = latIndex * GEOHASH36_FIXED_FRACTION_SCALE(n);                                             \
+      uint64_t lonFraction = lonIndex * GEOHASH36_FIXED_FRACTION_SCALE(n);                                             \
+      GEOHASH36_FIXED_REPEAT(n, GEOHASH36_FIXED_ENCODE_STEP)                                                           \
+   }                                                                                                                   \
+   else                                                                                                                \
+   {                                                                                                                   \
+      GEOHASH36_FIXED_REPEAT(n, GEOHASH36_FIXED_ENCODE_DIVIDE_STEP)                                                    \
+   }                                                                                                                   \
+                                                                                                                       \
+   return (n);                                                                                                         \
+}                                                                                                                      \
+                                                                                                                       \
+static inline int geohash36_decode##n(const char * buffer_, double * outLatitude_, double * outLongitude_)             \
+{                                                                                                                      \
+   uint64_t latIndex = 0, lonIndex = 0;                                                                                \
+   uint8_t index, invalid = 0;                                                                                         \
+                                                                                                                       \
+   if ((buffer_ == NULL) || (outLatitude_ == NULL) || (outLongitude_ == NULL))                                         \
+      return -1;                                                                                                       \
+                                                                                                                       \
+   GEOHASH36_FIXED_REPEAT(n, GEOHASH36_FIXED_DECODE_STEP)                                                              \
+                                                                                                                       \
+   if (invalid & 0x80)                                                                                                 \
+      return -1;                                                                                                       \
+                                                                                                                       \
+   (*outLatitude_) = (-90.0 + ((double)latIndex * (180.0 / (double)GEOHASH36_POW6(n)))) +                              \
+                     ((180.0 / (double)GEOHASH36_POW6(n)) / 2);                                                        \
+   (*outLongitude_) = (-180.0 + ((double)lonIndex * (360.0 / (double)GEOHASH36_POW6(n)))) +                            \
+                      ((360.0 / (double)GEOHASH36_POW6(n)) / 2);                                                       \
+                                                                                                                       \
+   return 0;                                                                                                           \
+}
+
+/*!
+************************************************************************************************************************
+* @brief Defines geohash36_encodeKey<n> and geohash36_decodeKey<n>, fixed length versions of geohash36_encodeKey and
+*        geohash36_decodeKey (n from 1 to GEOHASH36_KEY_MAX_CHARACTERS, as a literal or a macro expanding to one).
+*
+* geohash36_decodeKey<n> only accepts keys of length n.
+************************************************************************************************************************
+**/
+#define GEOHASH36_FIXED_DEFINE_KEY(n)        GEOHASH36_FIXED_DEFINE_KEY_(n)
+
+#define GEOHASH36_FIXED_DEFINE_KEY_(n)                                                                                 \
+static inline geohash36_key_t geohash36_encodeKey##n(double latitude_, double longitude_)                              \
+{                                                                                                                      \
+   uint64_t latFraction = geohash36_fixed_quantize(((latitude_ + 90.0) * (double)GEOHASH36_POW6(n)) / 180.0,           \
+                                                   (double)GEOHASH36_POW6(n)) * GEOHASH36_FIXED_FRACTION_SCALE(n);     \
+   uint64_t lonFraction = geohash36_fixed_quantize(((longitude_ + 180.0) * (double)GEOHASH36_POW6(n)) / 360.0,         \
+                                                   (double)GEOHASH36_POW6(n)) * GEOHASH36_FIXED_FRACTION_SCALE(n);     \
+   geohash36_key_t key = (n);                                                                                          \
+                                                                                                                       \
+   GEOHASH36_FIXED_REPEAT(n, GEOHASH36_FIXED_ENCODE_KEY_STEP)                                                          \
+                                                                                                                       \
+   return key;                                                                                                         \
+}                                                                                                                      \
+                                                                                                                       \
+static inline int geohash36_decodeKey##n(geohash36_key_t key_, double * outLatitude_, double * outLongitude_)          \
+{                                                                                                                      \
+   uint64_t latIndex = 0, lonIndex = 0;                                                                                \
+   uint8_t rank, position;                                                                                             \
+   int invalid = 0;                                                                                                    \
+                                                                                                                       \
+   if ((outLatitude_ == NULL) || (outLongitude_ == NULL) ||                                                            \
+       ((key_ & ~(UINT64_MAX << (64 - ((n) * GEOHASH36_FIXED_KEY_CHAR_BITS)))) != (geohash36_key_t)(n)))               \
+      return -1;                                                                                                       \
+                                                                                                                       \
+   GEOHASH36_FIXED_REPEAT(n, GEOHASH36_FIXED_DECODE_KEY_STEP)                                                          \
+                                                                                                                       \
+   if (invalid)                                                                                                        \
+      return -1;                                                                                                       \
+                                                                                                                       \
+   (*outLatitude_) = ((-90.0 + ((double)latIndex * (180.0 / (double)GEOHASH36_POW6(n)))) +                             \
+                      (-90.0 + ((double)(latIndex + 1) * (180.0 / (double)GEOHASH36_POW6(n))))) / 2;                   \
+   (*outLongitude_) = ((-180.0 + ((double)lonIndex * (360.0 / (double)GEOHASH36_POW6(n)))) +                           \
+                       (-180.0 + ((double)(lonIndex + 1) * (360.0 / (double)GEOHASH36_POW6(n))))) / 2;                 \
+                                                                                                                       \
+   return 0;                                                                                                           \
+}
+
+/***********************************************************************************************************************
+Constants
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Copies of the character tables of geohash36.c (matrix, line/column of each character, rank in ASCII order of
+*        each character and matrix position of each rank).
+************************************************************************************************************************
+**/
+static const char geohash36_fixed_chars[GEOHASH36_FIXED_SIDE][GEOHASH36_FIXED_SIDE] =
+{
+   { '2', '3', '4', '5', '6', '7' },
+   { '8', '9', 'b', 'B', 'C', 'd' },
+   { 'D', 'F', 'g', 'G', 'h', 'H' },
+   { 'j', 'J', 'K', 'l', 'L', 'M' },
+   { 'n', 'N', 'P', 'q', 'Q', 'r' },
+   { 'R', 't', 'T', 'V', 'W', 'X' }
+};
+
+static const uint8_t geohash36_fixed_index[256] =
+{
+   0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+   0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+   0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+   0xFF, 0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x10, 0x11, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+   0xFF, 0xFF, 0x13, 0x14, 0x20, 0xFF, 0x21, 0x23, 0x25, 0xFF, 0x31, 0x32, 0x34, 0x35, 0x41, 0xFF,
+   0x42, 0x44, 0x50, 0xFF, 0x52, 0xFF, 0x53, 0x54, 0x55, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+   0xFF, 0xFF, 0x12, 0xFF, 0x15, 0xFF, 0xFF, 0x22, 0x24, 0xFF, 0x30, 0xFF, 0x33, 0xFF, 0x40, 0xFF,
+   0xFF, 0x43, 0x45, 0xFF, 0x51, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+   0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+   0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+   0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+   0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+   0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+   0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+   0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+   0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+static const uint8_t geohash36_fixed_rank[GEOHASH36_FIXED_SIDE * GEOHASH36_FIXED_SIDE] =
+{
+   0,  1,  2,  3,  4,  5,  6,  7,  26, 8,  9,  27, 10, 11, 28, 12, 29, 13,
+   30, 14, 15, 31, 16, 17, 32, 18, 19, 33, 20, 34, 21, 35, 22, 23, 24, 25
+};
+
+static const uint8_t geohash36_fixed_rank_position[GEOHASH36_FIXED_SIDE * GEOHASH36_FIXED_SIDE] =
+{
+   0,  1,  2,  3,  4,  5,  6,  7,  9,  10, 12, 13, 15, 17, 19, 20, 22, 23,
+   25, 26, 28, 30, 32, 33, 34, 35, 8,  11, 14, 16, 18, 21, 24, 27, 29, 31
+};
+
+/***********************************************************************************************************************
+Internal functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Inline copy of geohash36_quantize (same steps, so that the results are the same).
+************************************************************************************************************************
+* @param [in] position_: position in cells, from 0 to "limit_";
+* @param [in] limit_: number of cells in this axis.
+************************************************************************************************************************
+* @return Cell index.
+************************************************************************************************************************
+**/
+static inline uint64_t geohash36_fixed_quantize(double position_, double limit_)
+{
+   uint64_t index;
+
+   position_ = (position_ > 0) ? position_ : 0;
+   position_ = (position_ < limit_) ? position_ : limit_;
+
+   index = (uint64_t)position_;
+
+   if ((double)index < position_)
+      index++;
+
+   return (index > 0) ? (index - 1) : 0;
+}
+
+/***********************************************************************************************************************
+Exported functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Fixed length functions for the default length: geohash36_encode10, geohash36_decode10, geohash36_encodeKey10
+*        and geohash36_decodeKey10.
+************************************************************************************************************************
+**/
+GEOHASH36_FIXED_DEFINE(GEOHASH36_DEFAULT_NUM_CHARACTERS)
+GEOHASH36_FIXED_DEFINE_KEY(GEOHASH36_DEFAULT_NUM_CHARACTERS)
+
+#endif // _GEOHASH36_FIXED_H_
@@ -0,0 +1,565 @@
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include "geohash36_geofence.h"
+#include "geohash36_internal.h"
+
+/***********************************************************************************************************************
+Defines/macros
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief End of a posting list.
+************************************************************************************************************************
+**/
+#define GEOHASH36_GEOFENCE_NONE              UINT32_MAX
+
+/*!
+************************************************************************************************************************
+* @brief Initial number of slots of the table (power of 2, kept at most half full).
+************************************************************************************************************************
+**/
+#define GEOHASH36_GEOFENCE_MIN_SLOTS         1024
+
+/***********************************************************************************************************************
+Typedefs/structs/unions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Polygon being rasterized, with one array of edge numbers per cell length.
+************************************************************************************************************************
+**/
+typedef struct
+{
+   geohash36_geofence_t * geofence;
+   uint32_t polygon;
+   const double * vertices;
+   size_t numVertices;
+   geohash36_bounds_t box;
+   uint32_t * edges;
+
+}geohash36_geofence_raster_t;
+
+/***********************************************************************************************************************
+Internal functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Gets the slot of the table for a key (hash of the key, then linear probing).
+************************************************************************************************************************
+* @param [in] slots_: table;
+* @param [in] numSlots_: number of slots (power of 2);
+* @param [in] key_: desired key.
+************************************************************************************************************************
+* @return Slot holding the key, or the empty slot where it would be.
+************************************************************************************************************************
+**/
+static geohash36_geofence_slot_t * geohash36_geofence_findSlot(geohash36_geofence_slot_t * slots_, size_t numSlots_,
+                                                              geohash36_key_t key_)
+{
+   size_t position = (size_t)((key_ * 0x9E3779B97F4A7C15ull) >> 32) & (numSlots_ - 1);
+
+   while ((slots_[position].key != key_) && (slots_[position].key != GEOHASH36_KEY_INVALID))
+      position = (position + 1) & (numSlots_ - 1);
+
+   return &slots_[position];
+}
+
+/*!
+************************************************************************************************************************
+* @brief Doubles the number of slots of the table.
+************************************************************************************************************************
+* @param [in] geofence_: pointer to the geofence set.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Allocation failure.
+************************************************************************************************************************
+**/
+static int geohash36_geofence_grow(geohash36_geofence_t * geofence_)
+{
+   size_t numSlots = geofence_->numSlots * 2;
+   geohash36_geofence_slot_t * slots;
+   size_t i;
+
+   slots = malloc(numSlots * sizeof(geohash36_geofence_slot_t));
+   if (slots == NULL)
+      return -1;
+
+   for (i = 0; i < numSlots; i++)
+      slots[i].key = GEOHASH36_KEY_INVALID;
+
+   for (i = 0; i < geofence_->numSlots; i++)
+   {
+      if (geofence_->slots[i].key != GEOHASH36_KEY_INVALID)
+         (*geohash36_geofence_findSlot(slots, numSlots, geofence_->slots[i].key)) = geofence_->slots[i];
+   }
+
+   free(geofence_->slots);
+   geofence_->slots = slots;
+   geofence_->numSlots = numSlots;
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Adds a polygon to the posting list of a cell.
+************************************************************************************************************************
+* @param [in] geofence_: pointer to the geofence set;
+* @param [in] cell_: cell;
+* @param [in] polygon_: polygon position, with GEOHASH36_GEOFENCE_BOUNDARY for boundary cells.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Allocation failure.
+************************************************************************************************************************
+**/
+static int geohash36_geofence_insert(geohash36_geofence_t * geofence_, const geohash36_cell_t * cell_,
+                                     uint32_t polygon_)
+{
+   geohash36_key_t key = geohash36_cellToKey(cell_);
+   geohash36_geofence_slot_t * slot;
+   geohash36_geofence_posting_t * postings;
+
+   if ((2 * (geofence_->numKeys + 1) > geofence_->numSlots) && (geohash36_geofence_grow(geofence_) != 0))
+      return -1;
+
+   if ((geofence_->numPostings == geofence_->postingCapacity) || (geofence_->postings == NULL))
+   {
+      postings = realloc(geofence_->postings, 2 * (geofence_->postingCapacity + 1) * sizeof(*postings));
+      if (postings == NULL)
+         return -1;
+
+      geofence_->postings = postings;
+      geofence_->postingCapacity = 2 * (geofence_->postingCapacity + 1);
+   }
+
+   slot = geohash36_geofence_findSlot(geofence_->slots, geofence_->numSlots, key);
+
+   if (slot->key == GEOHASH36_KEY_INVALID)
+   {
+      slot->key = key;
+      slot->head = GEOHASH36_GEOFENCE_NONE;
+      geofence_->numKeys++;
+   }
+
+   geofence_->postings[geofence_->numPostings].polygon = polygon_;
+   geofence_->postings[geofence_->numPostings].next = slot->head;
+   slot->head = (uint32_t)geofence_->numPostings++;
+   geofence_->lengths |= 1u << cell_->numCharacters;
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Removes the postings added since a failed geofence_add, and the slots left without postings.
+*
+* Postings are only appended and each one goes to the head of its list, so the postings of the failed polygon are the
+* last ones and the first ones of their lists. Emptied slots are removed by moving back the keys which follow them in
+* their probe sequence (no allocation, as this runs after an allocation failure). The scan starts after an empty slot,
+* so no probe sequence wraps past its start and every key moved back is checked again.
+************************************************************************************************************************
+* @param [in] geofence_: pointer to the geofence set;
+* @param [in] numPostings_: number of postings before the failed call;
+* @param [in] lengths_: cell lengths in use before the failed call.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_geofence_rollback(geohash36_geofence_t * geofence_, size_t numPostings_, uint32_t lengths_)
+{
+   geohash36_geofence_slot_t * slots = geofence_->slots;
+   size_t mask = geofence_->numSlots - 1;
+   size_t i, start, count, hole, position, home;
+
+   for (i = 0; i < geofence_->numSlots; i++)
+   {
+      while ((slots[i].key != GEOHASH36_KEY_INVALID) && (slots[i].head != GEOHASH36_GEOFENCE_NONE) &&
+             (slots[i].head >= numPostings_))
+         slots[i].head = geofence_->postings[slots[i].head].next;
+   }
+
+   // The table is at most half full, so it has an empty slot
+   for (start = 0; slots[start].key != GEOHASH36_KEY_INVALID; start++)
+      ;
+
+   // A slot a key was moved back into is checked again before moving on
+   for (count = 1; count < geofence_->numSlots; )
+   {
+      hole = (start + count) & mask;
+
+      if ((slots[hole].key == GEOHASH36_KEY_INVALID) || (slots[hole].head != GEOHASH36_GEOFENCE_NONE))
+      {
+         count++;
+         continue;
+      }
+
+      // Backward shift: keys after the hole move into it unless their home slot is between the hole and them
+      for (position = (hole + 1) & mask; slots[position].key != GEOHASH36_KEY_INVALID; position = (position + 1) & mask)
+      {
+         home = (size_t)((slots[position].key * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+
+         if (((position - home) & mask) >= ((position - hole) & mask))
+         {
+            slots[hole] = slots[position];
+            hole = position;
+         }
+      }
+
+      slots[hole].key = GEOHASH36_KEY_INVALID;
+      geofence_->numKeys--;
+   }
+
+   geofence_->numPostings = numPostings_;
+   geofence_->lengths = lengths_;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Checks if a position is inside a polygon (crossing number, even-odd rule).
+************************************************************************************************************************
+* @param [in] vertices_: latitude/longitude pairs of the polygon;
+* @param [in] numVertices_: number of vertices;
+* @param [in] latitude_, longitude_: position.
+************************************************************************************************************************
+* @return 1 or 0.
+************************************************************************************************************************
+**/
+static int geohash36_geofence_isInside(const double * vertices_, size_t numVertices_, double latitude_,
+                                       double longitude_)
+{
+   const double * a;
+   const double * b;
+   int inside = 0;
+   size_t i;
+
+   for (i = 0; i < numVertices_; i++)
+   {
+      a = vertices_ + (2 * i);
+      b = vertices_ + (2 * ((i + 1) % numVertices_));
+
+      if (((a[0] > latitude_) != (b[0] > latitude_)) &&
+          (longitude_ < (a[1] + (((b[1] - a[1]) * (latitude_ - a[0])) / (b[0] - a[0])))))
+         inside = !inside;
+   }
+
+   return inside;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Checks if an edge touches a box (separating axes: box axes, then the normal of the edge).
+************************************************************************************************************************
+* @param [in] a_, b_: latitude/longitude of the ends of the edge;
+* @param [in] bounds_: box.
+************************************************************************************************************************
+* @return 1 or 0.
+************************************************************************************************************************
+**/
+static int geohash36_geofence_touches(const double * a_, const double * b_, const geohash36_bounds_t * bounds_)
+{
+   double side[4];
+   double dLat = b_[0] - a_[0];
+   double dLon = b_[1] - a_[1];
+
+   if ((MAX(a_[0], b_[0]) < bounds_->minLatitude) || (MIN(a_[0], b_[0]) > bounds_->maxLatitude) ||
+       (MAX(a_[1], b_[1]) < bounds_->minLongitude) || (MIN(a_[1], b_[1]) > bounds_->maxLongitude))
+      return 0;
+
+   side[0] = (dLat * (bounds_->minLongitude - a_[1])) - (dLon * (bounds_->minLatitude - a_[0]));
+   side[1] = (dLat * (bounds_->maxLongitude - a_[1])) - (dLon * (bounds_->minLatitude - a_[0]));
+   side[2] = (dLat * (bounds_->minLongitude - a_[1])) - (dLon * (bounds_->maxLatitude - a_[0]));
+   side[3] = (dLat * (bounds_->maxLongitude - a_[1])) - (dLon * (bounds_->maxLatitude - a_[0]));
+
+   return !(((side[0] > 0) && (side[1] > 0) && (side[2] > 0) && (side[3] > 0)) ||
+            ((side[0] < 0) && (side[1] < 0) && (side[2] < 0) && (side[3] < 0)));
+}
+
+/*!
+************************************************************************************************************************
+* @brief Classifies the children of a boundary cell: cells without edges are inside or outside, cells with edges are
+*        split again (or stored as boundary cells at the maximum length).
+************************************************************************************************************************
+* @param [in] raster_: polygon being rasterized;
+* @param [in] cell_: boundary cell;
+* @param [in] edges_: edges touching the cell;
+* @param [in] numEdges_: number of edges.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Allocation failure.
+************************************************************************************************************************
+**/
+static int geohash36_geofence_rasterize(geohash36_geofence_raster_t * raster_, const geohash36_cell_t * cell_,
+                                        const uint32_t * edges_, size_t numEdges_)
+{
+   uint32_t * childEdges = raster_->edges + ((size_t)(cell_->numCharacters + 1) * raster_->numVertices);
+   geohash36_cell_t child;
+   geohash36_bounds_t bounds;
+   size_t numChildEdges, e;
+   const double * a;
+   int i, result = 0;
+
+   child.numCharacters = cell_->numCharacters + 1;
+
+   for (i = 0; (i < (GEOHASH_MATRIX_SIDE * GEOHASH_MATRIX_SIDE)) && (result == 0); i++)
+   {
+      child.latIndex = (cell_->latIndex * GEOHASH_MATRIX_SIDE) + (uint64_t)(i / GEOHASH_MATRIX_SIDE);
+      child.lonIndex = (cell_->lonIndex * GEOHASH_MATRIX_SIDE) + (uint64_t)(i % GEOHASH_MATRIX_SIDE);
+      geohash36_getCellBounds(&child, &bounds);
+
+      if ((bounds.minLatitude > raster_->box.maxLatitude) || (bounds.maxLatitude < raster_->box.minLatitude) ||
+          (bounds.minLongitude > raster_->box.maxLongitude) || (bounds.maxLongitude < raster_->box.minLongitude))
+         continue;
+
+      for (e = 0, numChildEdges = 0; e < numEdges_; e++)
+      {
+         a = raster_->vertices + (2 * edges_[e]);
+
+         if (geohash36_geofence_touches(a, raster_->vertices + (2 * ((edges_[e] + 1) % raster_->numVertices)),
+                                        &bounds))
+            childEdges[numChildEdges++] = edges_[e];
+      }
+
+      if (numChildEdges == 0)
+      {
+         if (geohash36_geofence_isInside(raster_->vertices, raster_->numVertices,
+                                         (bounds.minLatitude + bounds.maxLatitude) / 2.0,
+                                         (bounds.minLongitude + bounds.maxLongitude) / 2.0))
+            result = geohash36_geofence_insert(raster_->geofence, &child, raster_->polygon);
+      }
+      else if (child.numCharacters == raster_->geofence->maxCharacters)
+         result = geohash36_geofence_insert(raster_->geofence, &child, raster_->polygon | GEOHASH36_GEOFENCE_BOUNDARY);
+      else
+         result = geohash36_geofence_rasterize(raster_, &child, childEdges, numChildEdges);
+   }
+
+   return result;
+}
+
+/***********************************************************************************************************************
+External functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Initializes an empty geofence set.
+************************************************************************************************************************
+* @param [out] geofence_: pointer to the geofence set;
+* @param [in] maxCharacters_: length of the boundary cells (1 to GEOHASH36_KEY_MAX_CHARACTERS). Longer cells need
+*                             more memory, but fewer points fall in boundary cells.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input or allocation failure.
+************************************************************************************************************************
+**/
+int geohash36_geofence_init(geohash36_geofence_t * geofence_, int maxCharacters_)
+{
+   size_t i;
+
+   if ((geofence_ == NULL) || (maxCharacters_ < 1) || (maxCharacters_ > GEOHASH36_KEY_MAX_CHARACTERS))
+      return -1;
+
+   memset(geofence_, 0, sizeof(geohash36_geofence_t));
+
+   geofence_->slots = malloc(GEOHASH36_GEOFENCE_MIN_SLOTS * sizeof(geohash36_geofence_slot_t));
+   if (geofence_->slots == NULL)
+      return -1;
+
+   for (i = 0; i < GEOHASH36_GEOFENCE_MIN_SLOTS; i++)
+      geofence_->slots[i].key = GEOHASH36_KEY_INVALID;
+
+   geofence_->numSlots = GEOHASH36_GEOFENCE_MIN_SLOTS;
+   geofence_->maxCharacters = maxCharacters_;
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Releases the memory of a geofence set.
+************************************************************************************************************************
+* @param [in] geofence_: pointer to the geofence set.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+void geohash36_geofence_free(geohash36_geofence_t * geofence_)
+{
+   if (geofence_ == NULL)
+      return;
+
+   free(geofence_->polygons);
+   free(geofence_->vertices);
+   free(geofence_->slots);
+   free(geofence_->postings);
+   memset(geofence_, 0, sizeof(geohash36_geofence_t));
+}
+
+/*!
+************************************************************************************************************************
+* @brief Adds a polygon to a geofence set.
+*
+* Edges are straight lines in latitude/longitude, the inside follows the even-odd rule, and polygons must not cross the
+* antimeridian.
+************************************************************************************************************************
+* @param [in] geofence_: pointer to the geofence set;
+* @param [in] id_: ID reported by the queries;
+* @param [in] lat_: latitudes of the vertices;
+* @param [in] lon_: longitudes of the vertices;
+* @param [in] numVertices_: number of vertices (at least 3; the last one is connected to the first).
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input or allocation failure.
+************************************************************************************************************************
+**/
+int geohash36_geofence_add(geohash36_geofence_t * geofence_, uint32_t id_, const double * lat_, const double * lon_,
+                           size_t numVertices_)
+{
+   geohash36_geofence_raster_t raster;
+   geohash36_geofence_polygon_t * polygons;
+   geohash36_cell_t world = { 0, 0, 0 };
+   double * vertices;
+   size_t i, capacity, numPostings;
+   uint32_t lengths;
+   int result;
+
+   if ((geofence_ == NULL) || (geofence_->slots == NULL) || (lat_ == NULL) || (lon_ == NULL) || (numVertices_ < 3) ||
+       (numVertices_ >= GEOHASH36_GEOFENCE_NONE) || (geofence_->numPolygons >= GEOHASH36_GEOFENCE_BOUNDARY))
+      return -1;
+
+   for (i = 0; i < numVertices_; i++)
+   {
+      if (!(lat_[i] >= -90.0) || !(lat_[i] <= 90.0) || !(lon_[i] >= -180.0) || !(lon_[i] <= 180.0))
+         return -1;
+   }
+
+   if (geofence_->numVertices + numVertices_ > geofence_->vertexCapacity)
+   {
+      capacity = MAX(2 * geofence_->vertexCapacity, geofence_->numVertices + numVertices_);
+      vertices = realloc(geofence_->vertices, capacity * 2 * sizeof(double));
+      if (vertices == NULL)
+         return -1;
+
+      geofence_->vertices = vertices;
+      geofence_->vertexCapacity = capacity;
+   }
+
+   polygons = realloc(geofence_->polygons, (geofence_->numPolygons + 1) * sizeof(geohash36_geofence_polygon_t));
+   if (polygons == NULL)
+      return -1;
+
+   geofence_->polygons = polygons;
+
+   raster.geofence = geofence_;
+   raster.polygon = (uint32_t)geofence_->numPolygons;
+   raster.vertices = geofence_->vertices + (2 * geofence_->numVertices);
+   raster.numVertices = numVertices_;
+   raster.box.minLatitude = raster.box.maxLatitude = lat_[0];
+   raster.box.minLongitude = raster.box.maxLongitude = lon_[0];
+
+   for (i = 0; i < numVertices_; i++)
+   {
+      geofence_->vertices[2 * (geofence_->numVertices + i)] = lat_[i];
+      geofence_->vertices[(2 * (geofence_->numVertices + i)) + 1] = lon_[i];
+      raster.box.minLatitude = MIN(raster.box.minLatitude, lat_[i]);
+      raster.box.maxLatitude = MAX(raster.box.maxLatitude, lat_[i]);
+      raster.box.minLongitude = MIN(raster.box.minLongitude, lon_[i]);
+      raster.box.maxLongitude = MAX(raster.box.maxLongitude, lon_[i]);
+   }
+
+   raster.edges = malloc((size_t)(geofence_->maxCharacters + 1) * numVertices_ * sizeof(uint32_t));
+   if (raster.edges == NULL)
+      return -1;
+
+   numPostings = geofence_->numPostings;
+   lengths = geofence_->lengths;
+
+   for (i = 0; i < numVertices_; i++)
+      raster.edges[i] = (uint32_t)i;
+
+   result = geohash36_geofence_rasterize(&raster, &world, raster.edges, numVertices_);
+   free(raster.edges);
+
+   // Postings of a failed polygon would be reported under the next one, which gets the same position
+   if (result != 0)
+   {
+      geohash36_geofence_rollback(geofence_, numPostings, lengths);
+      return -1;
+   }
+
+   geofence_->polygons[geofence_->numPolygons].id = id_;
+   geofence_->polygons[geofence_->numPolygons].firstVertex = geofence_->numVertices;
+   geofence_->polygons[geofence_->numPolygons].numVertices = numVertices_;
+   geofence_->numPolygons++;
+   geofence_->numVertices += numVertices_;
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Finds the polygons which contain a position.
+************************************************************************************************************************
+* @param [in] geofence_: pointer to the geofence set;
+* @param [in] latitude_, longitude_: position;
+* @param [out] outIds_: array which will receive the IDs of the polygons (in no particular order);
+* @param [in] maxIds_: size of "outIds_".
+************************************************************************************************************************
+* @return Number of polygons containing the position (only the first "maxIds_" are written), or -1 for invalid input.
+************************************************************************************************************************
+**/
+int geohash36_geofence_query(const geohash36_geofence_t * geofence_, double latitude_, double longitude_,
+                             uint32_t * outIds_, int maxIds_)
+{
+   const geohash36_geofence_slot_t * slot;
+   const geohash36_geofence_polygon_t * polygon;
+   geohash36_key_t key;
+   uint32_t posting;
+   int numCharacters, count = 0;
+
+   if ((geofence_ == NULL) || (geofence_->slots == NULL) || ((outIds_ == NULL) && (maxIds_ > 0)) ||
+       !(latitude_ >= -90.0) || !(latitude_ <= 90.0) || !(longitude_ >= -180.0) || !(longitude_ <= 180.0))
+      return -1;
+
+   key = geohash36_encodeKey(latitude_, longitude_, geofence_->maxCharacters);
+
+   // A point is in exactly one cell of each length: one probe per length holding cells
+   for (numCharacters = 1; numCharacters <= geofence_->maxCharacters; numCharacters++)
+   {
+      if (!(geofence_->lengths & (1u << numCharacters)))
+         continue;
+
+      slot = geohash36_geofence_findSlot(geofence_->slots, geofence_->numSlots,
+                                         geohash36_keyTruncate(key, numCharacters));
+
+      if (slot->key == GEOHASH36_KEY_INVALID)
+         continue;
+
+      for (posting = slot->head; posting != GEOHASH36_GEOFENCE_NONE; posting = geofence_->postings[posting].next)
+      {
+         polygon = &geofence_->polygons[geofence_->postings[posting].polygon & ~GEOHASH36_GEOFENCE_BOUNDARY];
+
+         if ((geofence_->postings[posting].polygon & GEOHASH36_GEOFENCE_BOUNDARY) &&
+             !geohash36_geofence_isInside(geofence_->vertices + (2 * polygon->firstVertex), polygon->numVertices,
+                                          latitude_, longitude_))
+            continue;
+
+         if (count < maxIds_)
+            outIds_[count] = polygon->id;
+
+         count++;
+      }
+   }
+
+   return count;
+}
@@ -0,0 +1,159 @@
+#ifndef _GEOHASH36_GEOFENCE_H_
+#define _GEOHASH36_GEOFENCE_H_
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "stddef.h"
+#include "geohash36.h"
+
+/***********************************************************************************************************************
+Defines/macros
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Flag of the postings of boundary cells (the other bits are the polygon position).
+************************************************************************************************************************
+**/
+#define GEOHASH36_GEOFENCE_BOUNDARY          0x80000000u
+
+/***********************************************************************************************************************
+Typedefs/structs/unions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Polygon of a geofence set: vertices "firstVertex" to "firstVertex + numVertices - 1" of the vertex array.
+************************************************************************************************************************
+**/
+typedef struct
+{
+   uint32_t id;
+   size_t firstVertex;
+   size_t numVertices;
+
+}geohash36_geofence_polygon_t;
+
+/*!
+************************************************************************************************************************
+* @brief Slot of the open addressing table: cell key and first posting (GEOHASH36_KEY_INVALID for empty slots).
+************************************************************************************************************************
+**/
+typedef struct
+{
+   geohash36_key_t key;
+   uint32_t head;
+
+}geohash36_geofence_slot_t;
+
+/*!
+************************************************************************************************************************
+* @brief Posting: polygon (with GEOHASH36_GEOFENCE_BOUNDARY for boundary cells) and next posting of the same cell.
+************************************************************************************************************************
+**/
+typedef struct
+{
+   uint32_t polygon;
+   uint32_t next;
+
+}geohash36_geofence_posting_t;
+
+/*!
+************************************************************************************************************************
+* @brief Set of polygon geofences.
+*
+* Each polygon is rasterized in mixed length cells, either fully inside it or cut by its border (only at the maximum
+* length). The cells go to an open addressing table keyed by packed key, so a point test is one encode plus a probe
+* per cell length in use, and the exact point-in-polygon test only runs for boundary cells.
+************************************************************************************************************************
+**/
+typedef struct
+{
+   geohash36_geofence_polygon_t * polygons;
+   size_t numPolygons;
+
+   double * vertices;
+   size_t numVertices;
+   size_t vertexCapacity;
+
+   geohash36_geofence_slot_t * slots;
+   size_t numSlots;
+   size_t numKeys;
+
+   geohash36_geofence_posting_t * postings;
+   size_t numPostings;
+   size_t postingCapacity;
+
+   int maxCharacters;
+   uint32_t lengths;
+
+}geohash36_geofence_t;
+
+/***********************************************************************************************************************
+Exported functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Initializes an empty geofence set.
+************************************************************************************************************************
+* @param [out] geofence_: pointer to the geofence set;
+* @param [in] maxCharacters_: length of the boundary cells (1 to GEOHASH36_KEY_MAX_CHARACTERS). Longer cells need
+*                             more memory, but fewer points fall in boundary cells.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input or allocation failure.
+************************************************************************************************************************
+**/
+int geohash36_geofence_init(geohash36_geofence_t * geofence_, int maxCharacters_);
+
+/*!
+************************************************************************************************************************
+* @brief Releases the memory of a geofence set.
+************************************************************************************************************************
+* @param [in] geofence_: pointer to the geofence set.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+void geohash36_geofence_free(geohash36_geofence_t * geofence_);
+
+/*!
+************************************************************************************************************************
+* @brief Adds a polygon to a geofence set.
+*
+* Edges are straight lines in latitude/longitude, the inside follows the even-odd rule, and polygons must not cross the
+* antimeridian.
+************************************************************************************************************************
+* @param [in] geofence_: pointer to the geofence set;
+* @param [in] id_: ID reported by the queries;
+* @param [in] lat_: latitudes of the vertices;
+* @param [in] lon_: longitudes of the vertices;
+* @param [in] numVertices_: number of vertices (at least 3; the last one is connected to the first).
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input or allocation failure.
+************************************************************************************************************************
+**/
+int geohash36_geofence_add(geohash36_geofence_t * geofence_, uint32_t id_, const double * lat_, const double * lon_,
+                           size_t numVertices_);
+
+/*!
+************************************************************************************************************************
+* @brief Finds the polygons which contain a position.
+************************************************************************************************************************
+* @param [in] geofence_: pointer to the geofence set;
+* @param [in] latitude_, longitude_: position;
+* @param [out] outIds_: array which will receive the IDs of the polygons (in no particular order);
+* @param [in] maxIds_: size of "outIds_".
+************************************************************************************************************************
+* @return Number of polygons containing the position (only the first "maxIds_" are written), or -1 for invalid input.
+************************************************************************************************************************
+**/
+int geohash36_geofence_query(const geohash36_geofence_t * geofence_, double latitude_, double longitude_,
+                             uint32_t * outIds_, int maxIds_);
+
+#endif // _GEOHASH36_GEOFENCE_H_
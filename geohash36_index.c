@@ -0,0 +1,1144 @@
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "geohash36_index.h"
+#include "geohash36_cover.h"
+#include "geohash36_internal.h"
+
+/***********************************************************************************************************************
+Defines/macros
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Number of bits sorted by each pass of the radix sort (8 passes over the 64 bits of the keys).
+************************************************************************************************************************
+**/
+#define GEOHASH36_INDEX_RADIX_BITS           8
+#define GEOHASH36_INDEX_RADIX_BUCKETS        (1 << GEOHASH36_INDEX_RADIX_BITS)
+#define GEOHASH36_INDEX_RADIX_PASSES         (64 / GEOHASH36_INDEX_RADIX_BITS)
+
+/*!
+************************************************************************************************************************
+* @brief Size of the main array relative to the run which triggers a background merge.
+************************************************************************************************************************
+**/
+#define GEOHASH36_INDEX_RUN_RATIO            8
+
+/*!
+************************************************************************************************************************
+* @brief Number of entries above which the nearest neighbor search splits a cell in its children.
+************************************************************************************************************************
+**/
+#define GEOHASH36_INDEX_NEAREST_SPLIT        64
+
+/***********************************************************************************************************************
+Typedefs/structs/unions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Nearest neighbor search: query position and max-heap of the best entries found so far.
+************************************************************************************************************************
+**/
+typedef struct
+{
+   double latitude;
+   double longitude;
+   geohash36_index_neighbor_t * heap;
+   size_t k;
+   size_t count;
+
+}geohash36_index_nearest_t;
+
+/***********************************************************************************************************************
+Internal functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Sorts entries by key with a LSD radix sort. Histograms of every pass are computed in a single read of the
+*        input, and passes in which every key has the same digit (e.g. the first characters of clustered data) are
+*        skipped.
+************************************************************************************************************************
+* @param [in] entries_: entries to be sorted;
+* @param [in] buffer_: scratch array with the same size;
+* @param [in] n_: number of entries.
+************************************************************************************************************************
+* @return Array holding the sorted entries ("entries_" or "buffer_").
+************************************************************************************************************************
+**/
+static geohash36_entry_t * geohash36_index_radixSort(geohash36_entry_t * entries_, geohash36_entry_t * buffer_,
+                                                     size_t n_)
+{
+   size_t (*count)[GEOHASH36_INDEX_RADIX_BUCKETS];
+   geohash36_entry_t * source = entries_;
+   geohash36_entry_t * destination = buffer_;
+   geohash36_entry_t * swap;
+   size_t i, offset, total;
+   int pass, digit;
+
+   count = calloc(GEOHASH36_INDEX_RADIX_PASSES, sizeof(*count));
+   if (count == NULL)
+      return NULL;
+
+   for (i = 0; i < n_; i++)
+   {
+      for (pass = 0; pass < GEOHASH36_INDEX_RADIX_PASSES; pass++)
+         count[pass][(entries_[i].key >> (pass * GEOHASH36_INDEX_RADIX_BITS)) & (GEOHASH36_INDEX_RADIX_BUCKETS - 1)]++;
+   }
+
+   for (pass = 0; pass < GEOHASH36_INDEX_RADIX_PASSES; pass++)
+   {
+      // A single non-empty bucket: this pass would only copy the array
+      if (count[pass][(source[0].key >> (pass * GEOHASH36_INDEX_RADIX_BITS)) & (GEOHASH36_INDEX_RADIX_BUCKETS - 1)] ==
+          n_)
+         continue;
+
+      for (digit = 0, total = 0; digit < GEOHASH36_INDEX_RADIX_BUCKETS; digit++)
+      {
+         offset = count[pass][digit];
+         count[pass][digit] = total;
+         total += offset;
+      }
+
+      for (i = 0; i < n_; i++)
+      {
+         digit = (int)((source[i].key >> (pass * GEOHASH36_INDEX_RADIX_BITS)) & (GEOHASH36_INDEX_RADIX_BUCKETS - 1));
+         destination[count[pass][digit]++] = source[i];
+      }
+
+      swap = source;
+      source = destination;
+      destination = swap;
+   }
+
+   free(count);
+   return source;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Finds the first entry with key not lower than a value (lower bound).
+************************************************************************************************************************
+* @param [in] entries_: sorted entries;
+* @param [in] n_: number of entries;
+* @param [in] key_: desired key.
+************************************************************************************************************************
+* @return Position of the entry ("n_" if every key is lower).
+************************************************************************************************************************
+**/
+static size_t geohash36_index_lowerBound(const geohash36_entry_t * entries_, size_t n_, geohash36_key_t key_)
+{
+   size_t first = 0;
+   size_t half;
+
+   while (n_ > 0)
+   {
+      half = n_ / 2;
+
+      if (entries_[first + half].key < key_)
+      {
+         first += half + 1;
+         n_ -= half + 1;
+      }
+      else
+         n_ = half;
+   }
+
+   return first;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Merges two sorted arrays (entries of the first one come first among equal keys).
+************************************************************************************************************************
+* @param [in] a_, numA_: first array;
+* @param [in] b_, numB_: second array;
+* @param [out] out_: array of "numA_ + numB_" entries which will receive the result.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_index_merge(const geohash36_entry_t * a_, size_t numA_, const geohash36_entry_t * b_,
+                                  size_t numB_, geohash36_entry_t * out_)
+{
+   size_t i = 0;
+   size_t j = 0;
+
+   while ((i < numA_) && (j < numB_))
+      (*out_++) = (b_[j].key < a_[i].key) ? b_[j++] : a_[i++];
+
+   if (i < numA_)
+      memcpy(out_, a_ + i, (numA_ - i) * sizeof(geohash36_entry_t));
+
+   if (j < numB_)
+      memcpy(out_, b_ + j, (numB_ - j) * sizeof(geohash36_entry_t));
+}
+
+/*!
+************************************************************************************************************************
+* @brief Background merge of the main array with the frozen run.
+************************************************************************************************************************
+* @param [in] index_: pointer to the index.
+************************************************************************************************************************
+* @return NULL.
+************************************************************************************************************************
+**/
+static void * geohash36_index_mergeThread(void * index_)
+{
+   geohash36_index_t * index = (geohash36_index_t *)index_;
+
+   geohash36_index_merge(index->entries, index->numEntries, index->frozen, index->numFrozen, index->merged);
+   __atomic_store_n(&index->mergeDone, 1, __ATOMIC_RELEASE);
+
+   return NULL;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Replaces the main array with the result of the merge.
+************************************************************************************************************************
+* @param [in] index_: pointer to the index.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_index_publishMerge(geohash36_index_t * index_)
+{
+   free(index_->entries);
+   free(index_->frozen);
+   index_->entries = index_->merged;
+   index_->numEntries += index_->numFrozen;
+   index_->merged = NULL;
+   index_->frozen = NULL;
+   index_->numFrozen = 0;
+   index_->merging = 0;
+   index_->mergeDone = 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Waits for the running merge (if any) and publishes its result as the main array.
+************************************************************************************************************************
+* @param [in] index_: pointer to the index.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_index_finishMerge(geohash36_index_t * index_)
+{
+   if (!index_->merging)
+      return;
+
+   pthread_join(index_->mergeThread, NULL);
+   geohash36_index_publishMerge(index_);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Freezes the run and starts merging it with the main array in the background (synchronously if no thread is
+*        available).
+************************************************************************************************************************
+* @param [in] index_: pointer to the index.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Allocation failure.
+************************************************************************************************************************
+**/
+static int geohash36_index_startMerge(geohash36_index_t * index_)
+{
+   geohash36_index_finishMerge(index_);
+
+   index_->merged = malloc((index_->numEntries + index_->numRun) * sizeof(geohash36_entry_t));
+   if (index_->merged == NULL)
+      return -1;
+
+   index_->frozen = index_->run;
+   index_->numFrozen = index_->numRun;
+   index_->run = NULL;
+   index_->numRun = 0;
+   index_->mergeDone = 0;
+   index_->merging = 1;
+
+   if (pthread_create(&index_->mergeThread, NULL, geohash36_index_mergeThread, index_) != 0)
+   {
+      geohash36_index_mergeThread(index_);
+      geohash36_index_publishMerge(index_);
+   }
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Merges the delta buffer into the run, and starts the background merge of the run once it reaches
+*        1 / GEOHASH36_INDEX_RUN_RATIO of the main array (so each entry is copied a bounded number of times).
+************************************************************************************************************************
+* @param [in] index_: pointer to the index.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Allocation failure.
+************************************************************************************************************************
+**/
+static int geohash36_index_mergeDelta(geohash36_index_t * index_)
+{
+   geohash36_entry_t * run;
+
+   run = malloc((index_->numRun + index_->numDelta) * sizeof(geohash36_entry_t));
+   if (run == NULL)
+      return -1;
+
+   geohash36_index_merge(index_->run, index_->numRun, index_->delta, index_->numDelta, run);
+
+   free(index_->run);
+   index_->run = run;
+   index_->numRun += index_->numDelta;
+   index_->numDelta = 0;
+
+   if (index_->numRun >= MAX(GEOHASH36_INDEX_DELTA_CAPACITY, index_->numEntries / GEOHASH36_INDEX_RUN_RATIO))
+      return geohash36_index_startMerge(index_);
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Visits the entries of a sorted array in a closed key range.
+************************************************************************************************************************
+* @param [in] entries_, n_: sorted entries;
+* @param [in] first_, last_: key range;
+* @param [in] bounds_: box that the cell centers must be inside (NULL visits every entry in the range);
+* @param [in] callback_, context_: callback of the query;
+* @param [in,out] visited_: number of entries visited;
+* @param [out] stop_: set to 1 when the callback stops the query.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_index_scan(const geohash36_entry_t * entries_, size_t n_, geohash36_key_t first_,
+                                 geohash36_key_t last_, const geohash36_bounds_t * bounds_,
+                                 geohash36_index_callback_t callback_, void * context_, size_t * visited_, int * stop_)
+{
+   size_t i;
+   double latitude, longitude;
+   int inLongitude;
+
+   for (i = geohash36_index_lowerBound(entries_, n_, first_); (i < n_) && (entries_[i].key <= last_); i++)
+   {
+      if (bounds_ != NULL)
+      {
+         if (geohash36_decodeKey(entries_[i].key, &latitude, &longitude) != 0)
+            continue;
+
+         if (bounds_->minLongitude <= bounds_->maxLongitude)
+            inLongitude = (longitude >= bounds_->minLongitude) && (longitude <= bounds_->maxLongitude);
+         else
+            inLongitude = (longitude >= bounds_->minLongitude) || (longitude <= bounds_->maxLongitude);
+
+         if (!inLongitude || (latitude < bounds_->minLatitude) || (latitude > bounds_->maxLatitude))
+            continue;
+      }
+
+      (*visited_)++;
+
+      if ((callback_ != NULL) && callback_(&entries_[i], context_))
+      {
+         (*stop_) = 1;
+         return;
+      }
+   }
+}
+
+/*!
+************************************************************************************************************************
+* @brief Visits the entries of the buffers (run, frozen run and delta) in a closed key range.
+************************************************************************************************************************
+* @param [in] index_: pointer to the index;
+* @param [in] first_, last_: key range;
+* @param [in] bounds_: box that the cell centers must be inside (NULL visits every entry in the range);
+* @param [in] callback_, context_: callback of the query;
+* @param [in,out] visited_: number of entries visited;
+* @param [out] stop_: set to 1 when the callback stops the query.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_index_scanBuffers(const geohash36_index_t * index_, geohash36_key_t first_,
+                                        geohash36_key_t last_, const geohash36_bounds_t * bounds_,
+                                        geohash36_index_callback_t callback_, void * context_, size_t * visited_,
+                                        int * stop_)
+{
+   if (!(*stop_))
+      geohash36_index_scan(index_->run, index_->numRun, first_, last_, bounds_, callback_, context_, visited_, stop_);
+
+   if (!(*stop_))
+      geohash36_index_scan(index_->frozen, index_->numFrozen, first_, last_, bounds_, callback_, context_, visited_,
+                           stop_);
+
+   if (!(*stop_))
+      geohash36_index_scan(index_->delta, index_->numDelta, first_, last_, bounds_, callback_, context_, visited_,
+                           stop_);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Visits the entries of the main array and of the buffers in a closed key range.
+************************************************************************************************************************
+* @param [in] index_: pointer to the index;
+* @param [in] first_, last_: key range;
+* @param [in] bounds_: box that the cell centers must be inside (NULL visits every entry in the range);
+* @param [in] callback_, context_: callback of the query;
+* @param [in,out] visited_: number of entries visited;
+* @param [out] stop_: set to 1 when the callback stops the query.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_index_scanAll(const geohash36_index_t * index_, geohash36_key_t first_, geohash36_key_t last_,
+                                    const geohash36_bounds_t * bounds_, geohash36_index_callback_t callback_,
+                                    void * context_, size_t * visited_, int * stop_)
+{
+   geohash36_index_scan(index_->entries, index_->numEntries, first_, last_, bounds_, callback_, context_, visited_,
+                        stop_);
+
+   geohash36_index_scanBuffers(index_, first_, last_, bounds_, callback_, context_, visited_, stop_);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Compares two keys (qsort).
+************************************************************************************************************************
+* @param [in] a_, b_: pointers to the keys.
+************************************************************************************************************************
+* @return -1, 0 or 1.
+************************************************************************************************************************
+**/
+static int geohash36_index_compareKeys(const void * a_, const void * b_)
+{
+   geohash36_key_t a = *(const geohash36_key_t *)a_;
+   geohash36_key_t b = *(const geohash36_key_t *)b_;
+
+   return (a < b) ? -1 : ((a > b) ? 1 : 0);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Moves a neighbor down a max-heap (by distance) to its place.
+************************************************************************************************************************
+* @param [in] heap_: heap;
+* @param [in] n_: number of neighbors in the heap;
+* @param [in] position_: position of the neighbor.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_index_siftDown(geohash36_index_neighbor_t * heap_, size_t n_, size_t position_)
+{
+   geohash36_index_neighbor_t neighbor = heap_[position_];
+   size_t child;
+
+   while ((child = (2 * position_) + 1) < n_)
+   {
+      if ((child + 1 < n_) && (heap_[child + 1].distance > heap_[child].distance))
+         child++;
+
+      if (heap_[child].distance <= neighbor.distance)
+         break;
+
+      heap_[position_] = heap_[child];
+      position_ = child;
+   }
+
+   heap_[position_] = neighbor;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Keeps an entry if it is among the "k" nearest found so far (callback of the nearest neighbor search).
+************************************************************************************************************************
+* @param [in] entry_: entry found;
+* @param [in] context_: pointer to the search.
+************************************************************************************************************************
+* @return 0 (never stops the scan).
+************************************************************************************************************************
+**/
+static int geohash36_index_keepNearest(const geohash36_entry_t * entry_, void * context_)
+{
+   geohash36_index_nearest_t * search = (geohash36_index_nearest_t *)context_;
+   double latitude, longitude, distance;
+   size_t position, parent;
+
+   if (geohash36_decodeKey(entry_->key, &latitude, &longitude) != 0)
+      return 0;
+
+   // The latitude difference alone is a lower bound of the distance
+   if ((search->count == search->k) &&
+       (EARTH_RADIUS_IN_METERS * GEOHASH36_RADIANS(fabs(latitude - search->latitude)) >= search->heap[0].distance))
+      return 0;
+
+   distance = geohash36_getDistanceInMeters(search->latitude, search->longitude, latitude, longitude);
+
+   if (search->count < search->k)
+   {
+      for (position = search->count++; position > 0; position = parent)
+      {
+         parent = (position - 1) / 2;
+
+         if (search->heap[parent].distance >= distance)
+            break;
+
+         search->heap[position] = search->heap[parent];
+      }
+
+      search->heap[position].entry = (*entry_);
+      search->heap[position].distance = distance;
+   }
+   else if (distance < search->heap[0].distance)
+   {
+      search->heap[0].entry = (*entry_);
+      search->heap[0].distance = distance;
+      geohash36_index_siftDown(search->heap, search->count, 0);
+   }
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Counts the entries of the buffers (run, frozen run and delta) whose key starts with a prefix.
+************************************************************************************************************************
+* @param [in] index_: pointer to the index;
+* @param [in] prefix_: key of the prefix.
+************************************************************************************************************************
+* @return Number of entries.
+************************************************************************************************************************
+**/
+static size_t geohash36_index_countBuffers(const geohash36_index_t * index_, geohash36_key_t prefix_)
+{
+   geohash36_key_t last = geohash36_keyRangeEnd(prefix_);
+
+   return (geohash36_index_lowerBound(index_->run, index_->numRun, last) -
+           geohash36_index_lowerBound(index_->run, index_->numRun, prefix_)) +
+          (geohash36_index_lowerBound(index_->frozen, index_->numFrozen, last) -
+           geohash36_index_lowerBound(index_->frozen, index_->numFrozen, prefix_)) +
+          (geohash36_index_lowerBound(index_->delta, index_->numDelta, last) -
+           geohash36_index_lowerBound(index_->delta, index_->numDelta, prefix_));
+}
+
+/*!
+************************************************************************************************************************
+* @brief Gets a lower bound of the distance from a position to a meridian.
+************************************************************************************************************************
+* @param [in] latitude_: latitude of the position;
+* @param [in] deltaLongitude_: longitude of the meridian minus longitude of the position (0 to 360 degrees).
+************************************************************************************************************************
+* @return Distance in meters.
+************************************************************************************************************************
+**/
+static double geohash36_index_getMeridianDistance(double latitude_, double deltaLongitude_)
+{
+   deltaLongitude_ = (deltaLongitude_ > 180.0) ? (360.0 - deltaLongitude_) : deltaLongitude_;
+
+   // Beyond 90 degrees the closest point of the meridian is a pole
+   if (deltaLongitude_ >= 90.0)
+      return EARTH_RADIUS_IN_METERS * GEOHASH36_RADIANS(90.0 - fabs(latitude_));
+
+   return EARTH_RADIUS_IN_METERS *
+          asin(sin(GEOHASH36_RADIANS(deltaLongitude_)) * cos(GEOHASH36_RADIANS(latitude_)));
+}
+
+/*!
+************************************************************************************************************************
+* @brief Checks if a cell is too far to hold an entry nearer than the current k-th one (latitude difference first,
+*        then the exact distance lower bound).
+************************************************************************************************************************
+* @param [in] search_: search;
+* @param [in] bounds_: bounds of the cell.
+************************************************************************************************************************
+* @return 1 or 0.
+************************************************************************************************************************
+**/
+static int geohash36_index_isFarther(const geohash36_index_nearest_t * search_, const geohash36_bounds_t * bounds_)
+{
+   double gap;
+
+   if (search_->count < search_->k)
+      return 0;
+
+   gap = MAX(bounds_->minLatitude - search_->latitude, search_->latitude - bounds_->maxLatitude);
+
+   if ((gap > 0) && (EARTH_RADIUS_IN_METERS * GEOHASH36_RADIANS(gap) >= search_->heap[0].distance))
+      return 1;
+
+   return geohash36_getMinDistanceInMeters(search_->latitude, search_->longitude, bounds_) >= search_->heap[0].distance;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Visits the entries of a cell for the nearest neighbor search, unless the cell is too far. Cells with many
+*        entries are split, and their non-empty children visited nearest first.
+************************************************************************************************************************
+* @param [in] index_: pointer to the index;
+* @param [in] search_: search;
+* @param [in] cell_: cell;
+* @param [in] bounds_: bounds of the cell;
+* @param [in] key_: key of the cell;
+* @param [in] first_, last_: range of the main array holding the keys starting with the cell key.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_index_scanNearest(const geohash36_index_t * index_, geohash36_index_nearest_t * search_,
+                                        const geohash36_cell_t * cell_, const geohash36_bounds_t * bounds_,
+                                        geohash36_key_t key_, size_t first_, size_t last_)
+{
+   geohash36_cell_t children[GEOHASH_MATRIX_SIDE * GEOHASH_MATRIX_SIDE];
+   geohash36_bounds_t bounds[GEOHASH_MATRIX_SIDE * GEOHASH_MATRIX_SIDE];
+   geohash36_key_t keys[GEOHASH_MATRIX_SIDE * GEOHASH_MATRIX_SIDE];
+   double distances[GEOHASH_MATRIX_SIDE * GEOHASH_MATRIX_SIDE];
+   size_t firsts[GEOHASH_MATRIX_SIDE * GEOHASH_MATRIX_SIDE], lasts[GEOHASH_MATRIX_SIDE * GEOHASH_MATRIX_SIDE];
+   geohash36_cell_t child;
+   geohash36_bounds_t childBounds;
+   geohash36_key_t childKey;
+   size_t childFirst, childLast, visited = 0;
+   double distance;
+   int stop = 0;
+   int i, j, numChildren = 0;
+
+   if (geohash36_index_isFarther(search_, bounds_))
+      return;
+
+   if ((cell_->numCharacters == GEOHASH36_KEY_MAX_CHARACTERS) ||
+       ((last_ - first_) + geohash36_index_countBuffers(index_, key_) <= GEOHASH36_INDEX_NEAREST_SPLIT))
+   {
+      for (; first_ < last_; first_++)
+         geohash36_index_keepNearest(&index_->entries[first_], search_);
+
+      geohash36_index_scanBuffers(index_, key_, geohash36_keyRangeEnd(key_), NULL, geohash36_index_keepNearest,
+                                  search_, &visited, &stop);
+      return;
+   }
+
+   // Entries equal to the cell key come first in the range
+   for (; (first_ < last_) && (index_->entries[first_].key == key_); first_++)
+      geohash36_index_keepNearest(&index_->entries[first_], search_);
+
+   geohash36_index_scanBuffers(index_, key_, key_, NULL, geohash36_index_keepNearest, search_, &visited, &stop);
+
+   // Non-empty children in key order (consecutive ranges), sorted by distance (insertion sort)
+   child.numCharacters = cell_->numCharacters + 1;
+
+   for (i = 0, childLast = first_; i < (GEOHASH_MATRIX_SIDE * GEOHASH_MATRIX_SIDE); i++)
+   {
+      child.latIndex = (cell_->latIndex * GEOHASH_MATRIX_SIDE) + GEOHASH_MATRIX_SIDE - 1 -
+                       (uint64_t)(base36_rank_position[i] / GEOHASH_MATRIX_SIDE);
+      child.lonIndex = (cell_->lonIndex * GEOHASH_MATRIX_SIDE) +
+                       (uint64_t)(base36_rank_position[i] % GEOHASH_MATRIX_SIDE);
+      childKey = (key_ & ~GEOHASH36_KEY_LENGTH_MASK) | (geohash36_key_t)child.numCharacters |
+                 ((geohash36_key_t)i << (GEOHASH36_KEY_FIRST_CHAR_SHIFT -
+                                         (cell_->numCharacters * GEOHASH36_KEY_CHAR_BITS)));
+      childFirst = childLast;
+      childLast = childFirst + geohash36_index_lowerBound(index_->entries + childFirst, last_ - childFirst,
+                                                          geohash36_keyRangeEnd(childKey));
+
+      if ((childFirst == childLast) && (geohash36_index_countBuffers(index_, childKey) == 0))
+         continue;
+
+      // Distance to the position clamped to the cell: close to the lower bound, for a fraction of its cost
+      geohash36_getCellBounds(&child, &childBounds);
+      distance = geohash36_getDistanceInMeters(search_->latitude, search_->longitude,
+                                               MIN(MAX(search_->latitude, childBounds.minLatitude),
+                                                   childBounds.maxLatitude),
+                                               MIN(MAX(search_->longitude, childBounds.minLongitude),
+                                                   childBounds.maxLongitude));
+
+      for (j = numChildren++; (j > 0) && (distances[j - 1] > distance); j--)
+      {
+         children[j] = children[j - 1];
+         bounds[j] = bounds[j - 1];
+         keys[j] = keys[j - 1];
+         distances[j] = distances[j - 1];
+         firsts[j] = firsts[j - 1];
+         lasts[j] = lasts[j - 1];
+      }
+
+      children[j] = child;
+      bounds[j] = childBounds;
+      keys[j] = childKey;
+      distances[j] = distance;
+      firsts[j] = childFirst;
+      lasts[j] = childLast;
+   }
+
+   for (i = 0; i < numChildren; i++)
+      geohash36_index_scanNearest(index_, search_, &children[i], &bounds[i], keys[i], firsts[i], lasts[i]);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Visits a cell of a ring for the nearest neighbor search: its entries, and the entries with shorter keys whose
+*        center is in this cell (each shorter key has its center in exactly one cell of the ring length).
+************************************************************************************************************************
+* @param [in] index_: pointer to the index;
+* @param [in] search_: search;
+* @param [in] cell_: cell.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_index_scanRingCell(const geohash36_index_t * index_, geohash36_index_nearest_t * search_,
+                                         const geohash36_cell_t * cell_)
+{
+   geohash36_bounds_t bounds;
+   geohash36_key_t key, ancestor;
+   uint64_t size;
+   size_t visited = 0;
+   int stop = 0;
+   int length;
+
+   if ((geohash36_getCellBounds(cell_, &bounds) != 0) || geohash36_index_isFarther(search_, &bounds))
+      return;
+
+   key = geohash36_cellToKey(cell_);
+
+   for (length = 1; length < cell_->numCharacters; length++)
+   {
+      size = geohash36_pow6[cell_->numCharacters - length];
+
+      if (((cell_->latIndex % size) == (size / 2)) && ((cell_->lonIndex % size) == (size / 2)))
+      {
+         ancestor = geohash36_keyTruncate(key, length);
+         geohash36_index_scanAll(index_, ancestor, ancestor, NULL, geohash36_index_keepNearest, search_, &visited,
+                                 &stop);
+      }
+   }
+
+   geohash36_index_scanNearest(index_, search_, cell_, &bounds, key,
+                               geohash36_index_lowerBound(index_->entries, index_->numEntries, key),
+                               geohash36_index_lowerBound(index_->entries, index_->numEntries,
+                                                          geohash36_keyRangeEnd(key)));
+}
+
+/***********************************************************************************************************************
+External functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Initializes an empty index.
+************************************************************************************************************************
+* @param [out] index_: pointer to the index.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input or allocation failure.
+************************************************************************************************************************
+**/
+int geohash36_index_init(geohash36_index_t * index_)
+{
+   if (index_ == NULL)
+      return -1;
+
+   memset(index_, 0, sizeof(geohash36_index_t));
+
+   index_->delta = malloc(GEOHASH36_INDEX_DELTA_CAPACITY * sizeof(geohash36_entry_t));
+   if (index_->delta == NULL)
+      return -1;
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Releases the memory of an index (waiting for a running merge).
+************************************************************************************************************************
+* @param [in] index_: pointer to the index.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+void geohash36_index_free(geohash36_index_t * index_)
+{
+   if (index_ == NULL)
+      return;
+
+   geohash36_index_finishMerge(index_);
+
+   free(index_->entries);
+   free(index_->run);
+   free(index_->delta);
+   memset(index_, 0, sizeof(geohash36_index_t));
+}
+
+/*!
+************************************************************************************************************************
+* @brief Replaces the content of an index, sorting the entries with a LSD radix sort (stable: equal keys keep the
+*        input order).
+************************************************************************************************************************
+* @param [in] index_: pointer to the index;
+* @param [in] keys_: array of keys;
+* @param [in] ids_: array of object IDs;
+* @param [in] n_: number of entries.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input or allocation failure.
+************************************************************************************************************************
+**/
+int geohash36_index_build(geohash36_index_t * index_, const geohash36_key_t * keys_, const uint64_t * ids_,
+                          size_t n_)
+{
+   geohash36_entry_t * entries;
+   geohash36_entry_t * buffer;
+   geohash36_entry_t * sorted;
+   size_t i;
+
+   if ((index_ == NULL) || (index_->delta == NULL) || ((n_ > 0) && ((keys_ == NULL) || (ids_ == NULL))))
+      return -1;
+
+   entries = malloc((n_ + 1) * sizeof(geohash36_entry_t));
+   buffer = malloc((n_ + 1) * sizeof(geohash36_entry_t));
+
+   if ((entries == NULL) || (buffer == NULL))
+   {
+      free(entries);
+      free(buffer);
+      return -1;
+   }
+
+   for (i = 0; i < n_; i++)
+   {
+      entries[i].key = keys_[i];
+      entries[i].id = ids_[i];
+   }
+
+   sorted = (n_ > 0) ? geohash36_index_radixSort(entries, buffer, n_) : entries;
+   if (sorted == NULL)
+   {
+      free(entries);
+      free(buffer);
+      return -1;
+   }
+
+   free((sorted == entries) ? buffer : entries);
+
+   geohash36_index_finishMerge(index_);
+   free(index_->entries);
+   free(index_->run);
+
+   index_->entries = sorted;
+   index_->numEntries = n_;
+   index_->run = NULL;
+   index_->numRun = 0;
+   index_->numDelta = 0;
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Inserts an entry (in the delta buffer, which is merged in the background when full).
+************************************************************************************************************************
+* @param [in] index_: pointer to the index;
+* @param [in] key_: key of the entry;
+* @param [in] id_: object ID of the entry.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input or allocation failure.
+************************************************************************************************************************
+**/
+int geohash36_index_insert(geohash36_index_t * index_, geohash36_key_t key_, uint64_t id_)
+{
+   size_t position;
+
+   if ((index_ == NULL) || (index_->delta == NULL))
+      return -1;
+
+   if (index_->merging && __atomic_load_n(&index_->mergeDone, __ATOMIC_ACQUIRE))
+      geohash36_index_finishMerge(index_);
+
+   if ((index_->numDelta == GEOHASH36_INDEX_DELTA_CAPACITY) && (geohash36_index_mergeDelta(index_) != 0))
+      return -1;
+
+   // Upper bound keeps equal keys in insertion order
+   position = geohash36_index_lowerBound(index_->delta, index_->numDelta, key_);
+   while ((position < index_->numDelta) && (index_->delta[position].key == key_))
+      position++;
+
+   memmove(index_->delta + position + 1, index_->delta + position,
+           (index_->numDelta - position) * sizeof(geohash36_entry_t));
+
+   index_->delta[position].key = key_;
+   index_->delta[position].id = id_;
+   index_->numDelta++;
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Waits for a running merge and merges the delta buffer, so that every entry is in the sorted main array.
+************************************************************************************************************************
+* @param [in] index_: pointer to the index.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input or allocation failure.
+************************************************************************************************************************
+**/
+int geohash36_index_flush(geohash36_index_t * index_)
+{
+   if ((index_ == NULL) || (index_->delta == NULL))
+      return -1;
+
+   if ((index_->numDelta > 0) && (geohash36_index_mergeDelta(index_) != 0))
+      return -1;
+
+   if ((index_->numRun > 0) && (geohash36_index_startMerge(index_) != 0))
+      return -1;
+
+   geohash36_index_finishMerge(index_);
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Gets the number of entries of an index.
+************************************************************************************************************************
+* @param [in] index_: pointer to the index.
+************************************************************************************************************************
+* @return Number of entries.
+************************************************************************************************************************
+**/
+size_t geohash36_index_size(const geohash36_index_t * index_)
+{
+   if (index_ == NULL)
+      return 0;
+
+   return index_->numEntries + index_->numFrozen + index_->numRun + index_->numDelta;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Visits every entry whose key starts with a prefix (sorted within the main array and within the buffers).
+************************************************************************************************************************
+* @param [in] index_: pointer to the index;
+* @param [in] prefix_: key of the prefix;
+* @param [in] callback_: function called for each entry found;
+* @param [in] context_: pointer given to the callback.
+************************************************************************************************************************
+* @return Number of entries visited.
+************************************************************************************************************************
+**/
+size_t geohash36_index_queryPrefix(const geohash36_index_t * index_, geohash36_key_t prefix_,
+                                   geohash36_index_callback_t callback_, void * context_)
+{
+   size_t visited = 0;
+   int stop = 0;
+
+   if ((index_ == NULL) || !geohash36_keyIsValid(prefix_))
+      return 0;
+
+   geohash36_index_scanAll(index_, prefix_, geohash36_keyRangeEnd(prefix_), NULL, callback_, context_, &visited,
+                           &stop);
+
+   return visited;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Visits every entry whose cell center is inside a box, scanning the prefix ranges of a cell cover (and the
+*        shorter keys equal to the prefixes of the cover cells).
+************************************************************************************************************************
+* @param [in] index_: pointer to the index;
+* @param [in] bounds_: box ("minLongitude" > "maxLongitude" crosses the antimeridian);
+* @param [in] callback_: function called for each entry found;
+* @param [in] context_: pointer given to the callback.
+************************************************************************************************************************
+* @return Number of entries visited, or -1 for invalid input.
+************************************************************************************************************************
+**/
+long geohash36_index_queryBounds(const geohash36_index_t * index_, const geohash36_bounds_t * bounds_,
+                                 geohash36_index_callback_t callback_, void * context_)
+{
+   geohash36_key_t cover[GEOHASH36_INDEX_COVER_CELLS];
+   geohash36_key_t parents[GEOHASH36_INDEX_COVER_CELLS * GEOHASH36_KEY_MAX_CHARACTERS];
+   geohash36_cell_t cell;
+   geohash36_bounds_t cellBounds;
+   const geohash36_bounds_t * filter;
+   size_t visited = 0;
+   int stop = 0;
+   int numCells, numParents, i, length, inLongitude;
+
+   if (index_ == NULL)
+      return -1;
+
+   numCells = geohash36_coverBounds(bounds_, GEOHASH36_KEY_MAX_CHARACTERS, cover, GEOHASH36_INDEX_COVER_CELLS);
+   if (numCells < 0)
+      return -1;
+
+   for (i = 0; (i < numCells) && !stop; i++)
+   {
+      // Cells inside the box need no check of their entries
+      filter = bounds_;
+
+      if ((geohash36_keyToCell(cover[i], &cell) == 0) && (geohash36_getCellBounds(&cell, &cellBounds) == 0))
+      {
+         if (bounds_->minLongitude <= bounds_->maxLongitude)
+            inLongitude = (cellBounds.minLongitude >= bounds_->minLongitude) &&
+                          (cellBounds.maxLongitude <= bounds_->maxLongitude);
+         else
+            inLongitude = (cellBounds.minLongitude >= bounds_->minLongitude) ||
+                          (cellBounds.maxLongitude <= bounds_->maxLongitude);
+
+         if (inLongitude && (cellBounds.minLatitude >= bounds_->minLatitude) &&
+             (cellBounds.maxLatitude <= bounds_->maxLatitude))
+            filter = NULL;
+      }
+
+      geohash36_index_scanAll(index_, cover[i], geohash36_keyRangeEnd(cover[i]), filter, callback_, context_,
+                              &visited, &stop);
+   }
+
+   // Entries with shorter keys contain whole cover cells: each distinct prefix is an exact key lookup
+   for (i = 0, numParents = 0; i < numCells; i++)
+   {
+      for (length = 1; length < GEOHASH36_KEY_LENGTH(cover[i]); length++)
+         parents[numParents++] = geohash36_keyTruncate(cover[i], length);
+   }
+
+   qsort(parents, numParents, sizeof(geohash36_key_t), geohash36_index_compareKeys);
+
+   for (i = 0; (i < numParents) && !stop; i++)
+   {
+      if ((i == 0) || (parents[i] != parents[i - 1]))
+         geohash36_index_scanAll(index_, parents[i], parents[i], bounds_, callback_, context_, &visited, &stop);
+   }
+
+   return (long)visited;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Finds the "k_" entries nearest to a position (great-circle distance to their cell centers).
+*
+* The search starts at the longest cell around the position holding at least "k_" entries and expands in rings of
+* neighbor cells. Cells whose distance lower bound exceeds the current k-th distance are skipped, and the search stops
+* once the area left outside the rings is farther than it. Nothing is allocated.
+************************************************************************************************************************
+* @param [in] index_: pointer to the index;
+* @param [in] latitude_, longitude_: position;
+* @param [in] k_: number of entries desired;
+* @param [out] outNeighbors_: array of "k_" neighbors which will receive the result, nearest first.
+************************************************************************************************************************
+* @return Number of neighbors found (less than "k_" when the index is smaller), or -1 for invalid input.
+************************************************************************************************************************
+**/
+long geohash36_index_queryNearest(const geohash36_index_t * index_, double latitude_, double longitude_, size_t k_,
+                                  geohash36_index_neighbor_t * outNeighbors_)
+{
+   geohash36_index_nearest_t search;
+   geohash36_index_neighbor_t neighbor;
+   geohash36_cell_t center, cell;
+   geohash36_key_t key, prefix;
+   int64_t numCells, ring, row, column, step, west, east;
+   double limit, height, width;
+   int length;
+   size_t first, last, end;
+
+   if ((index_ == NULL) || ((outNeighbors_ == NULL) && (k_ > 0)) || !(latitude_ >= -90.0) || !(latitude_ <= 90.0) ||
+       !(longitude_ >= -180.0) || !(longitude_ <= 180.0))
+      return -1;
+
+   if ((k_ == 0) || (geohash36_index_size(index_) == 0))
+      return 0;
+
+   search.latitude = latitude_;
+   search.longitude = longitude_;
+   search.heap = outNeighbors_;
+   search.k = k_;
+   search.count = 0;
+
+   key = geohash36_encodeKey(latitude_, longitude_, GEOHASH36_KEY_MAX_CHARACTERS);
+
+   // Starting cell: the longest one around the position which holds "k_" entries (each range is inside the last one)
+   for (length = 1, first = 0, last = index_->numEntries; length < GEOHASH36_KEY_MAX_CHARACTERS; length++)
+   {
+      prefix = geohash36_keyTruncate(key, length + 1);
+      first += geohash36_index_lowerBound(index_->entries + first, last - first, prefix);
+      last = first + geohash36_index_lowerBound(index_->entries + first, last - first, geohash36_keyRangeEnd(prefix));
+
+      if ((last - first) + geohash36_index_countBuffers(index_, prefix) < k_)
+         break;
+   }
+
+   if (geohash36_encodeCell(latitude_, longitude_, length, &center) != 0)
+      return -1;
+
+   numCells = (int64_t)geohash36_pow6[length];
+   height = 180.0 / (double)numCells;
+   width = 360.0 / (double)numCells;
+
+   for (ring = 0; ; ring++)
+   {
+      // Columns of the rings, without going around the globe twice
+      west = MIN(ring, (numCells - 1) / 2);
+      east = MIN(ring, numCells - 1 - west);
+
+      for (row = -ring; row <= ring; row++)
+      {
+         // Rows inside the ring only have its two end columns
+         step = ((row == -ring) || (row == ring)) ? 1 : (2 * ring);
+
+         for (column = -ring; column <= ring; column += step)
+         {
+            if ((column >= -west) && (column <= east) &&
+                (geohash36_getCellNeighbor(&center, row, column, &cell) == 0))
+               geohash36_index_scanRingCell(index_, &search, &cell);
+         }
+      }
+
+      // Distance lower bound of everything outside the rings (whose sides are parallels and meridians)
+      limit = HUGE_VAL;
+
+      if ((int64_t)center.latIndex + ring + 1 < numCells)
+         limit = MIN(limit, EARTH_RADIUS_IN_METERS *
+                            GEOHASH36_RADIANS(-90.0 + ((double)((int64_t)center.latIndex + ring + 1) * height) -
+                                              latitude_));
+
+      if ((int64_t)center.latIndex - ring > 0)
+         limit = MIN(limit, EARTH_RADIUS_IN_METERS *
+                            GEOHASH36_RADIANS(latitude_ -
+                                              (-90.0 + ((double)((int64_t)center.latIndex - ring) * height))));
+
+      if (west + east + 1 < numCells)
+      {
+         limit = MIN(limit, geohash36_index_getMeridianDistance(latitude_, longitude_ -
+                            (-180.0 + ((double)((int64_t)center.lonIndex - west) * width))));
+         limit = MIN(limit, geohash36_index_getMeridianDistance(latitude_,
+                            (-180.0 + ((double)((int64_t)center.lonIndex + east + 1) * width)) - longitude_));
+      }
+
+      if ((limit == HUGE_VAL) || ((search.count == k_) && (limit >= search.heap[0].distance)))
+         break;
+   }
+
+   // Heap sort, nearest first
+   for (end = search.count; end > 1; end--)
+   {
+      neighbor = outNeighbors_[0];
+      outNeighbors_[0] = outNeighbors_[end - 1];
+      outNeighbors_[end - 1] = neighbor;
+      geohash36_index_siftDown(outNeighbors_, end - 1, 0);
+   }
+
+   return (long)search.count;
+}
@@ -0,0 +1,235 @@
+#ifndef _GEOHASH36_INDEX_H_
+#define _GEOHASH36_INDEX_H_
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include <pthread.h>
+#include "stddef.h"
+#include "geohash36.h"
+
+/***********************************************************************************************************************
+Defines/macros
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Number of inserted entries kept in the delta buffer before it is merged into the run.
+************************************************************************************************************************
+**/
+#define GEOHASH36_INDEX_DELTA_CAPACITY       1024
+
+/*!
+************************************************************************************************************************
+* @brief Number of cells used to cover the box of a geohash36_index_queryBounds.
+************************************************************************************************************************
+**/
+#define GEOHASH36_INDEX_COVER_CELLS          32
+
+/***********************************************************************************************************************
+Typedefs/structs/unions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Entry of the index: packed key and object ID.
+************************************************************************************************************************
+**/
+typedef struct
+{
+   geohash36_key_t key;
+   uint64_t id;
+
+}geohash36_entry_t;
+
+/*!
+************************************************************************************************************************
+* @brief Callback called for each entry found by a query.
+************************************************************************************************************************
+* @param [in] entry_: entry found;
+* @param [in] context_: pointer given to the query.
+************************************************************************************************************************
+* @return 0 to continue the query, any other value to stop it.
+************************************************************************************************************************
+**/
+typedef int (*geohash36_index_callback_t)(const geohash36_entry_t * entry_, void * context_);
+
+/*!
+************************************************************************************************************************
+* @brief Entry found by geohash36_index_queryNearest and its distance to the query position.
+************************************************************************************************************************
+**/
+typedef struct
+{
+   geohash36_entry_t entry;
+   double distance;
+
+}geohash36_index_neighbor_t;
+
+/*!
+************************************************************************************************************************
+* @brief In-memory spatial index: entries sorted by key in a flat array, plus a small sorted delta buffer for inserts.
+*
+* A full delta buffer is merged into a sorted run. Once the run is big enough, it is frozen and merged with the main
+* array by a background thread, while new inserts keep going to the delta buffer. The index has a single owner:
+* inserts/builds must not run concurrently with anything else, but queries can run from several threads at once (the
+* merge thread only reads frozen arrays).
+************************************************************************************************************************
+**/
+typedef struct
+{
+   geohash36_entry_t * entries;
+   size_t numEntries;
+
+   geohash36_entry_t * delta;
+   size_t numDelta;
+
+   geohash36_entry_t * run;
+   size_t numRun;
+
+   geohash36_entry_t * frozen;
+   size_t numFrozen;
+
+   geohash36_entry_t * merged;
+   pthread_t mergeThread;
+   int merging;
+   int mergeDone;
+
+}geohash36_index_t;
+
+/***********************************************************************************************************************
+Exported functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Initializes an empty index.
+************************************************************************************************************************
+* @param [out] index_: pointer to the index.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input or allocation failure.
+************************************************************************************************************************
+**/
+int geohash36_index_init(geohash36_index_t * index_);
+
+/*!
+************************************************************************************************************************
+* @brief Releases the memory of an index (waiting for a running merge).
+************************************************************************************************************************
+* @param [in] index_: pointer to the index.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+void geohash36_index_free(geohash36_index_t * index_);
+
+/*!
+************************************************************************************************************************
+* @brief Replaces the content of an index, sorting the entries with a LSD radix sort (stable: equal keys keep the
+*        input order).
+************************************************************************************************************************
+* @param [in] index_: pointer to the index;
+* @param [in] keys_: array of keys;
+* @param [in] ids_: array of object IDs;
+* @param [in] n_: number of entries.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input or allocation failure.
+************************************************************************************************************************
+**/
+int geohash36_index_build(geohash36_index_t * index_, const geohash36_key_t * keys_, const uint64_t * ids_,
+                          size_t n_);
+
+/*!
+************************************************************************************************************************
+* @brief Inserts an entry (in the delta buffer, which is merged in the background when full).
+************************************************************************************************************************
+* @param [in] index_: pointer to the index;
+* @param [in] key_: key of the entry;
+* @param [in] id_: object ID of the entry.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input or allocation failure.
+************************************************************************************************************************
+**/
+int geohash36_index_insert(geohash36_index_t * index_, geohash36_key_t key_, uint64_t id_);
+
+/*!
+************************************************************************************************************************
+* @brief Waits for a running merge and merges the delta buffer, so that every entry is in the sorted main array.
+************************************************************************************************************************
+* @param [in] index_: pointer to the index.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input or allocation failure.
+************************************************************************************************************************
+**/
+int geohash36_index_flush(geohash36_index_t * index_);
+
+/*!
+************************************************************************************************************************
+* @brief Gets the number of entries of an index.
+************************************************************************************************************************
+* @param [in] index_: pointer to the index.
+************************************************************************************************************************
+* @return Number of entries.
+************************************************************************************************************************
+**/
+size_t geohash36_index_size(const geohash36_index_t * index_);
+
+/*!
+************************************************************************************************************************
+* @brief Visits every entry whose key starts with a prefix (sorted within the main array and within the buffers).
+************************************************************************************************************************
+* @param [in] index_: pointer to the index;
+* @param [in] prefix_: key of the prefix;
+* @param [in] callback_: function called for each entry found;
+* @param [in] context_: pointer given to the callback.
+************************************************************************************************************************
+* @return Number of entries visited.
+************************************************************************************************************************
+**/
+size_t geohash36_index_queryPrefix(const geohash36_index_t * index_, geohash36_key_t prefix_,
+                                   geohash36_index_callback_t callback_, void * context_);
+
+/*!
+************************************************************************************************************************
+* @brief Visits every entry whose cell center is inside a box, scanning the prefix ranges of a cell cover (and the
+*        shorter keys equal to the prefixes of the cover cells).
+************************************************************************************************************************
+* @param [in] index_: pointer to the index;
+* @param [in] bounds_: box ("minLongitude" > "maxLongitude" crosses the antimeridian);
+* @param [in] callback_: function called for each entry found;
+* @param [in] context_: pointer given to the callback.
+************************************************************************************************************************
+* @return Number of entries visited, or -1 for invalid input.
+************************************************************************************************************************
+**/
+long geohash36_index_queryBounds(const geohash36_index_t * index_, const geohash36_bounds_t * bounds_,
+                                 geohash36_index_callback_t callback_, void * context_);
+
+/*!
+************************************************************************************************************************
+* @brief Finds the "k_" entries nearest to a position (great-circle distance to their cell centers).
+*
+* The search starts at the longest cell around the position holding at least "k_" entries and expands in rings of
+* neighbor cells. Cells whose distance lower bound exceeds the current k-th distance are skipped, and the search stops
+* once the area left outside the rings is farther than it. Nothing is allocated.
+************************************************************************************************************************
+* @param [in] index_: pointer to the index;
+* @param [in] latitude_, longitude_: position;
+* @param [in] k_: number of entries desired;
+* @param [out] outNeighbors_: array of "k_" neighbors which will receive the result, nearest first.
+************************************************************************************************************************
+* @return Number of neighbors found (less than "k_" when the index is smaller), or -1 for invalid input.
+************************************************************************************************************************
+**/
+long geohash36_index_queryNearest(const geohash36_index_t * index_, double latitude_, double longitude_, size_t k_,
+                                  geohash36_index_neighbor_t * outNeighbors_);
+
+#endif // _GEOHASH36_INDEX_H_
@@ -0,0 +1,109 @@
+#ifndef _GEOHASH36_INTERNAL_H_
+#define _GEOHASH36_INTERNAL_H_
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "geohash36.h"
+
+/***********************************************************************************************************************
+Defines/macros
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Defines the side size of base36 matrix.
+************************************************************************************************************************
+**/
+#define GEOHASH_MATRIX_SIDE                  6
+
+/*!
+************************************************************************************************************************
+* @brief Defines the Earth radius in meters.
+************************************************************************************************************************
+**/
+#ifndef EARTH_RADIUS_IN_METERS
+#define EARTH_RADIUS_IN_METERS               6370000
+#endif
+
+/*!
+************************************************************************************************************************
+* @brief Defines PI constant.
+************************************************************************************************************************
+**/
+#ifndef PI
+#define PI                                   3.14159265358979323846f
+#endif
+
+/*!
+************************************************************************************************************************
+* @brief Degrees to radians.
+************************************************************************************************************************
+**/
+#define GEOHASH36_RADIANS(degrees)           ((degrees) * (3.14159265358979323846 / 180.0))
+
+/*!
+************************************************************************************************************************
+* @brief Bits used by each character in a packed key and the position of its first character.
+************************************************************************************************************************
+**/
+#define GEOHASH36_KEY_CHAR_BITS              6
+#define GEOHASH36_KEY_FIRST_CHAR_SHIFT       58
+#define GEOHASH36_KEY_CHAR_MASK              0x3FULL
+#define GEOHASH36_KEY_LENGTH_MASK            0x0FULL
+
+/***********************************************************************************************************************
+Constants
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Base36 matrix (rows from north to south, columns from west to east).
+************************************************************************************************************************
+**/
+extern const char base36[GEOHASH_MATRIX_SIDE][GEOHASH_MATRIX_SIDE];
+
+/*!
+************************************************************************************************************************
+* @brief Line (high nibble) and column (low nibble) of each character in base36[][], 0xFF for invalid characters.
+************************************************************************************************************************
+**/
+extern const uint8_t base36_index[256];
+
+/*!
+************************************************************************************************************************
+* @brief Rank in ASCII order of each base36[][] character, and the base36[][] position of each rank.
+************************************************************************************************************************
+**/
+extern const uint8_t base36_rank[GEOHASH_MATRIX_SIDE * GEOHASH_MATRIX_SIDE];
+extern const uint8_t base36_rank_position[GEOHASH_MATRIX_SIDE * GEOHASH_MATRIX_SIDE];
+
+/*!
+************************************************************************************************************************
+* @brief Powers of 6 (number of rows/columns of the grid for each length).
+************************************************************************************************************************
+**/
+extern const uint64_t geohash36_pow6[GEOHASH36_MAX_CELL_CHARACTERS + 1];
+
+/***********************************************************************************************************************
+Internal functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Converts a position inside the grid (in cells) to the index of the cell which contains it.
+*
+* Every encoder (scalar or vectorized) must follow these exact steps so that all of them produce the same hashes.
+* The position must be computed as ((coordinate + 90 or 180) * numCells) / (180 or 360): a multiply by a rounded
+* numCells / 180 moves coordinates which are exactly on a cell edge to the next cell.
+************************************************************************************************************************
+* @param [in] position_: position in cells, from 0 to "numCells_";
+* @param [in] numCells_: number of cells in this axis;
+* @param [out] remainder_: optional pointer which will store the position inside the cell, from 0 to 1.
+************************************************************************************************************************
+* @return Cell index.
+************************************************************************************************************************
+**/
+uint64_t geohash36_quantize(double position_, uint64_t numCells_, double * remainder_);
+
+#endif // _GEOHASH36_INTERNAL_H_
@@ -0,0 +1,496 @@
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include <math.h>
+#include <stdlib.h>
+#include "geohash36_join.h"
+#include "geohash36_index.h"
+#include "geohash36_cover.h"
+#include "geohash36_internal.h"
+
+/***********************************************************************************************************************
+Defines/macros
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Minimum number of slots of the cell table.
+************************************************************************************************************************
+**/
+#define GEOHASH36_JOIN_MIN_SLOTS             1024
+
+/***********************************************************************************************************************
+Typedefs/structs/unions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Cell of the second set: key (GEOHASH36_KEY_INVALID for empty slots) and first entry.
+************************************************************************************************************************
+**/
+typedef struct
+{
+   geohash36_key_t key;
+   size_t first;
+
+}geohash36_join_cell_t;
+
+/*!
+************************************************************************************************************************
+* @brief Position of a point, copied in key order so that the cells are read sequentially.
+************************************************************************************************************************
+**/
+typedef struct
+{
+   double latitude;
+   double longitude;
+
+}geohash36_join_point_t;
+
+/*!
+************************************************************************************************************************
+* @brief Join being run: both sets sorted by key (entry IDs are the positions in the sets) and the pair filter.
+************************************************************************************************************************
+**/
+typedef struct
+{
+   const geohash36_entry_t * first;
+   size_t numFirst;
+   const geohash36_entry_t * second;
+   size_t numSecond;
+   const geohash36_join_cell_t * cells;
+   size_t numSlots;
+   size_t numCells;
+
+   const geohash36_join_point_t * points1;
+   const geohash36_join_point_t * points2;
+
+   double distance;
+   double angle;
+   geohash36_join_callback_t callback;
+   void * context;
+
+   long numPairs;
+   int stop;
+
+}geohash36_join_t;
+
+/***********************************************************************************************************************
+Internal functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Sorts a set of points by key at the given length.
+************************************************************************************************************************
+* @param [in] pool_: pool encoding the keys (can be NULL);
+* @param [in] lat_, lon_: positions;
+* @param [in] n_: number of points;
+* @param [in] numCharacters_: key length;
+* @param [out] outIndex_: index which will receive the keys, with the positions as IDs;
+* @param [out] outPoints_: pointer which will receive the positions in key order (to be released with free).
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Allocation failure.
+************************************************************************************************************************
+**/
+static int geohash36_join_sort(geohash36_pool_t * pool_, const double * lat_, const double * lon_, size_t n_,
+                               int numCharacters_, geohash36_index_t * outIndex_, geohash36_join_point_t ** outPoints_)
+{
+   geohash36_key_t * keys;
+   uint64_t * ids;
+   size_t i;
+   int result = -1;
+
+   *outPoints_ = NULL;
+
+   if (geohash36_index_init(outIndex_) != 0)
+      return -1;
+
+   keys = malloc((n_ + 1) * sizeof(geohash36_key_t));
+   ids = malloc((n_ + 1) * sizeof(uint64_t));
+
+   if ((keys != NULL) && (ids != NULL))
+   {
+      for (i = 0; i < n_; i++)
+         ids[i] = i;
+
+      if (((pool_ != NULL) ? geohash36_pool_encodeKey(pool_, lat_, lon_, n_, keys, numCharacters_) :
+                             geohash36_encodeKey_batch(lat_, lon_, n_, keys, numCharacters_)) == 0)
+         result = geohash36_index_build(outIndex_, keys, ids, n_);
+   }
+
+   free(keys);
+   free(ids);
+
+   if (result == 0)
+   {
+      *outPoints_ = malloc((n_ + 1) * sizeof(geohash36_join_point_t));
+
+      if (*outPoints_ == NULL)
+         return -1;
+
+      for (i = 0; i < n_; i++)
+      {
+         (*outPoints_)[i].latitude = lat_[outIndex_->entries[i].id];
+         (*outPoints_)[i].longitude = lon_[outIndex_->entries[i].id];
+      }
+   }
+
+   return result;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Builds the cell table of the second set, so that each neighbor cell costs one probe instead of a binary search.
+************************************************************************************************************************
+* @param [in] entries_: sorted entries of the second set;
+* @param [in] n_: number of entries;
+* @param [out] outNumSlots_: number of slots of the table;
+* @param [out] outNumCells_: number of cells of the second set.
+************************************************************************************************************************
+* @return Table, or NULL for allocation failure.
+************************************************************************************************************************
+**/
+static geohash36_join_cell_t * geohash36_join_buildCells(const geohash36_entry_t * entries_, size_t n_,
+                                                         size_t * outNumSlots_, size_t * outNumCells_)
+{
+   geohash36_join_cell_t * cells;
+   size_t numCells = 0, numSlots = GEOHASH36_JOIN_MIN_SLOTS;
+   size_t i, position;
+
+   for (i = 0; i < n_; i++)
+      numCells += ((i == 0) || (entries_[i].key != entries_[i - 1].key));
+
+   while (numSlots < 2 * numCells)
+      numSlots *= 2;
+
+   cells = malloc(numSlots * sizeof(geohash36_join_cell_t));
+
+   if (cells == NULL)
+      return NULL;
+
+   for (i = 0; i < numSlots; i++)
+      cells[i].key = GEOHASH36_KEY_INVALID;
+
+   for (i = 0; i < n_; i++)
+   {
+      if ((i > 0) && (entries_[i].key == entries_[i - 1].key))
+         continue;
+
+      position = (size_t)((entries_[i].key * 0x9E3779B97F4A7C15ull) >> 32) & (numSlots - 1);
+
+      while (cells[position].key != GEOHASH36_KEY_INVALID)
+         position = (position + 1) & (numSlots - 1);
+
+      cells[position].key = entries_[i].key;
+      cells[position].first = i;
+   }
+
+   *outNumSlots_ = numSlots;
+   *outNumCells_ = numCells;
+
+   return cells;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Gets the first entry of a cell in the second set.
+************************************************************************************************************************
+* @param [in] join_: join;
+* @param [in] key_: key of the cell.
+************************************************************************************************************************
+* @return First entry of the cell, or NULL if the second set has no point in it.
+************************************************************************************************************************
+**/
+static const geohash36_entry_t * geohash36_join_findCell(const geohash36_join_t * join_, geohash36_key_t key_)
+{
+   size_t position = (size_t)((key_ * 0x9E3779B97F4A7C15ull) >> 32) & (join_->numSlots - 1);
+
+   for (; join_->cells[position].key != GEOHASH36_KEY_INVALID; position = (position + 1) & (join_->numSlots - 1))
+   {
+      if (join_->cells[position].key == key_)
+         return &join_->second[join_->cells[position].first];
+   }
+
+   return NULL;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Matches the points of one cell of the first set against the points of one cell of the second set.
+************************************************************************************************************************
+* @param [in] join_: join;
+* @param [in] begin_, end_: entries of the cell in the first set;
+* @param [in] secondBegin_, secondEnd_: entries of the cell in the second set;
+* @param [in,out] numPairs_: number of pairs found.
+************************************************************************************************************************
+* @return 1 if the callback stopped the join, 0 otherwise.
+************************************************************************************************************************
+**/
+static int geohash36_join_matchPoints(geohash36_join_t * join_, size_t begin_, size_t end_, size_t secondBegin_,
+                                      size_t secondEnd_, long * numPairs_)
+{
+   const geohash36_join_point_t * a;
+   const geohash36_join_point_t * b;
+   double distance;
+   size_t i, j;
+
+   for (j = secondBegin_; j < secondEnd_; j++)
+   {
+      b = &join_->points2[j];
+
+      for (i = begin_; i < end_; i++)
+      {
+         a = &join_->points1[i];
+
+         // The great-circle distance is at least the latitude difference
+         if (fabs(a->latitude - b->latitude) > join_->angle)
+            continue;
+
+         distance = geohash36_getDistanceInMeters(a->latitude, a->longitude, b->latitude, b->longitude);
+
+         if (!(distance <= join_->distance))
+            continue;
+
+         (*numPairs_)++;
+
+         if ((join_->callback != NULL) && join_->callback((size_t)join_->first[i].id, (size_t)join_->second[j].id,
+                                                          distance, join_->context))
+         {
+            __atomic_store_n(&join_->stop, 1, __ATOMIC_RELAXED);
+            return 1;
+         }
+      }
+   }
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Matches the points of one cell of the first set against the cells of the second set which can hold points
+*        within the distance.
+************************************************************************************************************************
+* @param [in] join_: join;
+* @param [in] begin_, end_: entries of the cell in the first set;
+* @param [in,out] numPairs_: number of pairs found.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_join_matchCell(geohash36_join_t * join_, size_t begin_, size_t end_, long * numPairs_)
+{
+   geohash36_cell_t cell, neighbor;
+   geohash36_bounds_t bounds;
+   const geohash36_entry_t * second;
+   geohash36_key_t key;
+   int64_t numCells, rows, columns, west, east, row, column;
+   double height, width, latitude, ratio;
+   size_t j, next;
+
+   if ((geohash36_keyToCell(join_->first[begin_].key, &cell) != 0) || (geohash36_getCellBounds(&cell, &bounds) != 0))
+      return;
+
+   numCells = (int64_t)geohash36_pow6[cell.numCharacters];
+   height = 180.0 / (double)numCells;
+   width = 360.0 / (double)numCells;
+
+   // Rows within the distance, and columns within the longitude span of the distance at the latitudes of the cell
+   // (the bounds of the polar rows can round beyond 90 degrees, and every column is in range at the poles)
+   rows = (int64_t)(join_->angle / height) + 1;
+   latitude = MIN(MAX(fabs(bounds.minLatitude), fabs(bounds.maxLatitude)), 90.0);
+   ratio = sin(GEOHASH36_RADIANS(join_->angle)) / cos(GEOHASH36_RADIANS(latitude));
+
+   if ((join_->angle >= 90.0) || !((ratio >= 0.0) && (ratio < 1.0)))
+      columns = numCells;
+   else
+      columns = (int64_t)((asin(ratio) * (180.0 / 3.14159265358979323846)) / width) + 1;
+
+   west = MIN(columns, (numCells - 1) / 2);
+   east = MIN(columns, numCells - 1 - west);
+
+   // Near the poles the rows get wider than the second set: testing each of its cells is then cheaper than probing
+   if (((2 * rows) + 1) * (west + east + 1) > (int64_t)join_->numCells)
+   {
+      for (j = 0; j < join_->numSecond; j = next)
+      {
+         for (next = j + 1; (next < join_->numSecond) && (join_->second[next].key == join_->second[j].key); next++)
+            ;
+
+         if (geohash36_keyToCell(join_->second[j].key, &neighbor) != 0)
+            continue;
+
+         row = (int64_t)neighbor.latIndex - (int64_t)cell.latIndex;
+         column = ((int64_t)neighbor.lonIndex - (int64_t)cell.lonIndex + numCells) % numCells;
+
+         if ((row < -rows) || (row > rows) || ((column > east) && (column < numCells - west)))
+            continue;
+
+         if (geohash36_join_matchPoints(join_, begin_, end_, j, next, numPairs_))
+            return;
+      }
+
+      return;
+   }
+
+   for (row = -rows; row <= rows; row++)
+   {
+      for (column = -west; column <= east; column++)
+      {
+         if (geohash36_getCellNeighbor(&cell, row, column, &neighbor) != 0)
+            continue;
+
+         key = geohash36_cellToKey(&neighbor);
+         second = geohash36_join_findCell(join_, key);
+
+         if (second == NULL)
+            continue;
+
+         j = (size_t)(second - join_->second);
+
+         for (next = j + 1; (next < join_->numSecond) && (join_->second[next].key == key); next++)
+            ;
+
+         if (geohash36_join_matchPoints(join_, begin_, end_, j, next, numPairs_))
+            return;
+      }
+   }
+}
+
+/*!
+************************************************************************************************************************
+* @brief Joins the cells of the first set starting in a range of entries (pool task).
+************************************************************************************************************************
+* @param [in] first_: first entry of the range;
+* @param [in] count_: number of entries of the range;
+* @param [in] context_: pointer to the join.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_join_task(size_t first_, size_t count_, void * context_)
+{
+   geohash36_join_t * join = (geohash36_join_t *)context_;
+   size_t end, runEnd;
+   long numPairs = 0;
+
+   // A cell starting in the previous range belongs to it
+   while ((first_ > 0) && (count_ > 0) && (join->first[first_].key == join->first[first_ - 1].key))
+   {
+      first_++;
+      count_--;
+   }
+
+   for (end = first_ + count_; (first_ < end) && !__atomic_load_n(&join->stop, __ATOMIC_RELAXED); first_ = runEnd)
+   {
+      for (runEnd = first_ + 1; (runEnd < join->numFirst) && (join->first[runEnd].key == join->first[first_].key);
+           runEnd++)
+         ;
+
+      geohash36_join_matchCell(join, first_, runEnd, &numPairs);
+   }
+
+   __atomic_fetch_add(&join->numPairs, numPairs, __ATOMIC_RELAXED);
+}
+
+/***********************************************************************************************************************
+External functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Finds every pair of points (one from each set) within a distance of each other.
+*
+* Both sets are keyed at the longest length whose cells are at least "distanceInMeters_" high (see
+* geohash36_getPrecisionInMeters) and sorted by key. Each cell of the first set is then matched against the same cell
+* of the second set and its neighbors (more columns near the poles, where cells get narrow, up to every cell of the
+* second set), and candidate pairs go through the exact great-circle distance. Cells of the first set are split
+* between the threads of the pool.
+************************************************************************************************************************
+* @param [in] pool_: pool running the join (NULL runs it in the calling thread);
+* @param [in] lat1_, lon1_: positions of the first set;
+* @param [in] n1_: number of points of the first set;
+* @param [in] lat2_, lon2_: positions of the second set;
+* @param [in] n2_: number of points of the second set;
+* @param [in] distanceInMeters_: maximum distance of the pairs;
+* @param [in] callback_: function called for each pair;
+* @param [in] context_: pointer given to the callback.
+************************************************************************************************************************
+* @return Number of pairs found, or -1 for invalid input or allocation failure.
+************************************************************************************************************************
+**/
+long geohash36_join(geohash36_pool_t * pool_, const double * lat1_, const double * lon1_, size_t n1_,
+                    const double * lat2_, const double * lon2_, size_t n2_, double distanceInMeters_,
+                    geohash36_join_callback_t callback_, void * context_)
+{
+   geohash36_index_t first, second;
+   geohash36_join_point_t * points1;
+   geohash36_join_point_t * points2;
+   geohash36_join_t join;
+   double latPrecision, lonPrecision;
+   int numCharacters, result;
+
+   if ((((lat1_ == NULL) || (lon1_ == NULL)) && (n1_ > 0)) || (((lat2_ == NULL) || (lon2_ == NULL)) && (n2_ > 0)) ||
+       !(distanceInMeters_ >= 0.0))
+      return -1;
+
+   if ((n1_ == 0) || (n2_ == 0))
+      return 0;
+
+   // Longest length whose cells are at least as high as the distance ("latPrecision" is half a cell)
+   for (numCharacters = 1; numCharacters < GEOHASH36_KEY_MAX_CHARACTERS; numCharacters++)
+   {
+      geohash36_getPrecisionInMeters(numCharacters + 1, &latPrecision, &lonPrecision);
+
+      if (2.0 * latPrecision < distanceInMeters_)
+         break;
+   }
+
+   if (geohash36_join_sort(pool_, lat1_, lon1_, n1_, numCharacters, &first, &points1) != 0)
+   {
+      geohash36_index_free(&first);
+      return -1;
+   }
+
+   if (geohash36_join_sort(pool_, lat2_, lon2_, n2_, numCharacters, &second, &points2) != 0)
+   {
+      free(points1);
+      geohash36_index_free(&first);
+      geohash36_index_free(&second);
+      return -1;
+   }
+
+   join.first = first.entries;
+   join.numFirst = first.numEntries;
+   join.second = second.entries;
+   join.numSecond = second.numEntries;
+   join.cells = geohash36_join_buildCells(second.entries, second.numEntries, &join.numSlots, &join.numCells);
+   join.points1 = points1;
+   join.points2 = points2;
+   join.distance = distanceInMeters_;
+   join.angle = (distanceInMeters_ / EARTH_RADIUS_IN_METERS) * (180.0 / 3.14159265358979323846);
+   join.callback = callback_;
+   join.context = context_;
+   join.numPairs = 0;
+   join.stop = 0;
+
+   if (join.cells == NULL)
+      result = -1;
+   else if (pool_ != NULL)
+      result = geohash36_pool_run(pool_, join.numFirst, GEOHASH36_JOIN_CHUNK_POINTS, geohash36_join_task, &join);
+   else
+   {
+      geohash36_join_task(0, join.numFirst, &join);
+      result = 0;
+   }
+
+   free((void *)join.cells);
+   free(points1);
+   free(points2);
+   geohash36_index_free(&first);
+   geohash36_index_free(&second);
+
+   return (result == 0) ? join.numPairs : -1;
+}
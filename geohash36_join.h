@@ -0,0 +1,71 @@
+#ifndef _GEOHASH36_JOIN_H_
+#define _GEOHASH36_JOIN_H_
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "stddef.h"
+#include "geohash36.h"
+#include "geohash36_pool.h"
+
+/***********************************************************************************************************************
+Defines/macros
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Number of points of the first set handed to a worker at a time.
+************************************************************************************************************************
+**/
+#define GEOHASH36_JOIN_CHUNK_POINTS          4096
+
+/***********************************************************************************************************************
+Typedefs/structs/unions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Callback called for each pair found by a join. With a pool it is called from the worker threads, possibly at
+*        the same time.
+************************************************************************************************************************
+* @param [in] first_: position of the point in the first set;
+* @param [in] second_: position of the point in the second set;
+* @param [in] distance_: distance between the points in meters;
+* @param [in] context_: pointer given to the join.
+************************************************************************************************************************
+* @return 0 to continue the join, any other value to stop it.
+************************************************************************************************************************
+**/
+typedef int (*geohash36_join_callback_t)(size_t first_, size_t second_, double distance_, void * context_);
+
+/***********************************************************************************************************************
+Exported functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Finds every pair of points (one from each set) within a distance of each other.
+*
+* Both sets are keyed at the longest length whose cells are at least "distanceInMeters_" high (see
+* geohash36_getPrecisionInMeters) and sorted by key. Each cell of the first set is then matched against the same cell
+* of the second set and its neighbors (more columns near the poles, where cells get narrow, up to every cell of the
+* second set), and candidate pairs go through the exact great-circle distance. Cells of the first set are split
+* between the threads of the pool.
+************************************************************************************************************************
+* @param [in] pool_: pool running the join (NULL runs it in the calling thread);
+* @param [in] lat1_, lon1_: positions of the first set;
+* @param [in] n1_: number of points of the first set;
+* @param [in] lat2_, lon2_: positions of the second set;
+* @param [in] n2_: number of points of the second set;
+* @param [in] distanceInMeters_: maximum distance of the pairs;
+* @param [in] callback_: function called for each pair;
+* @param [in] context_: pointer given to the callback.
+************************************************************************************************************************
+* @return Number of pairs found, or -1 for invalid input or allocation failure.
+************************************************************************************************************************
+**/
+long geohash36_join(geohash36_pool_t * pool_, const double * lat1_, const double * lon1_, size_t n1_,
+                    const double * lat2_, const double * lon2_, size_t n2_, double distanceInMeters_,
+                    geohash36_join_callback_t callback_, void * context_);
+
+#endif // _GEOHASH36_JOIN_H_
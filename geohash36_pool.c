@@ -0,0 +1,639 @@
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#define _GNU_SOURCE
+
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "geohash36_pool.h"
+
+/***********************************************************************************************************************
+Defines/macros
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Maximum number of chunks of a job (chunk ranges are packed in 32 bits halves).
+************************************************************************************************************************
+**/
+#define GEOHASH36_POOL_MAX_CHUNKS            ((size_t)UINT32_MAX)
+
+/***********************************************************************************************************************
+Typedefs/structs/unions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Worker thread: its remaining chunks are [chunks >> 32, chunks & 0xFFFFFFFF). The owner takes chunks from the
+*        front and thieves from the back, both with a compare-and-swap of the whole range.
+************************************************************************************************************************
+**/
+struct geohash36_pool_worker_s
+{
+   uint64_t chunks;
+   geohash36_pool_t * pool;
+   pthread_t thread;
+   int index;
+   uint8_t padding[64];
+};
+
+/*!
+************************************************************************************************************************
+* @brief Context of the encode tasks.
+************************************************************************************************************************
+**/
+typedef struct
+{
+   const double * lat;
+   const double * lon;
+   void * out;
+   int numCharacters;
+
+}geohash36_pool_encode_t;
+
+/*!
+************************************************************************************************************************
+* @brief Context of the decode/neighbors tasks.
+************************************************************************************************************************
+**/
+typedef struct
+{
+   const char * hashes;
+   int numCharacters;
+   double * outLat;
+   double * outLon;
+   geohash36_bounds_t * outBounds;
+   uint8_t * outValid;
+   char * outNeighbors;
+   int * outMasks;
+   long numInvalid;
+
+}geohash36_pool_decode_t;
+
+/***********************************************************************************************************************
+Internal functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Takes a chunk from the range of a worker.
+************************************************************************************************************************
+* @param [in] chunks_: range of the worker;
+* @param [in] fromBack_: 0 for the owner (front), 1 for thieves (back);
+* @param [out] chunk_: chunk taken.
+************************************************************************************************************************
+* @return 1 if a chunk was taken, 0 if the range is empty.
+************************************************************************************************************************
+**/
+static int geohash36_pool_takeChunk(uint64_t * chunks_, int fromBack_, size_t * chunk_)
+{
+   uint64_t value = __atomic_load_n(chunks_, __ATOMIC_ACQUIRE);
+   uint64_t next;
+   uint32_t first, end;
+
+   do
+   {
+      first = (uint32_t)(value >> 32);
+      end = (uint32_t)value;
+
+      if (first >= end)
+         return 0;
+
+      next = fromBack_ ? ((((uint64_t)first) << 32) | (end - 1)) : ((((uint64_t)(first + 1)) << 32) | end);
+
+   }while (!__atomic_compare_exchange_n(chunks_, &value, next, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+   (*chunk_) = fromBack_ ? (end - 1) : first;
+   return 1;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Runs the chunks of a worker, then steals the chunks of the others until every range is empty.
+************************************************************************************************************************
+* @param [in] worker_: pointer to the worker.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_pool_work(geohash36_pool_worker_t * worker_)
+{
+   geohash36_pool_t * pool = worker_->pool;
+   size_t chunk = 0;
+   size_t first;
+   int i;
+
+   for (;;)
+   {
+      if (!geohash36_pool_takeChunk(&worker_->chunks, 0, &chunk))
+      {
+         for (i = 1; i < pool->numThreads; i++)
+         {
+            if (geohash36_pool_takeChunk(&pool->workers[(worker_->index + i) % pool->numThreads].chunks, 1, &chunk))
+               break;
+         }
+
+         if (i == pool->numThreads)
+            return;
+      }
+
+      first = chunk * pool->chunkSize;
+      pool->task(first, MIN(pool->chunkSize, pool->numItems - first), pool->context);
+   }
+}
+
+/*!
+************************************************************************************************************************
+* @brief Main loop of the worker threads: waits for a job, runs it and reports when done.
+************************************************************************************************************************
+* @param [in] worker_: pointer to the worker.
+************************************************************************************************************************
+* @return NULL.
+************************************************************************************************************************
+**/
+static void * geohash36_pool_thread(void * worker_)
+{
+   geohash36_pool_worker_t * worker = (geohash36_pool_worker_t *)worker_;
+   geohash36_pool_t * pool = worker->pool;
+   uint64_t generation = 0;
+
+   pthread_mutex_lock(&pool->mutex);
+
+   for (;;)
+   {
+      while (!pool->stop && (pool->generation == generation))
+         pthread_cond_wait(&pool->wakeup, &pool->mutex);
+
+      if (pool->stop)
+         break;
+
+      generation = pool->generation;
+      pthread_mutex_unlock(&pool->mutex);
+
+      geohash36_pool_work(worker);
+
+      pthread_mutex_lock(&pool->mutex);
+
+      if (--pool->numActive == 0)
+         pthread_cond_signal(&pool->finished);
+   }
+
+   pthread_mutex_unlock(&pool->mutex);
+   return NULL;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Stops and joins the first worker threads of a pool.
+************************************************************************************************************************
+* @param [in] pool_: pointer to the pool;
+* @param [in] numThreads_: number of running threads.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_pool_stop(geohash36_pool_t * pool_, int numThreads_)
+{
+   int i;
+
+   pthread_mutex_lock(&pool_->mutex);
+   pool_->stop = 1;
+   pthread_cond_broadcast(&pool_->wakeup);
+   pthread_mutex_unlock(&pool_->mutex);
+
+   for (i = 0; i < numThreads_; i++)
+      pthread_join(pool_->workers[i].thread, NULL);
+
+   pthread_cond_destroy(&pool_->finished);
+   pthread_cond_destroy(&pool_->wakeup);
+   pthread_mutex_destroy(&pool_->mutex);
+   pthread_mutex_destroy(&pool_->runMutex);
+   free(pool_->workers);
+   memset(pool_, 0, sizeof(geohash36_pool_t));
+}
+
+/*!
+************************************************************************************************************************
+* @brief Gets the number of items of a chunk of about GEOHASH36_POOL_CHUNK_BYTES.
+************************************************************************************************************************
+* @param [in] bytesPerItem_: memory touched by each item.
+************************************************************************************************************************
+* @return Number of items.
+************************************************************************************************************************
+**/
+static size_t geohash36_pool_chunkSize(size_t bytesPerItem_)
+{
+   return MAX((size_t)1, GEOHASH36_POOL_CHUNK_BYTES / MAX(bytesPerItem_, (size_t)1));
+}
+
+/*!
+************************************************************************************************************************
+* @brief Encode task (strings).
+************************************************************************************************************************
+* @param [in] first_, count_, context_: see geohash36_pool_task_t.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_pool_encodeTask(size_t first_, size_t count_, void * context_)
+{
+   geohash36_pool_encode_t * context = (geohash36_pool_encode_t *)context_;
+
+   geohash36_encode_batch(context->lat + first_, context->lon + first_, count_,
+                          (char *)context->out + (first_ * (size_t)context->numCharacters), context->numCharacters);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Encode task (keys).
+************************************************************************************************************************
+* @param [in] first_, count_, context_: see geohash36_pool_task_t.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_pool_encodeKeyTask(size_t first_, size_t count_, void * context_)
+{
+   geohash36_pool_encode_t * context = (geohash36_pool_encode_t *)context_;
+
+   geohash36_encodeKey_batch(context->lat + first_, context->lon + first_, count_,
+                             (geohash36_key_t *)context->out + first_, context->numCharacters);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Decode task.
+************************************************************************************************************************
+* @param [in] first_, count_, context_: see geohash36_pool_task_t.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_pool_decodeTask(size_t first_, size_t count_, void * context_)
+{
+   geohash36_pool_decode_t * context = (geohash36_pool_decode_t *)context_;
+   long numInvalid;
+
+   numInvalid = geohash36_decode_batch(context->hashes + (first_ * (size_t)context->numCharacters), count_,
+                                       context->numCharacters, context->outLat + first_, context->outLon + first_,
+                                       (context->outBounds != NULL) ? (context->outBounds + first_) : NULL,
+                                       (context->outValid != NULL) ? (context->outValid + first_) : NULL);
+
+   if (numInvalid > 0)
+      __atomic_fetch_add(&context->numInvalid, numInvalid, __ATOMIC_RELAXED);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Neighbors task.
+************************************************************************************************************************
+* @param [in] first_, count_, context_: see geohash36_pool_task_t.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_pool_neighborsTask(size_t first_, size_t count_, void * context_)
+{
+   geohash36_pool_decode_t * context = (geohash36_pool_decode_t *)context_;
+   size_t size = (size_t)context->numCharacters;
+   long numInvalid = 0;
+   size_t i;
+   int mask;
+
+   for (i = first_; i < (first_ + count_); i++)
+   {
+      mask = geohash36_getNeighbors(context->hashes + (i * size), context->numCharacters,
+                                    context->outNeighbors + (i * GEO36_NEIGHBORS_COUNT * size));
+
+      if (context->outMasks != NULL)
+         context->outMasks[i] = mask;
+
+      numInvalid += (mask < 0) ? 1 : 0;
+   }
+
+   if (numInvalid > 0)
+      __atomic_fetch_add(&context->numInvalid, numInvalid, __ATOMIC_RELAXED);
+}
+
+/***********************************************************************************************************************
+External functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Starts the worker threads of a pool.
+************************************************************************************************************************
+* @param [out] pool_: pointer to the pool;
+* @param [in] numThreads_: number of worker threads (0 uses one per online CPU);
+* @param [in] cpus_: optional array of "numThreads_" CPU numbers, worker "i" being pinned to "cpus_[i]" (can be NULL;
+*                    only supported on Linux).
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input, thread creation failure or affinity not supported.
+************************************************************************************************************************
+**/
+int geohash36_pool_init(geohash36_pool_t * pool_, int numThreads_, const int * cpus_)
+{
+   long numCpus;
+   int i;
+
+   if ((pool_ == NULL) || (numThreads_ < 0) || ((numThreads_ == 0) && (cpus_ != NULL)))
+      return -1;
+
+#ifdef __linux__
+   // CPU_SET does not check its argument: every CPU is checked before any thread starts
+   for (i = 0; (cpus_ != NULL) && (i < numThreads_); i++)
+   {
+      if ((cpus_[i] < 0) || (cpus_[i] >= CPU_SETSIZE))
+         return -1;
+   }
+#else
+   if (cpus_ != NULL)
+      return -1;
+#endif
+
+   if (numThreads_ == 0)
+   {
+      numCpus = sysconf(_SC_NPROCESSORS_ONLN);
+      numThreads_ = (numCpus > 0) ? (int)numCpus : 1;
+   }
+
+   memset(pool_, 0, sizeof(geohash36_pool_t));
+
+   pool_->workers = calloc((size_t)numThreads_, sizeof(geohash36_pool_worker_t));
+   if (pool_->workers == NULL)
+      return -1;
+
+   pool_->numThreads = numThreads_;
+   pthread_mutex_init(&pool_->runMutex, NULL);
+   pthread_mutex_init(&pool_->mutex, NULL);
+   pthread_cond_init(&pool_->wakeup, NULL);
+   pthread_cond_init(&pool_->finished, NULL);
+
+   for (i = 0; i < numThreads_; i++)
+   {
+      pool_->workers[i].pool = pool_;
+      pool_->workers[i].index = i;
+
+      if (pthread_create(&pool_->workers[i].thread, NULL, geohash36_pool_thread, &pool_->workers[i]) != 0)
+      {
+         geohash36_pool_stop(pool_, i);
+         return -1;
+      }
+
+#ifdef __linux__
+      if (cpus_ != NULL)
+      {
+         cpu_set_t set;
+
+         CPU_ZERO(&set);
+         CPU_SET(cpus_[i], &set);
+
+         if (pthread_setaffinity_np(pool_->workers[i].thread, sizeof(set), &set) != 0)
+         {
+            geohash36_pool_stop(pool_, i + 1);
+            return -1;
+         }
+      }
+#endif
+   }
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Stops the worker threads of a pool and releases its memory.
+************************************************************************************************************************
+* @param [in] pool_: pointer to the pool.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+void geohash36_pool_free(geohash36_pool_t * pool_)
+{
+   if ((pool_ == NULL) || (pool_->workers == NULL))
+      return;
+
+   geohash36_pool_stop(pool_, pool_->numThreads);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Runs a task over "n_" items split in chunks of "chunkSize_" items, and waits for it. Small jobs run in the
+*        calling thread.
+************************************************************************************************************************
+* @param [in] pool_: pointer to the pool;
+* @param [in] n_: number of items;
+* @param [in] chunkSize_: number of items per chunk;
+* @param [in] task_: function called for each chunk;
+* @param [in] context_: pointer given to the task.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input.
+************************************************************************************************************************
+**/
+int geohash36_pool_run(geohash36_pool_t * pool_, size_t n_, size_t chunkSize_, geohash36_pool_task_t task_,
+                       void * context_)
+{
+   size_t numChunks;
+   uint64_t first, end;
+   int i;
+
+   if ((pool_ == NULL) || (pool_->workers == NULL) || (chunkSize_ == 0) || (task_ == NULL))
+      return -1;
+
+   if (n_ == 0)
+      return 0;
+
+   if (n_ <= chunkSize_)
+   {
+      task_(0, n_, context_);
+      return 0;
+   }
+
+   while (((n_ - 1) / chunkSize_) >= GEOHASH36_POOL_MAX_CHUNKS)
+      chunkSize_ *= 2;
+
+   numChunks = ((n_ - 1) / chunkSize_) + 1;
+
+   pthread_mutex_lock(&pool_->runMutex);
+   pthread_mutex_lock(&pool_->mutex);
+
+   pool_->task = task_;
+   pool_->context = context_;
+   pool_->numItems = n_;
+   pool_->chunkSize = chunkSize_;
+
+   for (i = 0; i < pool_->numThreads; i++)
+   {
+      first = ((uint64_t)numChunks * (uint64_t)i) / (uint64_t)pool_->numThreads;
+      end = ((uint64_t)numChunks * (uint64_t)(i + 1)) / (uint64_t)pool_->numThreads;
+      __atomic_store_n(&pool_->workers[i].chunks, (first << 32) | end, __ATOMIC_RELAXED);
+   }
+
+   pool_->numActive = pool_->numThreads;
+   pool_->generation++;
+   pthread_cond_broadcast(&pool_->wakeup);
+
+   while (pool_->numActive > 0)
+      pthread_cond_wait(&pool_->finished, &pool_->mutex);
+
+   pthread_mutex_unlock(&pool_->mutex);
+   pthread_mutex_unlock(&pool_->runMutex);
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Parallel geohash36_encode_batch (same output).
+************************************************************************************************************************
+* @param [in] pool_: pointer to the pool;
+* @param [in] lat_: array of latitudes;
+* @param [in] lon_: array of longitudes;
+* @param [in] n_: number of positions;
+* @param [out] out_: buffer of "n_ * numCharacters_" characters which will receive the hashes;
+* @param [in] numCharacters_: desired Geohash-36 length.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input.
+************************************************************************************************************************
+**/
+int geohash36_pool_encode(geohash36_pool_t * pool_, const double * lat_, const double * lon_, size_t n_, char * out_,
+                          int numCharacters_)
+{
+   geohash36_pool_encode_t context;
+
+   // An empty batch checks the arguments exactly like the sequential function
+   if (geohash36_encode_batch(lat_, lon_, 0, out_, numCharacters_) != 0)
+      return -1;
+
+   context.lat = lat_;
+   context.lon = lon_;
+   context.out = out_;
+   context.numCharacters = numCharacters_;
+
+   return geohash36_pool_run(pool_, n_, geohash36_pool_chunkSize((2 * sizeof(double)) + (size_t)numCharacters_),
+                             geohash36_pool_encodeTask, &context);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Parallel geohash36_encodeKey_batch (same output).
+************************************************************************************************************************
+* @param [in] pool_: pointer to the pool;
+* @param [in] lat_: array of latitudes;
+* @param [in] lon_: array of longitudes;
+* @param [in] n_: number of positions;
+* @param [out] out_: array of "n_" keys which will receive the result;
+* @param [in] numCharacters_: desired Geohash-36 length (0 to GEOHASH36_KEY_MAX_CHARACTERS).
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input.
+************************************************************************************************************************
+**/
+int geohash36_pool_encodeKey(geohash36_pool_t * pool_, const double * lat_, const double * lon_, size_t n_,
+                             geohash36_key_t * out_, int numCharacters_)
+{
+   geohash36_pool_encode_t context;
+
+   if (geohash36_encodeKey_batch(lat_, lon_, 0, out_, numCharacters_) != 0)
+      return -1;
+
+   context.lat = lat_;
+   context.lon = lon_;
+   context.out = out_;
+   context.numCharacters = numCharacters_;
+
+   return geohash36_pool_run(pool_, n_, geohash36_pool_chunkSize((2 * sizeof(double)) + sizeof(geohash36_key_t)),
+                             geohash36_pool_encodeKeyTask, &context);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Parallel geohash36_decode_batch (same output).
+************************************************************************************************************************
+* @param [in] pool_: pointer to the pool;
+* @param [in] hashes_: buffer of "n_ * numCharacters_" characters with the hashes one after the other;
+* @param [in] n_: number of hashes;
+* @param [in] numCharacters_: length of each hash;
+* @param [out] outLat_: array which will receive the latitudes (center of the cells);
+* @param [out] outLon_: array which will receive the longitudes (center of the cells);
+* @param [out] outBounds_: optional array which will receive the boundaries of the cells (can be NULL);
+* @param [out] outValid_: optional array which will receive 1 for valid hashes and 0 for invalid ones (can be NULL).
+************************************************************************************************************************
+* @return Number of invalid hashes (0 when every hash was decoded), or -1 for invalid arguments.
+************************************************************************************************************************
+**/
+long geohash36_pool_decode(geohash36_pool_t * pool_, const char * hashes_, size_t n_, int numCharacters_,
+                           double * outLat_, double * outLon_, geohash36_bounds_t * outBounds_, uint8_t * outValid_)
+{
+   geohash36_pool_decode_t context;
+   size_t bytesPerItem;
+
+   if (geohash36_decode_batch(hashes_, 0, numCharacters_, outLat_, outLon_, outBounds_, outValid_) != 0)
+      return -1;
+
+   memset(&context, 0, sizeof(context));
+   context.hashes = hashes_;
+   context.numCharacters = numCharacters_;
+   context.outLat = outLat_;
+   context.outLon = outLon_;
+   context.outBounds = outBounds_;
+   context.outValid = outValid_;
+
+   bytesPerItem = (size_t)numCharacters_ + (2 * sizeof(double)) + sizeof(uint8_t) +
+                  ((outBounds_ != NULL) ? sizeof(geohash36_bounds_t) : 0);
+
+   if (geohash36_pool_run(pool_, n_, geohash36_pool_chunkSize(bytesPerItem), geohash36_pool_decodeTask, &context) != 0)
+      return -1;
+
+   return context.numInvalid;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Parallel geohash36_getNeighbors over an array of fixed length hashes (same output).
+************************************************************************************************************************
+* @param [in] pool_: pointer to the pool;
+* @param [in] hashes_: buffer of "n_ * numCharacters_" characters with the hashes one after the other;
+* @param [in] n_: number of hashes;
+* @param [in] numCharacters_: length of each hash;
+* @param [out] outNeighbors_: buffer of "n_ * GEO36_NEIGHBORS_COUNT * numCharacters_" characters which will receive
+*                             the neighbors of each hash (see geohash36_getNeighbors);
+* @param [out] outMasks_: optional array which will receive the result of geohash36_getNeighbors for each hash (can be
+*                         NULL).
+************************************************************************************************************************
+* @return Number of invalid hashes, or -1 for invalid arguments.
+************************************************************************************************************************
+**/
+long geohash36_pool_getNeighbors(geohash36_pool_t * pool_, const char * hashes_, size_t n_, int numCharacters_,
+                                 char * outNeighbors_, int * outMasks_)
+{
+   geohash36_pool_decode_t context;
+   size_t bytesPerItem;
+
+   if ((hashes_ == NULL) || (outNeighbors_ == NULL) || (numCharacters_ <= 0))
+      return -1;
+
+   memset(&context, 0, sizeof(context));
+   context.hashes = hashes_;
+   context.numCharacters = numCharacters_;
+   context.outNeighbors = outNeighbors_;
+   context.outMasks = outMasks_;
+
+   bytesPerItem = ((size_t)numCharacters_ * (GEO36_NEIGHBORS_COUNT + 1)) + sizeof(int);
+
+   if (geohash36_pool_run(pool_, n_, geohash36_pool_chunkSize(bytesPerItem), geohash36_pool_neighborsTask,
+                          &context) != 0)
+      return -1;
+
+   return context.numInvalid;
+}
@@ -0,0 +1,202 @@
+#ifndef _GEOHASH36_POOL_H_
+#define _GEOHASH36_POOL_H_
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include <pthread.h>
+#include "stddef.h"
+#include "geohash36.h"
+#include "geohash36_batch.h"
+
+/***********************************************************************************************************************
+Defines/macros
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Approximate memory (input + output) touched by each chunk of work, so that a chunk stays in the L2 cache.
+************************************************************************************************************************
+**/
+#define GEOHASH36_POOL_CHUNK_BYTES           (64 * 1024)
+
+/***********************************************************************************************************************
+Typedefs/structs/unions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Task run by the pool over a range of items.
+************************************************************************************************************************
+* @param [in] first_: first item of the range;
+* @param [in] count_: number of items of the range;
+* @param [in] context_: pointer given to geohash36_pool_run.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+typedef void (*geohash36_pool_task_t)(size_t first_, size_t count_, void * context_);
+
+/*!
+************************************************************************************************************************
+* @brief Worker thread of a pool (internal).
+************************************************************************************************************************
+**/
+typedef struct geohash36_pool_worker_s geohash36_pool_worker_t;
+
+/*!
+************************************************************************************************************************
+* @brief Pool of worker threads.
+*
+* Each job is split in chunks, and every worker gets a contiguous share of the chunks. A worker which runs out of chunks
+* steals the last chunk of the others, so slow cores don't hold the job back. Each chunk writes its own slice of the
+* outputs, so the results don't depend on the scheduling. Jobs of concurrent callers run one after the other.
+************************************************************************************************************************
+**/
+typedef struct
+{
+   geohash36_pool_worker_t * workers;
+   int numThreads;
+
+   pthread_mutex_t runMutex;
+   pthread_mutex_t mutex;
+   pthread_cond_t wakeup;
+   pthread_cond_t finished;
+
+   geohash36_pool_task_t task;
+   void * context;
+   size_t numItems;
+   size_t chunkSize;
+   uint64_t generation;
+   int numActive;
+   int stop;
+
+}geohash36_pool_t;
+
+/***********************************************************************************************************************
+Exported functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Starts the worker threads of a pool.
+************************************************************************************************************************
+* @param [out] pool_: pointer to the pool;
+* @param [in] numThreads_: number of worker threads (0 uses one per online CPU);
+* @param [in] cpus_: optional array of "numThreads_" CPU numbers, worker "i" being pinned to "cpus_[i]" (can be NULL;
+*                    only supported on Linux).
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input, thread creation failure or affinity not supported.
+************************************************************************************************************************
+**/
+int geohash36_pool_init(geohash36_pool_t * pool_, int numThreads_, const int * cpus_);
+
+/*!
+************************************************************************************************************************
+* @brief Stops the worker threads of a pool and releases its memory.
+************************************************************************************************************************
+* @param [in] pool_: pointer to the pool.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+void geohash36_pool_free(geohash36_pool_t * pool_);
+
+/*!
+************************************************************************************************************************
+* @brief Runs a task over "n_" items split in chunks of "chunkSize_" items, and waits for it. Small jobs run in the
+*        calling thread.
+************************************************************************************************************************
+* @param [in] pool_: pointer to the pool;
+* @param [in] n_: number of items;
+* @param [in] chunkSize_: number of items per chunk;
+* @param [in] task_: function called for each chunk;
+* @param [in] context_: pointer given to the task.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input.
+************************************************************************************************************************
+**/
+int geohash36_pool_run(geohash36_pool_t * pool_, size_t n_, size_t chunkSize_, geohash36_pool_task_t task_,
+                       void * context_);
+
+/*!
+************************************************************************************************************************
+* @brief Parallel geohash36_encode_batch (same output).
+************************************************************************************************************************
+* @param [in] pool_: pointer to the pool;
+* @param [in] lat_: array of latitudes;
+* @param [in] lon_: array of longitudes;
+* @param [in] n_: number of positions;
+* @param [out] out_: buffer of "n_ * numCharacters_" characters which will receive the hashes;
+* @param [in] numCharacters_: desired Geohash-36 length.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input.
+************************************************************************************************************************
+**/
+int geohash36_pool_encode(geohash36_pool_t * pool_, const double * lat_, const double * lon_, size_t n_, char * out_,
+                          int numCharacters_);
+
+/*!
+************************************************************************************************************************
+* @brief Parallel geohash36_encodeKey_batch (same output).
+************************************************************************************************************************
+* @param [in] pool_: pointer to the pool;
+* @param [in] lat_: array of latitudes;
+* @param [in] lon_: array of longitudes;
+* @param [in] n_: number of positions;
+* @param [out] out_: array of "n_" keys which will receive the result;
+* @param [in] numCharacters_: desired Geohash-36 length (0 to GEOHASH36_KEY_MAX_CHARACTERS).
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input.
+************************************************************************************************************************
+**/
+int geohash36_pool_encodeKey(geohash36_pool_t * pool_, const double * lat_, const double * lon_, size_t n_,
+                             geohash36_key_t * out_, int numCharacters_);
+
+/*!
+************************************************************************************************************************
+* @brief Parallel geohash36_decode_batch (same output).
+************************************************************************************************************************
+* @param [in] pool_: pointer to the pool;
+* @param [in] hashes_: buffer of "n_ * numCharacters_" characters with the hashes one after the other;
+* @param [in] n_: number of hashes;
+* @param [in] numCharacters_: length of each hash;
+* @param [out] outLat_: array which will receive the latitudes (center of the cells);
+* @param [out] outLon_: array which will receive the longitudes (center of the cells);
+* @param [out] outBounds_: optional array which will receive the boundaries of the cells (can be NULL);
+* @param [out] outValid_: optional array which will receive 1 for valid hashes and 0 for invalid ones (can be NULL).
+************************************************************************************************************************
+* @return Number of invalid hashes (0 when every hash was decoded), or -1 for invalid arguments.
+************************************************************************************************************************
+**/
+long geohash36_pool_decode(geohash36_pool_t * pool_, const char * hashes_, size_t n_, int numCharacters_,
+                           double * outLat_, double * outLon_, geohash36_bounds_t * outBounds_, uint8_t * outValid_);
+
+/*!
+************************************************************************************************************************
+* @brief Parallel geohash36_getNeighbors over an array of fixed length hashes (same output).
+************************************************************************************************************************
+* @param [in] pool_: pointer to the pool;
+* @param [in] hashes_: buffer of "n_ * numCharacters_" characters with the hashes one after the other;
+* @param [in] n_: number of hashes;
+* @param [in] numCharacters_: length of each hash;
+* @param [out] outNeighbors_: buffer of "n_ * GEO36_NEIGHBORS_COUNT * numCharacters_" characters which will receive
+*                             the neighbors of each hash (see geohash36_getNeighbors);
+* @param [out] outMasks_: optional array which will receive the result of geohash36_getNeighbors for each hash (can be
+*                         NULL).
+************************************************************************************************************************
+* @return Number of invalid hashes, or -1 for invalid arguments.
+************************************************************************************************************************
+**/
+long geohash36_pool_getNeighbors(geohash36_pool_t * pool_, const char * hashes_, size_t n_, int numCharacters_,
+                                 char * outNeighbors_, int * outMasks_);
+
+#endif // _GEOHASH36_POOL_H_
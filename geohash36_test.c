@@ -1,51 +1,2002 @@
-#include <stdio.h>
-#include <stdint.h>
-#include <stdbool.h>
-#include <string.h>
-#include <stdio.h>
-#include "geohash36.h"
-#include <stdlib.h>
-
-#define NUM_CHARACTERS_FOR_GEOHASH36    GEOHASH36_DEFAULT_NUM_CHARACTERS
-
-int main()
-{
-   char geohash36_buffer[NUM_CHARACTERS_FOR_GEOHASH36 + 1];
-   char geohash36_buffer_neighbor[NUM_CHARACTERS_FOR_GEOHASH36 + 1];
-
-   double latitude = 51.504444;
-   double longitude = -0.086666;
-   double outLatitude = 0, outLongitude = 0;
-   double lat_prec, long_prec;
-   int sizeBuf;
-
-   geohash36_getPrecisionInMeters(NUM_CHARACTERS_FOR_GEOHASH36, &lat_prec, &long_prec);
-
-   printf("Using %d characters for Geohash-36, our precision is %lf x %lf square meters\n", NUM_CHARACTERS_FOR_GEOHASH36, lat_prec, long_prec);
-
-   sizeBuf = geohash36_encode(latitude, longitude, geohash36_buffer, NUM_CHARACTERS_FOR_GEOHASH36);
-   sizeBuf = MIN(sizeBuf, NUM_CHARACTERS_FOR_GEOHASH36);
-   geohash36_buffer[sizeBuf] = 0;
-
-   printf("Geohash-36 of (%lf, %lf) is: %s\n", latitude, longitude, geohash36_buffer);
-
-   geohash36_decode(geohash36_buffer, sizeBuf, &outLatitude, &outLongitude);
-
-   printf("The Lat/Long of %s is: (%lf, %lf)\n", geohash36_buffer, outLatitude, outLongitude);
-   
-   printf("Geohash36 neighbors:\n");
-   
-   printf("%s\t", geohash36_getNeighbor(geohash36_buffer, sizeBuf, geohash36_buffer_neighbor, GEO36_NEIGHBORS_DIR_NORTHWEST));
-   printf("%s\t", geohash36_getNeighbor(geohash36_buffer, sizeBuf, geohash36_buffer_neighbor, GEO36_NEIGHBORS_DIR_NORTH));
-   printf("%s\n", geohash36_getNeighbor(geohash36_buffer, sizeBuf, geohash36_buffer_neighbor, GEO36_NEIGHBORS_DIR_NORTHEAST));
-   
-   printf("%s\t", geohash36_getNeighbor(geohash36_buffer, sizeBuf, geohash36_buffer_neighbor, GEO36_NEIGHBORS_DIR_WEST));
-   printf("%s\t", geohash36_getNeighbor(geohash36_buffer, sizeBuf, geohash36_buffer_neighbor, GEO36_NEIGHBORS_DIR_CENTER));
-   printf("%s\n", geohash36_getNeighbor(geohash36_buffer, sizeBuf, geohash36_buffer_neighbor, GEO36_NEIGHBORS_DIR_EAST));
-   
-   printf("%s\t", geohash36_getNeighbor(geohash36_buffer, sizeBuf, geohash36_buffer_neighbor, GEO36_NEIGHBORS_DIR_SOUTHWEST));
-   printf("%s\t", geohash36_getNeighbor(geohash36_buffer, sizeBuf, geohash36_buffer_neighbor, GEO36_NEIGHBORS_DIR_SOUTH));
-   printf("%s\n", geohash36_getNeighbor(geohash36_buffer, sizeBuf, geohash36_buffer_neighbor, GEO36_NEIGHBORS_DIR_SOUTHEAST));
-
-   return 0;
-}
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdio.h>
+#include "geohash36.h"
+#include "geohash36_batch.h"
+#include "geohash36_cover.h"
+#include "geohash36_index.h"
+#include "geohash36_file.h"
+#include "geohash36_pool.h"
+#include "geohash36_geofence.h"
+#include "geohash36_aggregate.h"
+#include "geohash36_tracker.h"
+#include "geohash36_join.h"
+#include "geohash36_compact.h"
+#include "geohash36_counter.h"
+#include "geohash36_transcode.h"
+#include "geohash36_fixed.h"
+#include "geohash36_internal.h"
+#include <stdlib.h>
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+#define NUM_CHARACTERS_FOR_GEOHASH36    GEOHASH36_DEFAULT_NUM_CHARACTERS
+
+static int test_failures = 0;
+
+#define CHECK(condition)                                                                  \
+   do                                                                                     \
+   {                                                                                      \
+      if (!(condition))                                                                   \
+      {                                                                                   \
+         printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition);             \
+         test_failures++;                                                                 \
+      }                                                                                   \
+   } while (0)
+
+static double random_between(double min_, double max_)
+{
+   return min_ + (((double)rand() / (double)RAND_MAX) * (max_ - min_));
+}
+
+static void test_encode_decode(void)
+{
+   char buffer[32];
+   geohash36_cell_t cell;
+   geohash36_bounds_t bounds;
+   double lat, lon, outLat, outLon;
+
+   CHECK(geohash36_encode(51.504444, -0.086666, buffer, 10) == 10);
+   CHECK(memcmp(buffer, "bdrdC26BqH", 10) == 0);
+
+   // Out of range coordinates are clamped to the border cells
+   CHECK(geohash36_encode(90.0, 180.0, buffer, 3) == 3);
+   CHECK(memcmp(buffer, "777", 3) == 0);
+   CHECK(geohash36_encode(-90.0, -180.0, buffer, 3) == 3);
+   CHECK(memcmp(buffer, "RRR", 3) == 0);
+
+   CHECK(geohash36_decode("bdrdC2!BqH", 10, &outLat, &outLon) == -1);
+   CHECK(geohash36_stringToCell("bdrdC2!BqH", 10, &cell) == -1);
+
+   for (int i = 0; i < 10000; i++)
+   {
+      int numCharacters = 1 + (i % 24);
+
+      lat = random_between(-90.0, 90.0);
+      lon = random_between(-180.0, 180.0);
+
+      CHECK(geohash36_encode(lat, lon, buffer, numCharacters) == numCharacters);
+      CHECK(geohash36_decode(buffer, numCharacters, &outLat, &outLon) == 0);
+
+      // Beyond 12 characters the cells get close to the double precision of the boundaries
+      if (numCharacters <= 12)
+      {
+         char cellBuffer[GEOHASH36_MAX_CELL_CHARACTERS];
+
+         CHECK(geohash36_encodeCell(lat, lon, numCharacters, &cell) == 0);
+         CHECK(geohash36_cellToString(&cell, cellBuffer) == numCharacters);
+         CHECK(memcmp(buffer, cellBuffer, numCharacters) == 0);
+         CHECK(geohash36_getCellBounds(&cell, &bounds) == 0);
+         CHECK((lat >= bounds.minLatitude) && (lat <= bounds.maxLatitude));
+         CHECK((lon >= bounds.minLongitude) && (lon <= bounds.maxLongitude));
+         CHECK((outLat > bounds.minLatitude) && (outLat < bounds.maxLatitude));
+         CHECK((outLon > bounds.minLongitude) && (outLon < bounds.maxLongitude));
+      }
+   }
+}
+
+// Reference copy of the original encoder (boundary scan, one character at a time)
+static void reference_encode(double latitude_, double longitude_, char * outBuffer_, int numCharacters_)
+{
+   static const char alphabet[] = "23456789bBCdDFgGhHjJKlLMnNPqQrRtTVWX";
+   double lat[] = { -90.0, 90.0 }, lon[] = { -180.0, 180.0 };
+
+   for (int c = 0; c < numCharacters_; c++)
+   {
+      double latSlice = (lat[1] - lat[0]) / 6, lonSlice = (lon[1] - lon[0]) / 6;
+      int latIdx = 0, lonIdx = 0;
+
+      for (int i = 0; i < 6; i++)
+      {
+         if ((longitude_ > (lon[0] + (i * lonSlice))) && (longitude_ <= (lon[0] + ((i + 1) * lonSlice))))
+         {
+            lonIdx = i;
+            lon[1] = lon[0] + ((i + 1) * lonSlice);
+            lon[0] = lon[0] + (i * lonSlice);
+            break;
+         }
+      }
+
+      for (int i = 0; i < 6; i++)
+      {
+         if ((latitude_ > (lat[0] + (i * latSlice))) && (latitude_ <= (lat[0] + ((i + 1) * latSlice))))
+         {
+            latIdx = 5 - i;
+            lat[1] = lat[0] + ((i + 1) * latSlice);
+            lat[0] = lat[0] + (i * latSlice);
+            break;
+         }
+      }
+
+      outBuffer_[c] = alphabet[(latIdx * 6) + lonIdx];
+   }
+}
+
+static void test_encode_boundaries(void)
+{
+   enum { MAX_POINTS = 181 * 361 + 1440 * 78, MAX_CHARACTERS = 12 };
+   static double lat[MAX_POINTS], lon[MAX_POINTS];
+   static char batch[MAX_POINTS * MAX_CHARACTERS];
+   char buffer[MAX_CHARACTERS], expected[MAX_CHARACTERS];
+   geohash36_cell_t cell;
+   int numPoints = 0;
+
+   CHECK(geohash36_encode(-89.0, -135.0, buffer, 5) == 5);
+   CHECK(memcmp(buffer, "RWPrr", 5) == 0);
+   CHECK(geohash36_encode(-89.0, -90.0, buffer, 5) == 5);
+   CHECK(memcmp(buffer, "tTrrr", 5) == 0);
+   CHECK(geohash36_encode(-45.625, 55.7671, buffer, 8) == 8);
+   CHECK(memcmp(buffer, "qM5PL544", 8) == 0);
+
+   // Integer degrees and eighths of a degree are exactly on the edges or the middle of cells. The south pole is left
+   // out: the original scan put it in the north-west cell
+   for (int i = -89; i <= 90; i++)
+   {
+      for (int j = -180; j <= 180; j++)
+      {
+         lat[numPoints] = i;
+         lon[numPoints++] = j;
+      }
+   }
+
+   for (int i = -719; i <= 720; i++)
+   {
+      for (int j = 0; j < 78; j++)
+      {
+         lat[numPoints] = i / 8.0;
+         lon[numPoints++] = -180.0 + ((j * 37) / 8.0);
+      }
+   }
+
+   for (int numCharacters = 1; numCharacters <= MAX_CHARACTERS; numCharacters++)
+   {
+      for (int i = 0; i < numPoints; i++)
+      {
+         reference_encode(lat[i], lon[i], expected, numCharacters);
+         CHECK(geohash36_encode(lat[i], lon[i], buffer, numCharacters) == numCharacters);
+         CHECK(memcmp(buffer, expected, numCharacters) == 0);
+         CHECK(geohash36_encodeCell(lat[i], lon[i], numCharacters, &cell) == 0);
+         CHECK(geohash36_cellToString(&cell, buffer) == numCharacters);
+         CHECK(memcmp(buffer, expected, numCharacters) == 0);
+      }
+
+      for (geohash36_kernel_t kernel = GEOHASH36_KERNEL_SCALAR; kernel <= GEOHASH36_KERNEL_AVX512; kernel++)
+      {
+         if (geohash36_batch_setKernel(kernel) != 0)
+            continue;
+
+         CHECK(geohash36_encode_batch(lat, lon, numPoints, batch, numCharacters) == 0);
+
+         for (int i = 0; i < numPoints; i++)
+         {
+            reference_encode(lat[i], lon[i], expected, numCharacters);
+            CHECK(memcmp(batch + (i * numCharacters), expected, numCharacters) == 0);
+         }
+      }
+   }
+
+   CHECK(geohash36_batch_setKernel(GEOHASH36_KERNEL_AUTO) == 0);
+}
+
+static int compare_strings(const void * a_, const void * b_)
+{
+   return strcmp(*(const char **)a_, *(const char **)b_);
+}
+
+static int compare_keys(const void * a_, const void * b_)
+{
+   geohash36_key_t a = *(const geohash36_key_t *)a_, b = *(const geohash36_key_t *)b_;
+
+   return (a > b) - (a < b);
+}
+
+static void test_keys(void)
+{
+   enum { NUM_KEYS = 2000 };
+   static char strings[NUM_KEYS][GEOHASH36_KEY_MAX_CHARACTERS + 1];
+   static const char * sorted[NUM_KEYS];
+   static geohash36_key_t keys[NUM_KEYS];
+   char buffer[GEOHASH36_KEY_MAX_CHARACTERS + 1];
+   double outLat, outLon;
+   geohash36_key_t key, prefix;
+
+   key = geohash36_encodeKey(51.504444, -0.086666, 10);
+   CHECK(key == geohash36_stringToKey("bdrdC26BqH", 10));
+   CHECK(geohash36_keyToString(key, buffer) == 10);
+   CHECK(memcmp(buffer, "bdrdC26BqH", 10) == 0);
+   CHECK(geohash36_decodeKey(key, &outLat, &outLon) == 0);
+   CHECK((outLat > 51.50444) && (outLat < 51.50445) && (outLon > -0.08667) && (outLon < -0.08666));
+
+   prefix = geohash36_stringToKey("bdrd", 4);
+   CHECK(geohash36_keyHasPrefix(prefix, key));
+   CHECK(!geohash36_keyHasPrefix(geohash36_stringToKey("bdrq", 4), key));
+   CHECK(!geohash36_keyHasPrefix(key, prefix));
+   CHECK(geohash36_keyTruncate(key, 4) == prefix);
+   CHECK((prefix <= key) && (key <= geohash36_keyRangeEnd(prefix)));
+
+   CHECK(geohash36_encodeKey(0, 0, GEOHASH36_KEY_MAX_CHARACTERS + 1) == GEOHASH36_KEY_INVALID);
+   CHECK(geohash36_stringToKey("bd!", 3) == GEOHASH36_KEY_INVALID);
+   CHECK(!geohash36_keyIsValid(GEOHASH36_KEY_INVALID));
+   CHECK(!geohash36_keyIsValid(key + 1));
+
+   // Integer order of the keys must be the memcmp order of the strings
+   for (int i = 0; i < NUM_KEYS; i++)
+   {
+      int numCharacters = 1 + (rand() % GEOHASH36_KEY_MAX_CHARACTERS);
+
+      // Clustered around a few points so that many keys share prefixes
+      geohash36_encode(random_between(51.0, 51.1), random_between(-0.1, 0.0), strings[i], numCharacters);
+      strings[i][numCharacters] = 0;
+      sorted[i] = strings[i];
+      keys[i] = geohash36_stringToKey(strings[i], numCharacters);
+      CHECK(geohash36_keyIsValid(keys[i]));
+   }
+
+   qsort(sorted, NUM_KEYS, sizeof(sorted[0]), compare_strings);
+   qsort(keys, NUM_KEYS, sizeof(keys[0]), compare_keys);
+
+   for (int i = 0; i < NUM_KEYS; i++)
+   {
+      int numCharacters = geohash36_keyToString(keys[i], buffer);
+
+      buffer[numCharacters] = 0;
+      CHECK(strcmp(buffer, sorted[i]) == 0);
+   }
+}
+
+static void test_batch_encode(void)
+{
+   enum { NUM_POINTS = 1003 };
+   static double lat[NUM_POINTS], lon[NUM_POINTS];
+   static char batch[NUM_POINTS * 24];
+   static geohash36_key_t keys[NUM_POINTS];
+   static const int lengths[] = { 0, 1, 5, 10, 16, 20, 24 };
+   char buffer[24];
+
+   for (int i = 0; i < NUM_POINTS; i++)
+   {
+      lat[i] = random_between(-90.0, 90.0);
+      lon[i] = random_between(-180.0, 180.0);
+   }
+
+   // Borders, exact cell boundaries and invalid values
+   lat[0] = -90.0;   lon[0] = -180.0;
+   lat[1] = 90.0;    lon[1] = 180.0;
+   lat[2] = 0.0;     lon[2] = 0.0;
+   lat[3] = 1e300;   lon[3] = -1e300;
+   lat[4] = 0.0 / 0.0; lon[4] = 0.0 / 0.0;
+   lat[5] = 30.0;    lon[5] = 60.0;
+
+   for (geohash36_kernel_t kernel = GEOHASH36_KERNEL_SCALAR; kernel <= GEOHASH36_KERNEL_AVX512; kernel++)
+   {
+      if (geohash36_batch_setKernel(kernel) != 0)
+         continue;
+
+      for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++)
+      {
+         int numCharacters = lengths[l];
+
+         CHECK(geohash36_encode_batch(lat, lon, NUM_POINTS, batch, numCharacters) == 0);
+
+         if (numCharacters <= GEOHASH36_KEY_MAX_CHARACTERS)
+            CHECK(geohash36_encodeKey_batch(lat, lon, NUM_POINTS, keys, numCharacters) == 0);
+
+         for (int i = 0; i < NUM_POINTS; i++)
+         {
+            geohash36_encode(lat[i], lon[i], buffer, numCharacters);
+            CHECK(memcmp(buffer, batch + (i * numCharacters), numCharacters) == 0);
+
+            if (numCharacters <= GEOHASH36_KEY_MAX_CHARACTERS)
+               CHECK(keys[i] == geohash36_encodeKey(lat[i], lon[i], numCharacters));
+         }
+      }
+   }
+
+   CHECK(geohash36_batch_setKernel(GEOHASH36_KERNEL_AUTO) == 0);
+   CHECK(geohash36_batch_getKernel() != GEOHASH36_KERNEL_AUTO);
+   CHECK(geohash36_encodeKey_batch(lat, lon, NUM_POINTS, keys, GEOHASH36_KEY_MAX_CHARACTERS + 1) == -1);
+}
+
+static void test_batch_decode(void)
+{
+   enum { NUM_HASHES = 517 };
+   static double lat[NUM_HASHES], lon[NUM_HASHES], outLat[NUM_HASHES], outLon[NUM_HASHES];
+   static geohash36_bounds_t bounds[NUM_HASHES];
+   static uint8_t valid[NUM_HASHES];
+   static char hashes[NUM_HASHES * 24];
+   static const int lengths[] = { 1, 7, 10, 20, 24 };
+   geohash36_cell_t cell;
+   geohash36_bounds_t cellBounds;
+
+   for (int i = 0; i < NUM_HASHES; i++)
+   {
+      lat[i] = random_between(-90.0, 90.0);
+      lon[i] = random_between(-180.0, 180.0);
+   }
+
+   for (geohash36_kernel_t kernel = GEOHASH36_KERNEL_SCALAR; kernel <= GEOHASH36_KERNEL_AVX512; kernel++)
+   {
+      if (geohash36_batch_setKernel(kernel) != 0)
+         continue;
+
+      for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++)
+      {
+         int numCharacters = lengths[l];
+         long expectedInvalid = 0;
+
+         geohash36_encode_batch(lat, lon, NUM_HASHES, hashes, numCharacters);
+
+         // Corrupt some hashes with characters out of the alphabet (including non ASCII ones)
+         for (int i = 0; i < NUM_HASHES; i += 13)
+         {
+            hashes[(i * numCharacters) + (i % numCharacters)] = (i & 1) ? 'a' : (char)0xB2;
+            expectedInvalid++;
+         }
+
+         CHECK(geohash36_decode_batch(hashes, NUM_HASHES, numCharacters, outLat, outLon, bounds, valid) ==
+               expectedInvalid);
+
+         for (int i = 0; i < NUM_HASHES; i++)
+         {
+            double refLat, refLon;
+            int refResult = geohash36_decode(hashes + (i * numCharacters), numCharacters, &refLat, &refLon);
+
+            CHECK(valid[i] == (refResult == 0));
+
+            if (refResult == 0)
+            {
+               CHECK((outLat[i] == refLat) && (outLon[i] == refLon));
+
+               if (numCharacters <= GEOHASH36_MAX_CELL_CHARACTERS)
+               {
+                  geohash36_stringToCell(hashes + (i * numCharacters), numCharacters, &cell);
+                  geohash36_getCellBounds(&cell, &cellBounds);
+                  CHECK(memcmp(&cellBounds, &bounds[i], sizeof(cellBounds)) == 0);
+               }
+            }
+            else
+            {
+               CHECK((outLat[i] != outLat[i]) && (outLon[i] != outLon[i]));
+            }
+         }
+      }
+   }
+
+   CHECK(geohash36_batch_setKernel(GEOHASH36_KERNEL_AUTO) == 0);
+}
+
+static void test_neighbors(void)
+{
+   char buffer[GEOHASH36_KEY_MAX_CHARACTERS], neighbor[GEOHASH36_KEY_MAX_CHARACTERS];
+   char neighbors[GEO36_NEIGHBORS_COUNT * GEOHASH36_KEY_MAX_CHARACTERS];
+   geohash36_key_t keys[GEO36_NEIGHBORS_COUNT];
+   static const uint16_t directions[GEO36_NEIGHBORS_COUNT] =
+   {
+      GEO36_NEIGHBORS_DIR_NORTHWEST, GEO36_NEIGHBORS_DIR_NORTH, GEO36_NEIGHBORS_DIR_NORTHEAST,
+      GEO36_NEIGHBORS_DIR_WEST, GEO36_NEIGHBORS_DIR_CENTER, GEO36_NEIGHBORS_DIR_EAST,
+      GEO36_NEIGHBORS_DIR_SOUTHWEST, GEO36_NEIGHBORS_DIR_SOUTH, GEO36_NEIGHBORS_DIR_SOUTHEAST
+   };
+
+   // East of a cell in the last column moves into the next parent
+   CHECK(geohash36_getNeighbor("bdrdC26BqH", 10, neighbor, GEO36_NEIGHBORS_DIR_EAST) == neighbor);
+   CHECK(memcmp(neighbor, "bdrdC26BQD", 10) == 0);
+
+   // Longitude wraps at the antimeridian, latitude stops at the poles
+   CHECK(geohash36_getNeighbors("77", 2, neighbors) == 0x1F8);
+   CHECK(memcmp(neighbors + (GEO36_NEIGHBORS_INDEX_EAST * 2), "22", 2) == 0);
+   CHECK(memcmp(neighbors + (GEO36_NEIGHBORS_INDEX_SOUTH * 2), "7d", 2) == 0);
+   CHECK(geohash36_getNeighbor("77", 2, neighbor, GEO36_NEIGHBORS_DIR_NORTH) == NULL);
+   CHECK(geohash36_getNeighbors("7!", 2, neighbors) == -1);
+
+   for (int i = 0; i < 2000; i++)
+   {
+      int numCharacters = 1 + (i % GEOHASH36_KEY_MAX_CHARACTERS);
+      double lat = random_between(-89.0, 89.0), lon = random_between(-180.0, 180.0);
+      double latPrec = 180.0, lonPrec = 360.0;
+      int mask;
+
+      for (int k = 0; k < numCharacters; k++)
+      {
+         latPrec /= 6;
+         lonPrec /= 6;
+      }
+
+      geohash36_encode(lat, lon, buffer, numCharacters);
+      geohash36_decode(buffer, numCharacters, &lat, &lon);
+
+      mask = geohash36_getNeighbors(buffer, numCharacters, neighbors);
+      CHECK(geohash36_getKeyNeighbors(geohash36_stringToKey(buffer, numCharacters), keys) == mask);
+
+      for (int d = 0; d < GEO36_NEIGHBORS_COUNT; d++)
+      {
+         double neighborLat = lat + (((d / 3) - 1) * -latPrec);
+         double neighborLon = lon + (((d % 3) - 1) * lonPrec);
+         char * out = neighbors + (d * numCharacters);
+
+         neighborLon = (neighborLon > 180.0) ? (neighborLon - 360.0) : neighborLon;
+         neighborLon = (neighborLon < -180.0) ? (neighborLon + 360.0) : neighborLon;
+
+         if ((neighborLat < -90.0) || (neighborLat > 90.0))
+         {
+            CHECK((mask & (1 << d)) == 0);
+            CHECK(keys[d] == GEOHASH36_KEY_INVALID);
+            continue;
+         }
+
+         CHECK(mask & (1 << d));
+         geohash36_encode(neighborLat, neighborLon, neighbor, numCharacters);
+         CHECK(memcmp(neighbor, out, numCharacters) == 0);
+         CHECK(keys[d] == geohash36_stringToKey(out, numCharacters));
+         CHECK(geohash36_getNeighbor(buffer, numCharacters, neighbor, directions[d]) == neighbor);
+         CHECK(memcmp(neighbor, out, numCharacters) == 0);
+      }
+   }
+}
+
+static int cover_contains(const geohash36_key_t * keys_, int numKeys_, double lat_, double lon_)
+{
+   geohash36_key_t key = geohash36_encodeKey(lat_, lon_, GEOHASH36_KEY_MAX_CHARACTERS);
+
+   for (int i = 0; i < numKeys_; i++)
+   {
+      if (geohash36_keyHasPrefix(keys_[i], key))
+         return 1;
+   }
+
+   return 0;
+}
+
+static void test_cover(void)
+{
+   enum { MAX_CELLS = 64 };
+   geohash36_key_t keys[MAX_CELLS];
+   geohash36_bounds_t box;
+   int numKeys;
+
+   CHECK(geohash36_getDistanceInMeters(0, 0, 0, 1) > 111000);
+   CHECK(geohash36_getDistanceInMeters(0, 0, 0, 1) < 111300);
+
+   for (int i = 0; i < 200; i++)
+   {
+      double lat = random_between(-85.0, 85.0), lon = random_between(-180.0, 180.0);
+      double size = random_between(0.0001, 5.0);
+      int maxCells = 1 + (rand() % MAX_CELLS);
+
+      box.minLatitude = lat;
+      box.maxLatitude = lat + size;
+      box.minLongitude = lon;
+      box.maxLongitude = (lon + size > 180.0) ? (lon + size - 360.0) : (lon + size);
+
+      numKeys = geohash36_coverBounds(&box, 8, keys, maxCells);
+      CHECK((numKeys >= 1) && (numKeys <= maxCells));
+
+      for (int k = 1; k < numKeys; k++)
+      {
+         CHECK(keys[k - 1] < keys[k]);
+         CHECK(!geohash36_keyHasPrefix(keys[k - 1], keys[k]));
+      }
+
+      for (int p = 0; p < 50; p++)
+      {
+         double pointLon = lon + random_between(0.0, size);
+
+         pointLon = (pointLon > 180.0) ? (pointLon - 360.0) : pointLon;
+         CHECK(cover_contains(keys, numKeys, lat + random_between(0.0, size), pointLon));
+      }
+
+      numKeys = geohash36_coverRadius(lat, lon, size * 10000.0, 8, keys, maxCells);
+      CHECK((numKeys >= 1) && (numKeys <= maxCells));
+
+      for (int p = 0; p < 50; p++)
+      {
+         double pointLat = lat + random_between(-size, size), pointLon = lon + random_between(-size, size);
+
+         pointLon = (pointLon > 180.0) ? (pointLon - 360.0) : ((pointLon < -180.0) ? (pointLon + 360.0) : pointLon);
+
+         if (geohash36_getDistanceInMeters(lat, lon, pointLat, pointLon) <= (size * 10000.0))
+            CHECK(cover_contains(keys, numKeys, pointLat, pointLon));
+      }
+   }
+
+   // 50 meters fit in 4 cells of 7 characters (~70 meters), and more cells refine the border with 8 characters
+   CHECK(geohash36_coverRadius(51.504444, -0.086666, 50.0, 7, keys, MAX_CELLS) == 4);
+   numKeys = geohash36_coverRadius(51.504444, -0.086666, 50.0, 8, keys, MAX_CELLS);
+   CHECK((numKeys > 4) && (numKeys <= MAX_CELLS));
+   CHECK(GEOHASH36_KEY_LENGTH(keys[0]) == 8);
+   CHECK(geohash36_coverRadius(0, 0, -1.0, 7, keys, MAX_CELLS) == -1);
+}
+
+static int index_count(const geohash36_entry_t * entry_, void * context_)
+{
+   (void)entry_;
+   (*(size_t *)context_)++;
+   return 0;
+}
+
+static void test_index(void)
+{
+   enum { NUM_BUILD = 5000, NUM_INSERT = 3000, NUM_TOTAL = NUM_BUILD + NUM_INSERT };
+   static geohash36_key_t keys[NUM_TOTAL];
+   static uint64_t ids[NUM_TOTAL];
+   geohash36_index_t index;
+   geohash36_bounds_t box;
+   size_t count, expected;
+   double lat, lon;
+
+   // Clustered positions, so that prefix queries find something and radix passes get skipped
+   for (int i = 0; i < NUM_TOTAL; i++)
+   {
+      keys[i] = geohash36_encodeKey(random_between(51.0, 52.0), random_between(-1.0, 0.5), 1 + (rand() % 10));
+      ids[i] = (uint64_t)i;
+   }
+
+   CHECK(geohash36_index_init(&index) == 0);
+   CHECK(geohash36_index_build(&index, keys, ids, NUM_BUILD) == 0);
+
+   for (size_t i = 1; i < index.numEntries; i++)
+   {
+      CHECK(index.entries[i - 1].key <= index.entries[i].key);
+      if (index.entries[i - 1].key == index.entries[i].key)
+         CHECK(index.entries[i - 1].id < index.entries[i].id);
+   }
+
+   for (int i = NUM_BUILD; i < NUM_TOTAL; i++)
+      CHECK(geohash36_index_insert(&index, keys[i], ids[i]) == 0);
+
+   CHECK(geohash36_index_size(&index) == NUM_TOTAL);
+
+   for (int q = 0; q < 100; q++)
+   {
+      geohash36_key_t prefix = geohash36_keyTruncate(keys[rand() % NUM_TOTAL], 1 + (rand() % 6));
+
+      for (expected = 0, count = 0; count < NUM_TOTAL; count++)
+         expected += geohash36_keyHasPrefix(prefix, keys[count]) ? 1 : 0;
+
+      count = 0;
+      CHECK(geohash36_index_queryPrefix(&index, prefix, index_count, &count) == expected);
+      CHECK(count == expected);
+   }
+
+   for (int q = 0; q < 50; q++)
+   {
+      box.minLatitude = random_between(50.9, 52.0);
+      box.maxLatitude = box.minLatitude + random_between(0.0, 0.3);
+      box.minLongitude = random_between(-1.1, 0.5);
+      box.maxLongitude = box.minLongitude + random_between(0.0, 0.3);
+
+      expected = 0;
+      for (int i = 0; i < NUM_TOTAL; i++)
+      {
+         geohash36_decodeKey(keys[i], &lat, &lon);
+         expected += ((lat >= box.minLatitude) && (lat <= box.maxLatitude) && (lon >= box.minLongitude) &&
+                      (lon <= box.maxLongitude)) ? 1 : 0;
+      }
+
+      CHECK(geohash36_index_queryBounds(&index, &box, NULL, NULL) == (long)expected);
+   }
+
+   CHECK(geohash36_index_flush(&index) == 0);
+   CHECK(index.numEntries == NUM_TOTAL);
+   CHECK(index.numDelta == 0);
+
+   for (size_t i = 1; i < index.numEntries; i++)
+      CHECK(index.entries[i - 1].key <= index.entries[i].key);
+
+   geohash36_index_free(&index);
+}
+
+static int compare_distances(const void * a_, const void * b_)
+{
+   double a = *(const double *)a_, b = *(const double *)b_;
+
+   return (a < b) ? -1 : ((a > b) ? 1 : 0);
+}
+
+static void test_index_nearest(void)
+{
+   enum { NUM_POINTS = 20000, MAX_K = 40 };
+   static geohash36_key_t keys[NUM_POINTS];
+   static uint64_t ids[NUM_POINTS];
+   static double distances[NUM_POINTS];
+   geohash36_index_neighbor_t neighbors[MAX_K];
+   geohash36_index_t index;
+   double lat, lon;
+
+   for (int i = 0; i < NUM_POINTS; i++)
+   {
+      // Clustered, uniform, near the antimeridian and near the poles, some with shorter keys
+      switch (i % 4)
+      {
+         case 0: lat = random_between(51.4, 51.6); lon = random_between(-0.2, 0.0); break;
+         case 1: lat = random_between(-90.0, 90.0); lon = random_between(-180.0, 180.0); break;
+         case 2: lat = random_between(-10.0, 10.0); lon = (i % 8 == 2) ? 179.99 : -179.99; break;
+         default: lat = random_between(85.0, 90.0); lon = random_between(-180.0, 180.0); break;
+      }
+
+      keys[i] = geohash36_encodeKey(lat, lon, (i % 50 == 0) ? 5 : 10);
+      ids[i] = i;
+   }
+
+   CHECK(geohash36_index_init(&index) == 0);
+   CHECK(geohash36_index_queryNearest(&index, 0.0, 0.0, MAX_K, neighbors) == 0);
+   CHECK(geohash36_index_build(&index, keys, ids, NUM_POINTS - 500) == 0);
+
+   for (int i = NUM_POINTS - 500; i < NUM_POINTS; i++)
+      CHECK(geohash36_index_insert(&index, keys[i], ids[i]) == 0);
+
+   for (int q = 0; q < 300; q++)
+   {
+      size_t k = (q % 3 == 0) ? 1 : ((q % 3 == 1) ? 7 : MAX_K);
+      long found;
+
+      switch (q % 5)
+      {
+         case 0: lat = random_between(51.49, 51.53); lon = random_between(-0.3, 0.1); break;
+         case 1: lat = random_between(-5.0, 5.0); lon = random_between(179.0, 180.0); break;
+         case 2: lat = random_between(88.0, 90.0); lon = random_between(-180.0, 180.0); break;
+         default: lat = random_between(-90.0, 90.0); lon = random_between(-180.0, 180.0); break;
+      }
+
+      for (int i = 0; i < NUM_POINTS; i++)
+      {
+         double keyLat, keyLon;
+
+         geohash36_decodeKey(keys[i], &keyLat, &keyLon);
+         distances[i] = geohash36_getDistanceInMeters(lat, lon, keyLat, keyLon);
+      }
+
+      qsort(distances, NUM_POINTS, sizeof(double), compare_distances);
+
+      found = geohash36_index_queryNearest(&index, lat, lon, k, neighbors);
+      CHECK(found == (long)k);
+
+      for (size_t j = 0; (long)j < found; j++)
+      {
+         CHECK(fabs(neighbors[j].distance - distances[j]) <= 1e-6);
+         CHECK((j == 0) || (neighbors[j - 1].distance <= neighbors[j].distance));
+      }
+   }
+
+   CHECK(geohash36_index_queryNearest(&index, 91.0, 0.0, 1, neighbors) == -1);
+   CHECK(geohash36_index_queryNearest(&index, 0.0, 0.0, 1, NULL) == -1);
+   CHECK(geohash36_index_queryNearest(&index, 0.0, 0.0, 0, NULL) == 0);
+
+   geohash36_index_free(&index);
+}
+
+static void test_file(void)
+{
+   enum { NUM_ENTRIES = 20000 };
+   static geohash36_key_t keys[NUM_ENTRIES];
+   static uint64_t ids[NUM_ENTRIES];
+   const char * path = "geohash36_test.idx";
+   geohash36_index_t index;
+   geohash36_file_t file;
+   size_t count, expected;
+
+   for (int i = 0; i < NUM_ENTRIES; i++)
+   {
+      keys[i] = geohash36_encodeKey(random_between(40.0, 42.0), random_between(-75.0, -73.0), 1 + (rand() % 10));
+      ids[i] = (uint64_t)i;
+   }
+
+   CHECK(geohash36_index_init(&index) == 0);
+   CHECK(geohash36_index_build(&index, keys, ids, NUM_ENTRIES - 100) == 0);
+
+   for (int i = NUM_ENTRIES - 100; i < NUM_ENTRIES; i++)
+      CHECK(geohash36_index_insert(&index, keys[i], ids[i]) == 0);
+
+   CHECK(geohash36_file_writeIndex(path, &index) == 0);
+   CHECK(geohash36_file_open(&file, path) == 0);
+   CHECK(file.numEntries == NUM_ENTRIES);
+   CHECK(((uintptr_t)file.entries % GEOHASH36_FILE_PAGE_SIZE) == 0);
+   CHECK(memcmp(file.entries, index.entries, NUM_ENTRIES * sizeof(geohash36_entry_t)) == 0);
+
+   for (int q = 0; q < 200; q++)
+   {
+      geohash36_key_t key = (q % 2) ? keys[rand() % NUM_ENTRIES] : geohash36_encodeKey(41.0, -74.0, 1 + (q % 10));
+      geohash36_key_t prefix = geohash36_keyTruncate(key, 1 + (rand() % 6));
+      size_t position = 0;
+
+      while ((position < index.numEntries) && (index.entries[position].key < key))
+         position++;
+
+      CHECK(geohash36_file_lowerBound(&file, key) == position);
+
+      expected = geohash36_index_queryPrefix(&index, prefix, NULL, NULL);
+      count = 0;
+      CHECK(geohash36_file_queryPrefix(&file, prefix, index_count, &count) == expected);
+      CHECK(count == expected);
+   }
+
+   CHECK(geohash36_file_lowerBound(&file, GEOHASH36_KEY_INVALID) == NUM_ENTRIES);
+   geohash36_file_close(&file);
+
+   // Empty and unsorted tables
+   CHECK(geohash36_file_write(path, NULL, 0) == 0);
+   CHECK(geohash36_file_open(&file, path) == 0);
+   CHECK(geohash36_file_lowerBound(&file, keys[0]) == 0);
+   CHECK(geohash36_file_queryPrefix(&file, keys[0], NULL, NULL) == 0);
+   geohash36_file_close(&file);
+
+   {
+      geohash36_entry_t unsorted[2] = { { 2, 0 }, { 1, 0 } };
+      CHECK(geohash36_file_write(path, unsorted, 2) == -1);
+   }
+
+   remove(path);
+   CHECK(geohash36_file_open(&file, path) == -1);
+
+   geohash36_index_free(&index);
+}
+
+static void test_pool(void)
+{
+   enum { NUM_POINTS = 100000, NUM_CHARACTERS = 9 };
+   static double lat[NUM_POINTS], lon[NUM_POINTS], outLat[NUM_POINTS], outLon[NUM_POINTS];
+   static double poolLat[NUM_POINTS], poolLon[NUM_POINTS];
+   static char hashes[NUM_POINTS * NUM_CHARACTERS], poolHashes[NUM_POINTS * NUM_CHARACTERS];
+   static geohash36_key_t keys[NUM_POINTS], poolKeys[NUM_POINTS];
+   static char neighbors[1000 * GEO36_NEIGHBORS_COUNT * NUM_CHARACTERS];
+   static char poolNeighbors[1000 * GEO36_NEIGHBORS_COUNT * NUM_CHARACTERS];
+   static int masks[1000];
+   geohash36_pool_t pool;
+   int cpus[2] = { 0, 0 };
+
+   for (int i = 0; i < NUM_POINTS; i++)
+   {
+      lat[i] = random_between(-90.0, 90.0);
+      lon[i] = random_between(-180.0, 180.0);
+   }
+
+   CHECK(geohash36_encode_batch(lat, lon, NUM_POINTS, hashes, NUM_CHARACTERS) == 0);
+   CHECK(geohash36_encodeKey_batch(lat, lon, NUM_POINTS, keys, NUM_CHARACTERS) == 0);
+   hashes[7 * NUM_CHARACTERS] = '!';
+   CHECK(geohash36_decode_batch(hashes, NUM_POINTS, NUM_CHARACTERS, outLat, outLon, NULL, NULL) == 1);
+
+   for (int numThreads = 1; numThreads <= 4; numThreads++)
+   {
+      CHECK(geohash36_pool_init(&pool, numThreads, (numThreads == 2) ? cpus : NULL) == 0);
+
+      CHECK(geohash36_pool_encode(&pool, lat, lon, NUM_POINTS, poolHashes, NUM_CHARACTERS) == 0);
+      CHECK(memcmp(poolHashes + (8 * NUM_CHARACTERS), hashes + (8 * NUM_CHARACTERS),
+                   (NUM_POINTS - 8) * NUM_CHARACTERS) == 0);
+
+      CHECK(geohash36_pool_encodeKey(&pool, lat, lon, NUM_POINTS, poolKeys, NUM_CHARACTERS) == 0);
+      CHECK(memcmp(poolKeys, keys, sizeof(keys)) == 0);
+
+      CHECK(geohash36_pool_decode(&pool, hashes, NUM_POINTS, NUM_CHARACTERS, poolLat, poolLon, NULL, NULL) == 1);
+      CHECK(memcmp(poolLat + 8, outLat + 8, (NUM_POINTS - 8) * sizeof(double)) == 0);
+      CHECK(memcmp(poolLon, outLon, 7 * sizeof(double)) == 0);
+
+      CHECK(geohash36_pool_getNeighbors(&pool, hashes, 1000, NUM_CHARACTERS, poolNeighbors, masks) == 1);
+      CHECK(masks[7] == -1);
+
+      for (int i = 0; i < 1000; i++)
+      {
+         if (i == 7)
+            continue;
+
+         CHECK(geohash36_getNeighbors(hashes + (i * NUM_CHARACTERS), NUM_CHARACTERS,
+                                      neighbors + (i * GEO36_NEIGHBORS_COUNT * NUM_CHARACTERS)) == masks[i]);
+         CHECK(memcmp(neighbors + (i * GEO36_NEIGHBORS_COUNT * NUM_CHARACTERS),
+                      poolNeighbors + (i * GEO36_NEIGHBORS_COUNT * NUM_CHARACTERS),
+                      GEO36_NEIGHBORS_COUNT * NUM_CHARACTERS) == 0);
+      }
+
+      CHECK(geohash36_pool_encodeKey(&pool, lat, lon, NUM_POINTS, poolKeys, GEOHASH36_KEY_MAX_CHARACTERS + 1) == -1);
+      CHECK(geohash36_pool_decode(&pool, NULL, NUM_POINTS, NUM_CHARACTERS, poolLat, poolLon, NULL, NULL) == -1);
+
+      geohash36_pool_free(&pool);
+   }
+
+   // Out of range CPUs are rejected before any thread starts
+   cpus[1] = -1;
+   CHECK(geohash36_pool_init(&pool, 2, cpus) == -1);
+   cpus[1] = 1 << 20;
+   CHECK(geohash36_pool_init(&pool, 2, cpus) == -1);
+}
+
+static int polygon_contains(const double * lat_, const double * lon_, int n_, double latitude_, double longitude_)
+{
+   int inside = 0;
+
+   for (int i = 0, j = n_ - 1; i < n_; j = i++)
+   {
+      if (((lat_[i] > latitude_) != (lat_[j] > latitude_)) &&
+          (longitude_ < lon_[i] + ((lon_[j] - lon_[i]) * (latitude_ - lat_[i]) / (lat_[j] - lat_[i]))))
+         inside = !inside;
+   }
+
+   return inside;
+}
+
+// Limits the address space to its current size plus "extraBytes_", so that larger allocations fail (returns 0 when
+// the limit could not be set)
+static int limit_memory(size_t extraBytes_, struct rlimit * previous_)
+{
+   struct rlimit limit;
+   unsigned long pages;
+   FILE * file = fopen("/proc/self/statm", "r");
+   int result = 0;
+
+   if (file == NULL)
+      return 0;
+
+   if ((fscanf(file, "%lu", &pages) == 1) && (getrlimit(RLIMIT_AS, previous_) == 0))
+   {
+      limit = *previous_;
+      limit.rlim_cur = ((rlim_t)pages * (rlim_t)sysconf(_SC_PAGESIZE)) + extraBytes_;
+      result = (limit.rlim_cur < previous_->rlim_cur) && (setrlimit(RLIMIT_AS, &limit) == 0);
+   }
+
+   fclose(file);
+
+   return result;
+}
+
+static void test_geofence(void)
+{
+   enum { NUM_POLYGONS = 6, NUM_VERTICES = 10, NUM_POINTS = 20000 };
+   static const double centers[NUM_POLYGONS][2] = { { 51.5, -0.1 }, { 51.52, -0.12 }, { 40.7, -74.0 },
+                                                     { -33.9, 151.2 }, { 0.0, 0.0 }, { 51.49, -0.08 } };
+   double lat[NUM_POLYGONS][NUM_VERTICES], lon[NUM_POLYGONS][NUM_VERTICES];
+   geohash36_geofence_t geofence, fine;
+   uint32_t ids[NUM_POLYGONS];
+   size_t numKeys, numPostings;
+   struct rlimit limit;
+
+   CHECK(geohash36_geofence_init(&geofence, 0) == -1);
+   CHECK(geohash36_geofence_init(&geofence, GEOHASH36_KEY_MAX_CHARACTERS + 1) == -1);
+   CHECK(geohash36_geofence_init(&geofence, 6) == 0);
+
+   // Stars (concave), overlapping around London
+   for (int p = 0; p < NUM_POLYGONS; p++)
+   {
+      double radius = (p == 4) ? 2.0 : 0.05;
+
+      for (int v = 0; v < NUM_VERTICES; v++)
+      {
+         double angle = (2.0 * 3.14159265358979 * v) / NUM_VERTICES;
+         double r = (v % 2) ? (radius * 0.4) : radius;
+
+         lat[p][v] = centers[p][0] + (r * sin(angle));
+         lon[p][v] = centers[p][1] + (r * cos(angle));
+      }
+
+      CHECK(geohash36_geofence_add(&geofence, 100 + p, lat[p], lon[p], NUM_VERTICES) == 0);
+   }
+
+   CHECK(geohash36_geofence_add(&geofence, 1, lat[0], lon[0], 2) == -1);
+   lat[0][3] = 91.0;
+   CHECK(geohash36_geofence_add(&geofence, 1, lat[0], lon[0], NUM_VERTICES) == -1);
+   lat[0][3] = centers[0][0] + (0.02 * sin((2.0 * 3.14159265358979 * 3) / NUM_VERTICES));
+
+   for (int i = 0; i < NUM_POINTS; i++)
+   {
+      int p = i % NUM_POLYGONS, expected = 0, count;
+      double latitude = centers[p][0] + random_between(-0.06, 0.06) * ((p == 4) ? 40.0 : 1.0);
+      double longitude = centers[p][1] + random_between(-0.06, 0.06) * ((p == 4) ? 40.0 : 1.0);
+      bool found[NUM_POLYGONS] = { false };
+
+      count = geohash36_geofence_query(&geofence, latitude, longitude, ids, NUM_POLYGONS);
+      CHECK((count >= 0) && (count <= NUM_POLYGONS));
+
+      for (int k = 0; k < count; k++)
+      {
+         CHECK((ids[k] >= 100) && (ids[k] < 100 + NUM_POLYGONS) && !found[ids[k] - 100]);
+         found[ids[k] - 100] = true;
+      }
+
+      for (int q = 0; q < NUM_POLYGONS; q++)
+      {
+         expected += polygon_contains(lat[q], lon[q], NUM_VERTICES, latitude, longitude);
+         CHECK(found[q] == (bool) polygon_contains(lat[q], lon[q], NUM_VERTICES, latitude, longitude));
+      }
+
+      CHECK(count == expected);
+   }
+
+   CHECK(geohash36_geofence_query(&geofence, centers[0][0], centers[0][1], ids, 0) ==
+         polygon_contains(lat[0], lon[0], NUM_VERTICES, centers[0][0], centers[0][1]) +
+         polygon_contains(lat[1], lon[1], NUM_VERTICES, centers[0][0], centers[0][1]) +
+         polygon_contains(lat[5], lon[5], NUM_VERTICES, centers[0][0], centers[0][1]));
+   CHECK(geohash36_geofence_query(&geofence, 0.0, 0.0, NULL, 0) == 1);
+   CHECK(geohash36_geofence_query(&geofence, -60.0, 10.0, ids, NUM_POLYGONS) == 0);
+   CHECK(geohash36_geofence_query(&geofence, NAN, 10.0, ids, NUM_POLYGONS) == -1);
+
+   // Polygons whose cells cannot be allocated are rolled back (each one leaves thousands of keys, some of them in probe
+   // sequences wrapping past the end of the table) and leave the other polygons as they were
+   CHECK(geohash36_geofence_init(&fine, 8) == 0);
+   CHECK(geohash36_geofence_add(&fine, 100, lat[0], lon[0], NUM_VERTICES) == 0);
+
+   numKeys = fine.numKeys;
+   numPostings = fine.numPostings;
+
+   for (int k = 0; k < 8; k++)
+   {
+      double squareLat[4] = { 11.0 + k, 11.0 + k, 12.0 + k, 12.0 + k };
+      double squareLon[4] = { 17.0 - (3.0 * k), 18.0 - (3.0 * k), 18.0 - (3.0 * k), 17.0 - (3.0 * k) };
+      size_t count = 0;
+
+      if (!limit_memory(1 << 20, &limit))
+         break;
+
+      CHECK(geohash36_geofence_add(&fine, 101, squareLat, squareLon, 4) == -1);
+      CHECK(setrlimit(RLIMIT_AS, &limit) == 0);
+      CHECK((fine.numKeys == numKeys) && (fine.numPostings == numPostings) && (fine.numPolygons == 1));
+
+      for (size_t i = 0; i < fine.numSlots; i++)
+      {
+         if (fine.slots[i].key != GEOHASH36_KEY_INVALID)
+         {
+            CHECK(fine.slots[i].head != UINT32_MAX);
+            count++;
+         }
+      }
+
+      CHECK(count == numKeys);
+      CHECK(geohash36_geofence_query(&fine, squareLat[0] + 0.5, squareLon[0] + 0.5, ids, NUM_POLYGONS) == 0);
+   }
+
+   for (int i = 0; i < 1000; i++)
+   {
+      double latitude = centers[0][0] + random_between(-0.06, 0.06);
+      double longitude = centers[0][1] + random_between(-0.06, 0.06);
+
+      CHECK(geohash36_geofence_query(&fine, latitude, longitude, ids, NUM_POLYGONS) ==
+            polygon_contains(lat[0], lon[0], NUM_VERTICES, latitude, longitude));
+   }
+
+   CHECK(geohash36_geofence_add(&fine, 101, lat[4], lon[4], NUM_VERTICES) == 0);
+   CHECK(geohash36_geofence_query(&fine, centers[4][0], centers[4][1], ids, NUM_POLYGONS) == 1);
+   CHECK(ids[0] == 101);
+
+   geohash36_geofence_free(&fine);
+   geohash36_geofence_free(&geofence);
+}
+
+static void test_aggregate(void)
+{
+   enum { NUM_POINTS = 20000, MAX_CHARACTERS = 6, NUM_BIG = 200000 };
+   static double lat[NUM_POINTS], lon[NUM_POINTS], values[NUM_POINTS], bigLat[NUM_BIG], bigLon[NUM_BIG];
+   static geohash36_key_t keys[NUM_POINTS], bigKeys[NUM_BIG];
+   static geohash36_aggregate_cell_t cells[MAX_CHARACTERS * NUM_POINTS], shardCells[MAX_CHARACTERS * NUM_POINTS];
+   geohash36_aggregate_t aggregate, shards[2];
+   geohash36_aggregate_cell_t cell;
+   uint64_t totals[MAX_CHARACTERS + 1] = { 0 };
+   struct rlimit limit;
+   long numCells;
+
+   for (int i = 0; i < NUM_POINTS; i++)
+   {
+      // Clustered, with runs of nearby points
+      lat[i] = ((i / 100) % 2) ? random_between(51.4, 51.6) : random_between(-90.0, 90.0);
+      lon[i] = ((i / 100) % 2) ? random_between(-0.2, 0.0) : random_between(-180.0, 180.0);
+      values[i] = (double)(i % 4);
+   }
+
+   CHECK(geohash36_encodeKey_batch(lat, lon, NUM_POINTS, keys, MAX_CHARACTERS) == 0);
+
+   CHECK(geohash36_aggregate_init(&aggregate, 0) == -1);
+   CHECK(geohash36_aggregate_init(&aggregate, MAX_CHARACTERS) == 0);
+   CHECK(geohash36_aggregate_addPoints(&aggregate, lat, lon, values, NUM_POINTS) == 0);
+
+   numCells = geohash36_aggregate_export(&aggregate, cells, MAX_CHARACTERS * NUM_POINTS);
+   CHECK((numCells > 0) && ((size_t)numCells == aggregate.numCells));
+   CHECK(geohash36_aggregate_export(&aggregate, cells, 1) == -1);
+
+   for (long c = 0; c < numCells; c++)
+   {
+      CHECK((c == 0) || (cells[c - 1].key < cells[c].key));
+      totals[GEOHASH36_KEY_LENGTH(cells[c].key)] += cells[c].count;
+   }
+
+   for (int length = 1; length <= MAX_CHARACTERS; length++)
+      CHECK(totals[length] == NUM_POINTS);
+
+   for (int i = 0; i < NUM_POINTS; i += 97)
+   {
+      for (int length = 1; length <= MAX_CHARACTERS; length++)
+      {
+         geohash36_key_t prefix = geohash36_keyTruncate(keys[i], length);
+         uint64_t count = 0;
+         double sum = 0.0;
+
+         for (int j = 0; j < NUM_POINTS; j++)
+         {
+            if (geohash36_keyHasPrefix(prefix, keys[j]))
+            {
+               count++;
+               sum += values[j];
+            }
+         }
+
+         CHECK(geohash36_aggregate_get(&aggregate, prefix, &cell) == 0);
+         CHECK((cell.count == count) && (cell.sum == sum));
+      }
+   }
+
+   // Shards merged together, one from keys and one from points, give the same cells
+   CHECK(geohash36_aggregate_init(&shards[0], MAX_CHARACTERS) == 0);
+   CHECK(geohash36_aggregate_init(&shards[1], MAX_CHARACTERS) == 0);
+   CHECK(geohash36_aggregate_addKeys(&shards[0], keys, values, NUM_POINTS / 3) == 0);
+   CHECK(geohash36_aggregate_addPoints(&shards[1], lat + (NUM_POINTS / 3), lon + (NUM_POINTS / 3),
+                                       values + (NUM_POINTS / 3), NUM_POINTS - (NUM_POINTS / 3)) == 0);
+   CHECK(geohash36_aggregate_merge(&shards[0], &shards[1]) == 0);
+   CHECK(geohash36_aggregate_export(&shards[0], shardCells, MAX_CHARACTERS * NUM_POINTS) == numCells);
+   CHECK(memcmp(cells, shardCells, numCells * sizeof(geohash36_aggregate_cell_t)) == 0);
+
+   CHECK(geohash36_aggregate_get(&aggregate, geohash36_stringToKey("22222", 5), &cell) == 0);
+   CHECK(cell.count == 0);
+   geohash36_aggregate_free(&shards[1]);
+   CHECK(geohash36_aggregate_init(&shards[1], MAX_CHARACTERS - 1) == 0);
+   CHECK(geohash36_aggregate_merge(&shards[0], &shards[1]) == -1);
+
+   // A batch whose table cannot be allocated leaves the aggregate as it was (about 6 new cells per scattered point)
+   for (int i = 0; i < NUM_BIG; i++)
+   {
+      bigLat[i] = random_between(-90.0, 90.0);
+      bigLon[i] = random_between(-180.0, 180.0);
+   }
+
+   CHECK(geohash36_encodeKey_batch(bigLat, bigLon, NUM_BIG, bigKeys, MAX_CHARACTERS) == 0);
+
+   if (limit_memory(32 << 20, &limit))
+   {
+      CHECK(geohash36_aggregate_addPoints(&aggregate, bigLat, bigLon, NULL, NUM_BIG) == -1);
+      CHECK(geohash36_aggregate_addKeys(&aggregate, bigKeys, NULL, NUM_BIG) == -1);
+      CHECK(setrlimit(RLIMIT_AS, &limit) == 0);
+
+      CHECK(geohash36_aggregate_export(&aggregate, shardCells, MAX_CHARACTERS * NUM_POINTS) == numCells);
+      CHECK(memcmp(cells, shardCells, numCells * sizeof(geohash36_aggregate_cell_t)) == 0);
+   }
+
+   CHECK(geohash36_aggregate_addKeys(&aggregate, bigKeys, NULL, NUM_BIG) == 0);
+   CHECK(geohash36_aggregate_get(&aggregate, geohash36_keyTruncate(bigKeys[0], 1), &cell) == 0);
+   CHECK(cell.count > 0);
+
+   geohash36_aggregate_free(&shards[1]);
+   geohash36_aggregate_free(&shards[0]);
+   geohash36_aggregate_free(&aggregate);
+}
+
+enum { TRACKER_OBJECTS = 3000, TRACKER_CHARACTERS = 10 };
+static geohash36_key_t tracker_cells[TRACKER_OBJECTS][TRACKER_CHARACTERS + 1];
+static int tracker_bad_events = 0;
+
+// Follows the cells of each object through the events
+static void tracker_event(const geohash36_tracker_event_t * event_, void * context_)
+{
+   (void)context_;
+
+   if ((event_->id >= TRACKER_OBJECTS) || (event_->left == event_->entered) ||
+       (tracker_cells[event_->id][event_->numCharacters] != event_->left))
+      tracker_bad_events++;
+   else
+      tracker_cells[event_->id][event_->numCharacters] = event_->entered;
+}
+
+static void test_tracker(void)
+{
+   static double lat[TRACKER_OBJECTS], lon[TRACKER_OBJECTS];
+   geohash36_tracker_t tracker;
+   geohash36_key_t key, previous;
+   const uint32_t eventLengths = (1u << 3) | (1u << 6) | (1u << 10);
+
+   for (int i = 0; i < TRACKER_OBJECTS; i++)
+   {
+      for (int length = 0; length <= TRACKER_CHARACTERS; length++)
+         tracker_cells[i][length] = GEOHASH36_KEY_INVALID;
+
+      lat[i] = random_between(-89.0, 89.0);
+      lon[i] = random_between(-179.0, 179.0);
+   }
+
+   CHECK(geohash36_tracker_init(&tracker, 0, 0, NULL, NULL) == -1);
+   CHECK(geohash36_tracker_init(&tracker, 6, 1u << 7, NULL, NULL) == -1);
+   CHECK(geohash36_tracker_init(&tracker, TRACKER_CHARACTERS, eventLengths, tracker_event, NULL) == 0);
+
+   for (int step = 0; step < 20; step++)
+   {
+      for (int i = 0; i < TRACKER_OBJECTS; i++)
+      {
+         int changed, common = 0;
+
+         previous = geohash36_tracker_get(&tracker, i);
+
+         // A few meters, sometimes a jump
+         lat[i] += (i % 50 == step) ? random_between(-1.0, 1.0) : random_between(-0.00005, 0.00005);
+         lon[i] += (i % 50 == step) ? random_between(-1.0, 1.0) : random_between(-0.00005, 0.00005);
+
+         changed = geohash36_tracker_update(&tracker, i, lat[i], lon[i], &key);
+         CHECK(key == geohash36_encodeKey(lat[i], lon[i], TRACKER_CHARACTERS));
+         CHECK(geohash36_tracker_get(&tracker, i) == key);
+
+         while ((previous != GEOHASH36_KEY_INVALID) && (common < TRACKER_CHARACTERS) &&
+                (geohash36_keyTruncate(previous, common + 1) == geohash36_keyTruncate(key, common + 1)))
+            common++;
+
+         CHECK(changed == TRACKER_CHARACTERS - common);
+      }
+   }
+
+   CHECK(tracker.numObjects == TRACKER_OBJECTS);
+   CHECK(geohash36_tracker_update(&tracker, 1, 91.0, 0.0, NULL) == -1);
+
+   // Removal keeps the other objects reachable
+   for (int i = 0; i < TRACKER_OBJECTS; i += 2)
+      CHECK(geohash36_tracker_remove(&tracker, i) == 0);
+
+   CHECK(geohash36_tracker_remove(&tracker, 0) == -1);
+   CHECK(tracker.numObjects == TRACKER_OBJECTS / 2);
+
+   for (int i = 0; i < TRACKER_OBJECTS; i++)
+   {
+      key = geohash36_tracker_get(&tracker, i);
+      CHECK((i % 2 == 0) ? (key == GEOHASH36_KEY_INVALID) :
+                           (key == geohash36_encodeKey(lat[i], lon[i], TRACKER_CHARACTERS)));
+
+      for (int length = 1; length <= TRACKER_CHARACTERS; length++)
+      {
+         if (eventLengths & (1u << length))
+            CHECK(tracker_cells[i][length] == ((i % 2 == 0) ? GEOHASH36_KEY_INVALID :
+                                                                geohash36_keyTruncate(key, length)));
+      }
+   }
+
+   CHECK(tracker_bad_events == 0);
+
+   geohash36_tracker_free(&tracker);
+}
+
+enum { JOIN_POINTS = 1500, JOIN_MAX_PAIRS = 200000 };
+static uint64_t join_pairs[JOIN_MAX_PAIRS];
+static long join_numPairs = 0;
+static int join_bad_distances = 0;
+
+// Collects the pairs as "first * JOIN_POINTS + second" (called from several threads with a pool)
+static int join_collect(size_t first_, size_t second_, double distance_, void * context_)
+{
+   const double * limit = (const double *)context_;
+   long slot = __atomic_fetch_add(&join_numPairs, 1, __ATOMIC_RELAXED);
+
+   if (slot < JOIN_MAX_PAIRS)
+      join_pairs[slot] = ((uint64_t)first_ * JOIN_POINTS) + second_;
+
+   if (!(distance_ <= *limit))
+      __atomic_fetch_add(&join_bad_distances, 1, __ATOMIC_RELAXED);
+
+   return 0;
+}
+
+static int join_stop(size_t first_, size_t second_, double distance_, void * context_)
+{
+   (void)first_;
+   (void)second_;
+   (void)distance_;
+
+   return (__atomic_add_fetch((long *)context_, 1, __ATOMIC_RELAXED) >= 10);
+}
+
+static int compare_pairs(const void * a_, const void * b_)
+{
+   uint64_t a = *(const uint64_t *)a_, b = *(const uint64_t *)b_;
+   return (a > b) - (a < b);
+}
+
+static void test_join(void)
+{
+   static double lat1[JOIN_POINTS], lon1[JOIN_POINTS], lat2[JOIN_POINTS], lon2[JOIN_POINTS];
+   static uint64_t expected[JOIN_MAX_PAIRS];
+   // Latitude/longitude ranges and distance: city, pole, antimeridian, global
+   const double areas[][5] = { { 48.0, 49.0, 2.0, 3.5, 2000.0 },
+                               { 88.5, 90.0, -180.0, 180.0, 30000.0 },
+                               { -1.0, 1.0, 179.0, 181.0, 8000.0 },
+                               { -90.0, 90.0, -180.0, 180.0, 800000.0 },
+                               { 10.0, 10.0001, 20.0, 20.0001, 0.0 },
+                               { 89.9999, 90.0, -180.0, 180.0, 1.5 } };
+   geohash36_pool_t pool;
+   long count, stopped = 0;
+
+   CHECK(geohash36_pool_init(&pool, 3, NULL) == 0);
+
+   for (size_t area = 0; area < sizeof(areas) / sizeof(areas[0]); area++)
+   {
+      long numExpected = 0;
+
+      for (int i = 0; i < JOIN_POINTS; i++)
+      {
+         lat1[i] = random_between(areas[area][0], areas[area][1]);
+         lon1[i] = random_between(areas[area][2], areas[area][3]);
+         lat2[i] = random_between(areas[area][0], areas[area][1]);
+         lon2[i] = random_between(areas[area][2], areas[area][3]);
+         lon1[i] -= (lon1[i] > 180.0) ? 360.0 : 0.0;
+         lon2[i] -= (lon2[i] > 180.0) ? 360.0 : 0.0;
+
+         // Exact duplicates for the zero distance
+         if ((i % 7) == 0)
+         {
+            lat2[i] = lat1[i / 2];
+            lon2[i] = lon1[i / 2];
+         }
+      }
+
+      for (int i = 0; i < JOIN_POINTS; i++)
+         for (int j = 0; j < JOIN_POINTS; j++)
+            if ((geohash36_getDistanceInMeters(lat1[i], lon1[i], lat2[j], lon2[j]) <= areas[area][4]) &&
+                (numExpected < JOIN_MAX_PAIRS))
+               expected[numExpected++] = ((uint64_t)i * JOIN_POINTS) + j;
+
+      CHECK(numExpected > 0);
+
+      for (int usePool = 0; usePool <= 1; usePool++)
+      {
+         join_numPairs = 0;
+         join_bad_distances = 0;
+
+         count = geohash36_join(usePool ? &pool : NULL, lat1, lon1, JOIN_POINTS, lat2, lon2, JOIN_POINTS,
+                                areas[area][4], join_collect, (void *)&areas[area][4]);
+         CHECK(count == numExpected);
+         CHECK(join_numPairs == numExpected);
+         CHECK(join_bad_distances == 0);
+
+         qsort(join_pairs, (size_t)MIN(join_numPairs, JOIN_MAX_PAIRS), sizeof(uint64_t), compare_pairs);
+         CHECK((count == numExpected) && (memcmp(join_pairs, expected, numExpected * sizeof(uint64_t)) == 0));
+      }
+   }
+
+   // Polar rows, whose bounds can round beyond 90 degrees
+   for (double distance = 0.5; distance < 2.0; distance += 0.1)
+   {
+      double polarLat1 = 89.999998, polarLat2 = 89.999998 + 1e-9, polarLon = 10.0, exactLat = 90.0;
+
+      CHECK(geohash36_join(NULL, &polarLat1, &polarLon, 1, &polarLat2, &polarLon, 1, distance, NULL, NULL) == 1);
+      CHECK(geohash36_join(NULL, &exactLat, &polarLon, 1, &exactLat, &polarLon, 1, distance, NULL, NULL) == 1);
+   }
+
+   // Stops when the callback asks for it
+   count = geohash36_join(NULL, lat1, lon1, JOIN_POINTS, lat2, lon2, JOIN_POINTS, 1000.0, join_stop, &stopped);
+   CHECK((count == 10) && (stopped == 10));
+
+   CHECK(geohash36_join(&pool, lat1, lon1, JOIN_POINTS, lat2, lon2, 0, 1000.0, NULL, NULL) == 0);
+   CHECK(geohash36_join(&pool, lat1, lon1, JOIN_POINTS, lat2, lon2, JOIN_POINTS, -1.0, NULL, NULL) == -1);
+   CHECK(geohash36_join(&pool, lat1, lon1, JOIN_POINTS, lat2, lon2, JOIN_POINTS, NAN, NULL, NULL) == -1);
+
+   geohash36_pool_free(&pool);
+}
+
+// Position of the first key not lower than "key_" (packed key order, as the collections sort)
+static size_t lower_bound(const geohash36_key_t * keys_, size_t n_, geohash36_key_t key_)
+{
+   size_t i = 0;
+
+   while ((i < n_) && (keys_[i] < key_))
+      i++;
+
+   return i;
+}
+
+static void test_compact(void)
+{
+   enum { NUM_POINTS = 20000, NUM_CHARACTERS = 10, SHORT_CHARACTERS = 6 };
+   static double lat[NUM_POINTS], lon[NUM_POINTS];
+   static char hashes[NUM_POINTS * NUM_CHARACTERS];
+   static geohash36_key_t keys[NUM_POINTS], shortKeys[NUM_POINTS], decoded[NUM_POINTS];
+   geohash36_compact_t compact, fromStrings, shortCompact;
+   size_t first;
+
+   // A city, with some points reported twice
+   for (int i = 0; i < NUM_POINTS; i++)
+   {
+      lat[i] = (i % 10 == 9) ? lat[i - 1] : random_between(51.49, 51.53);
+      lon[i] = (i % 10 == 9) ? lon[i - 1] : random_between(-0.14, -0.06);
+   }
+
+   CHECK(geohash36_encodeKey_batch(lat, lon, NUM_POINTS, keys, NUM_CHARACTERS) == 0);
+   qsort(keys, NUM_POINTS, sizeof(keys[0]), compare_keys);
+
+   for (int i = 0; i < NUM_POINTS; i++)
+   {
+      geohash36_keyToString(keys[i], hashes + (i * NUM_CHARACTERS));
+      shortKeys[i] = geohash36_keyTruncate(keys[i], SHORT_CHARACTERS);
+   }
+
+   CHECK(geohash36_compact_init(&compact, 0, GEOHASH36_COMPACT_DEFAULT_RESTART) == -1);
+   CHECK(geohash36_compact_init(&compact, NUM_CHARACTERS, 0) == -1);
+   CHECK(geohash36_compact_init(&compact, NUM_CHARACTERS, 7) == 0);
+   CHECK(geohash36_compact_init(&fromStrings, NUM_CHARACTERS, GEOHASH36_COMPACT_DEFAULT_RESTART) == 0);
+   CHECK(geohash36_compact_init(&shortCompact, SHORT_CHARACTERS, 1) == 0);
+
+   CHECK(geohash36_compact_build(&compact, keys, NUM_POINTS) == 0);
+   CHECK(geohash36_compact_buildStrings(&fromStrings, hashes, NUM_POINTS) == 0);
+   CHECK(geohash36_compact_build(&shortCompact, shortKeys, NUM_POINTS) == 0);
+   CHECK((compact.numEntries == NUM_POINTS) && (fromStrings.numEntries == NUM_POINTS));
+
+   // At least 3 times smaller than the strings
+   CHECK(3 * geohash36_compact_getBytes(&fromStrings) < NUM_POINTS * NUM_CHARACTERS);
+
+   CHECK(geohash36_compact_decode(&compact, 0, NUM_POINTS + 10, decoded) == NUM_POINTS);
+   CHECK(memcmp(decoded, keys, sizeof(keys)) == 0);
+   CHECK(geohash36_compact_decode(&fromStrings, 0, NUM_POINTS, decoded) == NUM_POINTS);
+   CHECK(memcmp(decoded, keys, sizeof(keys)) == 0);
+   CHECK(geohash36_compact_decode(&shortCompact, 0, NUM_POINTS, decoded) == NUM_POINTS);
+   CHECK(memcmp(decoded, shortKeys, sizeof(shortKeys)) == 0);
+   CHECK(geohash36_compact_decode(&compact, 1234, 100, decoded) == 100);
+   CHECK(memcmp(decoded, keys + 1234, 100 * sizeof(geohash36_key_t)) == 0);
+   CHECK(geohash36_compact_decode(&compact, NUM_POINTS, 1, decoded) == 0);
+
+   for (int i = 0; i < 500; i++)
+   {
+      size_t position = (size_t)rand() % NUM_POINTS;
+      geohash36_key_t probe = geohash36_encodeKey(random_between(51.49, 51.53), random_between(-0.14, -0.06),
+                                                  1 + (rand() % NUM_CHARACTERS));
+      geohash36_key_t prefix = geohash36_keyTruncate(keys[position], rand() % (NUM_CHARACTERS + 1));
+      long count = 0;
+
+      CHECK(geohash36_compact_get(&compact, position) == keys[position]);
+      CHECK(geohash36_compact_get(&fromStrings, position) == keys[position]);
+      CHECK(geohash36_compact_find(&compact, keys[position]) == lower_bound(keys, NUM_POINTS, keys[position]));
+      CHECK(geohash36_compact_find(&compact, probe) == lower_bound(keys, NUM_POINTS, probe));
+      CHECK(geohash36_compact_find(&shortCompact, keys[position]) ==
+            lower_bound(shortKeys, NUM_POINTS, keys[position]));
+
+      for (int j = 0; j < NUM_POINTS; j++)
+         count += geohash36_keyHasPrefix(prefix, keys[j]);
+
+      CHECK(geohash36_compact_findPrefix(&fromStrings, prefix, &first) == count);
+      CHECK(first == lower_bound(keys, NUM_POINTS, prefix));
+   }
+
+   CHECK(geohash36_compact_get(&compact, NUM_POINTS) == GEOHASH36_KEY_INVALID);
+   CHECK(geohash36_compact_find(&compact, GEOHASH36_KEY_INVALID) == NUM_POINTS);
+   CHECK(geohash36_compact_findPrefix(&shortCompact, keys[0], NULL) == -1);
+
+   // Rebuilding reuses the memory
+   CHECK(geohash36_compact_build(&compact, keys + 1, NUM_POINTS - 1) == 0);
+   CHECK(geohash36_compact_get(&compact, 0) == keys[1]);
+   CHECK(geohash36_compact_get(&compact, NUM_POINTS - 2) == keys[NUM_POINTS - 1]);
+
+   // Unsorted or foreign keys are refused
+   CHECK(geohash36_compact_build(&shortCompact, keys, NUM_POINTS) == -1);
+   CHECK(shortCompact.numEntries == 0);
+
+   hashes[5 * NUM_CHARACTERS] = '!';
+   CHECK(geohash36_compact_buildStrings(&fromStrings, hashes, NUM_POINTS) == -1);
+   CHECK(fromStrings.numEntries == 0);
+   keys[NUM_POINTS / 2] = keys[NUM_POINTS - 1];
+   CHECK(geohash36_compact_build(&compact, keys, NUM_POINTS) == -1);
+   CHECK(compact.numEntries == 0);
+
+   geohash36_compact_free(&shortCompact);
+   geohash36_compact_free(&fromStrings);
+   geohash36_compact_free(&compact);
+}
+
+typedef struct
+{
+   geohash36_counter_t * counter;
+   const double * lat;
+   const double * lon;
+   size_t n;
+   int numCharacters;
+   size_t stripe;
+   int result;
+
+}counter_writer_t;
+
+static void * counter_writer(void * context_)
+{
+   counter_writer_t * writer = context_;
+
+   writer->result = geohash36_counter_addPoints(writer->counter, writer->lat, writer->lon, writer->n,
+                                                 writer->numCharacters, writer->stripe);
+   return NULL;
+}
+
+static void test_counter(void)
+{
+   enum { NUM_POINTS = 40000, NUM_THREADS = 4, NUM_CHARACTERS = 4, MAX_CELLS = 4096 };
+   static double lat[NUM_POINTS], lon[NUM_POINTS];
+   static geohash36_key_t keys[NUM_POINTS];
+   static geohash36_counter_cell_t cells[MAX_CELLS], expected[MAX_CELLS];
+   counter_writer_t writers[NUM_THREADS];
+   pthread_t threads[NUM_THREADS];
+   geohash36_counter_t counter, totals, small;
+   size_t numExpected = 0;
+   int64_t snapshotSum = 0;
+   long count;
+
+   // Hot cells around a city, and a sparse background
+   for (int i = 0; i < NUM_POINTS; i++)
+   {
+      lat[i] = (i % 4 != 0) ? random_between(48.84, 48.87) : random_between(47.0, 51.0);
+      lon[i] = (i % 4 != 0) ? random_between(2.32, 2.37) : random_between(0.0, 5.0);
+   }
+
+   CHECK(geohash36_encodeKey_batch(lat, lon, NUM_POINTS, keys, NUM_CHARACTERS) == 0);
+   qsort(keys, NUM_POINTS, sizeof(keys[0]), compare_keys);
+
+   for (int i = 0; i < NUM_POINTS; i++)
+   {
+      if ((numExpected == 0) || (expected[numExpected - 1].key != keys[i]))
+         expected[numExpected++] = (geohash36_counter_cell_t) { keys[i], 0 };
+
+      expected[numExpected - 1].count++;
+   }
+
+   CHECK((numExpected > 100) && (numExpected < MAX_CELLS));
+
+   CHECK(geohash36_counter_init(&counter, 0, 1) == -1);
+   CHECK(geohash36_counter_init(&counter, MAX_CELLS, 0) == -1);
+   CHECK(geohash36_counter_init(&counter, MAX_CELLS, NUM_THREADS) == 0);
+   CHECK(geohash36_counter_init(&totals, MAX_CELLS, 1) == 0);
+
+   // Writers on their own stripes, while snapshots drain the counters
+   for (int i = 0; i < NUM_THREADS; i++)
+   {
+      size_t first = i * (NUM_POINTS / NUM_THREADS);
+
+      writers[i] = (counter_writer_t) { &counter, lat + first, lon + first, NUM_POINTS / NUM_THREADS, NUM_CHARACTERS,
+                                        i, -1 };
+      CHECK(pthread_create(&threads[i], NULL, counter_writer, &writers[i]) == 0);
+   }
+
+   for (int pass = 0; pass < 2; pass++)
+   {
+      do
+      {
+         CHECK((count = geohash36_counter_snapshot(&counter, cells, MAX_CELLS, 1)) >= 0);
+
+         for (long i = 0; i < count; i++)
+         {
+            CHECK((i == 0) || (cells[i - 1].key < cells[i].key));
+            CHECK(geohash36_counter_add(&totals, cells[i].key, cells[i].count, 0) == 0);
+            snapshotSum += cells[i].count;
+         }
+      }
+      while ((pass == 0) && (snapshotSum < NUM_POINTS / 2));
+
+      for (int i = 0; (pass == 0) && (i < NUM_THREADS); i++)
+      {
+         CHECK(pthread_join(threads[i], NULL) == 0);
+         CHECK(writers[i].result == 0);
+      }
+   }
+
+   // Every point is reported once, in the right cell
+   CHECK(snapshotSum == NUM_POINTS);
+   CHECK(counter.numCells == numExpected);
+   CHECK(geohash36_counter_snapshot(&counter, cells, MAX_CELLS, 0) == 0);
+   CHECK(geohash36_counter_snapshot(&totals, cells, MAX_CELLS, 0) == (long)numExpected);
+   CHECK(memcmp(cells, expected, numExpected * sizeof(geohash36_counter_cell_t)) == 0);
+
+   // Concurrent adds to the same cells on one stripe
+   for (int i = 0; i < NUM_THREADS; i++)
+   {
+      writers[i].stripe = 0;
+      CHECK(pthread_create(&threads[i], NULL, counter_writer, &writers[i]) == 0);
+   }
+
+   for (int i = 0; i < NUM_THREADS; i++)
+   {
+      CHECK(pthread_join(threads[i], NULL) == 0);
+      CHECK(writers[i].result == 0);
+   }
+
+   for (size_t i = 0; i < numExpected; i++)
+      CHECK(geohash36_counter_get(&counter, expected[i].key) == expected[i].count);
+
+   CHECK(geohash36_counter_get(&counter, geohash36_encodeKey(-33.86, 151.21, NUM_CHARACTERS)) == 0);
+   CHECK(geohash36_counter_get(&counter, GEOHASH36_KEY_INVALID) == 0);
+
+   // Negative amounts, and cells dropping to zero
+   CHECK(geohash36_counter_add(&counter, expected[0].key, -expected[0].count, 3) == 0);
+   CHECK(geohash36_counter_add(&counter, expected[1].key, -1, 7) == 0);
+   CHECK(geohash36_counter_get(&counter, expected[0].key) == 0);
+   CHECK(geohash36_counter_get(&counter, expected[1].key) == expected[1].count - 1);
+   CHECK(geohash36_counter_snapshot(&counter, cells, MAX_CELLS, 0) == (long)numExpected - 1);
+   CHECK(cells[0].key == expected[1].key);
+   CHECK(geohash36_counter_add(&counter, GEOHASH36_KEY_INVALID, 1, 0) == -1);
+
+   // Cells which do not fit stay for the next snapshot
+   CHECK(geohash36_counter_snapshot(&counter, cells, 10, 1) == 10);
+   CHECK(geohash36_counter_snapshot(&counter, cells, MAX_CELLS, 1) == (long)numExpected - 11);
+   CHECK(geohash36_counter_snapshot(&counter, cells, MAX_CELLS, 1) == 0);
+
+   // A full map refuses new cells only
+   CHECK(geohash36_counter_init(&small, 3, 1) == 0);
+
+   for (int i = 0; i < 3; i++)
+      CHECK(geohash36_counter_add(&small, expected[i].key, 1, 0) == 0);
+
+   CHECK(geohash36_counter_add(&small, expected[3].key, 1, 0) == -1);
+   CHECK(geohash36_counter_add(&small, expected[2].key, 1, 0) == 0);
+   CHECK(geohash36_counter_get(&small, expected[2].key) == 2);
+   CHECK(geohash36_counter_addPoints(&small, lat, lon, NUM_POINTS, NUM_CHARACTERS, 0) == -1);
+   CHECK(small.numCells == 3);
+
+   geohash36_counter_free(&small);
+   geohash36_counter_free(&totals);
+   geohash36_counter_free(&counter);
+}
+
+// Reference base-32 geohash encoder (bisection, longitude first)
+static void geohash32_encode(double latitude_, double longitude_, char * outBuffer_, int numCharacters_)
+{
+   static const char alphabet[] = "0123456789bcdefghjkmnpqrstuvwxyz";
+   double latRange[2] = { -90.0, 90.0 }, lonRange[2] = { -180.0, 180.0 };
+   int bit = 0, value = 0;
+
+   for (int i = 0; i < numCharacters_ * 5; i++)
+   {
+      double * range = (i % 2 == 0) ? lonRange : latRange;
+      double position = (i % 2 == 0) ? longitude_ : latitude_;
+      double middle = (range[0] + range[1]) / 2;
+
+      value = (value << 1) | (position >= middle);
+      range[position >= middle ? 0 : 1] = middle;
+
+      if (++bit == 5)
+      {
+         outBuffer_[i / 5] = alphabet[value];
+         bit = value = 0;
+      }
+   }
+}
+
+static void test_transcode(void)
+{
+   enum { NUM_POINTS = 5000, NUM_CHARACTERS = 10, SHORT_CHARACTERS = 4 };
+   static double lat[NUM_POINTS], lon[NUM_POINTS];
+   static char hashes[NUM_POINTS * NUM_CHARACTERS], hashes32[NUM_POINTS * 12], expected[NUM_POINTS * 12];
+   static char back[NUM_POINTS * NUM_CHARACTERS];
+   static geohash36_key_t keys[NUM_POINTS], shortKeys[NUM_POINTS], decoded[NUM_POINTS];
+   static uint64_t ids[NUM_POINTS];
+   geohash36_transcode_report_t report;
+   double centerLat, centerLon;
+
+   for (int i = 0; i < NUM_POINTS; i++)
+   {
+      lat[i] = random_between(-90.0, 90.0);
+      lon[i] = random_between(-180.0, 180.0);
+   }
+
+   lat[0] = 90.0;
+   lon[0] = 180.0;
+   lat[1] = -90.0;
+   lon[1] = -180.0;
+
+   CHECK(geohash36_encode_batch(lat, lon, NUM_POINTS, hashes, NUM_CHARACTERS) == 0);
+   CHECK(geohash36_encodeKey_batch(lat, lon, NUM_POINTS, keys, NUM_CHARACTERS) == 0);
+   CHECK(geohash36_encodeKey_batch(lat, lon, NUM_POINTS, shortKeys, SHORT_CHARACTERS) == 0);
+
+   // Each cell goes to the geohash of its center, from strings and keys alike
+   for (int length = 1; length <= GEOHASH36_GEOHASH32_MAX_CHARACTERS; length += 5)
+   {
+      for (int i = 0; i < NUM_POINTS; i++)
+      {
+         CHECK(geohash36_decodeKey(keys[i], &centerLat, &centerLon) == 0);
+         geohash32_encode(centerLat, centerLon, expected + (i * length), length);
+      }
+
+      CHECK(geohash36_toGeohash32_batch(hashes, NUM_POINTS, NUM_CHARACTERS, hashes32, length, &report) == 0);
+      CHECK(memcmp(hashes32, expected, NUM_POINTS * length) == 0);
+      CHECK(geohash36_keyToGeohash32_batch(keys, NUM_POINTS, hashes32, length, NULL) == 0);
+      CHECK(memcmp(hashes32, expected, NUM_POINTS * length) == 0);
+   }
+
+   // A finer geohash always cuts the cell, but converts back to it
+   CHECK(geohash36_keyToGeohash32_batch(shortKeys, NUM_POINTS, hashes32, 12, &report) == 0);
+   CHECK(report.numPartial == NUM_POINTS);
+   CHECK((report.maxLatError <= 90.0 / (1 << 30)) && (report.maxLonError <= 180.0 / (1 << 30)));
+   CHECK(geohash36_geohash32ToKey_batch(hashes32, NUM_POINTS, 12, decoded, SHORT_CHARACTERS, &report) == 0);
+   CHECK(memcmp(decoded, shortKeys, sizeof(shortKeys)) == 0);
+   CHECK(report.numPartial == 0);
+
+   // A coarser geohash holds most cells whole, and its center is at most half a cell away
+   CHECK(geohash36_keyToGeohash32_batch(shortKeys, NUM_POINTS, hashes32, 3, &report) == 0);
+   CHECK((report.numPartial > 0) && (report.numPartial < NUM_POINTS / 2));
+   CHECK((report.maxLatError <= 90.0 / (1 << 7)) && (report.maxLonError <= 180.0 / (1 << 8)));
+   CHECK(report.maxLatError > 0.0);
+
+   // Geohashes go to the Geohash-36 cell of their center
+   for (int i = 0; i < NUM_POINTS; i++)
+      geohash32_encode(lat[i], lon[i], hashes32 + (i * 7), 7);
+
+   CHECK(geohash36_fromGeohash32_batch(hashes32, NUM_POINTS, 7, back, NUM_CHARACTERS, &report) == 0);
+   CHECK(geohash36_geohash32ToKey_batch(hashes32, NUM_POINTS, 7, decoded, NUM_CHARACTERS, NULL) == 0);
+   CHECK(report.numPartial == NUM_POINTS);
+
+   for (int i = 0; i < NUM_POINTS; i++)
+   {
+      // Center of the 7 characters geohash (18 latitude bits, 17 longitude bits)
+      double cellLat = 180.0 / (1 << 17), cellLon = 360.0 / (1 << 18);
+      double south = -90.0 + (floor((lat[i] + 90.0) / cellLat) * cellLat);
+      double west = -180.0 + (floor((lon[i] + 180.0) / cellLon) * cellLon);
+
+      if ((lat[i] >= 90.0) || (lon[i] >= 180.0))
+         continue;
+
+      CHECK(decoded[i] == geohash36_encodeKey(south + (cellLat / 2), west + (cellLon / 2), NUM_CHARACTERS));
+      CHECK(decoded[i] == geohash36_stringToKey(back + (i * NUM_CHARACTERS), NUM_CHARACTERS));
+   }
+
+   // Morton IDs are the bits of the base-32 geohash
+   CHECK(geohash36_keyToMorton_batch(keys, NUM_POINTS, ids, 30, &report) == 0);
+   CHECK(geohash36_keyToGeohash32_batch(keys, NUM_POINTS, hashes32, 12, NULL) == 0);
+
+   for (int i = 0; i < NUM_POINTS; i++)
+   {
+      uint64_t bits = 0;
+
+      for (int j = 0; j < 12; j++)
+         bits = (bits << 5) | (uint64_t)(strchr("0123456789bcdefghjkmnpqrstuvwxyz", hashes32[(i * 12) + j]) -
+                                         "0123456789bcdefghjkmnpqrstuvwxyz");
+
+      CHECK(ids[i] == bits);
+   }
+
+   CHECK(geohash36_keyToMorton_batch(shortKeys, NUM_POINTS, ids, GEOHASH36_MORTON_MAX_BITS, NULL) == 0);
+   CHECK(geohash36_mortonToKey_batch(ids, NUM_POINTS, GEOHASH36_MORTON_MAX_BITS, decoded, SHORT_CHARACTERS,
+                                     &report) == 0);
+   CHECK(memcmp(decoded, shortKeys, sizeof(shortKeys)) == 0);
+   CHECK(geohash36_keyToMorton_batch(keys, NUM_POINTS, ids, 1, NULL) == 0);
+   CHECK((ids[0] == 3) && (ids[1] == 0));
+
+   // Invalid entries are flagged without stopping the others
+   hashes[3] = '!';
+   keys[5] = GEOHASH36_KEY_INVALID;
+   hashes32[(7 * 12) + 2] = 'a';
+   ids[9] = 1ULL << 2;
+
+   CHECK(geohash36_toGeohash32_batch(hashes, 2, NUM_CHARACTERS, hashes32, 12, NULL) == 1);
+   CHECK((hashes32[0] == GEOHASH36_TRANSCODE_INVALID_CHAR) && (hashes32[11] == GEOHASH36_TRANSCODE_INVALID_CHAR));
+   CHECK(hashes32[12] != GEOHASH36_TRANSCODE_INVALID_CHAR);
+   CHECK(geohash36_keyToMorton_batch(keys, 6, ids, 30, NULL) == 1);
+   CHECK(ids[5] == GEOHASH36_MORTON_INVALID);
+   CHECK(geohash36_keyToGeohash32_batch(keys, NUM_POINTS, hashes32, 12, NULL) == 1);
+   hashes32[(7 * 12) + 2] = 'a';
+   CHECK(geohash36_geohash32ToKey_batch(hashes32 + (7 * 12), 1, 12, decoded, 10, NULL) == 1);
+   CHECK(decoded[0] == GEOHASH36_KEY_INVALID);
+   CHECK(geohash36_fromGeohash32_batch(hashes32, 8, 12, back, 10, NULL) == 2);
+   CHECK(back[(7 * 10) + 9] == GEOHASH36_TRANSCODE_INVALID_CHAR);
+   CHECK(geohash36_mortonToKey_batch(ids + 9, 1, 1, decoded, 4, NULL) == 1);
+
+   CHECK(geohash36_toGeohash32_batch(hashes, 1, GEOHASH36_KEY_MAX_CHARACTERS + 1, hashes32, 12, NULL) == -1);
+   CHECK(geohash36_keyToGeohash32_batch(keys, 1, hashes32, GEOHASH36_GEOHASH32_MAX_CHARACTERS + 1, NULL) == -1);
+   CHECK(geohash36_keyToMorton_batch(keys, 1, ids, GEOHASH36_MORTON_MAX_BITS + 1, NULL) == -1);
+   CHECK(geohash36_mortonToKey_batch(NULL, 1, 8, decoded, 4, NULL) == -1);
+}
+
+GEOHASH36_FIXED_DEFINE(1)
+GEOHASH36_FIXED_DEFINE(6)
+GEOHASH36_FIXED_DEFINE(13)
+GEOHASH36_FIXED_DEFINE(20)
+GEOHASH36_FIXED_DEFINE_KEY(1)
+GEOHASH36_FIXED_DEFINE_KEY(6)
+
+static void test_fixed(void)
+{
+   enum { NUM_POINTS = 20000 };
+   char hash[20], expected[20];
+   double lat, lon, fixedLat, fixedLon, expectedLat, expectedLon;
+   geohash36_key_t key;
+
+   for (int i = 0; i < NUM_POINTS; i++)
+   {
+      // Random points, cell borders and out of range positions
+      lat = random_between(-90.0, 90.0);
+      lon = random_between(-180.0, 180.0);
+
+      if (i % 4 == 1)
+      {
+         lat = -90.0 + ((180.0 / 46656.0) * (double)(rand() % 46657));
+         lon = -180.0 + ((360.0 / 46656.0) * (double)(rand() % 46657));
+      }
+      else if (i % 4 == 2)
+      {
+         lat *= 1.2;
+         lon *= 1.2;
+      }
+
+      CHECK(geohash36_encode10(lat, lon, hash) == 10);
+      CHECK(geohash36_encode(lat, lon, expected, 10) == 10);
+      CHECK(memcmp(hash, expected, 10) == 0);
+      CHECK(geohash36_decode10(hash, &fixedLat, &fixedLon) == 0);
+      CHECK(geohash36_decode(expected, 10, &expectedLat, &expectedLon) == 0);
+      CHECK((fixedLat == expectedLat) && (fixedLon == expectedLon));
+
+      CHECK(geohash36_encode1(lat, lon, hash) == 1);
+      CHECK(geohash36_encode(lat, lon, expected, 1) == 1);
+      CHECK(hash[0] == expected[0]);
+      CHECK(geohash36_encode6(lat, lon, hash) == 6);
+      CHECK(geohash36_encode(lat, lon, expected, 6) == 6);
+      CHECK(memcmp(hash, expected, 6) == 0);
+      CHECK(geohash36_decode6(hash, &fixedLat, &fixedLon) == 0);
+      CHECK(geohash36_decode(expected, 6, &expectedLat, &expectedLon) == 0);
+      CHECK((fixedLat == expectedLat) && (fixedLon == expectedLon));
+      CHECK(geohash36_encode13(lat, lon, hash) == 13);
+      CHECK(geohash36_encode(lat, lon, expected, 13) == 13);
+      CHECK(memcmp(hash, expected, 13) == 0);
+      CHECK(geohash36_decode13(hash, &fixedLat, &fixedLon) == 0);
+      CHECK(geohash36_decode(expected, 13, &expectedLat, &expectedLon) == 0);
+      CHECK((fixedLat == expectedLat) && (fixedLon == expectedLon));
+      CHECK(geohash36_encode20(lat, lon, hash) == 20);
+      CHECK(geohash36_encode(lat, lon, expected, 20) == 20);
+      CHECK(memcmp(hash, expected, 20) == 0);
+
+      key = geohash36_encodeKey10(lat, lon);
+      CHECK(key == geohash36_encodeKey(lat, lon, 10));
+      CHECK(geohash36_decodeKey10(key, &fixedLat, &fixedLon) == 0);
+      CHECK(geohash36_decodeKey(key, &expectedLat, &expectedLon) == 0);
+      CHECK((fixedLat == expectedLat) && (fixedLon == expectedLon));
+      CHECK(geohash36_encodeKey1(lat, lon) == geohash36_encodeKey(lat, lon, 1));
+      key = geohash36_encodeKey6(lat, lon);
+      CHECK(key == geohash36_encodeKey(lat, lon, 6));
+      CHECK(geohash36_decodeKey6(key, &fixedLat, &fixedLon) == 0);
+      CHECK(geohash36_decodeKey(key, &expectedLat, &expectedLon) == 0);
+      CHECK((fixedLat == expectedLat) && (fixedLon == expectedLon));
+   }
+
+   // Integer degrees and eighths of a degree, exactly on the edges or the middle of cells
+   for (int i = -719; i <= 720; i++)
+   {
+      for (int j = 0; j < 78; j++)
+      {
+         lat = i / 8.0;
+         lon = -180.0 + ((j * 37) / 8.0);
+
+         reference_encode(lat, lon, expected, 13);
+         CHECK(geohash36_encode6(lat, lon, hash) == 6);
+         CHECK(memcmp(hash, expected, 6) == 0);
+         CHECK(geohash36_encode10(lat, lon, hash) == 10);
+         CHECK(memcmp(hash, expected, 10) == 0);
+         CHECK(geohash36_encode13(lat, lon, hash) == 13);
+         CHECK(memcmp(hash, expected, 13) == 0);
+         CHECK(geohash36_encodeKey6(lat, lon) == geohash36_stringToKey(expected, 6));
+         CHECK(geohash36_encodeKey10(lat, lon) == geohash36_stringToKey(expected, 10));
+      }
+   }
+
+   // Invalid characters, keys of another length and malformed keys
+   memcpy(hash, "bdrdC26BqH", 10);
+   CHECK(geohash36_decode10(hash, &fixedLat, &fixedLon) == 0);
+   hash[7] = 'a';
+   CHECK(geohash36_decode10(hash, &fixedLat, &fixedLon) == -1);
+   hash[7] = '\0';
+   CHECK(geohash36_decode10(hash, &fixedLat, &fixedLon) == -1);
+   CHECK(geohash36_decode10(NULL, &fixedLat, &fixedLon) == -1);
+   CHECK(geohash36_encode10(0.0, 0.0, NULL) == 0);
+
+   key = geohash36_stringToKey("bdrdC26BqH", 10);
+   CHECK(geohash36_decodeKey6(key, &fixedLat, &fixedLon) == -1);
+   CHECK(geohash36_decodeKey10(key | (63ULL << 22), &fixedLat, &fixedLon) == -1);
+   CHECK(geohash36_decodeKey6(geohash36_keyTruncate(key, 6) | (1ULL << 20), &fixedLat, &fixedLon) == -1);
+   CHECK(geohash36_decodeKey10(GEOHASH36_KEY_INVALID, &fixedLat, &fixedLon) == -1);
+   CHECK(GEOHASH36_POW6(GEOHASH36_MAX_CELL_CHARACTERS) == geohash36_pow6[GEOHASH36_MAX_CELL_CHARACTERS]);
+   CHECK(memcmp(geohash36_fixed_chars, base36, sizeof(base36)) == 0);
+   CHECK(memcmp(geohash36_fixed_index, base36_index, sizeof(base36_index)) == 0);
+   CHECK(memcmp(geohash36_fixed_rank, base36_rank, sizeof(base36_rank)) == 0);
+   CHECK(memcmp(geohash36_fixed_rank_position, base36_rank_position, sizeof(base36_rank_position)) == 0);
+}
+
+static int validate_reference(const char * hash_, int numCharacters_)
+{
+   for (int k = 0; k < numCharacters_; k++)
+   {
+      if (geohash36_stringToKey(hash_ + k, 1) == GEOHASH36_KEY_INVALID)
+         return k;
+   }
+
+   return -1;
+}
+
+static void test_validate(void)
+{
+   enum { NUM_HASHES = 3000 };
+   static char hashes[NUM_HASHES * 12], prefixed[NUM_HASHES * 16], canonical[NUM_HASHES * 6];
+   static double lat[NUM_HASHES], lon[NUM_HASHES];
+   static int offsets[NUM_HASHES], lengths[NUM_HASHES];
+   static geohash36_key_t keys[NUM_HASHES];
+   uint64_t valid[(NUM_HASHES + 63) / 64];
+   size_t size = 0;
+
+   for (int i = 0; i < NUM_HASHES; i++)
+   {
+      lat[i] = random_between(-90.0, 90.0);
+      lon[i] = random_between(-180.0, 180.0);
+   }
+
+   geohash36_encode_batch(lat, lon, NUM_HASHES, hashes, 12);
+
+   // Corrupt some hashes, sometimes twice (the first invalid character is reported)
+   for (int i = 0; i < NUM_HASHES; i += 7)
+   {
+      hashes[(i * 12) + (i % 12)] = (i & 1) ? 'a' : (char)0xB2;
+
+      if (i % 3 == 0)
+         hashes[(i * 12) + 11] = '\0';
+   }
+
+   // Length-prefixed copy, from 0 to 14 characters (longer entries get valid characters)
+   for (int i = 0; i < NUM_HASHES; i++)
+   {
+      lengths[i] = i % 15;
+      prefixed[size++] = (char)lengths[i];
+
+      for (int k = 0; k < lengths[i]; k++)
+         prefixed[size++] = (k < 12) ? hashes[(i * 12) + k] : '2';
+   }
+
+   for (geohash36_kernel_t kernel = GEOHASH36_KERNEL_SCALAR; kernel <= GEOHASH36_KERNEL_AVX512; kernel++)
+   {
+      long expectedInvalid = 0;
+
+      if (geohash36_batch_setKernel(kernel) != 0)
+         continue;
+
+      // Fixed length, truncated to 6 characters and converted to keys
+      for (int i = 0; i < NUM_HASHES; i++)
+         expectedInvalid += (validate_reference(hashes + (i * 12), 12) >= 0);
+
+      CHECK(geohash36_validate_batch(hashes, NUM_HASHES, 12, valid, offsets, 6, canonical, keys) == expectedInvalid);
+
+      for (int i = 0; i < NUM_HASHES; i++)
+      {
+         int offset = validate_reference(hashes + (i * 12), 12);
+
+         CHECK(offsets[i] == offset);
+         CHECK(((valid[i / 64] >> (i % 64)) & 1) == (offset < 0));
+
+         if (offset < 0)
+         {
+            CHECK(memcmp(canonical + (i * 6), hashes + (i * 12), 6) == 0);
+            CHECK(keys[i] == geohash36_stringToKey(hashes + (i * 12), 6));
+         }
+         else
+         {
+            CHECK(keys[i] == GEOHASH36_KEY_INVALID);
+         }
+      }
+
+      CHECK(geohash36_validate_batch(hashes, NUM_HASHES, 12, NULL, NULL, 0, NULL, NULL) == expectedInvalid);
+
+      // Length-prefixed, converted to keys of each length
+      expectedInvalid = 0;
+
+      for (int i = 0; i < NUM_HASHES; i++)
+      {
+         int offset = validate_reference(hashes + (i * 12), MIN(lengths[i], 12));
+
+         expectedInvalid += (offset >= 0) || (lengths[i] > GEOHASH36_KEY_MAX_CHARACTERS);
+      }
+
+      CHECK(geohash36_validatePrefixed_batch(prefixed, size, NUM_HASHES, valid, offsets, 0, NULL, keys) ==
+            expectedInvalid);
+
+      for (int i = 0; i < NUM_HASHES; i++)
+      {
+         int offset = validate_reference(hashes + (i * 12), MIN(lengths[i], 12));
+
+         if ((offset < 0) && (lengths[i] > GEOHASH36_KEY_MAX_CHARACTERS))
+            offset = GEOHASH36_KEY_MAX_CHARACTERS;
+
+         CHECK(offsets[i] == offset);
+         CHECK(((valid[i / 64] >> (i % 64)) & 1) == (offset < 0));
+
+         if (offset < 0)
+            CHECK(keys[i] == geohash36_stringToKey(hashes + (i * 12), lengths[i]));
+      }
+
+      // Canonical length of 6 characters: shorter entries are invalid
+      CHECK(geohash36_validatePrefixed_batch(prefixed, size, NUM_HASHES, valid, offsets, 6, canonical, NULL) > 0);
+
+      for (int i = 0; i < NUM_HASHES; i++)
+      {
+         int offset = validate_reference(hashes + (i * 12), MIN(lengths[i], 12));
+
+         if ((offset < 0) && (lengths[i] < 6))
+            offset = lengths[i];
+
+         CHECK(offsets[i] == offset);
+
+         if (offset < 0)
+            CHECK(memcmp(canonical + (i * 6), hashes + (i * 12), 6) == 0);
+      }
+
+      // Buffer cut in the middle of an entry: it and the missing ones are invalid
+      CHECK(geohash36_validatePrefixed_batch(prefixed, 1 + 2 + 3 + 3, 5, valid, offsets, 0, NULL, NULL) == 2);
+      CHECK((offsets[0] == -1) && (offsets[1] == -1) && (offsets[2] == -1) && (offsets[3] == 2) && (offsets[4] == 0));
+      CHECK(valid[0] == 7);
+   }
+
+   CHECK(geohash36_batch_setKernel(GEOHASH36_KERNEL_AUTO) == 0);
+
+   // Invalid arguments
+   CHECK(geohash36_validate_batch(NULL, 1, 12, valid, offsets, 0, NULL, NULL) == -1);
+   CHECK(geohash36_validate_batch(hashes, 1, 0, valid, offsets, 0, NULL, NULL) == -1);
+   CHECK(geohash36_validate_batch(hashes, 1, 12, valid, offsets, 13, NULL, NULL) == -1);
+   CHECK(geohash36_validate_batch(hashes, 1, 12, valid, offsets, 0, NULL, keys) == -1);
+   CHECK(geohash36_validatePrefixed_batch(prefixed, size, 1, valid, offsets, 0, canonical, NULL) == -1);
+   CHECK(geohash36_validatePrefixed_batch(prefixed, size, 1, valid, offsets, 11, NULL, keys) == -1);
+}
+
+int main()
+{
+   char geohash36_buffer[NUM_CHARACTERS_FOR_GEOHASH36 + 1];
+   char geohash36_buffer_neighbor[NUM_CHARACTERS_FOR_GEOHASH36 + 1];
+
+   double latitude = 51.504444;
+   double longitude = -0.086666;
+   double outLatitude = 0, outLongitude = 0;
+   double lat_prec, long_prec;
+   int sizeBuf;
+
+   geohash36_getPrecisionInMeters(NUM_CHARACTERS_FOR_GEOHASH36, &lat_prec, &long_prec);
+
+   printf("Using %d characters for Geohash-36, our precision is %lf x %lf square meters\n", NUM_CHARACTERS_FOR_GEOHASH36, lat_prec, long_prec);
+
+   sizeBuf = geohash36_encode(latitude, longitude, geohash36_buffer, NUM_CHARACTERS_FOR_GEOHASH36);
+   sizeBuf = MIN(sizeBuf, NUM_CHARACTERS_FOR_GEOHASH36);
+   geohash36_buffer[sizeBuf] = 0;
+
+   printf("Geohash-36 of (%lf, %lf) is: %s\n", latitude, longitude, geohash36_buffer);
+
+   geohash36_decode(geohash36_buffer, sizeBuf, &outLatitude, &outLongitude);
+
+   printf("The Lat/Long of %s is: (%lf, %lf)\n", geohash36_buffer, outLatitude, outLongitude);
+   
+   printf("Geohash36 neighbors:\n");
+   
+   printf("%s\t", geohash36_getNeighbor(geohash36_buffer, sizeBuf, geohash36_buffer_neighbor, GEO36_NEIGHBORS_DIR_NORTHWEST));
+   printf("%s\t", geohash36_getNeighbor(geohash36_buffer, sizeBuf, geohash36_buffer_neighbor, GEO36_NEIGHBORS_DIR_NORTH));
+   printf("%s\n", geohash36_getNeighbor(geohash36_buffer, sizeBuf, geohash36_buffer_neighbor, GEO36_NEIGHBORS_DIR_NORTHEAST));
+   
+   printf("%s\t", geohash36_getNeighbor(geohash36_buffer, sizeBuf, geohash36_buffer_neighbor, GEO36_NEIGHBORS_DIR_WEST));
+   printf("%s\t", geohash36_getNeighbor(geohash36_buffer, sizeBuf, geohash36_buffer_neighbor, GEO36_NEIGHBORS_DIR_CENTER));
+   printf("%s\n", geohash36_getNeighbor(geohash36_buffer, sizeBuf, geohash36_buffer_neighbor, GEO36_NEIGHBORS_DIR_EAST));
+   
+   printf("%s\t", geohash36_getNeighbor(geohash36_buffer, sizeBuf, geohash36_buffer_neighbor, GEO36_NEIGHBORS_DIR_SOUTHWEST));
+   printf("%s\t", geohash36_getNeighbor(geohash36_buffer, sizeBuf, geohash36_buffer_neighbor, GEO36_NEIGHBORS_DIR_SOUTH));
+   printf("%s\n", geohash36_getNeighbor(geohash36_buffer, sizeBuf, geohash36_buffer_neighbor, GEO36_NEIGHBORS_DIR_SOUTHEAST));
+
+   test_encode_decode();
+   test_encode_boundaries();
+   test_keys();
+   test_batch_encode();
+   test_batch_decode();
+   test_neighbors();
+   test_cover();
+   test_index();
+   test_index_nearest();
+   test_file();
+   test_pool();
+   test_geofence();
+   test_aggregate();
+   test_tracker();
+   test_join();
+   test_compact();
+   test_counter();
+   test_transcode();
+   test_fixed();
+   test_validate();
+
+   printf("%s\n", (test_failures == 0) ? "All checks passed" : "Some checks failed");
+
+   return (test_failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,367 @@
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include "geohash36_tracker.h"
+#include "geohash36_internal.h"
+
+/***********************************************************************************************************************
+Defines/macros
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Initial number of slots of the table (power of 2, kept at most half full).
+************************************************************************************************************************
+**/
+#define GEOHASH36_TRACKER_MIN_SLOTS          1024
+
+/***********************************************************************************************************************
+Internal functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Gets the home slot of an object ID.
+************************************************************************************************************************
+* @param [in] id_: object ID;
+* @param [in] numSlots_: number of slots (power of 2).
+************************************************************************************************************************
+* @return Slot position.
+************************************************************************************************************************
+**/
+static size_t geohash36_tracker_hash(uint64_t id_, size_t numSlots_)
+{
+   return (size_t)((id_ * 0x9E3779B97F4A7C15ull) >> 32) & (numSlots_ - 1);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Gets the slot of the table for an object (hash of the ID, then linear probing).
+************************************************************************************************************************
+* @param [in] objects_: table;
+* @param [in] numSlots_: number of slots (power of 2);
+* @param [in] id_: object ID.
+************************************************************************************************************************
+* @return Position of the slot holding the object, or of the empty slot where it would be.
+************************************************************************************************************************
+**/
+static size_t geohash36_tracker_findSlot(const geohash36_tracker_object_t * objects_, size_t numSlots_, uint64_t id_)
+{
+   size_t position = geohash36_tracker_hash(id_, numSlots_);
+
+   while ((objects_[position].key != GEOHASH36_KEY_INVALID) && (objects_[position].id != id_))
+      position = (position + 1) & (numSlots_ - 1);
+
+   return position;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Doubles the number of slots of the table.
+************************************************************************************************************************
+* @param [in] tracker_: pointer to the tracker.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Allocation failure.
+************************************************************************************************************************
+**/
+static int geohash36_tracker_grow(geohash36_tracker_t * tracker_)
+{
+   size_t numSlots = tracker_->numSlots * 2;
+   geohash36_tracker_object_t * objects;
+   size_t i;
+
+   objects = malloc(numSlots * sizeof(geohash36_tracker_object_t));
+   if (objects == NULL)
+      return -1;
+
+   for (i = 0; i < numSlots; i++)
+      objects[i].key = GEOHASH36_KEY_INVALID;
+
+   for (i = 0; i < tracker_->numSlots; i++)
+   {
+      if (tracker_->objects[i].key != GEOHASH36_KEY_INVALID)
+         objects[geohash36_tracker_findSlot(objects, numSlots, tracker_->objects[i].id)] = tracker_->objects[i];
+   }
+
+   free(tracker_->objects);
+   tracker_->objects = objects;
+   tracker_->numSlots = numSlots;
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Raises the events of the watched lengths from "firstCharacters_" to the key length.
+************************************************************************************************************************
+* @param [in] tracker_: pointer to the tracker;
+* @param [in] id_: object ID;
+* @param [in] left_: previous key (GEOHASH36_KEY_INVALID for new objects);
+* @param [in] entered_: new key (GEOHASH36_KEY_INVALID for removed objects);
+* @param [in] firstCharacters_: first length which changed.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_tracker_raise(const geohash36_tracker_t * tracker_, uint64_t id_, geohash36_key_t left_,
+                                    geohash36_key_t entered_, int firstCharacters_)
+{
+   geohash36_tracker_event_t event;
+
+   if (tracker_->callback == NULL)
+      return;
+
+   event.id = id_;
+
+   for (event.numCharacters = firstCharacters_; event.numCharacters <= tracker_->numCharacters; event.numCharacters++)
+   {
+      if (!(tracker_->eventLengths & (1u << event.numCharacters)))
+         continue;
+
+      event.left = (left_ != GEOHASH36_KEY_INVALID) ? geohash36_keyTruncate(left_, event.numCharacters) : left_;
+      event.entered = (entered_ != GEOHASH36_KEY_INVALID) ? geohash36_keyTruncate(entered_, event.numCharacters) :
+                                                            entered_;
+      tracker_->callback(&event, tracker_->context);
+   }
+}
+
+/***********************************************************************************************************************
+External functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Initializes an empty tracker.
+************************************************************************************************************************
+* @param [out] tracker_: pointer to the tracker;
+* @param [in] numCharacters_: length of the keys (1 to GEOHASH36_KEY_MAX_CHARACTERS);
+* @param [in] eventLengths_: lengths raising events (bit "k" for length "k", 1 to "numCharacters_");
+* @param [in] callback_: function called for each event (can be NULL);
+* @param [in] context_: pointer given to the callback.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input or allocation failure.
+************************************************************************************************************************
+**/
+int geohash36_tracker_init(geohash36_tracker_t * tracker_, int numCharacters_, uint32_t eventLengths_,
+                           geohash36_tracker_callback_t callback_, void * context_)
+{
+   size_t i;
+
+   if ((tracker_ == NULL) || (numCharacters_ < 1) || (numCharacters_ > GEOHASH36_KEY_MAX_CHARACTERS) ||
+       ((eventLengths_ & ~(((2u << numCharacters_) - 1) & ~1u)) != 0))
+      return -1;
+
+   memset(tracker_, 0, sizeof(geohash36_tracker_t));
+
+   tracker_->objects = malloc(GEOHASH36_TRACKER_MIN_SLOTS * sizeof(geohash36_tracker_object_t));
+   if (tracker_->objects == NULL)
+      return -1;
+
+   for (i = 0; i < GEOHASH36_TRACKER_MIN_SLOTS; i++)
+      tracker_->objects[i].key = GEOHASH36_KEY_INVALID;
+
+   tracker_->numSlots = GEOHASH36_TRACKER_MIN_SLOTS;
+   tracker_->numCharacters = numCharacters_;
+   tracker_->eventLengths = eventLengths_;
+   tracker_->callback = callback_;
+   tracker_->context = context_;
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Releases the memory of a tracker.
+************************************************************************************************************************
+* @param [in] tracker_: pointer to the tracker.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+void geohash36_tracker_free(geohash36_tracker_t * tracker_)
+{
+   if (tracker_ == NULL)
+      return;
+
+   free(tracker_->objects);
+   memset(tracker_, 0, sizeof(geohash36_tracker_t));
+}
+
+/*!
+************************************************************************************************************************
+* @brief Updates the position of an object (added on its first update), raising an event for each watched length
+*        whose cell changed.
+************************************************************************************************************************
+* @param [in] tracker_: pointer to the tracker;
+* @param [in] id_: ID of the object;
+* @param [in] latitude_, longitude_: new position;
+* @param [out] outKey_: optional pointer which will receive the key of the object (same as geohash36_encodeKey).
+************************************************************************************************************************
+* @return Number of characters which changed (0 when the object stays in its cell), or -1 for invalid input or
+*         allocation failure.
+************************************************************************************************************************
+**/
+int geohash36_tracker_update(geohash36_tracker_t * tracker_, uint64_t id_, double latitude_, double longitude_,
+                             geohash36_key_t * outKey_)
+{
+   geohash36_tracker_object_t * object;
+   geohash36_cell_t cell;
+   geohash36_key_t previous, key;
+   uint64_t oldLat, oldLon, newLat, newLon;
+   int numCharacters, common, shift, i;
+   size_t position;
+
+   if ((tracker_ == NULL) || (tracker_->objects == NULL) || !(latitude_ >= -90.0) || !(latitude_ <= 90.0) ||
+       !(longitude_ >= -180.0) || !(longitude_ <= 180.0))
+      return -1;
+
+   numCharacters = tracker_->numCharacters;
+   geohash36_encodeCell(latitude_, longitude_, numCharacters, &cell);
+
+   position = geohash36_tracker_findSlot(tracker_->objects, tracker_->numSlots, id_);
+   object = &tracker_->objects[position];
+
+   if (object->key == GEOHASH36_KEY_INVALID)
+   {
+      if (2 * (tracker_->numObjects + 1) > tracker_->numSlots)
+      {
+         if (geohash36_tracker_grow(tracker_) != 0)
+            return -1;
+
+         object = &tracker_->objects[geohash36_tracker_findSlot(tracker_->objects, tracker_->numSlots, id_)];
+      }
+
+      object->id = id_;
+      object->key = geohash36_cellToKey(&cell);
+      object->latIndex = (uint32_t)cell.latIndex;
+      object->lonIndex = (uint32_t)cell.lonIndex;
+      tracker_->numObjects++;
+
+      if (outKey_ != NULL)
+         (*outKey_) = object->key;
+
+      geohash36_tracker_raise(tracker_, id_, GEOHASH36_KEY_INVALID, object->key, 1);
+      return numCharacters;
+   }
+
+   // Longest ancestor shared with the previous cell
+   oldLat = object->latIndex;
+   oldLon = object->lonIndex;
+   newLat = cell.latIndex;
+   newLon = cell.lonIndex;
+
+   for (common = numCharacters; (oldLat != newLat) || (oldLon != newLon); common--)
+   {
+      oldLat /= GEOHASH_MATRIX_SIDE;
+      oldLon /= GEOHASH_MATRIX_SIDE;
+      newLat /= GEOHASH_MATRIX_SIDE;
+      newLon /= GEOHASH_MATRIX_SIDE;
+   }
+
+   if (outKey_ != NULL)
+      (*outKey_) = object->key;
+
+   if (common == numCharacters)
+      return 0;
+
+   // Characters after the shared prefix, from the last one (as in geohash36_cellToKey)
+   previous = object->key;
+   key = (previous & geohash36_keyPrefixMask(common)) | (geohash36_key_t)numCharacters;
+   newLat = cell.latIndex;
+   newLon = cell.lonIndex;
+   shift = GEOHASH36_KEY_FIRST_CHAR_SHIFT - ((numCharacters - 1) * GEOHASH36_KEY_CHAR_BITS);
+
+   for (i = numCharacters - 1; i >= common; i--)
+   {
+      key |= (geohash36_key_t)base36_rank[((GEOHASH_MATRIX_SIDE - 1 - (newLat % GEOHASH_MATRIX_SIDE)) *
+                                           GEOHASH_MATRIX_SIDE) + (newLon % GEOHASH_MATRIX_SIDE)] << shift;
+      newLat /= GEOHASH_MATRIX_SIDE;
+      newLon /= GEOHASH_MATRIX_SIDE;
+      shift += GEOHASH36_KEY_CHAR_BITS;
+   }
+
+   object->key = key;
+   object->latIndex = (uint32_t)cell.latIndex;
+   object->lonIndex = (uint32_t)cell.lonIndex;
+
+   if (outKey_ != NULL)
+      (*outKey_) = key;
+
+   geohash36_tracker_raise(tracker_, id_, previous, key, common + 1);
+
+   return numCharacters - common;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Removes an object, raising a "left" event for each watched length.
+************************************************************************************************************************
+* @param [in] tracker_: pointer to the tracker;
+* @param [in] id_: ID of the object.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input or unknown object.
+************************************************************************************************************************
+**/
+int geohash36_tracker_remove(geohash36_tracker_t * tracker_, uint64_t id_)
+{
+   geohash36_tracker_object_t * objects;
+   geohash36_key_t key;
+   size_t mask, hole, position, home;
+
+   if ((tracker_ == NULL) || (tracker_->objects == NULL))
+      return -1;
+
+   objects = tracker_->objects;
+   mask = tracker_->numSlots - 1;
+   hole = geohash36_tracker_findSlot(objects, tracker_->numSlots, id_);
+
+   if (objects[hole].key == GEOHASH36_KEY_INVALID)
+      return -1;
+
+   key = objects[hole].key;
+
+   // Backward shift: objects after the hole move into it unless their home slot is between the hole and them
+   for (position = (hole + 1) & mask; objects[position].key != GEOHASH36_KEY_INVALID; position = (position + 1) & mask)
+   {
+      home = geohash36_tracker_hash(objects[position].id, tracker_->numSlots);
+
+      if (((position - home) & mask) >= ((position - hole) & mask))
+      {
+         objects[hole] = objects[position];
+         hole = position;
+      }
+   }
+
+   objects[hole].key = GEOHASH36_KEY_INVALID;
+   tracker_->numObjects--;
+
+   geohash36_tracker_raise(tracker_, id_, key, GEOHASH36_KEY_INVALID, 1);
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Gets the key of an object.
+************************************************************************************************************************
+* @param [in] tracker_: pointer to the tracker;
+* @param [in] id_: ID of the object.
+************************************************************************************************************************
+* @return Key of the object, or GEOHASH36_KEY_INVALID for unknown objects.
+************************************************************************************************************************
+**/
+geohash36_key_t geohash36_tracker_get(const geohash36_tracker_t * tracker_, uint64_t id_)
+{
+   if ((tracker_ == NULL) || (tracker_->objects == NULL))
+      return GEOHASH36_KEY_INVALID;
+
+   return tracker_->objects[geohash36_tracker_findSlot(tracker_->objects, tracker_->numSlots, id_)].key;
+}
@@ -0,0 +1,153 @@
+#ifndef _GEOHASH36_TRACKER_H_
+#define _GEOHASH36_TRACKER_H_
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "stddef.h"
+#include "geohash36.h"
+
+/***********************************************************************************************************************
+Typedefs/structs/unions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Tracked object: last key and its grid cell (GEOHASH36_KEY_INVALID for empty slots).
+************************************************************************************************************************
+**/
+typedef struct
+{
+   uint64_t id;
+   geohash36_key_t key;
+   uint32_t latIndex;
+   uint32_t lonIndex;
+
+}geohash36_tracker_object_t;
+
+/*!
+************************************************************************************************************************
+* @brief Cell change of an object at one length: cell left and cell entered (GEOHASH36_KEY_INVALID when the object
+*        appears or is removed).
+************************************************************************************************************************
+**/
+typedef struct
+{
+   uint64_t id;
+   int numCharacters;
+   geohash36_key_t left;
+   geohash36_key_t entered;
+
+}geohash36_tracker_event_t;
+
+/*!
+************************************************************************************************************************
+* @brief Callback called for each cell change.
+************************************************************************************************************************
+* @param [in] event_: cell change;
+* @param [in] context_: pointer given to geohash36_tracker_init.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+typedef void (*geohash36_tracker_callback_t)(const geohash36_tracker_event_t * event_, void * context_);
+
+/*!
+************************************************************************************************************************
+* @brief Keys of moving objects, kept up to date from their position reports.
+*
+* The objects are kept in an open addressing table keyed by ID. An update quantizes the new position like
+* geohash36_encodeKey, finds the longest ancestor cell shared with the previous position, and only rebuilds the
+* characters after it; lengths whose prefix changed raise events.
+************************************************************************************************************************
+**/
+typedef struct
+{
+   geohash36_tracker_object_t * objects;
+   size_t numSlots;
+   size_t numObjects;
+
+   int numCharacters;
+   uint32_t eventLengths;
+   geohash36_tracker_callback_t callback;
+   void * context;
+
+}geohash36_tracker_t;
+
+/***********************************************************************************************************************
+Exported functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Initializes an empty tracker.
+************************************************************************************************************************
+* @param [out] tracker_: pointer to the tracker;
+* @param [in] numCharacters_: length of the keys (1 to GEOHASH36_KEY_MAX_CHARACTERS);
+* @param [in] eventLengths_: lengths raising events (bit "k" for length "k", 1 to "numCharacters_");
+* @param [in] callback_: function called for each event (can be NULL);
+* @param [in] context_: pointer given to the callback.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input or allocation failure.
+************************************************************************************************************************
+**/
+int geohash36_tracker_init(geohash36_tracker_t * tracker_, int numCharacters_, uint32_t eventLengths_,
+                           geohash36_tracker_callback_t callback_, void * context_);
+
+/*!
+************************************************************************************************************************
+* @brief Releases the memory of a tracker.
+************************************************************************************************************************
+* @param [in] tracker_: pointer to the tracker.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+void geohash36_tracker_free(geohash36_tracker_t * tracker_);
+
+/*!
+************************************************************************************************************************
+* @brief Updates the position of an object (added on its first update), raising an event for each watched length
+*        whose cell changed.
+************************************************************************************************************************
+* @param [in] tracker_: pointer to the tracker;
+* @param [in] id_: ID of the object;
+* @param [in] latitude_, longitude_: new position;
+* @param [out] outKey_: optional pointer which will receive the key of the object (same as geohash36_encodeKey).
+************************************************************************************************************************
+* @return Number of characters which changed (0 when the object stays in its cell), or -1 for invalid input or
+*         allocation failure.
+************************************************************************************************************************
+**/
+int geohash36_tracker_update(geohash36_tracker_t * tracker_, uint64_t id_, double latitude_, double longitude_,
+                             geohash36_key_t * outKey_);
+
+/*!
+************************************************************************************************************************
+* @brief Removes an object, raising a "left" event for each watched length.
+************************************************************************************************************************
+* @param [in] tracker_: pointer to the tracker;
+* @param [in] id_: ID of the object.
+************************************************************************************************************************
+* @return Initialize result code.
+* @retval  0  - Everything worked;
+* @retval -1  - Invalid input or unknown object.
+************************************************************************************************************************
+**/
+int geohash36_tracker_remove(geohash36_tracker_t * tracker_, uint64_t id_);
+
+/*!
+************************************************************************************************************************
+* @brief Gets the key of an object.
+************************************************************************************************************************
+* @param [in] tracker_: pointer to the tracker;
+* @param [in] id_: ID of the object.
+************************************************************************************************************************
+* @return Key of the object, or GEOHASH36_KEY_INVALID for unknown objects.
+************************************************************************************************************************
+**/
+geohash36_key_t geohash36_tracker_get(const geohash36_tracker_t * tracker_, uint64_t id_);
+
+#endif // _GEOHASH36_TRACKER_H_
@@ -0,0 +1,619 @@
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include "geohash36_transcode.h"
+#include "geohash36_internal.h"
+
+/***********************************************************************************************************************
+Defines/macros
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Bits encoded by each base-32 geohash character.
+************************************************************************************************************************
+**/
+#define GEOHASH32_CHAR_BITS                  5
+
+/***********************************************************************************************************************
+Constants
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Base-32 geohash alphabet.
+************************************************************************************************************************
+**/
+static const char geohash32_alphabet[32] =
+{
+   '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'b', 'c', 'd', 'e', 'f', 'g',
+   'h', 'j', 'k', 'm', 'n', 'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z'
+};
+
+/*!
+************************************************************************************************************************
+* @brief Value + 1 of each base-32 geohash character, 0 for invalid characters.
+************************************************************************************************************************
+**/
+static const uint8_t geohash32_index[256] =
+{
+   ['0'] = 1,  ['1'] = 2,  ['2'] = 3,  ['3'] = 4,  ['4'] = 5,  ['5'] = 6,  ['6'] = 7,  ['7'] = 8,
+   ['8'] = 9,  ['9'] = 10, ['b'] = 11, ['c'] = 12, ['d'] = 13, ['e'] = 14, ['f'] = 15, ['g'] = 16,
+   ['h'] = 17, ['j'] = 18, ['k'] = 19, ['m'] = 20, ['n'] = 21, ['p'] = 22, ['q'] = 23, ['r'] = 24,
+   ['s'] = 25, ['t'] = 26, ['u'] = 27, ['v'] = 28, ['w'] = 29, ['x'] = 30, ['y'] = 31, ['z'] = 32
+};
+
+/*!
+************************************************************************************************************************
+* @brief Powers of 3, up to GEOHASH36_KEY_MAX_CHARACTERS.
+************************************************************************************************************************
+**/
+static const double geohash36_transcode_pow3[GEOHASH36_KEY_MAX_CHARACTERS + 1] =
+{
+   1.0, 3.0, 9.0, 27.0, 81.0, 243.0, 729.0, 2187.0, 6561.0, 19683.0, 59049.0
+};
+
+/***********************************************************************************************************************
+Typedefs/structs/unions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Cell of a binary grid (base-32 geohash or Morton ID): 2^latBits rows from the south pole and 2^lonBits columns
+*        from the antimeridian.
+************************************************************************************************************************
+**/
+typedef struct
+{
+   uint64_t latIndex;
+   uint64_t lonIndex;
+   int latBits;
+   int lonBits;
+
+}geohash36_transcode_grid_t;
+
+/***********************************************************************************************************************
+Internal functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Spreads the bits of a 32 bits integer on the even bits of a 64 bits integer.
+************************************************************************************************************************
+**/
+static uint64_t geohash36_transcode_spread(uint64_t value_)
+{
+   value_ &= 0xFFFFFFFFULL;
+   value_ = (value_ | (value_ << 16)) & 0x0000FFFF0000FFFFULL;
+   value_ = (value_ | (value_ << 8)) & 0x00FF00FF00FF00FFULL;
+   value_ = (value_ | (value_ << 4)) & 0x0F0F0F0F0F0F0F0FULL;
+   value_ = (value_ | (value_ << 2)) & 0x3333333333333333ULL;
+   value_ = (value_ | (value_ << 1)) & 0x5555555555555555ULL;
+
+   return value_;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Gathers the even bits of a 64 bits integer (reverse of geohash36_transcode_spread).
+************************************************************************************************************************
+**/
+static uint64_t geohash36_transcode_gather(uint64_t value_)
+{
+   value_ &= 0x5555555555555555ULL;
+   value_ = (value_ | (value_ >> 1)) & 0x3333333333333333ULL;
+   value_ = (value_ | (value_ >> 2)) & 0x0F0F0F0F0F0F0F0FULL;
+   value_ = (value_ | (value_ >> 4)) & 0x00FF00FF00FF00FFULL;
+   value_ = (value_ | (value_ >> 8)) & 0x0000FFFF0000FFFFULL;
+   value_ = (value_ | (value_ >> 16)) & 0x00000000FFFFFFFFULL;
+
+   return value_;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Splits the interleaved bits of a binary cell (longitude first, as in a base-32 geohash).
+************************************************************************************************************************
+* @param [in] bits_: interleaved bits;
+* @param [in] numBits_: number of bits;
+* @param [out] outGrid_: pointer which will receive the cell.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_transcode_split(uint64_t bits_, int numBits_, geohash36_transcode_grid_t * outGrid_)
+{
+   // The last bit is a longitude one when the number of bits is odd
+   int odd = numBits_ & 1;
+
+   outGrid_->lonIndex = geohash36_transcode_gather(bits_ >> (1 - odd));
+   outGrid_->latIndex = geohash36_transcode_gather(bits_ >> odd);
+   outGrid_->lonBits = (numBits_ + 1) / 2;
+   outGrid_->latBits = numBits_ / 2;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Interleaves the bits of a binary cell (reverse of geohash36_transcode_split).
+************************************************************************************************************************
+**/
+static uint64_t geohash36_transcode_interleave(const geohash36_transcode_grid_t * grid_)
+{
+   int odd = (grid_->latBits + grid_->lonBits) & 1;
+
+   return (geohash36_transcode_spread(grid_->lonIndex) << (1 - odd)) |
+          (geohash36_transcode_spread(grid_->latIndex) << odd);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Maps an index of a Geohash-36 grid axis to the index of the binary cell which contains the center of its cell.
+*
+* The center of cell "index_" out of 6^n falls in cell ((2 * index_ + 1) * 2^bits) / (2 * 6^n) out of 2^bits. The
+* division by 2^(n + 1) is a shift, and the one by 3^n is done in floating point: its operands are exact (below 2^53)
+* and the quotient is correctly rounded, while a non-integer quotient is at least 1/3^n away from the next integer, so
+* truncating it gives the exact result.
+************************************************************************************************************************
+* @param [in] index_: index in the Geohash-36 grid;
+* @param [in] numCharacters_: length of the Geohash-36 grid (up to GEOHASH36_KEY_MAX_CHARACTERS);
+* @param [in] bits_: bits of the binary grid (up to GEOHASH36_MORTON_MAX_BITS).
+************************************************************************************************************************
+* @return Index in the binary grid.
+************************************************************************************************************************
+**/
+static uint64_t geohash36_transcode_toBinary(uint64_t index_, int numCharacters_, int bits_)
+{
+   uint64_t scaled = (((2 * index_) + 1) << bits_) >> (numCharacters_ + 1);
+
+   return (uint64_t)((double)scaled / geohash36_transcode_pow3[numCharacters_]);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Maps an index of a binary grid axis to the index of the Geohash-36 cell which contains the center of its cell.
+************************************************************************************************************************
+* @param [in] index_: index in the binary grid;
+* @param [in] bits_: bits of the binary grid (up to GEOHASH36_MORTON_MAX_BITS);
+* @param [in] numCharacters_: length of the Geohash-36 grid (up to GEOHASH36_KEY_MAX_CHARACTERS).
+************************************************************************************************************************
+* @return Index in the Geohash-36 grid.
+************************************************************************************************************************
+**/
+static uint64_t geohash36_transcode_fromBinary(uint64_t index_, int bits_, int numCharacters_)
+{
+   return (((2 * index_) + 1) * geohash36_pow6[numCharacters_]) >> (bits_ + 1);
+}
+
+/*!
+************************************************************************************************************************
+* @brief Measures the precision lost by mapping a grid axis to another.
+************************************************************************************************************************
+* @param [in] index_: index in the input grid;
+* @param [in] from_: number of cells of the input grid in this axis;
+* @param [in] outIndex_: index in the output grid;
+* @param [in] to_: number of cells of the output grid in this axis;
+* @param [in] span_: degrees covered by this axis;
+* @param [out] partial_: pointer set to 1 when the input cell is not entirely inside the output cell;
+* @param [out] maxError_: pointer to the largest distance between the centers, in degrees.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_transcode_measure(uint64_t index_, uint64_t from_, uint64_t outIndex_, uint64_t to_,
+                                        double span_, int * partial_, double * maxError_)
+{
+   // Both centers scaled by 2 * from_ * to_, to stay in integers
+   int64_t offset = (int64_t)(((2 * index_) + 1) * to_) - (int64_t)(((2 * outIndex_) + 1) * from_);
+   double error = ((double)llabs(offset) * span_) / (2.0 * (double)from_ * (double)to_);
+
+   if ((index_ * to_) / from_ != (((index_ + 1) * to_) - 1) / from_)
+      (*partial_) = 1;
+
+   if (error > (*maxError_))
+      (*maxError_) = error;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Converts a Geohash-36 cell to a binary cell.
+************************************************************************************************************************
+* @param [in] cell_: pointer to the Geohash-36 cell (up to GEOHASH36_KEY_MAX_CHARACTERS);
+* @param [in,out] grid_: pointer to the binary cell ("latBits" and "lonBits" set by the caller);
+* @param [in,out] report_: optional pointer to the report.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_transcode_toGrid(const geohash36_cell_t * cell_, geohash36_transcode_grid_t * grid_,
+                                       geohash36_transcode_report_t * report_)
+{
+   uint64_t numCells = geohash36_pow6[cell_->numCharacters];
+   uint64_t numRows = 1ULL << grid_->latBits, numColumns = 1ULL << grid_->lonBits;
+   int partial = 0;
+
+   grid_->latIndex = geohash36_transcode_toBinary(cell_->latIndex, cell_->numCharacters, grid_->latBits);
+   grid_->lonIndex = geohash36_transcode_toBinary(cell_->lonIndex, cell_->numCharacters, grid_->lonBits);
+
+   if (report_ == NULL)
+      return;
+
+   geohash36_transcode_measure(cell_->latIndex, numCells, grid_->latIndex, numRows, 180.0, &partial,
+                               &report_->maxLatError);
+   geohash36_transcode_measure(cell_->lonIndex, numCells, grid_->lonIndex, numColumns, 360.0, &partial,
+                               &report_->maxLonError);
+   report_->numPartial += partial;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Converts a binary cell to a Geohash-36 cell.
+************************************************************************************************************************
+* @param [in] grid_: pointer to the binary cell;
+* @param [in,out] cell_: pointer to the Geohash-36 cell ("numCharacters" set by the caller, up to
+*                        GEOHASH36_KEY_MAX_CHARACTERS);
+* @param [in,out] report_: optional pointer to the report.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_transcode_fromGrid(const geohash36_transcode_grid_t * grid_, geohash36_cell_t * cell_,
+                                         geohash36_transcode_report_t * report_)
+{
+   uint64_t numCells = geohash36_pow6[cell_->numCharacters];
+   uint64_t numRows = 1ULL << grid_->latBits, numColumns = 1ULL << grid_->lonBits;
+   int partial = 0;
+
+   cell_->latIndex = geohash36_transcode_fromBinary(grid_->latIndex, grid_->latBits, cell_->numCharacters);
+   cell_->lonIndex = geohash36_transcode_fromBinary(grid_->lonIndex, grid_->lonBits, cell_->numCharacters);
+
+   if (report_ == NULL)
+      return;
+
+   geohash36_transcode_measure(grid_->latIndex, numRows, cell_->latIndex, numCells, 180.0, &partial,
+                               &report_->maxLatError);
+   geohash36_transcode_measure(grid_->lonIndex, numColumns, cell_->lonIndex, numCells, 360.0, &partial,
+                               &report_->maxLonError);
+   report_->numPartial += partial;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Reads a base-32 geohash.
+************************************************************************************************************************
+* @param [in] hash_: pointer to the geohash;
+* @param [in] numCharacters_: geohash length;
+* @param [out] outGrid_: pointer which will receive the cell.
+************************************************************************************************************************
+* @return 0 if valid, -1 otherwise.
+************************************************************************************************************************
+**/
+static int geohash36_transcode_readGeohash32(const char * hash_, int numCharacters_,
+                                             geohash36_transcode_grid_t * outGrid_)
+{
+   uint64_t bits = 0;
+   uint8_t invalid = 0, value;
+
+   for (int i = 0; i < numCharacters_; i++)
+   {
+      value = geohash32_index[(uint8_t)hash_[i]];
+      invalid |= (value == 0);
+      bits = (bits << GEOHASH32_CHAR_BITS) | (uint8_t)(value - 1);
+   }
+
+   if (invalid)
+      return -1;
+
+   geohash36_transcode_split(bits, numCharacters_ * GEOHASH32_CHAR_BITS, outGrid_);
+
+   return 0;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Writes a base-32 geohash.
+************************************************************************************************************************
+* @param [in] grid_: pointer to the cell;
+* @param [out] outHash_: buffer of "numCharacters_" characters which will receive the geohash;
+* @param [in] numCharacters_: geohash length.
+************************************************************************************************************************
+* @return None.
+************************************************************************************************************************
+**/
+static void geohash36_transcode_writeGeohash32(const geohash36_transcode_grid_t * grid_, char * outHash_,
+                                               int numCharacters_)
+{
+   uint64_t bits = geohash36_transcode_interleave(grid_);
+
+   for (int i = numCharacters_ - 1; i >= 0; i--)
+   {
+      outHash_[i] = geohash32_alphabet[bits & 0x1F];
+      bits >>= GEOHASH32_CHAR_BITS;
+   }
+}
+
+/***********************************************************************************************************************
+External functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Converts fixed length Geohash-36 strings to base-32 geohashes.
+*
+* Invalid hashes don't stop the conversion: their output is filled with GEOHASH36_TRANSCODE_INVALID_CHAR.
+************************************************************************************************************************
+* @param [in] hashes_: buffer of "n_ * numCharacters_" characters with the hashes one after the other;
+* @param [in] n_: number of hashes;
+* @param [in] numCharacters_: length of each hash (1 to GEOHASH36_KEY_MAX_CHARACTERS);
+* @param [out] out_: buffer of "n_ * outCharacters_" characters which will receive the geohashes;
+* @param [in] outCharacters_: length of the geohashes (1 to GEOHASH36_GEOHASH32_MAX_CHARACTERS);
+* @param [out] outReport_: optional pointer which will receive the precision lost (can be NULL).
+************************************************************************************************************************
+* @return Number of invalid hashes (0 when every hash was converted), or -1 for invalid arguments.
+************************************************************************************************************************
+**/
+long geohash36_toGeohash32_batch(const char * hashes_, size_t n_, int numCharacters_, char * out_, int outCharacters_,
+                                 geohash36_transcode_report_t * outReport_)
+{
+   int numBits = outCharacters_ * GEOHASH32_CHAR_BITS;
+   geohash36_transcode_grid_t grid = { 0, 0, numBits / 2, (numBits + 1) / 2 };
+   geohash36_cell_t cell;
+   long invalid = 0;
+
+   if ((((hashes_ == NULL) || (out_ == NULL)) && (n_ > 0)) || (numCharacters_ < 1) ||
+       (numCharacters_ > GEOHASH36_KEY_MAX_CHARACTERS) || (outCharacters_ < 1) ||
+       (outCharacters_ > GEOHASH36_GEOHASH32_MAX_CHARACTERS))
+      return -1;
+
+   if (outReport_ != NULL)
+      memset(outReport_, 0, sizeof(geohash36_transcode_report_t));
+
+   for (size_t i = 0; i < n_; i++)
+   {
+      if (geohash36_stringToCell(hashes_ + (i * numCharacters_), numCharacters_, &cell) != 0)
+      {
+         memset(out_ + (i * outCharacters_), GEOHASH36_TRANSCODE_INVALID_CHAR, outCharacters_);
+         invalid++;
+         continue;
+      }
+
+      geohash36_transcode_toGrid(&cell, &grid, outReport_);
+      geohash36_transcode_writeGeohash32(&grid, out_ + (i * outCharacters_), outCharacters_);
+   }
+
+   return invalid;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Converts packed keys (of any length) to base-32 geohashes.
+*
+* Invalid keys don't stop the conversion: their output is filled with GEOHASH36_TRANSCODE_INVALID_CHAR.
+************************************************************************************************************************
+* @param [in] keys_: array of keys;
+* @param [in] n_: number of keys;
+* @param [out] out_: buffer of "n_ * outCharacters_" characters which will receive the geohashes;
+* @param [in] outCharacters_: length of the geohashes (1 to GEOHASH36_GEOHASH32_MAX_CHARACTERS);
+* @param [out] outReport_: optional pointer which will receive the precision lost (can be NULL).
+************************************************************************************************************************
+* @return Number of invalid keys (0 when every key was converted), or -1 for invalid arguments.
+************************************************************************************************************************
+**/
+long geohash36_keyToGeohash32_batch(const geohash36_key_t * keys_, size_t n_, char * out_, int outCharacters_,
+                                    geohash36_transcode_report_t * outReport_)
+{
+   int numBits = outCharacters_ * GEOHASH32_CHAR_BITS;
+   geohash36_transcode_grid_t grid = { 0, 0, numBits / 2, (numBits + 1) / 2 };
+   geohash36_cell_t cell;
+   long invalid = 0;
+
+   if ((((keys_ == NULL) || (out_ == NULL)) && (n_ > 0)) || (outCharacters_ < 1) ||
+       (outCharacters_ > GEOHASH36_GEOHASH32_MAX_CHARACTERS))
+      return -1;
+
+   if (outReport_ != NULL)
+      memset(outReport_, 0, sizeof(geohash36_transcode_report_t));
+
+   for (size_t i = 0; i < n_; i++)
+   {
+      if (geohash36_keyToCell(keys_[i], &cell) != 0)
+      {
+         memset(out_ + (i * outCharacters_), GEOHASH36_TRANSCODE_INVALID_CHAR, outCharacters_);
+         invalid++;
+         continue;
+      }
+
+      geohash36_transcode_toGrid(&cell, &grid, outReport_);
+      geohash36_transcode_writeGeohash32(&grid, out_ + (i * outCharacters_), outCharacters_);
+   }
+
+   return invalid;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Converts fixed length base-32 geohashes to Geohash-36 strings.
+*
+* Invalid geohashes don't stop the conversion: their output is filled with GEOHASH36_TRANSCODE_INVALID_CHAR.
+************************************************************************************************************************
+* @param [in] hashes_: buffer of "n_ * numCharacters_" characters with the geohashes one after the other;
+* @param [in] n_: number of geohashes;
+* @param [in] numCharacters_: length of each geohash (1 to GEOHASH36_GEOHASH32_MAX_CHARACTERS);
+* @param [out] out_: buffer of "n_ * outCharacters_" characters which will receive the hashes;
+* @param [in] outCharacters_: length of the hashes (1 to GEOHASH36_KEY_MAX_CHARACTERS);
+* @param [out] outReport_: optional pointer which will receive the precision lost (can be NULL).
+************************************************************************************************************************
+* @return Number of invalid geohashes (0 when every geohash was converted), or -1 for invalid arguments.
+************************************************************************************************************************
+**/
+long geohash36_fromGeohash32_batch(const char * hashes_, size_t n_, int numCharacters_, char * out_, int outCharacters_,
+                                   geohash36_transcode_report_t * outReport_)
+{
+   geohash36_transcode_grid_t grid;
+   geohash36_cell_t cell = { 0, 0, outCharacters_ };
+   long invalid = 0;
+
+   if ((((hashes_ == NULL) || (out_ == NULL)) && (n_ > 0)) || (numCharacters_ < 1) ||
+       (numCharacters_ > GEOHASH36_GEOHASH32_MAX_CHARACTERS) || (outCharacters_ < 1) ||
+       (outCharacters_ > GEOHASH36_KEY_MAX_CHARACTERS))
+      return -1;
+
+   if (outReport_ != NULL)
+      memset(outReport_, 0, sizeof(geohash36_transcode_report_t));
+
+   for (size_t i = 0; i < n_; i++)
+   {
+      if (geohash36_transcode_readGeohash32(hashes_ + (i * numCharacters_), numCharacters_, &grid) != 0)
+      {
+         memset(out_ + (i * outCharacters_), GEOHASH36_TRANSCODE_INVALID_CHAR, outCharacters_);
+         invalid++;
+         continue;
+      }
+
+      geohash36_transcode_fromGrid(&grid, &cell, outReport_);
+      geohash36_cellToString(&cell, out_ + (i * outCharacters_));
+   }
+
+   return invalid;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Converts fixed length base-32 geohashes to packed keys.
+*
+* Invalid geohashes don't stop the conversion: their output is GEOHASH36_KEY_INVALID.
+************************************************************************************************************************
+* @param [in] hashes_: buffer of "n_ * numCharacters_" characters with the geohashes one after the other;
+* @param [in] n_: number of geohashes;
+* @param [in] numCharacters_: length of each geohash (1 to GEOHASH36_GEOHASH32_MAX_CHARACTERS);
+* @param [out] out_: array of "n_" keys which will receive the result;
+* @param [in] outCharacters_: length of the keys (1 to GEOHASH36_KEY_MAX_CHARACTERS);
+* @param [out] outReport_: optional pointer which will receive the precision lost (can be NULL).
+************************************************************************************************************************
+* @return Number of invalid geohashes (0 when every geohash was converted), or -1 for invalid arguments.
+************************************************************************************************************************
+**/
+long geohash36_geohash32ToKey_batch(const char * hashes_, size_t n_, int numCharacters_, geohash36_key_t * out_,
+                                    int outCharacters_, geohash36_transcode_report_t * outReport_)
+{
+   geohash36_transcode_grid_t grid;
+   geohash36_cell_t cell = { 0, 0, outCharacters_ };
+   long invalid = 0;
+
+   if ((((hashes_ == NULL) || (out_ == NULL)) && (n_ > 0)) || (numCharacters_ < 1) ||
+       (numCharacters_ > GEOHASH36_GEOHASH32_MAX_CHARACTERS) || (outCharacters_ < 1) ||
+       (outCharacters_ > GEOHASH36_KEY_MAX_CHARACTERS))
+      return -1;
+
+   if (outReport_ != NULL)
+      memset(outReport_, 0, sizeof(geohash36_transcode_report_t));
+
+   for (size_t i = 0; i < n_; i++)
+   {
+      if (geohash36_transcode_readGeohash32(hashes_ + (i * numCharacters_), numCharacters_, &grid) != 0)
+      {
+         out_[i] = GEOHASH36_KEY_INVALID;
+         invalid++;
+         continue;
+      }
+
+      geohash36_transcode_fromGrid(&grid, &cell, outReport_);
+      out_[i] = geohash36_cellToKey(&cell);
+   }
+
+   return invalid;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Converts packed keys (of any length) to Morton cell IDs.
+*
+* A Morton ID of "numBits_" bits per axis interleaves the column (odd bits) and the row (even bits) of a 2^numBits_ x
+* 2^numBits_ grid, most significant bits first: it is the integer value of a base-32 geohash of 2 * numBits_ bits.
+* Invalid keys don't stop the conversion: their output is GEOHASH36_MORTON_INVALID.
+************************************************************************************************************************
+* @param [in] keys_: array of keys;
+* @param [in] n_: number of keys;
+* @param [out] out_: array of "n_" IDs which will receive the result;
+* @param [in] numBits_: bits per axis of the IDs (1 to GEOHASH36_MORTON_MAX_BITS);
+* @param [out] outReport_: optional pointer which will receive the precision lost (can be NULL).
+************************************************************************************************************************
+* @return Number of invalid keys (0 when every key was converted), or -1 for invalid arguments.
+************************************************************************************************************************
+**/
+long geohash36_keyToMorton_batch(const geohash36_key_t * keys_, size_t n_, uint64_t * out_, int numBits_,
+                                 geohash36_transcode_report_t * outReport_)
+{
+   geohash36_transcode_grid_t grid = { 0, 0, numBits_, numBits_ };
+   geohash36_cell_t cell;
+   long invalid = 0;
+
+   if ((((keys_ == NULL) || (out_ == NULL)) && (n_ > 0)) || (numBits_ < 1) || (numBits_ > GEOHASH36_MORTON_MAX_BITS))
+      return -1;
+
+   if (outReport_ != NULL)
+      memset(outReport_, 0, sizeof(geohash36_transcode_report_t));
+
+   for (size_t i = 0; i < n_; i++)
+   {
+      if (geohash36_keyToCell(keys_[i], &cell) != 0)
+      {
+         out_[i] = GEOHASH36_MORTON_INVALID;
+         invalid++;
+         continue;
+      }
+
+      geohash36_transcode_toGrid(&cell, &grid, outReport_);
+      out_[i] = geohash36_transcode_interleave(&grid);
+   }
+
+   return invalid;
+}
+
+/*!
+************************************************************************************************************************
+* @brief Converts Morton cell IDs to packed keys.
+*
+* Invalid IDs (wider than 2 * numBits_ bits) don't stop the conversion: their output is GEOHASH36_KEY_INVALID.
+************************************************************************************************************************
+* @param [in] ids_: array of IDs;
+* @param [in] n_: number of IDs;
+* @param [in] numBits_: bits per axis of the IDs (1 to GEOHASH36_MORTON_MAX_BITS);
+* @param [out] out_: array of "n_" keys which will receive the result;
+* @param [in] outCharacters_: length of the keys (1 to GEOHASH36_KEY_MAX_CHARACTERS);
+* @param [out] outReport_: optional pointer which will receive the precision lost (can be NULL).
+************************************************************************************************************************
+* @return Number of invalid IDs (0 when every ID was converted), or -1 for invalid arguments.
+************************************************************************************************************************
+**/
+long geohash36_mortonToKey_batch(const uint64_t * ids_, size_t n_, int numBits_, geohash36_key_t * out_,
+                                 int outCharacters_, geohash36_transcode_report_t * outReport_)
+{
+   geohash36_transcode_grid_t grid;
+   geohash36_cell_t cell = { 0, 0, outCharacters_ };
+   long invalid = 0;
+
+   if ((((ids_ == NULL) || (out_ == NULL)) && (n_ > 0)) || (numBits_ < 1) || (numBits_ > GEOHASH36_MORTON_MAX_BITS) ||
+       (outCharacters_ < 1) || (outCharacters_ > GEOHASH36_KEY_MAX_CHARACTERS))
+      return -1;
+
+   if (outReport_ != NULL)
+      memset(outReport_, 0, sizeof(geohash36_transcode_report_t));
+
+   for (size_t i = 0; i < n_; i++)
+   {
+      if ((ids_[i] >> (2 * numBits_)) != 0)
+      {
+         out_[i] = GEOHASH36_KEY_INVALID;
+         invalid++;
+         continue;
+      }
+
+      geohash36_transcode_split(ids_[i], 2 * numBits_, &grid);
+      geohash36_transcode_fromGrid(&grid, &cell, outReport_);
+      out_[i] = geohash36_cellToKey(&cell);
+   }
+
+   return invalid;
+}
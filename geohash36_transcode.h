@@ -0,0 +1,183 @@
+#ifndef _GEOHASH36_TRANSCODE_H_
+#define _GEOHASH36_TRANSCODE_H_
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "stddef.h"
+#include "geohash36.h"
+
+/***********************************************************************************************************************
+Defines/macros
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Maximum length of a base-32 geohash (60 bits, 30 per axis).
+************************************************************************************************************************
+**/
+#define GEOHASH36_GEOHASH32_MAX_CHARACTERS   12
+
+/*!
+************************************************************************************************************************
+* @brief Maximum number of bits per axis of a Morton cell ID.
+************************************************************************************************************************
+**/
+#define GEOHASH36_MORTON_MAX_BITS            31
+
+/*!
+************************************************************************************************************************
+* @brief Morton cell ID returned for invalid input (never a valid ID, which has at most 62 bits).
+************************************************************************************************************************
+**/
+#define GEOHASH36_MORTON_INVALID             UINT64_MAX
+
+/*!
+************************************************************************************************************************
+* @brief Character written in the output hashes of invalid input.
+************************************************************************************************************************
+**/
+#define GEOHASH36_TRANSCODE_INVALID_CHAR     '?'
+
+/***********************************************************************************************************************
+Typedefs/structs/unions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Precision lost by a conversion.
+*
+* Rows and columns of both grids start at the south pole and at the antimeridian, but a Geohash-36 grid has 6^n of
+* them and the binary grids (base-32 geohash, Morton) 2^n, so their borders never line up. Each input cell is mapped to
+* the output cell which contains its center. "numPartial" counts the input cells which are not entirely inside their
+* output cell (always the case when the output is finer), and the errors are the largest distances between the center
+* of an input cell and the center of its output cell.
+************************************************************************************************************************
+**/
+typedef struct
+{
+   size_t numPartial;
+   double maxLatError;
+   double maxLonError;
+
+}geohash36_transcode_report_t;
+
+/***********************************************************************************************************************
+Exported functions
+***********************************************************************************************************************/
+
+/*!
+************************************************************************************************************************
+* @brief Converts fixed length Geohash-36 strings to base-32 geohashes.
+*
+* Invalid hashes don't stop the conversion: their output is filled with GEOHASH36_TRANSCODE_INVALID_CHAR.
+************************************************************************************************************************
+* @param [in] hashes_: buffer of "n_ * numCharacters_" characters with the hashes one after the other;
+* @param [in] n_: number of hashes;
+* @param [in] numCharacters_: length of each hash (1 to GEOHASH36_KEY_MAX_CHARACTERS);
+* @param [out] out_: buffer of "n_ * outCharacters_" characters which will receive the geohashes;
+* @param [in] outCharacters_: length of the geohashes (1 to GEOHASH36_GEOHASH32_MAX_CHARACTERS);
+* @param [out] outReport_: optional pointer which will receive the precision lost (can be NULL).
+************************************************************************************************************************
+* @return Number of invalid hashes (0 when every hash was converted), or -1 for invalid arguments.
+************************************************************************************************************************
+**/
+long geohash36_toGeohash32_batch(const char * hashes_, size_t n_, int numCharacters_, char * out_, int outCharacters_,
+                                 geohash36_transcode_report_t * outReport_);
+
+/*!
+************************************************************************************************************************
+* @brief Converts packed keys (of any length) to base-32 geohashes.
+*
+* Invalid keys don't stop the conversion: their output is filled with GEOHASH36_TRANSCODE_INVALID_CHAR.
+************************************************************************************************************************
+* @param [in] keys_: array of keys;
+* @param [in] n_: number of keys;
+* @param [out] out_: buffer of "n_ * outCharacters_" characters which will receive the geohashes;
+* @param [in] outCharacters_: length of the geohashes (1 to GEOHASH36_GEOHASH32_MAX_CHARACTERS);
+* @param [out] outReport_: optional pointer which will receive the precision lost (can be NULL).
+************************************************************************************************************************
+* @return Number of invalid keys (0 when every key was converted), or -1 for invalid arguments.
+************************************************************************************************************************
+**/
+long geohash36_keyToGeohash32_batch(const geohash36_key_t * keys_, size_t n_, char * out_, int outCharacters_,
+                                    geohash36_transcode_report_t * outReport_);
+
+/*!
+************************************************************************************************************************
+* @brief Converts fixed length base-32 geohashes to Geohash-36 strings.
+*
+* Invalid geohashes don't stop the conversion: their output is filled with GEOHASH36_TRANSCODE_INVALID_CHAR.
+************************************************************************************************************************
+* @param [in] hashes_: buffer of "n_ * numCharacters_" characters with the geohashes one after the other;
+* @param [in] n_: number of geohashes;
+* @param [in] numCharacters_: length of each geohash (1 to GEOHASH36_GEOHASH32_MAX_CHARACTERS);
+* @param [out] out_: buffer of "n_ * outCharacters_" characters which will receive the hashes;
+* @param [in] outCharacters_: length of the hashes (1 to GEOHASH36_KEY_MAX_CHARACTERS);
+* @param [out] outReport_: optional pointer which will receive the precision lost (can be NULL).
+************************************************************************************************************************
+* @return Number of invalid geohashes (0 when every geohash was converted), or -1 for invalid arguments.
+************************************************************************************************************************
+**/
+long geohash36_fromGeohash32_batch(const char * hashes_, size_t n_, int numCharacters_, char * out_, int outCharacters_,
+                                   geohash36_transcode_report_t * outReport_);
+
+/*!
+************************************************************************************************************************
+* @brief Converts fixed length base-32 geohashes to packed keys.
+*
+* Invalid geohashes don't stop the conversion: their output is GEOHASH36_KEY_INVALID.
+************************************************************************************************************************
+* @param [in] hashes_: buffer of "n_ * numCharacters_" characters with the geohashes one after the other;
+* @param [in] n_: number of geohashes;
+* @param [in] numCharacters_: length of each geohash (1 to GEOHASH36_GEOHASH32_MAX_CHARACTERS);
+* @param [out] out_: array of "n_" keys which will receive the result;
+* @param [in] outCharacters_: length of the keys (1 to GEOHASH36_KEY_MAX_CHARACTERS);
+* @param [out] outReport_: optional pointer which will receive the precision lost (can be NULL).
+************************************************************************************************************************
+* @return Number of invalid geohashes (0 when every geohash was converted), or -1 for invalid arguments.
+************************************************************************************************************************
+**/
+long geohash36_geohash32ToKey_batch(const char * hashes_, size_t n_, int numCharacters_, geohash36_key_t * out_,
+                                    int outCharacters_, geohash36_transcode_report_t * outReport_);
+
+/*!
+************************************************************************************************************************
+* @brief Converts packed keys (of any length) to Morton cell IDs.
+*
+* A Morton ID of "numBits_" bits per axis interleaves the column (odd bits) and the row (even bits) of a 2^numBits_ x
+* 2^numBits_ grid, most significant bits first: it is the integer value of a base-32 geohash of 2 * numBits_ bits.
+* Invalid keys don't stop the conversion: their output is GEOHASH36_MORTON_INVALID.
+************************************************************************************************************************
+* @param [in] keys_: array of keys;
+* @param [in] n_: number of keys;
+* @param [out] out_: array of "n_" IDs which will receive the result;
+* @param [in] numBits_: bits per axis of the IDs (1 to GEOHASH36_MORTON_MAX_BITS);
+* @param [out] outReport_: optional pointer which will receive the precision lost (can be NULL).
+************************************************************************************************************************
+* @return Number of invalid keys (0 when every key was converted), or -1 for invalid arguments.
+************************************************************************************************************************
+**/
+long geohash36_keyToMorton_batch(const geohash36_key_t * keys_, size_t n_, uint64_t * out_, int numBits_,
+                                 geohash36_transcode_report_t * outReport_);
+
+/*!
+************************************************************************************************************************
+* @brief Converts Morton cell IDs to packed keys.
+*
+* Invalid IDs (wider than 2 * numBits_ bits) don't stop the conversion: their output is GEOHASH36_KEY_INVALID.
+************************************************************************************************************************
+* @param [in] ids_: array of IDs;
+* @param [in] n_: number of IDs;
+* @param [in] numBits_: bits per axis of the IDs (1 to GEOHASH36_MORTON_MAX_BITS);
+* @param [out] out_: array of "n_" keys which will receive the result;
+* @param [in] outCharacters_: length of the keys (1 to GEOHASH36_KEY_MAX_CHARACTERS);
+* @param [out] outReport_: optional pointer which will receive the precision lost (can be NULL).
+************************************************************************************************************************
+* @return Number of invalid IDs (0 when every ID was converted), or -1 for invalid arguments.
+************************************************************************************************************************
+**/
+long geohash36_mortonToKey_batch(const uint64_t * ids_, size_t n_, int numBits_, geohash36_key_t * out_,
+                                 int outCharacters_, geohash36_transcode_report_t * outReport_);
+
+#endif // _GEOHASH36_TRANSCODE_H_